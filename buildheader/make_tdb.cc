@@ -373,6 +373,12 @@ static void print_db_env_struct (void) {
                              "int (*cleaner_get_iterations)               (DB_ENV*, uint32_t*) /* Retrieve the number of attempts on each cleaner invocation.  0 means disabled. */",
                              "int (*evictor_set_enable_partial_eviction)  (DB_ENV*, bool) /* Enables or disabled partial eviction of nodes from cachetable. */",
                              "int (*evictor_get_enable_partial_eviction)  (DB_ENV*, bool*) /* Retrieve the status of partial eviction of nodes from cachetable. */",
+                             "int (*evictor_set_eviction_policy)          (DB_ENV*, TOKU_EVICTION_POLICY) /* Select the cachetable replacement policy. */",
+                             "int (*evictor_get_eviction_policy)          (DB_ENV*, TOKU_EVICTION_POLICY*) /* Retrieve the cachetable replacement policy. */",
+                             "int (*set_checksum_method)                  (DB_ENV*, TOKU_CHECKSUM_METHOD) /* Select the checksum for dictionaries and log files created from now on.  Must be called before open. */",
+                             "int (*get_checksum_method)                  (DB_ENV*, TOKU_CHECKSUM_METHOD*) /* Retrieve the checksum for new dictionaries and log files. */",
+                             "int (*set_group_commit_policy)              (DB_ENV*, uint32_t max_delay_usec, uint32_t min_batch) /* Let the log flusher wait up to max_delay_usec for min_batch committers before each fsync.  0 means fsync right away. */",
+                             "int (*get_group_commit_policy)              (DB_ENV*, uint32_t *max_delay_usec, uint32_t *min_batch) /* Retrieve the group commit policy. */",
                              "int (*checkpointing_postpone)               (DB_ENV*) /* Use for 'rename table' or any other operation that must be disjoint from a checkpoint */",
                              "int (*checkpointing_resume)                 (DB_ENV*) /* Alert tokuft that 'postpone' is no longer necessary */",
                              "int (*checkpointing_begin_atomic_operation) (DB_ENV*) /* Begin a set of operations (that must be atomic as far as checkpoints are concerned). i.e. inserting into every index in one table */",
@@ -403,6 +409,12 @@ static void print_db_env_struct (void) {
                              "int (*set_redzone)                          (DB_ENV *env, int redzone) /* set the redzone limit in percent of total space */",
                              "int (*set_lk_max_memory)                    (DB_ENV *env, uint64_t max)",
                              "int (*get_lk_max_memory)                    (DB_ENV *env, uint64_t *max)",
+                             "int (*set_lock_partitions)                  (DB_ENV *env, uint32_t num_partitions) /* range partition new locktrees */",
+                             "int (*get_lock_partitions)                  (DB_ENV *env, uint32_t *num_partitions)",
+                             "int (*set_lock_deadlock_victim)             (DB_ENV *env, TOKU_DEADLOCK_VICTIM victim) /* which txn on a wait-for cycle gets DB_LOCK_DEADLOCK */",
+                             "int (*get_lock_deadlock_victim)             (DB_ENV *env, TOKU_DEADLOCK_VICTIM *victim)",
+                             "int (*set_lock_escalation_soft_limit)       (DB_ENV *env, uint32_t percent) /* escalate in the background from this percent of lk_max_memory */",
+                             "int (*get_lock_escalation_soft_limit)       (DB_ENV *env, uint32_t *percent)",
                              "void (*set_update)                          (DB_ENV *env, int (*update_function)(DB *, const DBT *key, const DBT *old_val, const DBT *extra, void (*set_val)(const DBT *new_val, void *set_extra), void *set_extra))",
                              "int (*set_lock_timeout)                     (DB_ENV *env, uint64_t default_lock_wait_time_msec, uint64_t (*get_lock_wait_time_cb)(uint64_t default_lock_wait_time))",
                              "int (*get_lock_timeout)                     (DB_ENV *env, uint64_t *lock_wait_time_msec)",
@@ -422,6 +434,7 @@ static void print_db_env_struct (void) {
                              "int (*set_client_pool_threads)(DB_ENV *, uint32_t)",
                              "int (*set_cachetable_pool_threads)(DB_ENV *, uint32_t)",
                              "int (*set_checkpoint_pool_threads)(DB_ENV *, uint32_t)",
+                             "int (*set_cachetable_numa_nodes)(DB_ENV *, uint32_t num_nodes, bool fake_nodes) /* Split the cachetable across NUMA nodes, must be called before open. */",
                              "void (*set_check_thp)(DB_ENV *, bool new_val)",
                              "bool (*get_check_thp)(DB_ENV *)",
                              "bool (*set_dir_per_db)(DB_ENV *, bool new_val)",
@@ -675,8 +688,29 @@ int main (int argc, char *const argv[] __attribute__((__unused__))) {
     printf("    TOKU_DEFAULT_COMPRESSION_METHOD = 1,\n");  // default is actually quicklz
     printf("    TOKU_FAST_COMPRESSION_METHOD = 2,\n");  // friendlier names
     printf("    TOKU_SMALL_COMPRESSION_METHOD = 3,\n");
+    printf("    TOKU_ZSTD_DICTIONARY_METHOD = 4,\n");  // zstd against a dictionary trained by hot optimize.  Stored as TOKU_ZSTD_METHOD with a flag in the high-order nibble.
+    printf("    TOKU_ADAPTIVE_COMPRESSION_METHOD = 5,\n");  // pick none, snappy, zstd or zlib for each partition by how well it compresses.  Stored as the method picked.
     printf("} TOKU_COMPRESSION_METHOD;\n");
 
+    // cachetable replacement policies
+    printf("typedef enum toku_eviction_policy {\n");
+    printf("    TOKU_EVICTION_POLICY_CLOCK = 0,\n");  // classic clock
+    printf("    TOKU_EVICTION_POLICY_2Q    = 1,\n");  // scan resistant 2Q on top of the clock
+    printf("} TOKU_EVICTION_POLICY;\n");
+
+    // lock deadlock victim policies
+    printf("typedef enum toku_deadlock_victim {\n");
+    printf("    TOKU_DEADLOCK_VICTIM_REQUESTER  = 0,\n");  // the txn whose lock request closed the cycle
+    printf("    TOKU_DEADLOCK_VICTIM_YOUNGEST   = 1,\n");  // the txn on the cycle with the largest txnid
+    printf("    TOKU_DEADLOCK_VICTIM_LEAST_WORK = 2,\n");  // the txn on the cycle holding the fewest locks in the locktree
+    printf("} TOKU_DEADLOCK_VICTIM;\n");
+
+    // checksums for ftnodes and log entries
+    printf("typedef enum toku_checksum_method {\n");
+    printf("    TOKU_CHECKSUM_X1764  = 0,\n");  // the only method before layout version 30
+    printf("    TOKU_CHECKSUM_CRC32C = 1,\n");  // crc32c, uses the SSE4.2 crc32 instruction when available
+    printf("} TOKU_CHECKSUM_METHOD;\n");
+
     //bulk loader
     printf("typedef struct __toku_loader DB_LOADER;\n");
     printf("struct __toku_loader_internal;\n");
@@ -811,6 +845,10 @@ int main (int argc, char *const argv[] __attribute__((__unused__))) {
     printf("int toku_close_trace_file (void) %s;\n", VISIBLE);
     printf("void db_env_set_direct_io (bool direct_io_on) %s;\n", VISIBLE);
     printf("void db_env_set_compress_buffers_before_eviction (bool compress_buffers) %s;\n", VISIBLE);
+    printf("void db_env_set_cursor_readahead_window (uint32_t num_leaves) %s;\n", VISIBLE);
+    printf("void db_env_set_background_gc_threshold (uint32_t num_uxrs) %s;\n", VISIBLE);
+    printf("void db_env_set_adaptive_compression_min_throughput (uint64_t mb_per_sec) %s;\n", VISIBLE);
+    printf("void db_env_set_recovery_threads (uint32_t num_threads) %s;\n", VISIBLE);
     printf("void db_env_set_func_fsync (int (*)(int)) %s;\n", VISIBLE);
     printf("void db_env_set_func_free (void (*)(void*)) %s;\n", VISIBLE);
     printf("void db_env_set_func_malloc (void *(*)(size_t)) %s;\n", VISIBLE);
@@ -22,6 +22,7 @@ check_include_files(inttypes.h HAVE_INTTYPES_H)
 check_include_files(libkern/OSAtomic.h HAVE_LIBKERN_OSATOMIC_H)
 check_include_files(libkern/OSByteOrder.h HAVE_LIBKERN_OSBYTEORDER_H)
 check_include_files(limits.h HAVE_LIMITS_H)
+check_include_files(linux/io_uring.h HAVE_LINUX_IO_URING_H)
 check_include_files(machine/endian.h HAVE_MACHINE_ENDIAN_H)
 check_include_files(malloc.h HAVE_MALLOC_H)
 check_include_files(malloc/malloc.h HAVE_MALLOC_MALLOC_H)
@@ -138,6 +138,8 @@ ExternalProject_Add_Step(build_zstd reclone_src # Names of project and custom st
 )
 
 include_directories("${CMAKE_CURRENT_BINARY_DIR}/${CMAKE_CFG_INTDIR}/zstd/include")
+## zstd does not install zdict.h, which we need to train dictionaries
+include_directories("${ZSTD_SOURCE_DIR}/lib/dictBuilder")
 
 add_library(zstd STATIC IMPORTED)
 set_target_properties(zstd PROPERTIES IMPORTED_LOCATION
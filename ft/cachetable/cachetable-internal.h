@@ -194,6 +194,8 @@ struct ctpair {
 
     // protected by PAIR->mutex
     uint32_t count;        // clock count
+    bool frequent;         // false while the pair is probationary under the 2Q policy
+    uint32_t numa_node;    // node whose share of the cachetable this pair is charged to
     uint32_t refcount; // if > 0, then this PAIR is referenced by
                        // callers to the cachetable, and therefore cannot 
                        // be evicted
@@ -278,6 +280,18 @@ public:
     uint32_t m_num_locks;
     PAIR *m_table; // hash table
     toku_mutex_aligned_t *m_mutexes; 
+    //
+    // While the hash table is being grown, the pairs that have not yet
+    // been moved to m_table are still chained off the old table. A
+    // bucket of either table is only ever modified while holding the
+    // write list lock and the bucket's mutex. Because the table is never
+    // smaller than m_num_locks, every pair in a bucket, old or new,
+    // hashes to the same mutex, so holding the mutex for a fullhash is
+    // enough to look that pair up. m_table and m_old_table themselves
+    // are only swapped while every bucket mutex is held.
+    //
+    uint32_t m_old_table_size;
+    PAIR *m_old_table; // non-null only while a resize is in progress
     // 
     // The following fields are the heads of various linked lists.
     // They also protected by the list lock, but their 
@@ -332,6 +346,9 @@ public:
     void add_to_cachetable_only(PAIR p);
     void put(PAIR pair);
     PAIR find_pair(CACHEFILE file, CACHEKEY key, uint32_t hash);
+    void maybe_grow_table();
+    uint32_t num_buckets();
+    PAIR bucket_chain(uint32_t i);
     void pending_pairs_remove (PAIR p);
     void verify();
     void get_state(int *num_entries, int *hash_size);
@@ -357,6 +374,8 @@ private:
     void add_to_cf_list (PAIR p);
     void add_to_clock (PAIR p);
     void add_to_hash_chain(PAIR p);
+    void lock_all_buckets();
+    void unlock_all_buckets();
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -455,6 +474,12 @@ private:
 //
 const int EVICTION_PERIOD = 1;
 
+//
+// This is how many node reads and writes the cachetable's
+// asynchronous I/O engine keeps in flight at most.
+//
+const uint32_t AIO_QUEUE_DEPTH = 128;
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // The evictor handles the removal of pairs from the pair list/cachetable.
@@ -483,6 +508,15 @@ public:
     void fill_engine_status();
     void set_enable_partial_eviction(bool enabled);
     bool get_enable_partial_eviction(void) const;
+    void set_eviction_policy(enum cachetable_eviction_policy policy);
+    enum cachetable_eviction_policy get_eviction_policy(void) const;
+    void admit_fetched_pair(PAIR p);
+    void note_pair_hit(PAIR p);
+    int set_numa_nodes(uint32_t num_nodes, bool fake_nodes);
+    uint32_t get_numa_nodes(void) const;
+    void get_numa_node_state(uint32_t node, long *size_current_ptr, long *size_limit_ptr);
+    uint32_t current_numa_node(void);
+    void change_numa_node_size(uint32_t node, int64_t size);
 private:
     void add_to_size_current(long size);
     void remove_from_size_current(long size);
@@ -492,6 +526,10 @@ private:
     void decrease_size_evicting(long size_evicting_estimate);
     bool should_sleeping_clients_wakeup();
     bool eviction_needed();
+    void ghost_insert(PAIR p);
+    bool ghost_remove(PAIR p);
+    uint32_t numa_nodes_over_limit(void);
+    bool numa_spares_pair(PAIR p);
 
     // We have some intentional races with these variables because we're ok with reading something a little bit old.
     // Provide some hooks for reading variables in an unsafe way so that there are function names we can stick in a valgrind suppression.
@@ -515,6 +553,25 @@ private:
 
     bool m_enable_partial_eviction; // true if partial evictions are permitted
 
+    // replacement policy, read by client threads inserting pairs
+    // while they hold the write list lock
+    enum cachetable_eviction_policy m_policy;
+    // direct-mapped table of fingerprints of recently evicted pairs
+    // (the 2Q "A1out" queue), indexed by fullhash. protected by the
+    // pair list's write list lock.
+    uint64_t *m_ghost_table;
+    uint32_t m_ghost_table_size;
+
+    // NUMA partitioning, 0 nodes when it is off. These only change
+    // while the cachetable is empty, see set_numa_nodes.
+    uint32_t m_numa_nodes;
+    bool m_fake_numa_nodes;
+    // bytes charged to each node, changed with atomic adds
+    int64_t *m_numa_node_size;
+    // maps a processor to its node, unused with fake nodes
+    int m_numa_num_processors;
+    uint32_t *m_numa_processor_node;
+
     // used to calculate random numbers
     struct random_data m_random_data;
     char m_random_statebuf[64];
@@ -549,6 +606,10 @@ private:
     PARTITIONED_COUNTER m_wait_pressure_time;
     PARTITIONED_COUNTER m_long_wait_pressure_count;
     PARTITIONED_COUNTER m_long_wait_pressure_time;
+    PARTITIONED_COUNTER m_hits;
+    PARTITIONED_COUNTER m_ghost_hits;
+    PARTITIONED_COUNTER m_probationary_evictions;
+    PARTITIONED_COUNTER m_numa_remote_pins;
     
     KIBBUTZ m_kibbutz;
 
@@ -604,6 +665,7 @@ struct cachetable {
     KIBBUTZ client_kibbutz; // pool of worker threads and jobs to do asynchronously for the client.
     KIBBUTZ ct_kibbutz; // pool of worker threads and jobs to do asynchronously for the cachetable
     KIBBUTZ checkpointing_kibbutz; // small pool for checkpointing cloned pairs
+    TOKU_AIO aio; // batched, asynchronous reads and writes of nodes
     bool in_backup; // we are in back up or NOT, default is false
 
     char *env_dir;
@@ -165,21 +165,24 @@ toku_cachetable_get_status(CACHETABLE ct, CACHETABLE_STATUS statp) {
                             &CT_STATUS_VAL(CT_POOL_CLIENT_QUEUE_SIZE),
                             &CT_STATUS_VAL(CT_POOL_CLIENT_MAX_QUEUE_SIZE),
                             &CT_STATUS_VAL(CT_POOL_CLIENT_TOTAL_ITEMS_PROCESSED),
-                            &CT_STATUS_VAL(CT_POOL_CLIENT_TOTAL_EXECUTION_TIME));
+                            &CT_STATUS_VAL(CT_POOL_CLIENT_TOTAL_EXECUTION_TIME),
+                            &CT_STATUS_VAL(CT_POOL_CLIENT_TOTAL_STEALS));
     toku_kibbutz_get_status(ct->ct_kibbutz,
                             &CT_STATUS_VAL(CT_POOL_CACHETABLE_NUM_THREADS),
                             &CT_STATUS_VAL(CT_POOL_CACHETABLE_NUM_THREADS_ACTIVE),
                             &CT_STATUS_VAL(CT_POOL_CACHETABLE_QUEUE_SIZE),
                             &CT_STATUS_VAL(CT_POOL_CACHETABLE_MAX_QUEUE_SIZE),
                             &CT_STATUS_VAL(CT_POOL_CACHETABLE_TOTAL_ITEMS_PROCESSED),
-                            &CT_STATUS_VAL(CT_POOL_CACHETABLE_TOTAL_EXECUTION_TIME));
+                            &CT_STATUS_VAL(CT_POOL_CACHETABLE_TOTAL_EXECUTION_TIME),
+                            &CT_STATUS_VAL(CT_POOL_CACHETABLE_TOTAL_STEALS));
     toku_kibbutz_get_status(ct->checkpointing_kibbutz,
                             &CT_STATUS_VAL(CT_POOL_CHECKPOINT_NUM_THREADS),
                             &CT_STATUS_VAL(CT_POOL_CHECKPOINT_NUM_THREADS_ACTIVE),
                             &CT_STATUS_VAL(CT_POOL_CHECKPOINT_QUEUE_SIZE),
                             &CT_STATUS_VAL(CT_POOL_CHECKPOINT_MAX_QUEUE_SIZE),
                             &CT_STATUS_VAL(CT_POOL_CHECKPOINT_TOTAL_ITEMS_PROCESSED),
-                            &CT_STATUS_VAL(CT_POOL_CHECKPOINT_TOTAL_EXECUTION_TIME));
+                            &CT_STATUS_VAL(CT_POOL_CHECKPOINT_TOTAL_EXECUTION_TIME),
+                            &CT_STATUS_VAL(CT_POOL_CHECKPOINT_TOTAL_STEALS));
     ct->ev.fill_engine_status();
     *statp = ct_status;
 }
@@ -254,6 +257,29 @@ bool toku_get_enable_partial_eviction (CACHETABLE ct) {
     return ct->ev.get_enable_partial_eviction();
 }
 
+void toku_set_eviction_policy (CACHETABLE ct, enum cachetable_eviction_policy policy) {
+    ct->ev.set_eviction_policy(policy);
+}
+
+enum cachetable_eviction_policy toku_get_eviction_policy (CACHETABLE ct) {
+    return ct->ev.get_eviction_policy();
+}
+
+int toku_cachetable_set_numa_nodes (CACHETABLE ct, uint32_t num_nodes, bool fake_nodes) {
+    // pairs of closed files are charged to a node too, and there is
+    // no need to keep them around across the change
+    ct->cf_list.free_stale_data(&ct->ev);
+    return ct->ev.set_numa_nodes(num_nodes, fake_nodes);
+}
+
+uint32_t toku_cachetable_get_numa_nodes (CACHETABLE ct) {
+    return ct->ev.get_numa_nodes();
+}
+
+void toku_cachetable_get_numa_node_state (CACHETABLE ct, uint32_t node, long *size_current_ptr, long *size_limit_ptr) {
+    ct->ev.get_numa_node_state(node, size_current_ptr, size_limit_ptr);
+}
+
 // reserve 25% as "unreservable".  The loader cannot have it.
 #define unreservable_memory(size) ((size)/4)
 
@@ -276,20 +302,27 @@ int toku_cachetable_create_ex(CACHETABLE *ct_result, long size_limit,
 
     int num_processors = toku_os_get_number_active_processors();
     int checkpointing_nworkers = (num_processors/4) ? num_processors/4 : 1;
+    // flusher jobs hold nodes pinned while they wait in the client pool, and
+    // must be done in FIFO order to avoid deadlocks
     r = toku_kibbutz_create(client_pool_threads ? client_pool_threads : num_processors,
-                            &ct->client_kibbutz);
+                            &ct->client_kibbutz, KIBBUTZ_FIFO);
     if (r != 0) {
         result = r;
         goto cleanup;
     }
     r = toku_kibbutz_create(cachetable_pool_threads ? cachetable_pool_threads : 2*num_processors,
-                            &ct->ct_kibbutz);
+                            &ct->ct_kibbutz, KIBBUTZ_WORK_STEALING);
     if (r != 0) {
         result = r;
         goto cleanup;
     }
     r = toku_kibbutz_create(checkpoint_pool_threads ? checkpoint_pool_threads : checkpointing_nworkers,
-                            &ct->checkpointing_kibbutz);
+                            &ct->checkpointing_kibbutz, KIBBUTZ_WORK_STEALING);
+    if (r != 0) {
+        result = r;
+        goto cleanup;
+    }
+    r = toku_aio_create(&ct->aio, AIO_QUEUE_DEPTH, true);
     if (r != 0) {
         result = r;
         goto cleanup;
@@ -596,10 +629,16 @@ uint32_t toku_cachetable_hash (CACHEFILE cachefile, BLOCKNUM key)
 
 #define CLOCK_SATURATION 15
 #define CLOCK_INITIAL_COUNT 3
+// Probationary pairs (2Q policy) can survive at most one idle sweep,
+// so hits while a scan streams through them never earn them more.
+#define CLOCK_PROBATION_SATURATION 1
+#define CLOCK_PROBATION_INITIAL_COUNT 1
 
 // Requires pair's mutex to be held
 static void pair_touch (PAIR p) {
-    p->count = (p->count < CLOCK_SATURATION) ? p->count+1 : CLOCK_SATURATION;
+    const uint32_t saturation = p->frequent ? CLOCK_SATURATION : CLOCK_PROBATION_SATURATION;
+    p->count = (p->count < saturation) ? p->count+1 : saturation;
+    p->ev->note_pair_hit(p);
 }
 
 // Remove a pair from the cachetable, requires write list lock to be held and p->mutex to be held
@@ -609,6 +648,7 @@ static void pair_touch (PAIR p) {
 static void cachetable_remove_pair (pair_list* list, evictor* ev, PAIR p) {
     list->evict_completely(p);
     ev->remove_pair_attr(p->attr);
+    ev->change_numa_node_size(p->numa_node, -p->attr.size);
 }
 
 static void cachetable_free_pair(PAIR p) {
@@ -727,6 +767,7 @@ static void cachetable_write_locked_pair(
         if (new_attr.is_valid) {
             p->attr = new_attr;
             ev->change_pair_attr(old_attr, new_attr);
+            ev->change_numa_node_size(p->numa_node, new_attr.size - old_attr.size);
         }
     }
     // the pair is no longer dirty once written
@@ -803,6 +844,8 @@ void pair_init(PAIR p,
     p->write_extraargs = write_callback.write_extraargs;
 
     p->count = 0;  // <CER> Is zero the correct init value?
+    p->frequent = true;
+    p->numa_node = ev ? ev->current_numa_node() : 0;
     p->refcount = 0;
     p->num_waiting_on_refs = 0;
     toku_cond_init(*cachetable_p_refcount_wait_key, &p->refcount_wait, nullptr);
@@ -861,7 +904,9 @@ static PAIR cachetable_insert_at(CACHETABLE ct,
         );
 
     ct->list.put(p);
+    ct->ev.admit_fetched_pair(p);
     ct->ev.add_pair_attr(attr);
+    ct->ev.change_numa_node_size(p->numa_node, attr.size);
     return p;
 }
 
@@ -870,6 +915,7 @@ static PAIR cachetable_insert_at(CACHETABLE ct,
 static void cachetable_insert_pair_at(CACHETABLE ct, PAIR p, PAIR_ATTR attr) {
     ct->list.put(p);
     ct->ev.add_pair_attr(attr);
+    ct->ev.change_numa_node_size(p->numa_node, attr.size);
 }
 
 
@@ -934,6 +980,7 @@ clone_pair(evictor* ev, PAIR p) {
     if (new_attr.is_valid) {
         p->attr = new_attr;
         ev->change_pair_attr(old_attr, new_attr);
+        ev->change_numa_node_size(p->numa_node, new_attr.size - old_attr.size);
     }
     p->cloned_value_size = clone_size;
     ev->add_cloned_data_size(p->cloned_value_size);
@@ -961,7 +1008,8 @@ static void checkpoint_cloned_pair(void* extra) {
 
 static void
 checkpoint_cloned_pair_on_writer_thread(CACHETABLE ct, PAIR p) {
-    toku_kibbutz_enq(ct->checkpointing_kibbutz, checkpoint_cloned_pair, p);
+    toku_kibbutz_enq_with_affinity(ct->checkpointing_kibbutz, checkpoint_cloned_pair, p,
+                                   KIBBUTZ_PRIORITY_BACKGROUND, p->fullhash);
 }
 
 
@@ -1253,6 +1301,7 @@ do_partial_fetch(
     lazy_assert_zero(r);
     p->attr = new_attr;
     ct->ev.change_pair_attr(old_attr, new_attr);
+    ct->ev.change_numa_node_size(p->numa_node, new_attr.size - old_attr.size);
     pair_lock(p);
     nb_mutex_unlock(&p->disk_nb_mutex);
     if (!keep_pair_locked) {
@@ -1363,6 +1412,7 @@ static void cachetable_fetch_pair(
     p->disk_data = disk_data;
     p->attr = attr;
     ct->ev.add_pair_attr(attr);
+    ct->ev.change_numa_node_size(p->numa_node, attr.size);
     pair_lock(p);
     nb_mutex_unlock(&p->disk_nb_mutex);
     if (!keep_pair_locked) {
@@ -1900,6 +1950,8 @@ cachetable_unpin_internal(
     pair_lock(p);
     PAIR_ATTR old_attr = p->attr;
     PAIR_ATTR new_attr = attr;
+    // p may be evicted as soon as it is unpinned
+    const uint32_t numa_node = p->numa_node;
     if (dirty) {
         p->dirty = CACHETABLE_DIRTY;
     }
@@ -1915,6 +1967,7 @@ cachetable_unpin_internal(
             added_data_to_cachetable = true;
         }
         ct->ev.change_pair_attr(old_attr, new_attr);
+        ct->ev.change_numa_node_size(numa_node, new_attr.size - old_attr.size);
     }
 
     // see comments above this function to understand this code
@@ -2252,7 +2305,8 @@ int toku_cachefile_prefetch(CACHEFILE cf, CACHEKEY key, uint32_t fullhash,
         cpargs->p = p;
         cpargs->fetch_callback = fetch_callback;
         cpargs->read_extraargs = read_extraargs;
-        toku_kibbutz_enq(ct->ct_kibbutz, cachetable_reader, cpargs);
+        toku_kibbutz_enq_with_affinity(ct->ct_kibbutz, cachetable_reader, cpargs,
+                                       KIBBUTZ_PRIORITY_BACKGROUND, p->fullhash);
         if (doing_prefetch) {
             *doing_prefetch = true;
         }
@@ -2277,7 +2331,8 @@ found_pair:
             cpargs->p = p;
             cpargs->pf_callback = pf_callback;
             cpargs->read_extraargs = read_extraargs;
-            toku_kibbutz_enq(ct->ct_kibbutz, cachetable_partial_reader, cpargs);
+            toku_kibbutz_enq_with_affinity(ct->ct_kibbutz, cachetable_partial_reader, cpargs,
+                                           KIBBUTZ_PRIORITY_BACKGROUND, p->fullhash);
             if (doing_prefetch) {
                 *doing_prefetch = true;
             }
@@ -2346,7 +2401,9 @@ static void flush_pair_for_close_on_background_thread(
         struct pair_flush_for_close *XMALLOC(args);
         args->p = p;
         args->bjm = bjm;
-        toku_kibbutz_enq(ct->ct_kibbutz, cachetable_flush_pair_for_close, args);
+        // the thread closing the cachefile waits for this
+        toku_kibbutz_enq_with_affinity(ct->ct_kibbutz, cachetable_flush_pair_for_close, args,
+                                       KIBBUTZ_PRIORITY_CLIENT, p->fullhash);
     }
     pair_unlock(p);
 }
@@ -2529,6 +2586,8 @@ void toku_cachetable_close (CACHETABLE *ctp) {
         toku_kibbutz_destroy(ct->ct_kibbutz);
     if (ct->checkpointing_kibbutz)
         toku_kibbutz_destroy(ct->checkpointing_kibbutz);
+    if (ct->aio)
+        toku_aio_destroy(ct->aio);
     toku_free(ct->env_dir);
     toku_free(ct);
     *ctp = 0;
@@ -2832,9 +2891,9 @@ int toku_cachetable_assert_all_unpinned (CACHETABLE ct) {
     uint32_t i;
     int some_pinned=0;
     ct->list.read_list_lock();
-    for (i=0; i<ct->list.m_table_size; i++) {
+    for (i=0; i<ct->list.num_buckets(); i++) {
         PAIR p;
-        for (p=ct->list.m_table[i]; p; p=p->hash_chain) {
+        for (p=ct->list.bucket_chain(i); p; p=p->hash_chain) {
             pair_lock(p);
             if (p->value_rwlock.users()) {
                 //printf("%s:%d pinned: %" PRId64 " (%p)\n", __FILE__, __LINE__, p->key.b, p->value_data);
@@ -2855,8 +2914,8 @@ int toku_cachefile_count_pinned (CACHEFILE cf, int print_them) {
 
     // Iterate over all the pairs to find pairs specific to the
     // given cachefile.
-    for (uint32_t i = 0; i < ct->list.m_table_size; i++) {
-        for (PAIR p = ct->list.m_table[i]; p; p = p->hash_chain) {
+    for (uint32_t i = 0; i < ct->list.num_buckets(); i++) {
+        for (PAIR p = ct->list.bucket_chain(i); p; p = p->hash_chain) {
             if (p->cachefile == cf) {
                 pair_lock(p);
                 if (p->value_rwlock.users()) {
@@ -2881,12 +2940,12 @@ int toku_cachefile_count_pinned (CACHEFILE cf, int print_them) {
 void toku_cachetable_print_state (CACHETABLE ct) {
     uint32_t i;
     ct->list.read_list_lock();
-    for (i=0; i<ct->list.m_table_size; i++) {
-        PAIR p = ct->list.m_table[i];
+    for (i=0; i<ct->list.num_buckets(); i++) {
+        PAIR p = ct->list.bucket_chain(i);
         if (p != 0) {
             pair_lock(p);
             printf("t[%u]=", i);
-            for (p=ct->list.m_table[i]; p; p=p->hash_chain) {
+            for (p=ct->list.bucket_chain(i); p; p=p->hash_chain) {
                 printf(" {%" PRId64 ", %p, dirty=%d, pin=%d, size=%ld}", p->key.b, p->cachefile, (int) p->dirty, p->value_rwlock.users(), p->attr.size);
             }
             printf("\n");
@@ -2955,6 +3014,11 @@ toku_cachefile_get_cachetable(CACHEFILE cf) {
     return cf->cachetable;
 }
 
+TOKU_AIO
+toku_cachefile_get_aio(CACHEFILE cf) {
+    return cf->cachetable->aio;
+}
+
 CACHEFILE toku_pair_get_cachefile(PAIR pair) {
     return pair->cachefile;
 }
@@ -3254,8 +3318,11 @@ int cleaner::run_cleaner(void) {
 
 static_assert(std::is_pod<pair_list>::value, "pair_list isn't POD");
 
-const uint32_t INITIAL_PAIR_LIST_SIZE = 1<<20;
 uint32_t PAIR_LOCK_SIZE = 1<<20;
+// the hash table stops doubling once it has this many buckets
+const uint32_t MAX_PAIR_LIST_SIZE = 1U<<30;
+// number of old buckets moved to the new table per grab of the write list lock
+const uint32_t PAIR_LIST_RESIZE_BATCH = 1<<10;
 
 void toku_pair_list_set_lock_size(uint32_t num_locks) {
     PAIR_LOCK_SIZE = num_locks;
@@ -3279,14 +3346,18 @@ static void evict_pair_from_cachefile(PAIR p) {
 // Allocates the hash table of pairs inside this pair list.
 //
 void pair_list::init() {
-    m_table_size = INITIAL_PAIR_LIST_SIZE;
     m_num_locks = PAIR_LOCK_SIZE;
+    // the table starts with one bucket per mutex and grows from there,
+    // it must never have fewer buckets than mutexes (see m_old_table)
+    m_table_size = m_num_locks;
     m_n_in_table = 0;
     m_clock_head = NULL;
     m_cleaner_head = NULL;
     m_checkpoint_head = NULL;
     m_pending_head = NULL;
     m_table = NULL;
+    m_old_table = NULL;
+    m_old_table_size = 0;
     
 
     pthread_rwlockattr_t attr;
@@ -3325,6 +3396,7 @@ void pair_list::destroy() {
     for (uint32_t i = 0; i < m_table_size; ++i) {
         invariant_null(m_table[i]);
     }
+    invariant_null(m_old_table);
     for (uint64_t i = 0; i < m_num_locks; i++) {
         toku_mutex_destroy(&m_mutexes[i].aligned_mutex);
     }
@@ -3434,24 +3506,44 @@ void pair_list::pending_pairs_remove (PAIR p) {
     p->pending_prev = p->pending_next = NULL;
 }
 
-void pair_list::remove_from_hash_chain(PAIR p) {
-    // Remove it from the hash chain.
-    unsigned int h = p->fullhash&(m_table_size - 1);
-    paranoid_invariant(m_table[h] != NULL);
-    if (m_table[h] == p) {
-        m_table[h] = p->hash_chain;
+// Unlinks p from the hash chain starting at *head.
+// Returns false if p is not on that chain.
+static bool remove_from_chain(PAIR *head, PAIR p) {
+    if (*head == p) {
+        *head = p->hash_chain;
+        return true;
     }
-    else {
-        PAIR curr = m_table[h];
-        while (curr->hash_chain != p) {
-            curr = curr->hash_chain;
+    for (PAIR curr = *head; curr; curr = curr->hash_chain) {
+        if (curr->hash_chain == p) {
+            // remove p from the singular linked list
+            curr->hash_chain = p->hash_chain;
+            return true;
         }
-        // remove p from the singular linked list
-        curr->hash_chain = p->hash_chain;
     }
+    return false;
+}
+
+void pair_list::remove_from_hash_chain(PAIR p) {
+    // Remove it from the hash chain. If a resize is in progress, the
+    // pair may not have been moved out of the old table yet.
+    bool removed = remove_from_chain(&m_table[p->fullhash&(m_table_size - 1)], p);
+    if (!removed) {
+        paranoid_invariant(m_old_table != NULL);
+        removed = remove_from_chain(&m_old_table[p->fullhash&(m_old_table_size - 1)], p);
+    }
+    paranoid_invariant(removed);
     p->hash_chain = NULL;
 }
 
+static PAIR find_in_chain(PAIR head, CACHEFILE file, CACHEKEY key) {
+    for (PAIR p = head; p; p = p->hash_chain) {
+        if (p->key.b == key.b && p->cachefile == file) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
 // Returns a pair from the pair list, using the given 
 // pair.  If the pair cannot be found, null is returned.
 //
@@ -3459,16 +3551,95 @@ void pair_list::remove_from_hash_chain(PAIR p) {
 // bucket's mutex.
 //
 PAIR pair_list::find_pair(CACHEFILE file, CACHEKEY key, uint32_t fullhash) {
-    PAIR found_pair = nullptr;
-    for (PAIR p = m_table[fullhash&(m_table_size - 1)]; p; p = p->hash_chain) {
-        if (p->key.b == key.b && p->cachefile == file) {
-            found_pair = p;
-            break;
-        }
+    PAIR found_pair = find_in_chain(m_table[fullhash&(m_table_size - 1)], file, key);
+    if (found_pair == nullptr && m_old_table != nullptr) {
+        found_pair = find_in_chain(m_old_table[fullhash&(m_old_table_size - 1)], file, key);
     }
     return found_pair;
 }
 
+// Grows the hash table, by a power of two, to at least one bucket per
+// pair once it holds more pairs than buckets.
+//
+// The new table is installed while holding every bucket mutex, after
+// which pairs are moved over from the old table a batch of buckets at a
+// time, so neither lookups nor the rest of the cachetable are stalled
+// for the length of a full rehash.
+//
+// Called by the eviction thread. Requires the caller to hold neither
+// the list lock nor any bucket mutex.
+//
+void pair_list::maybe_grow_table() {
+    this->write_list_lock();
+    if (m_n_in_table <= m_table_size || m_table_size >= MAX_PAIR_LIST_SIZE) {
+        this->write_list_unlock();
+        return;
+    }
+    invariant_null(m_old_table);
+    uint32_t new_table_size = m_table_size;
+    while (new_table_size < m_n_in_table && new_table_size < MAX_PAIR_LIST_SIZE) {
+        new_table_size *= 2;
+    }
+    PAIR *XCALLOC_N(new_table_size, new_table);
+    this->lock_all_buckets();
+    m_old_table = m_table;
+    m_old_table_size = m_table_size;
+    m_table = new_table;
+    m_table_size = new_table_size;
+    this->unlock_all_buckets();
+    this->write_list_unlock();
+
+    uint32_t i = 0;
+    while (i < m_old_table_size) {
+        this->write_list_lock();
+        uint32_t end = i + PAIR_LIST_RESIZE_BATCH;
+        if (end > m_old_table_size) {
+            end = m_old_table_size;
+        }
+        for (; i < end; i++) {
+            // every pair in old bucket i hashes to the mutex for i,
+            // and so do the new buckets it spreads out into
+            this->pair_lock_by_fullhash(i);
+            PAIR p = m_old_table[i];
+            while (p) {
+                PAIR next = p->hash_chain;
+                this->add_to_hash_chain(p);
+                p = next;
+            }
+            m_old_table[i] = NULL;
+            this->pair_unlock_by_fullhash(i);
+        }
+        this->write_list_unlock();
+    }
+
+    this->write_list_lock();
+    this->lock_all_buckets();
+    PAIR *old_table = m_old_table;
+    m_old_table = NULL;
+    m_old_table_size = 0;
+    this->unlock_all_buckets();
+    this->write_list_unlock();
+    toku_free(old_table);
+}
+
+// The number of buckets that bucket_chain() may be asked for, which
+// includes the buckets of the old table while a resize is in progress.
+//
+// requires caller to have grabbed a read lock on the list.
+//
+uint32_t pair_list::num_buckets() {
+    return m_table_size + (m_old_table ? m_old_table_size : 0);
+}
+
+// Returns the head of the i'th hash chain, for iterating over
+// every pair in the table.
+//
+// requires caller to have grabbed a read lock on the list.
+//
+PAIR pair_list::bucket_chain(uint32_t i) {
+    return i < m_table_size ? m_table[i] : m_old_table[i - m_table_size];
+}
+
 // Add PAIR to linked list shared by cleaner thread and clock
 //
 // requires caller to have grabbed write lock on list.
@@ -3535,9 +3706,9 @@ void pair_list::verify() {
     // First clear all the verify flags by going through the hash chains
     {
         uint32_t i;
-        for (i = 0; i < m_table_size; i++) {
+        for (i = 0; i < num_buckets(); i++) {
             PAIR p;
-            for (p = m_table[i]; p; p = p->hash_chain) {
+            for (p = bucket_chain(i); p; p = p->hash_chain) {
                 num_found++;
             }
         }
@@ -3553,12 +3724,11 @@ void pair_list::verify() {
             PAIR p2;
             uint32_t fullhash = p->fullhash;
             //assert(fullhash==toku_cachetable_hash(p->cachefile, p->key));
-            for (p2 = m_table[fullhash&(m_table_size-1)]; p2; p2=p2->hash_chain) {
-                if (p2==p) {
-                    /* found it */
-                    num_found++;
-                    goto next;
-                }
+            p2 = find_pair(p->cachefile, p->key, fullhash);
+            if (p2==p) {
+                /* found it */
+                num_found++;
+                goto next;
             }
             fprintf(stderr, "Something in the clock chain is not hashed\n");
             assert(0);
@@ -3646,6 +3816,22 @@ void pair_list::pair_unlock_by_fullhash(uint32_t fullhash) {
     toku_mutex_unlock(&m_mutexes[fullhash&(m_num_locks - 1)].aligned_mutex);
 }
 
+// Grabs every bucket mutex, in order, so that the tables may be swapped.
+//
+// requires caller to have grabbed write lock on list.
+//
+void pair_list::lock_all_buckets() {
+    for (uint32_t i = 0; i < m_num_locks; i++) {
+        toku_mutex_lock(&m_mutexes[i].aligned_mutex);
+    }
+}
+
+void pair_list::unlock_all_buckets() {
+    for (uint32_t i = 0; i < m_num_locks; i++) {
+        toku_mutex_unlock(&m_mutexes[i].aligned_mutex);
+    }
+}
+
 
 ENSURE_POD(evictor);
 
@@ -3688,6 +3874,22 @@ int evictor::init(long _size_limit, pair_list* _pl, cachefile_list* _cf_list, KI
     
     m_enable_partial_eviction = true;
 
+    m_policy = CACHETABLE_EVICTION_POLICY_CLOCK;
+    // remember roughly one evicted pair per 64KB (about one basement
+    // node) of cache, the ghost queue size 2Q recommends
+    m_ghost_table_size = 1 << 10;
+    while (m_ghost_table_size < (1U << 22) &&
+           ((int64_t) m_ghost_table_size << 16) < _size_limit) {
+        m_ghost_table_size <<= 1;
+    }
+    XCALLOC_N(m_ghost_table_size, m_ghost_table);
+
+    m_numa_nodes = 0;
+    m_fake_numa_nodes = false;
+    m_numa_num_processors = 0;
+    m_numa_processor_node = NULL;
+    XCALLOC_N(1, m_numa_node_size);
+
     m_size_reserved = unreservable_memory(_size_limit);
     m_size_current = 0;
     m_size_cloned_data = 0;
@@ -3701,6 +3903,10 @@ int evictor::init(long _size_limit, pair_list* _pl, cachefile_list* _cf_list, KI
     m_wait_pressure_time = create_partitioned_counter();
     m_long_wait_pressure_count = create_partitioned_counter();
     m_long_wait_pressure_time = create_partitioned_counter();
+    m_hits = create_partitioned_counter();
+    m_ghost_hits = create_partitioned_counter();
+    m_probationary_evictions = create_partitioned_counter();
+    m_numa_remote_pins = create_partitioned_counter();
 
     m_pl = _pl;
     m_cf_list = _cf_list;
@@ -3772,6 +3978,16 @@ void evictor::destroy() {
     destroy_partitioned_counter(m_wait_pressure_time); m_wait_pressure_time = NULL;
     destroy_partitioned_counter(m_long_wait_pressure_count); m_long_wait_pressure_count = NULL;
     destroy_partitioned_counter(m_long_wait_pressure_time); m_long_wait_pressure_time = NULL;
+    destroy_partitioned_counter(m_hits); m_hits = NULL;
+    destroy_partitioned_counter(m_ghost_hits); m_ghost_hits = NULL;
+    destroy_partitioned_counter(m_probationary_evictions); m_probationary_evictions = NULL;
+    destroy_partitioned_counter(m_numa_remote_pins); m_numa_remote_pins = NULL;
+    toku_free(m_ghost_table);
+    m_ghost_table = NULL;
+    toku_free(m_numa_node_size);
+    m_numa_node_size = NULL;
+    toku_free(m_numa_processor_node);
+    m_numa_processor_node = NULL;
 
     toku_cond_destroy(&m_flow_control_cond);
     toku_cond_destroy(&m_ev_thread_cond);
@@ -3890,6 +4106,13 @@ void evictor::release_reserved_memory(uint64_t reserved_memory){
 void evictor::run_eviction_thread(){
     toku_mutex_lock(&m_ev_thread_lock);
     while (m_run_thread) {
+        // grow the pair hash table here, where we hold no locks that
+        // the resize could wait behind. Any signal that arrives in the
+        // meantime is picked up by run_eviction below.
+        toku_mutex_unlock(&m_ev_thread_lock);
+        m_pl->maybe_grow_table();
+        toku_mutex_lock(&m_ev_thread_lock);
+
         m_num_eviction_thread_runs++; // for test purposes only
         m_ev_thread_is_running = true;
         // responsibility of run_eviction to release and 
@@ -3967,7 +4190,8 @@ void evictor::run_eviction(){
                 exited_early = true;
                 goto exit;
             }
-            bool eviction_run = run_eviction_on_pair(curr_in_clock);
+            bool eviction_run = !this->numa_spares_pair(curr_in_clock) &&
+                run_eviction_on_pair(curr_in_clock);
             if (eviction_run) {
                 // reset the count
                 num_pairs_examined_without_evicting = 0;
@@ -4096,8 +4320,10 @@ bool evictor::run_eviction_on_pair(PAIR curr_in_clock) {
                     toku_mutex_lock(&m_ev_thread_lock);
                     m_size_evicting += bytes_freed_estimate;
                     toku_mutex_unlock(&m_ev_thread_lock);
-                    toku_kibbutz_enq(m_kibbutz, cachetable_partial_eviction,
-                                     curr_in_clock);
+                    // clients may be waiting for cache pressure to subside
+                    toku_kibbutz_enq_with_affinity(m_kibbutz, cachetable_partial_eviction,
+                                                   curr_in_clock, KIBBUTZ_PRIORITY_CLIENT,
+                                                   curr_in_clock->fullhash);
                 } else {
                     curr_in_clock->value_rwlock.write_unlock();
                     pair_unlock(curr_in_clock);
@@ -4140,6 +4366,7 @@ static void pair_unpin_with_new_attr(PAIR_ATTR new_attr, void *extra) {
 
     // change the attr in the evictor, then update the value in the pair
     ev->change_pair_attr(p->attr, new_attr);
+    ev->change_numa_node_size(p->numa_node, new_attr.size - p->attr.size);
     p->attr = new_attr;
 
     // unpin
@@ -4207,7 +4434,9 @@ void evictor::try_evict_pair(PAIR p) {
         m_size_evicting += p->size_evicting_estimate;
         assert(m_size_evicting >= 0);
         toku_mutex_unlock(&m_ev_thread_lock);
-        toku_kibbutz_enq(m_kibbutz, cachetable_evicter, p);
+        // clients may be waiting for cache pressure to subside
+        toku_kibbutz_enq_with_affinity(m_kibbutz, cachetable_evicter, p,
+                                       KIBBUTZ_PRIORITY_CLIENT, p->fullhash);
     }
 }
 
@@ -4250,6 +4479,10 @@ void evictor::evict_pair(PAIR p, bool for_checkpoint) {
         // no one is writing a cloned value out.
         assert(nb_mutex_users(&p->disk_nb_mutex) == 0);
         assert(p->cloned_value_data == NULL);
+        if (!p->frequent) {
+            increment_partitioned_counter(m_probationary_evictions, 1);
+        }
+        this->ghost_insert(p);
         cachetable_remove_pair(m_pl, this, p);
         removed = true;
     }
@@ -4415,6 +4648,13 @@ void evictor::fill_engine_status() {
     CT_STATUS_VAL(CT_WAIT_PRESSURE_TIME) = read_partitioned_counter(m_wait_pressure_time);
     CT_STATUS_VAL(CT_LONG_WAIT_PRESSURE_COUNT) = read_partitioned_counter(m_long_wait_pressure_count);
     CT_STATUS_VAL(CT_LONG_WAIT_PRESSURE_TIME) = read_partitioned_counter(m_long_wait_pressure_time);
+    CT_STATUS_VAL(CT_EVICTION_POLICY) = m_policy;
+    CT_STATUS_VAL(CT_HITS) = read_partitioned_counter(m_hits);
+    CT_STATUS_VAL(CT_GHOST_HITS) = read_partitioned_counter(m_ghost_hits);
+    CT_STATUS_VAL(CT_PROBATIONARY_EVICTIONS) = read_partitioned_counter(m_probationary_evictions);
+    CT_STATUS_VAL(CT_NUMA_NODES) = m_numa_nodes;
+    CT_STATUS_VAL(CT_NUMA_NODES_OVER_LIMIT) = this->numa_nodes_over_limit();
+    CT_STATUS_VAL(CT_NUMA_REMOTE_PINS) = read_partitioned_counter(m_numa_remote_pins);
 }
 
 void evictor::set_enable_partial_eviction(bool enabled) {
@@ -4425,6 +4665,174 @@ bool evictor::get_enable_partial_eviction(void) const {
     return m_enable_partial_eviction;
 }
 
+//
+// Changes the replacement policy. Pairs already in the cachetable keep
+// their classification, so switching policies takes effect gradually
+// as the clock turns over.
+//
+void evictor::set_eviction_policy(enum cachetable_eviction_policy policy) {
+    m_pl->write_list_lock();
+    m_policy = policy;
+    if (policy != CACHETABLE_EVICTION_POLICY_2Q) {
+        memset(m_ghost_table, 0, m_ghost_table_size * sizeof m_ghost_table[0]);
+    }
+    m_pl->write_list_unlock();
+}
+
+enum cachetable_eviction_policy evictor::get_eviction_policy(void) const {
+    return m_policy;
+}
+
+//
+// Called on a pair that was just inserted into the cachetable because of
+// a miss (or a prefetch), before it is fetched. Under 2Q the pair is
+// probationary unless it was evicted recently, in which case we have
+// seen it reused and it enters the protected part of the clock.
+//
+// requires the write list lock and the pair's mutex to be held
+//
+void evictor::admit_fetched_pair(PAIR p) {
+    if (m_policy != CACHETABLE_EVICTION_POLICY_2Q) {
+        return;
+    }
+    if (this->ghost_remove(p)) {
+        increment_partitioned_counter(m_ghost_hits, 1);
+        p->frequent = true;
+        p->count = CLOCK_INITIAL_COUNT;
+    } else {
+        p->frequent = false;
+        p->count = CLOCK_PROBATION_INITIAL_COUNT;
+    }
+}
+
+void evictor::note_pair_hit(PAIR p) {
+    increment_partitioned_counter(m_hits, 1);
+    if (m_numa_nodes > 0 && p->numa_node != this->current_numa_node()) {
+        increment_partitioned_counter(m_numa_remote_pins, 1);
+    }
+}
+
+//
+// Partitions the size limit across num_nodes nodes, see
+// toku_cachetable_set_numa_nodes. Pairs are charged to a node for as
+// long as they are in the cachetable, so this may only be done while
+// the cachetable is empty and no other thread is using it.
+//
+int evictor::set_numa_nodes(uint32_t num_nodes, bool fake_nodes) {
+    int r = 0;
+    m_pl->write_list_lock();
+    if (m_pl->m_n_in_table > 0) {
+        r = EINVAL;
+        goto exit;
+    }
+    toku_free(m_numa_node_size);
+    XCALLOC_N(num_nodes > 0 ? num_nodes : 1, m_numa_node_size);
+    toku_free(m_numa_processor_node);
+    m_numa_processor_node = NULL;
+    m_numa_num_processors = 0;
+    if (num_nodes > 0 && !fake_nodes) {
+        m_numa_num_processors = toku_os_get_number_processors();
+        XCALLOC_N(m_numa_num_processors, m_numa_processor_node);
+        for (int i = 0; i < m_numa_num_processors; i++) {
+            int node = toku_os_get_processor_numa_node(i);
+            m_numa_processor_node[i] = node > 0 ? node % num_nodes : 0;
+        }
+    }
+    m_fake_numa_nodes = fake_nodes;
+    m_numa_nodes = num_nodes;
+exit:
+    m_pl->write_list_unlock();
+    return r;
+}
+
+uint32_t evictor::get_numa_nodes(void) const {
+    return m_numa_nodes;
+}
+
+void evictor::get_numa_node_state(uint32_t node, long *size_current_ptr, long *size_limit_ptr) {
+    const uint32_t num_nodes = m_numa_nodes > 0 ? m_numa_nodes : 1;
+    paranoid_invariant(node < num_nodes);
+    if (size_current_ptr) {
+        *size_current_ptr = m_numa_node_size[node];
+    }
+    if (size_limit_ptr) {
+        *size_limit_ptr = m_low_size_watermark / num_nodes;
+    }
+}
+
+//
+// Returns the node that pairs brought in by the calling thread are
+// charged to.
+//
+uint32_t evictor::current_numa_node(void) {
+    if (m_numa_nodes == 0) {
+        return 0;
+    }
+    if (m_fake_numa_nodes) {
+        return (uint32_t) toku_os_gettid() % m_numa_nodes;
+    }
+    int processor = toku_os_get_current_processor();
+    return (processor >= 0 && processor < m_numa_num_processors) ? m_numa_processor_node[processor] : 0;
+}
+
+void evictor::change_numa_node_size(uint32_t node, int64_t size) {
+    if (m_numa_nodes > 0) {
+        (void) toku_sync_fetch_and_add(&m_numa_node_size[node], size);
+    }
+}
+
+uint32_t evictor::numa_nodes_over_limit(void) {
+    uint32_t n_over = 0;
+    for (uint32_t i = 0; i < m_numa_nodes; i++) {
+        if (m_numa_node_size[i] > m_low_size_watermark / m_numa_nodes) {
+            n_over++;
+        }
+    }
+    return n_over;
+}
+
+//
+// While some node is over its share of the cachetable, pairs charged
+// to nodes within their share are left alone by the eviction thread so
+// that one node's working set cannot push out another's.
+//
+bool evictor::numa_spares_pair(PAIR p) {
+    return m_numa_nodes > 0 &&
+        m_numa_node_size[p->numa_node] <= m_low_size_watermark / m_numa_nodes &&
+        this->numa_nodes_over_limit() > 0;
+}
+
+static inline uint64_t ghost_fingerprint(PAIR p) {
+    // never zero, zero marks an empty slot
+    return ((((uint64_t) p->cachefile->hash_id) << 40) ^ (uint64_t) p->key.b) | (1ULL << 63);
+}
+
+//
+// Remembers that p is being evicted, overwriting whatever pair
+// previously hashed to the same slot.
+//
+// requires the write list lock to be held
+//
+void evictor::ghost_insert(PAIR p) {
+    if (m_policy == CACHETABLE_EVICTION_POLICY_2Q) {
+        m_ghost_table[p->fullhash & (m_ghost_table_size - 1)] = ghost_fingerprint(p);
+    }
+}
+
+//
+// Returns true if p was evicted recently, and forgets it.
+//
+// requires the write list lock to be held
+//
+bool evictor::ghost_remove(PAIR p) {
+    uint64_t *slot = &m_ghost_table[p->fullhash & (m_ghost_table_size - 1)];
+    if (*slot == ghost_fingerprint(p)) {
+        *slot = 0;
+        return true;
+    }
+    return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 ENSURE_POD(checkpointer);
@@ -4994,6 +5402,7 @@ bool cachefile_list::evict_some_stale_pair(evictor* ev) {
     write_unlock();
     
     ev->remove_pair_attr(p->attr);
+    ev->change_numa_node_size(p->numa_node, -p->attr.size);
     cachetable_free_pair(p);
     if (destroy_cf) {
         cachefile_destroy(stale_cf);
@@ -5015,6 +5424,7 @@ void cachefile_list::free_stale_data(evictor* ev) {
         
         evict_pair_from_cachefile(p);
         ev->remove_pair_attr(p->attr);
+        ev->change_numa_node_size(p->numa_node, -p->attr.size);
         cachetable_free_pair(p);
         
         // now that we have evicted something,
@@ -44,6 +44,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/serialize/block_table.h"
 #include "ft/txn/txn.h"
 #include "ft/ft-status.h"
+#include "util/aio.h"
 #include "util/minicron.h"
 
 // Maintain a cache mapping from cachekeys to values (void*)
@@ -105,6 +106,31 @@ uint32_t toku_get_cleaner_iterations_unlocked (CACHETABLE ct);
 void toku_set_enable_partial_eviction (CACHETABLE ct, bool enabled);
 bool toku_get_enable_partial_eviction (CACHETABLE ct);
 
+// Replacement policies the evictor may use to pick victims from the clock.
+enum cachetable_eviction_policy {
+    // every pair enters the clock with the same count and is aged uniformly
+    CACHETABLE_EVICTION_POLICY_CLOCK = 0,
+    // 2Q: fetched pairs are probationary and leave after one idle sweep
+    // unless a recently evicted (ghost) copy shows they are reused, in which
+    // case they come back protected. Large scans cannot flush the hot set.
+    CACHETABLE_EVICTION_POLICY_2Q = 1,
+};
+void toku_set_eviction_policy (CACHETABLE ct, enum cachetable_eviction_policy policy);
+enum cachetable_eviction_policy toku_get_eviction_policy (CACHETABLE ct);
+
+// Splits the cachetable's size limit evenly across num_nodes NUMA nodes.
+// Every pair is charged to the node of the thread that brought it into the
+// cachetable, and while some node is over its share the evictor only takes
+// victims from nodes that are over their share. With fake_nodes, threads
+// are spread over the nodes by thread id rather than by the processor they
+// run on, so the partitioning can be exercised on a single node machine.
+// num_nodes == 0 turns partitioning off.
+// Returns EINVAL if the cachetable holds any pairs.
+int toku_cachetable_set_numa_nodes (CACHETABLE ct, uint32_t num_nodes, bool fake_nodes);
+uint32_t toku_cachetable_get_numa_nodes (CACHETABLE ct);
+// Get the number of bytes charged to a node and the node's share of the size limit
+void toku_cachetable_get_numa_node_state (CACHETABLE ct, uint32_t node, long *size_current_ptr, long *size_limit_ptr);
+
 // cachetable operations
 
 // create and initialize a cache table
@@ -301,6 +327,10 @@ void *toku_cachefile_get_userdata(CACHEFILE);
 CACHETABLE toku_cachefile_get_cachetable(CACHEFILE cf);
 // Effect: Get the cachetable.
 
+TOKU_AIO toku_cachefile_get_aio(CACHEFILE cf);
+// Effect: Get the asynchronous I/O engine used to batch reads and writes
+//  of the cachefile's nodes.
+
 CACHEFILE toku_pair_get_cachefile(PAIR);
 // Effect: Get the cachefile of the pair
 
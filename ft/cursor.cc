@@ -253,6 +253,9 @@ int toku_ft_cursor_check_restricted_range(FT_CURSOR c, const void *key, uint32_t
     return 0;
 }
 
+// Upper bound on how many leafentries toku_ft_cursor_shortcut resolves at once.
+static const uint32_t shortcut_max_batch = 16;
+
 int toku_ft_cursor_shortcut(FT_CURSOR cursor, int direction, uint32_t index, bn_data *bd,
                             FT_GET_CALLBACK_FUNCTION getf, void *getf_v,
                             uint32_t *keylen, void **key, uint32_t *vallen, void **val) {
@@ -260,28 +263,41 @@ int toku_ft_cursor_shortcut(FT_CURSOR cursor, int direction, uint32_t index, bn_
     // if we are searching towards the end, limit is last element
     // if we are searching towards the beginning, limit is the first element
     uint32_t limit = (direction > 0) ? (bd->num_klpairs() - 1) : 0;
-
+    const bool is_leaf_mode = toku_ft_cursor_is_leaf_mode(cursor);
+
+    LEAFENTRY les[shortcut_max_batch];
+    void *foundkeys[shortcut_max_batch];
+    uint32_t foundkeylens[shortcut_max_batch];
+    struct le_cursor_val vals[shortcut_max_batch];
+
+    // Visibility is resolved a batch of leafentries at a time. The batch
+    // starts at one entry and doubles, so a getf that stops after the first
+    // entry does not pay for entries it never looks at, while a bulk fetch
+    // quickly reaches the full batch size.
+    uint32_t batch_size = 1;
+    bool done = false;
     //Starting with the prev, find the first real (non-provdel) leafentry.
-    while (index != limit) {
-        index += direction;
-        LEAFENTRY le;
-        void* foundkey = NULL;
-        uint32_t foundkeylen = 0;
-        
-        r = bd->fetch_klpair(index, &le, &foundkeylen, &foundkey);
-        invariant_zero(r);
-
-        if (toku_ft_cursor_is_leaf_mode(cursor) || !le_val_is_del(le, cursor->read_type, cursor->ttxn)) {
-            le_extract_val(
-                le,
-                toku_ft_cursor_is_leaf_mode(cursor),
-                cursor->read_type,
-                cursor->ttxn,
-                vallen,
-                val
-                );
-            *key = foundkey;
-            *keylen = foundkeylen;
+    while (!done && index != limit) {
+        uint32_t remaining = (direction > 0) ? (limit - index) : (index - limit);
+        uint32_t n = remaining < batch_size ? remaining : batch_size;
+        for (uint32_t i = 0; i < n; i++) {
+            index += direction;
+            r = bd->fetch_klpair(index, &les[i], &foundkeylens[i], &foundkeys[i]);
+            invariant_zero(r);
+        }
+        le_extract_vals(les, n, is_leaf_mode, cursor->read_type, cursor->ttxn, vals);
+        if (batch_size < shortcut_max_batch) {
+            batch_size *= 2;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            if (!is_leaf_mode && vals[i].is_del) {
+                continue;
+            }
+            *val = vals[i].val;
+            *vallen = vals[i].vallen;
+            *key = foundkeys[i];
+            *keylen = foundkeylens[i];
 
             cursor->direction = direction;
             r = toku_ft_cursor_check_restricted_range(cursor, *key, *keylen);
@@ -290,13 +306,12 @@ int toku_ft_cursor_shortcut(FT_CURSOR cursor, int direction, uint32_t index, bn_
                 // We already got at least one entry from the bulk fetch.
                 // Return 0 (instead of out of range error).
                 r = 0;
+                done = true;
                 break;
             }
             r = getf(*keylen, *key, *vallen, *val, getf_v, false);
-            if (r == TOKUDB_CURSOR_CONTINUE) {
-                continue;
-            }
-            else {
+            if (r != TOKUDB_CURSOR_CONTINUE) {
+                done = true;
                 break;
             }
         }
@@ -356,6 +371,9 @@ int toku_ft_cursor_prev(FT_CURSOR cursor, FT_GET_CALLBACK_FUNCTION getf, void *g
     ft_search_init(&search, ft_cursor_compare_prev, FT_SEARCH_RIGHT, &cursor->key, nullptr, cursor->ft_handle);
     int r = ft_cursor_search(cursor, &search, getf, getf_v, true);
     ft_search_finish(&search);
+    if (r == 0) {
+        toku_ft_cursor_set_prefetching(cursor);
+    }
     return r;
 }
 
@@ -54,6 +54,12 @@ struct ft_cursor {
     bool is_temporary;
     int out_of_range_error;
     int direction;
+    // read-ahead state: the last leaf this cursor's searches landed in,
+    // the direction it was entered from, and how many leaves in a row
+    // were entered in that direction (the scan's velocity)
+    int64_t readahead_last_leaf;
+    int readahead_direction;
+    uint32_t readahead_run;
     TOKUTXN ttxn;
     FT_CHECK_INTERRUPT_CALLBACK interrupt_cb;
     void *interrupt_cb_extra;
@@ -190,6 +190,11 @@ toku_pin_ftnode_for_query(
         goto exit;
     }
     node = static_cast<FTNODE>(node_v);
+    // several readers may hold the pin, only one of them gets the credit
+    if (node->readahead_unused &&
+        toku_sync_bool_compare_and_swap(&node->readahead_unused, true, false)) {
+        FT_STATUS_INC(FT_READAHEAD_HITS, 1);
+    }
     if (apply_ancestor_messages && node->height == 0) {
         needs_ancestors_messages = toku_ft_leaf_needs_ancestors_messages(
             ft_handle->ft, 
@@ -646,6 +646,8 @@ move_leafentries(
 {
     invariant(ube == src_bn->data_buffer.num_klpairs());
     src_bn->data_buffer.split_klpairs(&dest_bn->data_buffer, lbi);
+    toku_bn_count_garbage(src_bn);
+    toku_bn_count_garbage(dest_bn);
 }
 
 static void ftnode_finalize_split(FTNODE node, FTNODE B, MSN max_msn_applied_to_node) {
@@ -1741,8 +1743,15 @@ toku_ftnode_cleaner_callback(
     FTNODE node = (FTNODE) ftnode_pv;
     invariant(node->blocknum.b == blocknum.b);
     invariant(node->fullhash == fullhash);
-    invariant(node->height > 0);   // we should never pick a leaf node (for now at least)
     FT ft = (FT) extraargs;
+    if (node->height == 0) {
+        // Leaves are only picked for the MVCC garbage they hold, see
+        // toku_ftnode_leaf_gc_priority(). Basements that are not in memory
+        // are left alone, so don't bring the node in.
+        toku_ftnode_leaf_run_background_gc(ft, node);
+        toku_unpin_ftnode(ft, node);
+        return 0;
+    }
     bring_node_fully_into_memory(node, ft);
     int childnum = find_heaviest_child(node);
     update_cleaner_status(node, childnum);
@@ -42,6 +42,8 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/ft-flusher-internal.h"
 #include "ft/ft-internal.h"
 #include "ft/node.h"
+#include "ft/serialize/compress.h"
+#include "ft/serialize/ft_node-serialize.h"
 #include "portability/toku_atomic.h"
 #include "util/context.h"
 #include "util/status.h"
@@ -57,12 +59,15 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 // been flushed into.
 // 5. rightmost_leaf_seen - this is a boolean we use to determine if
 // if we have flushed to every leaf node.
+// 6. trainer - if the tree uses dictionary compression, this collects
+// samples of the leaves we flush into, to train a new dictionary.
 struct hot_flusher_extra {
     DBT highest_pivot_key;
     DBT max_current_key;
     float sub_tree_size;
     float percentage_done;
     bool rightmost_leaf_seen;
+    struct toku_compression_dictionary_trainer *trainer;
 };
 
 void
@@ -155,13 +160,16 @@ hot_pick_child(FT ft,
     return childnum;
 }
 
-// Does nothing for now.
+// Samples the leaves we flush into for the dictionary trainer.
 static void
-hot_update_status(FTNODE UU(child),
+hot_update_status(FTNODE child,
                   int UU(dirtied),
-                  void *UU(extra))
+                  void *extra)
 {
-    return;
+    struct hot_flusher_extra *flusher = (struct hot_flusher_extra *) extra;
+    if (flusher->trainer != nullptr && child->height == 0) {
+        toku_ftnode_train_compression_dictionary(child, flusher->trainer);
+    }
 }
 
 // If we've just split a node, HOT needs another chance to decide which
@@ -201,6 +209,7 @@ hot_flusher_init(struct flusher_advice *advice,
     flusher->rightmost_leaf_seen = 0;
     flusher->sub_tree_size = 1.0;
     flusher->percentage_done = 0.0;
+    flusher->trainer = nullptr;
     flusher_advice_init(advice,
                         hot_pick_child,
                         dont_destroy_basement_nodes,
@@ -218,6 +227,9 @@ hot_flusher_destroy(struct hot_flusher_extra *flusher)
 {
     toku_destroy_dbt(&flusher->highest_pivot_key);
     toku_destroy_dbt(&flusher->max_current_key);
+    if (flusher->trainer != nullptr) {
+        toku_compression_dictionary_trainer_destroy(flusher->trainer);
+    }
 }
 
 // Entry point for Hot Optimize Table (HOT).  Note, this function is
@@ -236,6 +248,18 @@ toku_ft_hot_optimize(FT_HANDLE ft_handle, DBT* left, DBT* right,
     hot_flusher_init(&advice, &flusher);
     hot_set_start_key(&flusher, left);
 
+    // A tree that compresses its leaves against a dictionary gets a new
+    // one trained from the leaves we visit.
+    FT ft = ft_handle->ft;
+    enum toku_compression_method compression_method;
+    toku_ft_get_compression_method(ft, &compression_method);
+    uint32_t dictionary_id_at_start = 0;
+    bool reached_rightmost_leaf = false;
+    if (compression_method == TOKU_ZSTD_DICTIONARY_METHOD) {
+        flusher.trainer = toku_compression_dictionary_trainer_create();
+        dictionary_id_at_start = toku_ft_get_compression_dictionary_id(ft);
+    }
+
     uint64_t loop_count = 0;
     MSN msn_at_start_of_hot = ZERO_MSN;  // capture msn from root at
                                          // start of HOT operation
@@ -294,6 +318,12 @@ toku_ft_hot_optimize(FT_HANDLE ft_handle, DBT* left, DBT* right,
             // Since there are no children to flush, we should abort
             // the HOT call.
             flusher.rightmost_leaf_seen = 1;
+            if (flusher.trainer != nullptr) {
+                // a flush would have dirtied the leaf, so that it gets
+                // rewritten with the new dictionary
+                toku_ftnode_train_compression_dictionary(root, flusher.trainer);
+                root->set_dirty();
+            }
             toku_unpin_ftnode(ft_handle->ft, root);
         }
 
@@ -306,6 +336,7 @@ toku_ft_hot_optimize(FT_HANDLE ft_handle, DBT* left, DBT* right,
         // not.
         if (flusher.max_current_key.data == NULL) {
             flusher.rightmost_leaf_seen = 1;
+            reached_rightmost_leaf = true;
         }
         else if (right) {
             // if we have flushed past the bounds set for us,
@@ -331,6 +362,15 @@ toku_ft_hot_optimize(FT_HANDLE ft_handle, DBT* left, DBT* right,
     } while (!flusher.rightmost_leaf_seen);
     *loops_run = loop_count;
 
+    if (flusher.trainer != nullptr) {
+        // Every flush from a height 1 node dirties the leaf, so a
+        // completed pass over the whole tree dirtied every leaf.
+        bool rewrote_every_leaf = r == 0 && left == NULL && reached_rightmost_leaf;
+        if (toku_ft_retrain_compression_dictionary(ft, flusher.trainer, dictionary_id_at_start, rewrote_every_leaf)) {
+            (void) toku_sync_fetch_and_add(&HOT_STATUS_VAL(FT_HOT_NUM_DICTIONARIES_TRAINED), 1);
+        }
+    }
+
     // Cleanup.
     hot_flusher_destroy(&flusher);
 
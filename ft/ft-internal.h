@@ -141,6 +141,14 @@ struct ft_header {
     unsigned int basementnodesize;
     enum toku_compression_method compression_method;
     unsigned int fanout;
+    // checksum of the ftnodes, fixed when the dictionary is created
+    enum toku_checksum_method checksum_method;
+    // zstd dictionaries for TOKU_ZSTD_DICTIONARY_METHOD (see compress.h),
+    // owned by ft->compression_dictionaries.  Leaf partitions are compressed
+    // against the current one.  The retired one is the dictionary it replaced,
+    // kept until a hot optimize of the whole tree has dirtied every leaf.
+    const struct toku_compression_dictionary *compression_dictionary;
+    const struct toku_compression_dictionary *retired_compression_dictionary;
 
     // Current Minimum MSN to be used when upgrading pre-MSN FT's.
     // This is decremented from our currnt MIN_MSN so as not to clash
@@ -230,6 +238,11 @@ struct ft {
     // on first initialization, see ft_set_or_verify_rightmost_blocknum()
     BLOCKNUM rightmost_blocknum;
 
+    // Every compression dictionary this FT has read from its header or
+    // trained, newest first.  Dictionaries are added under the ft lock and
+    // never removed while the FT is alive, so readers need no lock.
+    struct toku_compression_dictionary *compression_dictionaries;
+
     // sequential access pattern heuristic
     // - when promotion pushes a message directly into the rightmost leaf, the score goes up.
     // - if the score is high enough, we optimistically attempt to insert directly into the rightmost leaf
@@ -248,6 +261,7 @@ struct ft_options {
     unsigned int basementnodesize;
     enum toku_compression_method compression_method;
     unsigned int fanout;
+    enum toku_checksum_method checksum_method;
     unsigned int flags;
     uint8_t memcmp_magic;
     ft_compare_func compare_fun;
@@ -204,6 +204,8 @@ toku_instr_key *result_i_open_dbs_rwlock_key;
 // locktree
 toku_instr_key *lock_request_m_wait_cond_key;
 toku_instr_key *manager_m_escalator_done_key;
+toku_instr_key *manager_background_escalation_cond_key;
+toku_instr_key *manager_background_escalation_thread_key;
 toku_instr_key *locktree_request_info_mutex_key;
 toku_instr_key *locktree_request_info_retry_mutex_key;
 toku_instr_key *locktree_request_info_retry_cv_key;
@@ -321,29 +323,27 @@ static long ftnode_cachepressure_size(FTNODE node) {
     long retval = 0;
     bool totally_empty = true;
     if (node->height == 0) {
-        goto exit;
+        // leaves only matter to the cleaner for their MVCC garbage
+        return toku_ftnode_leaf_gc_priority(node);
     }
-    else {
-        for (int i = 0; i < node->n_children; i++) {
-            if (BP_STATE(node,i) == PT_INVALID || BP_STATE(node,i) == PT_ON_DISK) {
-                continue;
-            }
-            else if (BP_STATE(node,i) == PT_COMPRESSED) {
-                SUB_BLOCK sb = BSB(node, i);
-                totally_empty = false;
-                retval += sb->compressed_size;
-            }
-            else if (BP_STATE(node,i) == PT_AVAIL) {
-                totally_empty = totally_empty && (toku_bnc_n_entries(BNC(node, i)) == 0);
-                retval += get_avail_internal_node_partition_size(node, i);
-                retval += BP_WORKDONE(node, i);
-            }
-            else {
-                abort();
-            }
+    for (int i = 0; i < node->n_children; i++) {
+        if (BP_STATE(node,i) == PT_INVALID || BP_STATE(node,i) == PT_ON_DISK) {
+            continue;
+        }
+        else if (BP_STATE(node,i) == PT_COMPRESSED) {
+            SUB_BLOCK sb = BSB(node, i);
+            totally_empty = false;
+            retval += sb->compressed_size;
+        }
+        else if (BP_STATE(node,i) == PT_AVAIL) {
+            totally_empty = totally_empty && (toku_bnc_n_entries(BNC(node, i)) == 0);
+            retval += get_avail_internal_node_partition_size(node, i);
+            retval += BP_WORKDONE(node, i);
+        }
+        else {
+            abort();
         }
     }
-exit:
     if (totally_empty) {
         return 0;
     }
@@ -554,6 +554,19 @@ int ftnode_fetch_extra::rightmost_child_wanted(FTNODE node) const {
     }
 }
 
+static int
+ft_cursor_leftmost_child_wanted(FT_CURSOR cursor, FT_HANDLE ft_handle, FTNODE node)
+{
+    if (cursor->left_is_neg_infty) {
+        return 0;
+    } else if (cursor->range_lock_left_key.data == nullptr) {
+        // no range lock yet, so don't read ahead to the left
+        return node->n_children;
+    } else {
+        return toku_ftnode_which_child(node, &cursor->range_lock_left_key, ft_handle->ft->cmp);
+    }
+}
+
 static int
 ft_cursor_rightmost_child_wanted(FT_CURSOR cursor, FT_HANDLE ft_handle, FTNODE node)
 {
@@ -727,6 +740,9 @@ void toku_ftnode_flush_callback(CACHEFILE UU(cachefile),
     if (!keep_me) {
         if (!is_clone) {
             long node_size = ftnode_memory_size(ftnode);
+            if (ftnode->readahead_unused) {
+                FT_STATUS_INC(FT_READAHEAD_WASTED, 1);
+            }
             if (ftnode->height == 0) {
                 FT_STATUS_INC(FT_FULL_EVICTIONS_LEAF, 1);
                 FT_STATUS_INC(FT_FULL_EVICTIONS_LEAF_BYTES, node_size);
@@ -846,6 +862,7 @@ int toku_ftnode_fetch_callback(CACHEFILE UU(cachefile),
     if (r == 0) {
         *sizep = make_ftnode_pair_attr(*node);
         (*node)->ct_pair = p;
+        (*node)->readahead_unused = bfe->type == ftnode_fetch_prefetch;
         *dirtyp = (*node)->dirty();  // deserialize could mark the node as dirty
                                      // (presumably for upgrade)
     }
@@ -912,14 +929,15 @@ exit:
 }
 
 // replace the child buffer with a compressed version of itself.
-static void compress_internal_node_partition(FTNODE node, int i, enum toku_compression_method compression_method) {
+static void compress_internal_node_partition(FTNODE node, int i, enum toku_compression_method compression_method,
+                                             enum toku_checksum_method checksum_method) {
     // if we should evict, compress the
     // message buffer into a sub_block
     assert(BP_STATE(node, i) == PT_AVAIL);
     assert(node->height > 0);
     SUB_BLOCK XMALLOC(sb);
     sub_block_init(sb);
-    toku_create_compressed_partition_from_available(node, i, compression_method, sb);
+    toku_create_compressed_partition_from_available(node, i, compression_method, checksum_method, sb);
 
     // now set the state to compressed
     set_BSB(node, i, sb);
@@ -981,7 +999,8 @@ int toku_ftnode_pe_callback(void *ftnode_pv,
                             node,
                             i,
                             // Always compress with zstd
-                            TOKU_ZSTD_METHOD);
+                            TOKU_ZSTD_METHOD,
+                            ft->h->checksum_method);
                     } else {
                         // We're not compressing buffers before eviction. Simply
                         // detach the buffer and set the child's state to
@@ -1301,6 +1320,21 @@ void toku_ft_status_note_ftnode(int height, bool created) {
     }
 }
 
+static void ft_pf_callback_check_error(int r, ftnode_fetch_extra *bfe) {
+    if (r != 0) {
+        if (r == TOKUDB_BAD_CHECKSUM) {
+            fprintf(stderr,
+                    "Checksum failure while reading node partition in file %s.\n",
+                    toku_cachefile_fname_in_env(bfe->ft->cf));
+        } else {
+            fprintf(stderr,
+                    "Error while reading node partition %d\n",
+                    get_maybe_error_errno());
+        }
+        abort();
+    }
+}
+
 // callback for partially reading a node
 // could have just used toku_ftnode_fetch_callback, but wanted to separate the two cases to separate functions
 int toku_ftnode_pf_callback(void* ftnode_pv, void* disk_data, void* read_extraargs, int fd, PAIR_ATTR* sizep) {
@@ -1323,6 +1357,10 @@ int toku_ftnode_pf_callback(void* ftnode_pv, void* disk_data, void* read_extraar
         lc = -1;
         rc = -1;
     }
+    // partitions that are on disk are read together once we know all of them
+    toku::scoped_malloc on_disk_buf(node->n_children * sizeof(int));
+    int *on_disk = reinterpret_cast<int *>(on_disk_buf.get());
+    int n_on_disk = 0;
     for (int i = 0; i < node->n_children; i++) {
         if (BP_STATE(node,i) == PT_AVAIL) {
             continue;
@@ -1331,25 +1369,32 @@ int toku_ftnode_pf_callback(void* ftnode_pv, void* disk_data, void* read_extraar
             enum pt_state state = BP_STATE(node, i);
             if (state == PT_COMPRESSED) {
                 r = toku_deserialize_bp_from_compressed(node, i, bfe);
+                ft_status_update_partial_fetch_reason(bfe, i, state, (node->height == 0));
+                ft_pf_callback_check_error(r, bfe);
             } else {
                 invariant(state == PT_ON_DISK);
-                r = toku_deserialize_bp_from_disk(node, ndd, i, fd, bfe);
+                on_disk[n_on_disk++] = i;
             }
-            ft_status_update_partial_fetch_reason(bfe, i, state, (node->height == 0));
         }
-
-        if (r != 0) {
-            if (r == TOKUDB_BAD_CHECKSUM) {
-                fprintf(stderr,
-                        "Checksum failure while reading node partition in file %s.\n",
-                        toku_cachefile_fname_in_env(bfe->ft->cf));
-            } else {
-                fprintf(stderr,
-                        "Error while reading node partition %d\n",
-                        get_maybe_error_errno());
-            }
-            abort();
+    }
+    if (n_on_disk > 0) {
+        // issue the reads as one batch so they are all in flight at once
+        TOKU_AIO aio = bfe->ft->cf ? toku_cachefile_get_aio(bfe->ft->cf) : nullptr;
+        r = toku_deserialize_bps_from_disk(node, ndd, on_disk, n_on_disk, fd, aio, bfe);
+        // the batch's bytes and io time are only counted once
+        const uint64_t bytes_read = bfe->bytes_read;
+        const tokutime_t io_time = bfe->io_time;
+        for (int j = 0; j < n_on_disk; j++) {
+            ft_status_update_partial_fetch_reason(bfe, on_disk[j], PT_ON_DISK, (node->height == 0));
+            bfe->bytes_read = 0;
+            bfe->io_time = 0;
         }
+        bfe->bytes_read = bytes_read;
+        bfe->io_time = io_time;
+        ft_pf_callback_check_error(r, bfe);
+    }
+    if (bfe->type == ftnode_fetch_prefetch) {
+        node->readahead_unused = true;
     }
 
     *sizep = make_ftnode_pair_attr(node);
@@ -2856,6 +2901,25 @@ toku_ft_handle_get_fanout(FT_HANDLE ft_handle, unsigned int *fanout)
     }
 }
 
+// The checksum method is fixed when the dictionary is created, so setting it
+// on a handle only affects the dictionary that handle may go on to create.
+void
+toku_ft_handle_set_checksum_method(FT_HANDLE ft_handle, enum toku_checksum_method method)
+{
+    ft_handle->options.checksum_method = method;
+}
+
+void
+toku_ft_handle_get_checksum_method(FT_HANDLE ft_handle, enum toku_checksum_method *methodp)
+{
+    if (ft_handle->ft) {
+        *methodp = ft_handle->ft->h->checksum_method;
+    }
+    else {
+        *methodp = ft_handle->options.checksum_method;
+    }
+}
+
 // The memcmp magic byte may be set on a per fractal tree basis to communicate
 // that if two keys begin with this byte, they may be compared with the builtin
 // key comparison function. This greatly optimizes certain in-memory workloads,
@@ -2941,6 +3005,7 @@ toku_ft_handle_inherit_options(FT_HANDLE t, FT ft) {
         .basementnodesize = ft->h->basementnodesize,
         .compression_method = ft->h->compression_method,
         .fanout = ft->h->fanout,
+        .checksum_method = ft->h->checksum_method,
         .flags = ft->h->flags,
         .memcmp_magic = ft->cmp.get_memcmp_magic(),
         .compare_fun = ft->cmp.get_compare_func(),
@@ -3304,6 +3369,7 @@ void toku_ft_handle_create(FT_HANDLE *ft_handle_ptr) {
     ft_handle->options.basementnodesize = FT_DEFAULT_BASEMENT_NODE_SIZE;
     ft_handle->options.compression_method = TOKU_DEFAULT_COMPRESSION_METHOD;
     ft_handle->options.fanout = FT_DEFAULT_FANOUT;
+    ft_handle->options.checksum_method = TOKU_CHECKSUM_X1764;
     ft_handle->options.compare_fun = toku_builtin_compare_fun;
     ft_handle->options.update_fun = NULL;
     *ft_handle_ptr = ft_handle;
@@ -3334,6 +3400,10 @@ static int heaviside_from_search_t(const DBT &kdbt, ft_search &search) {
     abort(); return 0;
 }
 
+// How many leaf entries ft_search_basement_node resolves at once while
+// skipping deleted entries.
+static const uint32_t ft_search_skip_batch = 16;
+
 // This is a bottom layer of the search functions.
 static int
 ft_search_basement_node(
@@ -3369,23 +3439,35 @@ ok: ;
         );
     if (r!=0) return r;
 
+    struct le_cursor_val leval;
+    le_extract_vals(&le, 1, toku_ft_cursor_is_leaf_mode(ftcursor),
+                    ftcursor->read_type, ftcursor->ttxn, &leval);
     if (toku_ft_cursor_is_leaf_mode(ftcursor))
         goto got_a_good_value;        // leaf mode cursors see all leaf entries
-    if (le_val_is_del(le, ftcursor->read_type, ftcursor->ttxn)) {
+    if (leval.is_del) {
         // Provisionally deleted stuff is gone.
         // So we need to scan in the direction to see if we can find something.
-        // Every 64 deleted leaf entries check if the leaf's key is within the search bounds.
-        for (uint64_t n_deleted = 1; ; n_deleted++) {
+        // Visibility is resolved for up to ft_search_skip_batch leaf entries
+        // at a time. Every 64 deleted leaf entries check if the leaf's key is
+        // within the search bounds.
+        LEAFENTRY les[ft_search_skip_batch];
+        void *keys[ft_search_skip_batch];
+        uint32_t keylens[ft_search_skip_batch];
+        struct le_cursor_val levals[ft_search_skip_batch];
+        for (uint64_t n_deleted = 1; ; ) {
+            uint32_t n;
             switch (search->direction) {
             case FT_SEARCH_LEFT:
-                idx++;
-                if (idx >= bn->data_buffer.num_klpairs() || ((n_deleted % 64) == 0 && !search_continue(search, key, keylen))) {
+                if (idx + 1 >= bn->data_buffer.num_klpairs() || ((n_deleted % 64) == 0 && !search_continue(search, key, keylen))) {
                     FT_STATUS_INC(FT_CURSOR_SKIP_DELETED_LEAF_ENTRY, n_deleted);
                     if (ftcursor->interrupt_cb && ftcursor->interrupt_cb(ftcursor->interrupt_cb_extra, n_deleted)) {
                         return TOKUDB_INTERRUPTED;
                     }
                     return DB_NOTFOUND;
                 }
+                // stop the batch at the next bounds check
+                n = std::min(bn->data_buffer.num_klpairs() - 1 - idx,
+                             std::min(ft_search_skip_batch, (uint32_t) (64 - (n_deleted % 64))));
                 break;
             case FT_SEARCH_RIGHT:
                 if (idx == 0) {
@@ -3395,29 +3477,37 @@ ok: ;
                     }
                     return DB_NOTFOUND;
                 }
-                idx--;
+                n = std::min(idx, ft_search_skip_batch);
                 break;
             default:
                 abort();
             }
-            r = bn->data_buffer.fetch_klpair(idx, &le, &keylen, &key);
-            assert_zero(r); // we just validated the index
-            if (!le_val_is_del(le, ftcursor->read_type, ftcursor->ttxn)) {
-                FT_STATUS_INC(FT_CURSOR_SKIP_DELETED_LEAF_ENTRY, n_deleted);
-                if (ftcursor->interrupt_cb)
-                    ftcursor->interrupt_cb(ftcursor->interrupt_cb_extra, n_deleted);
-                goto got_a_good_value;
+            for (uint32_t i = 0; i < n; i++) {
+                r = bn->data_buffer.fetch_klpair(idx + direction * (int) (i + 1), &les[i], &keylens[i], &keys[i]);
+                assert_zero(r); // we just validated the index
+            }
+            le_extract_vals(les, n, false, ftcursor->read_type, ftcursor->ttxn, levals);
+            for (uint32_t i = 0; i < n; i++) {
+                idx += direction;
+                le = les[i];
+                key = keys[i];
+                keylen = keylens[i];
+                if (!levals[i].is_del) {
+                    leval = levals[i];
+                    FT_STATUS_INC(FT_CURSOR_SKIP_DELETED_LEAF_ENTRY, n_deleted);
+                    if (ftcursor->interrupt_cb)
+                        ftcursor->interrupt_cb(ftcursor->interrupt_cb_extra, n_deleted);
+                    goto got_a_good_value;
+                }
+                n_deleted++;
             }
         }
     }
 got_a_good_value:
     {
-        uint32_t vallen;
-        void *val;
+        uint32_t vallen = leval.vallen;
+        void *val = leval.val;
 
-        le_extract_val(le, toku_ft_cursor_is_leaf_mode(ftcursor),
-                       ftcursor->read_type, ftcursor->ttxn,
-                       &vallen, &val);
         r = toku_ft_cursor_check_restricted_range(ftcursor, key, keylen);
         if (r == 0) {
             r = getf(keylen, key, vallen, val, getf_v, false);
@@ -3495,39 +3585,136 @@ CACHETABLE_WRITE_CALLBACK get_write_callbacks_for_node(FT ft) {
     return wc;
 }
 
+// The most leaves a cursor keeps in flight ahead of itself.  The actual
+// window starts at one leaf and doubles each time the cursor moves into the
+// next leaf in the same direction, so point queries and short ranges don't
+// pay for reads they won't use.  Zero turns cursor read-ahead off.
+static uint32_t ft_cursor_readahead_window = 8;
+
+void toku_ft_set_cursor_readahead_window(uint32_t num_leaves) {
+    ft_cursor_readahead_window = num_leaves;
+}
+
+struct readahead_extent {
+    DISKOFF offset;
+    DISKOFF size;
+};
+
+static int
+readahead_extent_cmp(const void *a, const void *b) {
+    const struct readahead_extent *ea = (const struct readahead_extent *) a;
+    const struct readahead_extent *eb = (const struct readahead_extent *) b;
+    return (ea->offset > eb->offset) - (ea->offset < eb->offset);
+}
+
+// Effect: Ask the kernel to read each run of physically adjacent blocks in
+//  one request, so the prefetch threads' individual reads hit the page cache.
+//  Does nothing with direct I/O, where there is no page cache to fill.
 static void
-ft_node_maybe_prefetch(FT_HANDLE ft_handle, FTNODE node, int childnum, FT_CURSOR ftcursor, bool *doprefetch) {
-    // the number of nodes to prefetch
-    const int num_nodes_to_prefetch = 1;
-
-    // if we want to prefetch in the tree
-    // then prefetch the next children if there are any
-    if (*doprefetch && toku_ft_cursor_prefetching(ftcursor) && !ftcursor->disable_prefetching) {
-        int rc = ft_cursor_rightmost_child_wanted(ftcursor, ft_handle, node);
-        for (int i = childnum + 1; (i <= childnum + num_nodes_to_prefetch) && (i <= rc); i++) {
-            BLOCKNUM nextchildblocknum = BP_BLOCKNUM(node, i);
-            uint32_t nextfullhash = compute_child_fullhash(ft_handle->ft->cf, node, i);
-            ftnode_fetch_extra *XCALLOC(bfe);
-            bfe->create_for_prefetch(ft_handle->ft, ftcursor);
-            bool doing_prefetch = false;
-            toku_cachefile_prefetch(
-                ft_handle->ft->cf,
-                nextchildblocknum,
-                nextfullhash,
-                get_write_callbacks_for_node(ft_handle->ft),
-                ftnode_fetch_callback_and_free_bfe,
-                toku_ftnode_pf_req_callback,
-                ftnode_pf_callback_and_free_bfe,
-                bfe,
-                &doing_prefetch
-                );
-            if (!doing_prefetch) {
-                bfe->destroy();
-                toku_free(bfe);
-            }
-            *doprefetch = false;
+ft_readahead_coalesce(FT ft, struct readahead_extent *extents, int n) {
+    if (use_direct_io || n < 2) {
+        return;
+    }
+    qsort(extents, n, sizeof extents[0], readahead_extent_cmp);
+    const int fd = toku_cachefile_get_fd(ft->cf);
+    int run_start = 0;
+    for (int i = 1; i <= n; i++) {
+        // blocks are allocated on aligned boundaries, so the next block of a
+        // run starts where the previous one's padding ends
+        if (i < n && extents[i].offset ==
+                         (DISKOFF) roundup_to_multiple(BlockAllocator::BLOCK_ALLOCATOR_ALIGNMENT,
+                                                       extents[i - 1].offset + extents[i - 1].size)) {
+            continue;
+        }
+        if (i - run_start > 1) {
+            const DISKOFF len = extents[i - 1].offset + extents[i - 1].size - extents[run_start].offset;
+            toku_os_readahead_hint(fd, extents[run_start].offset, len);
+            FT_STATUS_INC(FT_READAHEAD_COALESCED_READS, 1);
+            FT_STATUS_INC(FT_READAHEAD_COALESCED_BYTES, len);
+        }
+        run_start = i;
+    }
+}
+
+// Effect: Cursor read-ahead.  Called after a successful search of the leaf
+//  at childnum of the height 1 node.  When the cursor has just moved into a
+//  new leaf, put the next window of leaves (in the direction of the scan, and
+//  within the cursor's range lock) into the prefetch queue.
+static void
+ft_node_maybe_prefetch(FT_HANDLE ft_handle, FTNODE node, int childnum, ft_search *search, FT_CURSOR ftcursor, bool *doprefetch) {
+    if (!*doprefetch || !toku_ft_cursor_prefetching(ftcursor) || ftcursor->disable_prefetching) {
+        return;
+    }
+    *doprefetch = false;
+
+    // Only act when the cursor moves into a new leaf.  Whatever the
+    // window holds for the current leaf was queued when we got here.
+    const BLOCKNUM leaf = BP_BLOCKNUM(node, childnum);
+    if (leaf.b == ftcursor->readahead_last_leaf) {
+        return;
+    }
+    const int direction = search->direction == FT_SEARCH_LEFT ? 1 : -1;
+    if (ftcursor->readahead_last_leaf != 0 && direction == ftcursor->readahead_direction) {
+        ftcursor->readahead_run++;
+    } else {
+        ftcursor->readahead_run = 1;
+    }
+    ftcursor->readahead_last_leaf = leaf.b;
+    ftcursor->readahead_direction = direction;
+
+    uint32_t window = ft_cursor_readahead_window;
+    if (ftcursor->readahead_run <= 32) {
+        window = std::min(window, 1U << (ftcursor->readahead_run - 1));
+    }
+    if (window == 0) {
+        return;
+    }
+
+    int first, last;
+    if (direction > 0) {
+        first = childnum + 1;
+        last = std::min(childnum + (int) window, ft_cursor_rightmost_child_wanted(ftcursor, ft_handle, node));
+    } else {
+        first = std::max(childnum - (int) window, ft_cursor_leftmost_child_wanted(ftcursor, ft_handle, node));
+        last = childnum - 1;
+    }
+    if (first > last) {
+        return;
+    }
+
+    FT ft = ft_handle->ft;
+    toku::scoped_malloc extents_buf((last - first + 1) * sizeof(struct readahead_extent));
+    struct readahead_extent *extents = reinterpret_cast<struct readahead_extent *>(extents_buf.get());
+    int n_extents = 0;
+    for (int j = 0; j <= last - first; j++) {
+        const int i = direction > 0 ? first + j : last - j;
+        BLOCKNUM nextchildblocknum = BP_BLOCKNUM(node, i);
+        uint32_t nextfullhash = compute_child_fullhash(ft->cf, node, i);
+        ftnode_fetch_extra *XCALLOC(bfe);
+        bfe->create_for_prefetch(ft, ftcursor);
+        bool doing_prefetch = false;
+        toku_cachefile_prefetch(
+            ft->cf,
+            nextchildblocknum,
+            nextfullhash,
+            get_write_callbacks_for_node(ft),
+            ftnode_fetch_callback_and_free_bfe,
+            toku_ftnode_pf_req_callback,
+            ftnode_pf_callback_and_free_bfe,
+            bfe,
+            &doing_prefetch
+            );
+        if (doing_prefetch) {
+            FT_STATUS_INC(FT_READAHEAD_NODES, 1);
+            ft->blocktable.translate_blocknum_to_offset_size(
+                nextchildblocknum, &extents[n_extents].offset, &extents[n_extents].size);
+            n_extents++;
+        } else {
+            bfe->destroy();
+            toku_free(bfe);
         }
     }
+    ft_readahead_coalesce(ft, extents, n_extents);
 }
 
 struct unlock_ftnode_extra {
@@ -3600,7 +3787,7 @@ ft_search_child(FT_HANDLE ft_handle, FTNODE node, int childnum, ft_search *searc
     if (r!=TOKUDB_TRY_AGAIN) {
         // maybe prefetch the next child
         if (r == 0 && node->height == 1) {
-            ft_node_maybe_prefetch(ft_handle, node, childnum, ftcursor, doprefetch);
+            ft_node_maybe_prefetch(ft_handle, node, childnum, search, ftcursor, doprefetch);
         }
 
         assert(next_unlockers.locked);
@@ -4648,6 +4835,11 @@ int toku_dump_ft(FILE *f, FT_HANDLE ft_handle) {
 static void toku_pfs_keys_init(const char *toku_instr_group_name) {
     kibbutz_mutex_key = new toku_instr_key(
         toku_instr_object_type::mutex, toku_instr_group_name, "kibbutz_mutex");
+    kibbutz_queue_mutex_key = new toku_instr_key(
+        toku_instr_object_type::mutex, toku_instr_group_name,
+        "kibbutz_queue_mutex");
+    aio_mutex_key = new toku_instr_key(
+        toku_instr_object_type::mutex, toku_instr_group_name, "aio_mutex");
     minicron_p_mutex_key = new toku_instr_key(
         toku_instr_object_type::mutex, toku_instr_group_name,
         "minicron_p_mutex");
@@ -4657,9 +4849,6 @@ static void toku_pfs_keys_init(const char *toku_instr_group_name) {
     tpool_lock_mutex_key = new toku_instr_key(
         toku_instr_object_type::mutex, toku_instr_group_name,
         "tpool_lock_mutex");
-    workset_lock_mutex_key = new toku_instr_key(
-        toku_instr_object_type::mutex, toku_instr_group_name,
-        "workset_lock_mutex");
     bjm_jobs_lock_mutex_key = new toku_instr_key(
         toku_instr_object_type::mutex, toku_instr_group_name,
         "bjm_jobs_lock_mutex");
@@ -4783,6 +4972,12 @@ static void toku_pfs_keys_init(const char *toku_instr_group_name) {
     tp_internal_thread_key = new toku_instr_key(
         toku_instr_object_type::thread, toku_instr_group_name,
         "tp_internal_thread");
+    log_flusher_thread_key = new toku_instr_key(
+        toku_instr_object_type::thread, toku_instr_group_name,
+        "log_flusher_thread");
+    manager_background_escalation_thread_key = new toku_instr_key(
+        toku_instr_object_type::thread, toku_instr_group_name,
+        "manager_background_escalation_thread");
 
     result_state_cond_key = new toku_instr_key(
         toku_instr_object_type::cond, toku_instr_group_name,
@@ -4804,17 +4999,21 @@ static void toku_pfs_keys_init(const char *toku_instr_group_name) {
     result_output_condition_key = new toku_instr_key(
         toku_instr_object_type::cond, toku_instr_group_name,
         "result_output_condition");
+    log_flusher_condition_key = new toku_instr_key(
+        toku_instr_object_type::cond, toku_instr_group_name,
+        "log_flusher_condition");
     manager_m_escalator_done_key = new toku_instr_key(
         toku_instr_object_type::cond, toku_instr_group_name,
         "manager_m_escalator_done");
+    manager_background_escalation_cond_key = new toku_instr_key(
+        toku_instr_object_type::cond, toku_instr_group_name,
+        "manager_background_escalation_cond");
     lock_request_m_wait_cond_key = new toku_instr_key(
         toku_instr_object_type::cond, toku_instr_group_name,
         "lock_request_m_wait_cond");
     queue_result_cond_key = new toku_instr_key(
         toku_instr_object_type::cond, toku_instr_group_name,
         "queue_result_cond");
-    ws_worker_wait_key = new toku_instr_key(
-        toku_instr_object_type::cond, toku_instr_group_name, "ws_worker_wait");
     rwlock_wait_read_key = new toku_instr_key(
         toku_instr_object_type::cond, toku_instr_group_name, "rwlock_wait_read");
     rwlock_wait_write_key = new toku_instr_key(
@@ -4833,6 +5032,11 @@ static void toku_pfs_keys_init(const char *toku_instr_group_name) {
         "frwlock_m_wait_read");
     kibbutz_k_cond_key = new toku_instr_key(
         toku_instr_object_type::cond, toku_instr_group_name, "kibbutz_k_cond");
+    kibbutz_parallel_for_cond_key = new toku_instr_key(
+        toku_instr_object_type::cond, toku_instr_group_name,
+        "kibbutz_parallel_for_cond");
+    aio_cond_key = new toku_instr_key(
+        toku_instr_object_type::cond, toku_instr_group_name, "aio_cond");
     minicron_p_condvar_key = new toku_instr_key(
         toku_instr_object_type::cond, toku_instr_group_name,
         "minicron_p_condvar");
@@ -4867,6 +5071,9 @@ static void toku_pfs_keys_init(const char *toku_instr_group_name) {
     checkpoint_safe_rwlock_key = new toku_instr_key(
         toku_instr_object_type::rwlock, toku_instr_group_name,
         "checkpoint_safe_rwlock");
+    txn_manager_epoch_rwlock_key = new toku_instr_key(
+        toku_instr_object_type::rwlock, toku_instr_group_name,
+        "txn_manager_epoch_rwlock");
     cachetable_value_key = new toku_instr_key(
         toku_instr_object_type::rwlock, toku_instr_group_name,
         "cachetable_value");
@@ -4882,10 +5089,11 @@ static void toku_pfs_keys_init(const char *toku_instr_group_name) {
 
 static void toku_pfs_keys_destroy(void) {
     delete kibbutz_mutex_key;
+    delete kibbutz_queue_mutex_key;
+    delete aio_mutex_key;
     delete minicron_p_mutex_key;
     delete queue_result_mutex_key;
     delete tpool_lock_mutex_key;
-    delete workset_lock_mutex_key;
     delete bjm_jobs_lock_mutex_key;
     delete log_internal_lock_mutex_key;
     delete cachetable_ev_thread_lock_mutex_key;
@@ -4931,6 +5139,8 @@ static void toku_pfs_keys_destroy(void) {
     delete kibbutz_thread_key;
     delete minicron_thread_key;
     delete tp_internal_thread_key;
+    delete log_flusher_thread_key;
+    delete manager_background_escalation_thread_key;
 
     delete result_state_cond_key;
     delete bjm_jobs_wait_key;
@@ -4939,10 +5149,11 @@ static void toku_pfs_keys_destroy(void) {
     delete cachetable_m_ev_thread_cond_key;
     delete bfs_cond_key;
     delete result_output_condition_key;
+    delete log_flusher_condition_key;
     delete manager_m_escalator_done_key;
+    delete manager_background_escalation_cond_key;
     delete lock_request_m_wait_cond_key;
     delete queue_result_cond_key;
-    delete ws_worker_wait_key;
     delete rwlock_wait_read_key;
     delete rwlock_wait_write_key;
     delete rwlock_cond_key;
@@ -4950,6 +5161,8 @@ static void toku_pfs_keys_destroy(void) {
     delete tp_pool_wait_free_key;
     delete frwlock_m_wait_read_key;
     delete kibbutz_k_cond_key;
+    delete kibbutz_parallel_for_cond_key;
+    delete aio_cond_key;
     delete minicron_p_condvar_key;
     delete locktree_request_info_retry_cv_key;
 
@@ -4961,6 +5174,7 @@ static void toku_pfs_keys_destroy(void) {
     delete cachetable_m_lock_key;
     delete result_i_open_dbs_rwlock_key;
     delete checkpoint_safe_rwlock_key;
+    delete txn_manager_epoch_rwlock_key;
     delete cachetable_value_key;
     delete safe_file_size_lock_rwlock_key;
 
@@ -75,6 +75,8 @@ void toku_ft_handle_set_compression_method(FT_HANDLE, enum toku_compression_meth
 void toku_ft_handle_get_compression_method(FT_HANDLE, enum toku_compression_method *);
 void toku_ft_handle_set_fanout(FT_HANDLE, unsigned int fanout);
 void toku_ft_handle_get_fanout(FT_HANDLE, unsigned int *fanout);
+void toku_ft_handle_set_checksum_method(FT_HANDLE, enum toku_checksum_method);
+void toku_ft_handle_get_checksum_method(FT_HANDLE, enum toku_checksum_method *);
 int toku_ft_handle_set_memcmp_magic(FT_HANDLE, uint8_t magic);
 
 void toku_ft_set_bt_compare(FT_HANDLE ft_handle, ft_compare_func cmp_func);
@@ -286,6 +288,8 @@ extern bool garbage_collection_debug;
 // This is a poor place to put global options like these.
 void toku_ft_set_direct_io(bool direct_io_on);
 void toku_ft_set_compress_buffers_before_eviction(bool compress_buffers);
+void toku_ft_set_cursor_readahead_window(uint32_t num_leaves);
+void toku_ft_set_background_gc_threshold(uint32_t num_uxrs);
 
 void toku_note_deserialized_basement_node(bool fixed_key_size);
 
@@ -141,6 +141,13 @@ void CACHETABLE_STATUS_S::init() {
     CT_STATUS_INIT(CT_WAIT_PRESSURE_TIME,       CACHETABLE_WAIT_PRESSURE_TIME,          UINT64, "time waiting on cache pressure");
     CT_STATUS_INIT(CT_LONG_WAIT_PRESSURE_COUNT, CACHETABLE_LONG_WAIT_PRESSURE_COUNT,    UINT64, "number of long waits on cache pressure");
     CT_STATUS_INIT(CT_LONG_WAIT_PRESSURE_TIME,  CACHETABLE_LONG_WAIT_PRESSURE_TIME,     UINT64, "long time waiting on cache pressure");
+    CT_STATUS_INIT(CT_EVICTION_POLICY,          CACHETABLE_EVICTION_POLICY,             UINT64, "eviction policy");
+    CT_STATUS_INIT(CT_HITS,                     CACHETABLE_HITS,                        UINT64, "hits");
+    CT_STATUS_INIT(CT_GHOST_HITS,               CACHETABLE_GHOST_HITS,                  UINT64, "ghost hits");
+    CT_STATUS_INIT(CT_PROBATIONARY_EVICTIONS,   CACHETABLE_PROBATIONARY_EVICTIONS,      UINT64, "probationary evictions");
+    CT_STATUS_INIT(CT_NUMA_NODES,               CACHETABLE_NUMA_NODES,                  UINT64, "numa nodes");
+    CT_STATUS_INIT(CT_NUMA_NODES_OVER_LIMIT,    CACHETABLE_NUMA_NODES_OVER_LIMIT,       UINT64, "numa nodes over their size limit");
+    CT_STATUS_INIT(CT_NUMA_REMOTE_PINS,         CACHETABLE_NUMA_REMOTE_PINS,            UINT64, "numa remote pins");
     
     CT_STATUS_INIT(CT_POOL_CLIENT_NUM_THREADS,                  CACHETABLE_POOL_CLIENT_NUM_THREADS,                 UINT64, "client pool: number of threads in pool");
     CT_STATUS_INIT(CT_POOL_CLIENT_NUM_THREADS_ACTIVE,           CACHETABLE_POOL_CLIENT_NUM_THREADS_ACTIVE,          UINT64, "client pool: number of currently active threads in pool");
@@ -148,18 +155,21 @@ void CACHETABLE_STATUS_S::init() {
     CT_STATUS_INIT(CT_POOL_CLIENT_MAX_QUEUE_SIZE,               CACHETABLE_POOL_CLIENT_MAX_QUEUE_SIZE,              UINT64, "client pool: largest number of queued work items");
     CT_STATUS_INIT(CT_POOL_CLIENT_TOTAL_ITEMS_PROCESSED,        CACHETABLE_POOL_CLIENT_TOTAL_ITEMS_PROCESSED,       UINT64, "client pool: total number of work items processed");
     CT_STATUS_INIT(CT_POOL_CLIENT_TOTAL_EXECUTION_TIME,         CACHETABLE_POOL_CLIENT_TOTAL_EXECUTION_TIME,        UINT64, "client pool: total execution time of processing work items");
+    CT_STATUS_INIT(CT_POOL_CLIENT_TOTAL_STEALS,                 CACHETABLE_POOL_CLIENT_TOTAL_STEALS,                UINT64, "client pool: total number of work items run by a worker other than the one they were queued for");
     CT_STATUS_INIT(CT_POOL_CACHETABLE_NUM_THREADS,              CACHETABLE_POOL_CACHETABLE_NUM_THREADS,             UINT64, "cachetable pool: number of threads in pool");
     CT_STATUS_INIT(CT_POOL_CACHETABLE_NUM_THREADS_ACTIVE,       CACHETABLE_POOL_CACHETABLE_NUM_THREADS_ACTIVE,      UINT64, "cachetable pool: number of currently active threads in pool");
     CT_STATUS_INIT(CT_POOL_CACHETABLE_QUEUE_SIZE,               CACHETABLE_POOL_CACHETABLE_QUEUE_SIZE,              UINT64, "cachetable pool: number of currently queued work items");
     CT_STATUS_INIT(CT_POOL_CACHETABLE_MAX_QUEUE_SIZE,           CACHETABLE_POOL_CACHETABLE_MAX_QUEUE_SIZE,          UINT64, "cachetable pool: largest number of queued work items");
     CT_STATUS_INIT(CT_POOL_CACHETABLE_TOTAL_ITEMS_PROCESSED,    CACHETABLE_POOL_CACHETABLE_TOTAL_ITEMS_PROCESSED,   UINT64, "cachetable pool: total number of work items processed");
     CT_STATUS_INIT(CT_POOL_CACHETABLE_TOTAL_EXECUTION_TIME,     CACHETABLE_POOL_CACHETABLE_TOTAL_EXECUTION_TIME,    UINT64, "cachetable pool: total execution time of processing work items");
+    CT_STATUS_INIT(CT_POOL_CACHETABLE_TOTAL_STEALS,             CACHETABLE_POOL_CACHETABLE_TOTAL_STEALS,            UINT64, "cachetable pool: total number of work items run by a worker other than the one they were queued for");
     CT_STATUS_INIT(CT_POOL_CHECKPOINT_NUM_THREADS,              CACHETABLE_POOL_CHECKPOINT_NUM_THREADS,             UINT64, "checkpoint pool: number of threads in pool");
     CT_STATUS_INIT(CT_POOL_CHECKPOINT_NUM_THREADS_ACTIVE,       CACHETABLE_POOL_CHECKPOINT_NUM_THREADS_ACTIVE,      UINT64, "checkpoint pool: number of currently active threads in pool");
     CT_STATUS_INIT(CT_POOL_CHECKPOINT_QUEUE_SIZE,               CACHETABLE_POOL_CHECKPOINT_QUEUE_SIZE,              UINT64, "checkpoint pool: number of currently queued work items");
     CT_STATUS_INIT(CT_POOL_CHECKPOINT_MAX_QUEUE_SIZE,           CACHETABLE_POOL_CHECKPOINT_MAX_QUEUE_SIZE,          UINT64, "checkpoint pool: largest number of queued work items");
     CT_STATUS_INIT(CT_POOL_CHECKPOINT_TOTAL_ITEMS_PROCESSED,    CACHETABLE_POOL_CHECKPOINT_TOTAL_ITEMS_PROCESSED,   UINT64, "checkpoint pool: total number of work items processed");
     CT_STATUS_INIT(CT_POOL_CHECKPOINT_TOTAL_EXECUTION_TIME,     CACHETABLE_POOL_CHECKPOINT_TOTAL_EXECUTION_TIME,    UINT64, "checkpoint pool: total execution time of processing work items");
+    CT_STATUS_INIT(CT_POOL_CHECKPOINT_TOTAL_STEALS,             CACHETABLE_POOL_CHECKPOINT_TOTAL_STEALS,            UINT64, "checkpoint pool: total number of work items run by a worker other than the one they were queued for");
 
     m_initialized = true;
 #undef CT_STATUS_INIT
@@ -194,10 +204,17 @@ void LTM_STATUS_S::init() {
     LTM_STATUS_INIT(LTM_LONG_WAIT_COUNT,            LOCKTREE_LONG_WAIT_COUNT,               UINT64, "number of long wait locks");
     LTM_STATUS_INIT(LTM_LONG_WAIT_TIME,             LOCKTREE_LONG_WAIT_TIME,                UINT64, "long time waiting for locks");
     LTM_STATUS_INIT(LTM_TIMEOUT_COUNT,              LOCKTREE_TIMEOUT_COUNT,                 UINT64, "number of lock timeouts");
+    LTM_STATUS_INIT(LTM_RETRY_COUNT,                LOCKTREE_RETRY_COUNT,                   UINT64, "number of pending lock request retries");
+    LTM_STATUS_INIT(LTM_RETRY_SUCCESS_COUNT,        LOCKTREE_RETRY_SUCCESS_COUNT,           UINT64, "number of pending lock request retries that got the lock");
+    LTM_STATUS_INIT(LTM_DEADLOCK_COUNT,             LOCKTREE_DEADLOCK_COUNT,                UINT64, "number of lock deadlocks found");
+    LTM_STATUS_INIT(LTM_DEADLOCK_DETECT_COUNT,      LOCKTREE_DEADLOCK_DETECT_COUNT,         UINT64, "number of deadlock checks on blocked lock requests");
+    LTM_STATUS_INIT(LTM_DEADLOCK_DETECT_TIME,       LOCKTREE_DEADLOCK_DETECT_TIME,          UINT64, "time checking for deadlocks (microseconds)");
     LTM_STATUS_INIT(LTM_WAIT_ESCALATION_COUNT,      LOCKTREE_WAIT_ESCALATION_COUNT,         UINT64, "number of waits on lock escalation");
     LTM_STATUS_INIT(LTM_WAIT_ESCALATION_TIME,       LOCKTREE_WAIT_ESCALATION_TIME,          UINT64, "time waiting on lock escalation");
     LTM_STATUS_INIT(LTM_LONG_WAIT_ESCALATION_COUNT, LOCKTREE_LONG_WAIT_ESCALATION_COUNT,    UINT64, "number of long waits on lock escalation");
     LTM_STATUS_INIT(LTM_LONG_WAIT_ESCALATION_TIME,  LOCKTREE_LONG_WAIT_ESCALATION_TIME,     UINT64, "long time waiting on lock escalation");
+    LTM_STATUS_INIT(LTM_BACKGROUND_ESCALATION_COUNT, LOCKTREE_BACKGROUND_ESCALATION_NUM,    UINT64, "number of times background lock escalation ran");
+    LTM_STATUS_INIT(LTM_BACKGROUND_ESCALATION_TIME, LOCKTREE_BACKGROUND_ESCALATION_SECONDS, TOKUTIME, "time spent running background escalation (seconds)");
 
     m_initialized = true;
 #undef LTM_STATUS_INIT
@@ -348,6 +365,31 @@ void FT_STATUS_S::init() {
 
     FT_STATUS_INIT(FT_CURSOR_SKIP_DELETED_LEAF_ENTRY,         CURSOR_SKIP_DELETED_LEAF_ENTRY,       PARCOUNT, "cursor skipped deleted leaf entries");
 
+    // Cursor read-ahead
+    FT_STATUS_INIT(FT_READAHEAD_NODES,                        CURSOR_READAHEAD_NODES,               PARCOUNT, "cursor read-ahead: leaves requested");
+    FT_STATUS_INIT(FT_READAHEAD_HITS,                         CURSOR_READAHEAD_HITS,                PARCOUNT, "cursor read-ahead: leaves used by a query");
+    FT_STATUS_INIT(FT_READAHEAD_WASTED,                       CURSOR_READAHEAD_WASTED,              PARCOUNT, "cursor read-ahead: leaves evicted unused");
+    FT_STATUS_INIT(FT_READAHEAD_COALESCED_READS,              CURSOR_READAHEAD_COALESCED_READS,     PARCOUNT, "cursor read-ahead: coalesced reads");
+    FT_STATUS_INIT(FT_READAHEAD_COALESCED_BYTES,              CURSOR_READAHEAD_COALESCED_BYTES,     PARCOUNT, "cursor read-ahead: coalesced bytes");
+
+    // Background garbage collection of leaf entries
+    FT_STATUS_INIT(FT_BACKGROUND_GC_LEAVES,                   BACKGROUND_GC_LEAVES,                 PARCOUNT, "background gc: leaves collected");
+    FT_STATUS_INIT(FT_BACKGROUND_GC_BASEMENTS,                BACKGROUND_GC_BASEMENTS,              PARCOUNT, "background gc: basements collected");
+    FT_STATUS_INIT(FT_BACKGROUND_GC_DEFERRED,                 BACKGROUND_GC_DEFERRED,               PARCOUNT, "background gc: basements deferred (garbage still referenced)");
+    FT_STATUS_INIT(FT_BACKGROUND_GC_BYTES,                    BACKGROUND_GC_BYTES,                  PARCOUNT, "background gc: bytes reclaimed");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_IN_NONE,                COMPRESSION_NONE_UNCOMPRESSED_BYTES,   PARCOUNT, "compression: stored uncompressed (uncompressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_OUT_NONE,               COMPRESSION_NONE_COMPRESSED_BYTES,     PARCOUNT, "compression: stored uncompressed (compressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_IN_SNAPPY,              COMPRESSION_SNAPPY_UNCOMPRESSED_BYTES, PARCOUNT, "compression: snappy (uncompressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_OUT_SNAPPY,             COMPRESSION_SNAPPY_COMPRESSED_BYTES,   PARCOUNT, "compression: snappy (compressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_IN_ZSTD,                COMPRESSION_ZSTD_UNCOMPRESSED_BYTES,   PARCOUNT, "compression: zstd (uncompressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_OUT_ZSTD,               COMPRESSION_ZSTD_COMPRESSED_BYTES,     PARCOUNT, "compression: zstd (compressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_IN_ZLIB,                COMPRESSION_ZLIB_UNCOMPRESSED_BYTES,   PARCOUNT, "compression: zlib (uncompressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_OUT_ZLIB,               COMPRESSION_ZLIB_COMPRESSED_BYTES,     PARCOUNT, "compression: zlib (compressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_IN_QUICKLZ,             COMPRESSION_QUICKLZ_UNCOMPRESSED_BYTES, PARCOUNT, "compression: quicklz (uncompressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_OUT_QUICKLZ,            COMPRESSION_QUICKLZ_COMPRESSED_BYTES,  PARCOUNT, "compression: quicklz (compressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_IN_LZMA,                COMPRESSION_LZMA_UNCOMPRESSED_BYTES,   PARCOUNT, "compression: lzma (uncompressed bytes)");
+    FT_STATUS_INIT(FT_COMPRESS_BYTES_OUT_LZMA,               COMPRESSION_LZMA_COMPRESSED_BYTES,     PARCOUNT, "compression: lzma (compressed bytes)");
+
     m_initialized = true;
 #undef FT_STATUS_INIT
 }
@@ -422,6 +464,7 @@ void FT_HOT_STATUS_S::init() {
     HOT_STATUS_INIT(FT_HOT_NUM_COMPLETED,         HOT_NUM_COMPLETED,         UINT64, "operations successfully completed");
     HOT_STATUS_INIT(FT_HOT_NUM_ABORTED,           HOT_NUM_ABORTED,           UINT64, "operations aborted");
     HOT_STATUS_INIT(FT_HOT_MAX_ROOT_FLUSH_COUNT,  HOT_MAX_ROOT_FLUSH_COUNT,  UINT64, "max number of flushes from root ever required to optimize a tree");
+    HOT_STATUS_INIT(FT_HOT_NUM_DICTIONARIES_TRAINED, HOT_NUM_DICTIONARIES_TRAINED, UINT64, "compression dictionaries trained");
 
     m_initialized = true;
 #undef HOT_STATUS_INIT
@@ -468,6 +511,8 @@ void LOGGER_STATUS_S::init() {
     LOG_STATUS_INIT(LOGGER_UNCOMPRESSED_BYTES_WRITTEN,  LOGGER_WRITES_UNCOMPRESSED_BYTES, UINT64, "writes (uncompressed bytes)");
     LOG_STATUS_INIT(LOGGER_TOKUTIME_WRITES,             LOGGER_WRITES_SECONDS,  TOKUTIME, "writes (seconds)");
     LOG_STATUS_INIT(LOGGER_WAIT_BUF_LONG,               LOGGER_WAIT_LONG,       UINT64, "number of long logger write operations");
+    LOG_STATUS_INIT(LOGGER_NUM_GROUP_COMMITS,           LOGGER_GROUP_COMMITS,   UINT64, "group commits");
+    LOG_STATUS_INIT(LOGGER_GROUP_COMMIT_WAITERS,        LOGGER_GROUP_COMMIT_WAITERS, UINT64, "group commits (committers satisfied)");
     m_initialized = true;
 #undef LOG_STATUS_INIT
 }
@@ -170,6 +170,13 @@ public:
         CT_WAIT_PRESSURE_TIME,
         CT_LONG_WAIT_PRESSURE_COUNT,
         CT_LONG_WAIT_PRESSURE_TIME,
+        CT_EVICTION_POLICY,        // the replacement policy in use (enum cachetable_eviction_policy)
+        CT_HITS,                   // number of pins that found the pair already in the cachetable
+        CT_GHOST_HITS,             // number of misses on pairs the 2Q policy had recently evicted
+        CT_PROBATIONARY_EVICTIONS, // number of pairs evicted before they were ever promoted by 2Q
+        CT_NUMA_NODES,             // number of NUMA nodes the size limit is split across, 0 if off
+        CT_NUMA_NODES_OVER_LIMIT,  // number of NUMA nodes using more than their share of the cachetable
+        CT_NUMA_REMOTE_PINS,       // number of pins of a pair charged to a node other than the pinning thread's
 
         CT_POOL_CLIENT_NUM_THREADS,
         CT_POOL_CLIENT_NUM_THREADS_ACTIVE,
@@ -177,18 +184,21 @@ public:
         CT_POOL_CLIENT_MAX_QUEUE_SIZE,
         CT_POOL_CLIENT_TOTAL_ITEMS_PROCESSED,
         CT_POOL_CLIENT_TOTAL_EXECUTION_TIME,
+        CT_POOL_CLIENT_TOTAL_STEALS,
         CT_POOL_CACHETABLE_NUM_THREADS,
         CT_POOL_CACHETABLE_NUM_THREADS_ACTIVE,
         CT_POOL_CACHETABLE_QUEUE_SIZE,
         CT_POOL_CACHETABLE_MAX_QUEUE_SIZE,
         CT_POOL_CACHETABLE_TOTAL_ITEMS_PROCESSED,
         CT_POOL_CACHETABLE_TOTAL_EXECUTION_TIME,
+        CT_POOL_CACHETABLE_TOTAL_STEALS,
         CT_POOL_CHECKPOINT_NUM_THREADS,
         CT_POOL_CHECKPOINT_NUM_THREADS_ACTIVE,
         CT_POOL_CHECKPOINT_QUEUE_SIZE,
         CT_POOL_CHECKPOINT_MAX_QUEUE_SIZE,
         CT_POOL_CHECKPOINT_TOTAL_ITEMS_PROCESSED,
         CT_POOL_CHECKPOINT_TOTAL_EXECUTION_TIME,
+        CT_POOL_CHECKPOINT_TOTAL_STEALS,
 
         CT_STATUS_NUM_ROWS
     };
@@ -229,10 +239,17 @@ public:
         LTM_LONG_WAIT_COUNT,
         LTM_LONG_WAIT_TIME,
         LTM_TIMEOUT_COUNT,
+        LTM_RETRY_COUNT,
+        LTM_RETRY_SUCCESS_COUNT,
+        LTM_DEADLOCK_COUNT,
+        LTM_DEADLOCK_DETECT_COUNT,
+        LTM_DEADLOCK_DETECT_TIME,
         LTM_WAIT_ESCALATION_COUNT,
         LTM_WAIT_ESCALATION_TIME,
         LTM_LONG_WAIT_ESCALATION_COUNT,
         LTM_LONG_WAIT_ESCALATION_TIME,
+        LTM_BACKGROUND_ESCALATION_COUNT,
+        LTM_BACKGROUND_ESCALATION_TIME,
         LTM_STATUS_NUM_ROWS // must be last
     };
 
@@ -367,6 +384,27 @@ public:
         FT_PRO_RIGHTMOST_LEAF_SHORTCUT_FAIL_POS,
         FT_PRO_RIGHTMOST_LEAF_SHORTCUT_FAIL_REACTIVE,
         FT_CURSOR_SKIP_DELETED_LEAF_ENTRY, // how many deleted leaf entries were skipped by a cursor
+        FT_READAHEAD_NODES,             // how many leaves a cursor asked to have read ahead
+        FT_READAHEAD_HITS,              // how many read-ahead leaves were later used by a query
+        FT_READAHEAD_WASTED,            // how many read-ahead leaves were evicted before any query used them
+        FT_READAHEAD_COALESCED_READS,   // how many runs of adjacent read-ahead leaves were read as one extent
+        FT_READAHEAD_COALESCED_BYTES,   // how many bytes those runs covered
+        FT_BACKGROUND_GC_LEAVES,        // how many leaves the cleaner thread garbage collected
+        FT_BACKGROUND_GC_BASEMENTS,     // how many basements it garbage collected in those leaves
+        FT_BACKGROUND_GC_DEFERRED,      // how many basements it skipped because their garbage was still referenced
+        FT_BACKGROUND_GC_BYTES,         // how many bytes of leafentries it reclaimed
+        FT_COMPRESS_BYTES_IN_NONE,      // bytes handed to and produced by each compression method
+        FT_COMPRESS_BYTES_OUT_NONE,
+        FT_COMPRESS_BYTES_IN_SNAPPY,
+        FT_COMPRESS_BYTES_OUT_SNAPPY,
+        FT_COMPRESS_BYTES_IN_ZSTD,
+        FT_COMPRESS_BYTES_OUT_ZSTD,
+        FT_COMPRESS_BYTES_IN_ZLIB,
+        FT_COMPRESS_BYTES_OUT_ZLIB,
+        FT_COMPRESS_BYTES_IN_QUICKLZ,
+        FT_COMPRESS_BYTES_OUT_QUICKLZ,
+        FT_COMPRESS_BYTES_IN_LZMA,
+        FT_COMPRESS_BYTES_OUT_LZMA,
         FT_STATUS_NUM_ROWS
     };
 
@@ -461,6 +499,7 @@ public:
         FT_HOT_NUM_COMPLETED,        // number of HOT operations that have successfully completed
         FT_HOT_NUM_ABORTED,          // number of HOT operations that have been aborted
         FT_HOT_MAX_ROOT_FLUSH_COUNT, // max number of flushes from root ever required to optimize a tree
+        FT_HOT_NUM_DICTIONARIES_TRAINED, // number of compression dictionaries trained by HOT
         FT_HOT_STATUS_NUM_ROWS
     };
 
@@ -519,6 +558,8 @@ public:
         LOGGER_UNCOMPRESSED_BYTES_WRITTEN,
         LOGGER_TOKUTIME_WRITES,
         LOGGER_WAIT_BUF_LONG,
+        LOGGER_NUM_GROUP_COMMITS,
+        LOGGER_GROUP_COMMIT_WAITERS,
         LOGGER_STATUS_NUM_ROWS
     };
 
@@ -37,6 +37,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
 
 #include "ft/serialize/block_table.h"
+#include "ft/serialize/compress.h"
 #include "ft/ft.h"
 #include "ft/ft-cachetable-wrappers.h"
 #include "ft/ft-internal.h"
@@ -74,6 +75,7 @@ ft_destroy(FT ft) {
     toku_destroy_dbt(&ft->descriptor.dbt);
     toku_destroy_dbt(&ft->cmp_descriptor.dbt);
     toku_ft_destroy_reflock(ft);
+    toku_ft_free_compression_dictionaries(ft);
     toku_free(ft->h);
 }
 
@@ -393,6 +395,9 @@ ft_header_create(FT_OPTIONS options, BLOCKNUM root_blocknum, TXNID root_xid_that
         .basementnodesize = options->basementnodesize,
         .compression_method = options->compression_method,
         .fanout = options->fanout,
+        .checksum_method = options->checksum_method,
+        .compression_dictionary = nullptr,
+        .retired_compression_dictionary = nullptr,
         .highest_unused_msn_for_upgrade = { .msn = (MIN_MSN.msn - 1) },
         .max_msn_in_ft = ZERO_MSN,
         .time_of_last_optimize_begin = 0,
@@ -573,6 +578,7 @@ toku_ft_init(FT ft,
         .basementnodesize = target_basementnodesize,
         .compression_method = compression_method,
         .fanout = fanout,
+        .checksum_method = TOKU_CHECKSUM_X1764,
         .flags = 0,
         .memcmp_magic = 0,
         .compare_fun = NULL,
@@ -595,6 +601,7 @@ ft_handle_open_for_redirect(FT_HANDLE *new_ftp, const char *fname_in_env, TOKUTX
     toku_ft_handle_set_basementnodesize(ft_handle, old_ft->h->basementnodesize);
     toku_ft_handle_set_compression_method(ft_handle, old_ft->h->compression_method);
     toku_ft_handle_set_fanout(ft_handle, old_ft->h->fanout);
+    toku_ft_handle_set_checksum_method(ft_handle, old_ft->h->checksum_method);
     CACHETABLE ct = toku_cachefile_get_cachetable(old_ft->cf);
     int r = toku_ft_handle_open_with_dict_id(ft_handle, fname_in_env, 0, 0, ct, txn, old_ft->dict_id);
     if (r != 0) {
@@ -1004,6 +1011,69 @@ void toku_ft_get_compression_method(FT ft, enum toku_compression_method *methodp
     toku_ft_unlock(ft);
 }
 
+void toku_ft_add_compression_dictionary(FT ft, struct toku_compression_dictionary *dict) {
+    dict->next = ft->compression_dictionaries;
+    // readers walk the list without the ft lock
+    __atomic_store_n(&ft->compression_dictionaries, dict, __ATOMIC_RELEASE);
+}
+
+const struct toku_compression_dictionary *toku_ft_find_compression_dictionary(FT ft, uint32_t id) {
+    for (const struct toku_compression_dictionary *dict =
+             __atomic_load_n(&ft->compression_dictionaries, __ATOMIC_ACQUIRE);
+         dict != nullptr; dict = dict->next) {
+        if (dict->id == id) {
+            return dict;
+        }
+    }
+    return nullptr;
+}
+
+void toku_ft_free_compression_dictionaries(FT ft) {
+    while (ft->compression_dictionaries != nullptr) {
+        struct toku_compression_dictionary *dict = ft->compression_dictionaries;
+        ft->compression_dictionaries = dict->next;
+        toku_compression_dictionary_destroy(dict);
+    }
+}
+
+bool toku_ft_retrain_compression_dictionary(FT ft, struct toku_compression_dictionary_trainer *trainer,
+                                            uint32_t id_at_start, bool rewrote_every_leaf) {
+    bool trained = false;
+    toku_ft_lock(ft);
+    const struct toku_compression_dictionary *current = ft->h->compression_dictionary;
+    uint32_t current_id = current ? current->id : 0;
+    // Every leaf written from now on uses the current dictionary, and so
+    // does every leaf the hot optimize dirtied, so once all of them are
+    // checkpointed nothing refers to the retired dictionary any more.  The
+    // header it is dropped from goes out in that same checkpoint.
+    if (rewrote_every_leaf && current_id == id_at_start &&
+        ft->h->retired_compression_dictionary != nullptr) {
+        ft->h->retired_compression_dictionary = nullptr;
+        ft->h->set_dirty();
+    }
+    if (ft->h->retired_compression_dictionary == nullptr) {
+        uint32_t id = ft->compression_dictionaries ? ft->compression_dictionaries->id + 1 : 1;
+        struct toku_compression_dictionary *dict = toku_compression_dictionary_trainer_finish(trainer, id);
+        if (dict != nullptr) {
+            toku_ft_add_compression_dictionary(ft, dict);
+            ft->h->retired_compression_dictionary = current;
+            ft->h->compression_dictionary = dict;
+            ft->h->set_dirty();
+            trained = true;
+        }
+    }
+    toku_ft_unlock(ft);
+    return trained;
+}
+
+uint32_t toku_ft_get_compression_dictionary_id(FT ft) {
+    toku_ft_lock(ft);
+    const struct toku_compression_dictionary *current = ft->h->compression_dictionary;
+    uint32_t id = current ? current->id : 0;
+    toku_ft_unlock(ft);
+    return id;
+}
+
 void toku_ft_set_fanout(FT ft, unsigned int fanout) {
     toku_ft_lock(ft);
     ft->h->fanout = fanout;
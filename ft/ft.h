@@ -44,6 +44,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/ft-ops.h"
 #include "ft/logger/log.h"
 #include "util/dbt.h"
+#include "util/kibbutz.h"
 
 typedef struct ft *FT;
 typedef struct ft_options *FT_OPTIONS;
@@ -159,6 +160,22 @@ void toku_ft_get_compression_method(FT ft, enum toku_compression_method *methodp
 void toku_ft_set_fanout(FT ft, unsigned int fanout);
 void toku_ft_get_fanout(FT ft, unsigned int *fanout);
 
+// Compression dictionaries (see compress.h).
+void toku_ft_add_compression_dictionary(FT ft, struct toku_compression_dictionary *dict);
+// Effect: Make dict known to the FT, which takes ownership of it.
+//  Requires: ft lock is held, or the FT is not yet visible to other threads.
+const struct toku_compression_dictionary *toku_ft_find_compression_dictionary(FT ft, uint32_t id);
+// Effect: Return the dictionary with the given id, or NULL.  Needs no lock.
+void toku_ft_free_compression_dictionaries(FT ft);
+bool toku_ft_retrain_compression_dictionary(FT ft, struct toku_compression_dictionary_trainer *trainer,
+                                            uint32_t id_at_start, bool rewrote_every_leaf);
+// Effect: Called at the end of a hot optimize.  If the hot optimize dirtied
+//  every leaf and the dictionary did not change meanwhile, forget the retired
+//  dictionary.  Then, if there is no retired dictionary, retire the current one
+//  and make a dictionary trained from trainer current.
+//  Returns true if it did so.
+uint32_t toku_ft_get_compression_dictionary_id(FT ft);
+
 // mark the ft as a blackhole. any message injections will be a no op.
 void toku_ft_set_blackhole(FT_HANDLE ft_handle);
 
@@ -170,7 +187,7 @@ void toku_ft_get_garbage(FT ft, uint64_t *total_space, uint64_t *used_space);
 int get_num_cores(void);
 
 // TODO: Use the cachetable's worker pool instead of something managed by the FT...
-struct toku_thread_pool *get_ft_pool(void);
+KIBBUTZ get_ft_pool(void);
 
 // TODO: Should be in portability
 int toku_single_process_lock(const char *lock_dir, const char *which, int *lockfd);
@@ -196,6 +196,25 @@ void le_extract_val(
     uint32_t* vallen,
     void** val);
 
+// What a cursor reads from a leafentry, as returned by le_extract_vals().
+struct le_cursor_val {
+    void *val;
+    uint32_t vallen;
+    bool is_del;
+};
+
+// Batch version of le_val_is_del() and le_extract_val() for scans. Resolves
+// the value that is read from each of num_les leafentries, and whether it is
+// a delete, walking each leafentry's xid stack only once. Clean leafentries
+// take a fast path that does not consult the txn.
+void le_extract_vals(
+    LEAFENTRY *les,
+    uint32_t num_les,
+    bool is_leaf_mode,
+    enum cursor_read_type read_type,
+    TOKUTXN ttxn,
+    struct le_cursor_val *vals);
+
 size_t leafentry_disksize_13(LEAFENTRY_13 le);
 
 int toku_le_upgrade_13_14(
@@ -225,6 +244,17 @@ bool toku_le_worth_running_garbage_collection(
     LEAFENTRY le,
     txn_gc_info* gc_info);
 
+// Effect: Counts the uxrs in le that garbage collection may reclaim: committed
+//         uxrs shadowed by a newer committed uxr, and provisional uxrs.
+//         *newest_xid is the newest xid among them, or TXNID_NONE if there
+//         are none. Once no live txn references that xid, all of them can be
+//         reclaimed.
+void toku_le_count_garbage(
+    LEAFENTRY le,
+    uint32_t* num_stale_cxrs,
+    uint32_t* num_pxrs,
+    TXNID* newest_xid);
+
 void toku_le_garbage_collect(
     LEAFENTRY old_leaf_entry,
     bn_data* data_buffer,
@@ -178,6 +178,7 @@ struct ft_loader_s {
     DB **dbs; // N of these
     DESCRIPTOR *descriptors; // N of these.
     TXNID      *root_xids_that_created; // N of these.
+    enum toku_checksum_method *checksum_methods; // N of these.  A loaded dictionary keeps the checksum of the one it replaces.
     const char **new_fnames_in_env; // N of these.  The file names that the final data will be written to (relative to env).
 
     uint64_t *extracted_datasizes; // N of these.
@@ -344,6 +344,7 @@ void toku_ft_loader_internal_destroy(FTLOADER bl, bool is_error) {
     toku_free(bl->dbs);
     toku_free(bl->descriptors);
     toku_free(bl->root_xids_that_created);
+    toku_free(bl->checksum_methods);
     if (bl->new_fnames_in_env) {
         for (int i = 0; i < bl->N; i++)
             toku_free((char*)bl->new_fnames_in_env[i]);
@@ -535,6 +536,8 @@ int toku_ft_loader_internal_init (/* out */ FTLOADER *blp,
 
     MY_CALLOC_N(N, bl->root_xids_that_created);
     for (int i=0; i<N; i++) if (fts[i]) bl->root_xids_that_created[i]=fts[i]->ft->h->root_xid_that_created;
+    MY_CALLOC_N(N, bl->checksum_methods);
+    for (int i=0; i<N; i++) if (fts[i]) bl->checksum_methods[i]=fts[i]->ft->h->checksum_method;
     MY_CALLOC_N(N, bl->dbs);
     for (int i=0; i<N; i++) if (fts[i]) bl->dbs[i]=dbs[i];
     MY_CALLOC_N(N, bl->descriptors);
@@ -2442,6 +2445,8 @@ static int toku_loader_write_ft_from_q (FTLOADER bl,
     // TODO: (Zardosht/Yoni/Leif), do this code properly
     struct ft ft;
     toku_ft_init(&ft, (BLOCKNUM){0}, bl->load_lsn, root_xid_that_created, target_nodesize, target_basementnodesize, target_compression_method, target_fanout);
+    if (bl->checksum_methods)
+        ft.h->checksum_method = bl->checksum_methods[which_db];
 
     struct dbout out;
     ZERO_STRUCT(out);
@@ -2665,7 +2670,7 @@ static int toku_loader_write_ft_from_q (FTLOADER bl,
             result = r; goto error;
         }
 
-        r = write_header(&out, off_of_translation, (out.n_translations+1)*16+4);
+        r = write_header(&out, off_of_translation, out.translation[1].size);
         if (r) {
             result = r; goto error;
         }
@@ -3037,6 +3042,7 @@ static void finish_leafnode(
         &ndd,
         target_basementnodesize,
         target_compression_method,
+        out->ft->h->checksum_method,
         true,
         true,
         &serialized_leaf_size,
@@ -3078,7 +3084,8 @@ static int write_translation_table (struct dbout *out, long long *off_of_transla
     struct dbuf ttable;
     dbuf_init(&ttable);
     long long off_of_translation = out->current_off;
-    long long bt_size_on_disk = out->n_translations * 16 + 20;
+    long long bt_size_on_disk = out->n_translations * 16 + 24;
+    putbuf_int32(&ttable, TRANSLATION_FORMAT_FULL);
     putbuf_int64(&ttable, out->n_translations);    // number of records
     putbuf_int64(&ttable, -1LL); // the linked list
     out->translation[1].off = off_of_translation;
@@ -3259,7 +3266,7 @@ static void write_nonleaf_node (FTLOADER bl, struct dbout *out, int64_t blocknum
         size_t n_uncompressed_bytes;
         char *bytes;
         int r;
-        r = toku_serialize_ftnode_to_memory(node, &ndd, target_basementnodesize, target_compression_method, true, true, &n_bytes, &n_uncompressed_bytes, &bytes);
+        r = toku_serialize_ftnode_to_memory(node, &ndd, target_basementnodesize, target_compression_method, out->ft->h->checksum_method, true, true, &n_bytes, &n_uncompressed_bytes, &bytes);
         if (r) {
             result = r;
         } else {
@@ -104,11 +104,16 @@ struct tokulogger {
     int fd;
     CACHETABLE ct;
     int lg_max; // The size of the single file in the log.  Default is 100MB.
+    enum toku_checksum_method checksum_method; // Checksum of the entries written by this logger.  Recorded in the magic of each log file.
 
     // To access these, you must have the input lock
     LSN lsn; // the next available lsn
     struct logbuf inbuf; // data being accumulated for the write
 
+    // Log entries reserved in the inbuf but not yet filled in.  Incremented with the input lock held,
+    // decremented without it (atomically).  The inbuf may only be swapped out once this is zero.
+    uint32_t num_unfilled_reservations;
+
     // To access these, you must have the output condition lock.
     LSN written_lsn; // the last lsn written
     LSN fsynced_lsn; // What is the LSN of the highest fsynced log entry  (accessed only while holding the output lock, and updated only when the output lock and output permission are held)
@@ -120,6 +125,21 @@ struct tokulogger {
     // To access the logfilemgr you must have the output condition lock.
     TOKULOGFILEMGR logfilemgr;
 
+    // Group commit.  Committers that need the log fsynced raise flush_requested_lsn, wake the
+    // flusher thread, and wait on the output condition until fsynced_lsn catches up.  The flusher
+    // writes and fsyncs on behalf of everyone who asked since its last fsync.
+    // To access these, you must have the output condition lock.
+    bool flusher_is_running;
+    bool flusher_should_stop;
+    toku_pthread_t flusher_thread;
+    toku_cond_t flusher_condition;     // signalled when a committer asks for a flush, or at shutdown
+    LSN flush_requested_lsn;           // the highest lsn any committer is waiting to see fsynced
+    uint32_t num_flush_waiters;        // committers that asked since the flusher last took a batch
+    uint32_t group_commit_max_delay_usec; // how long the flusher may wait for a batch to fill.  0 means don't wait.
+    uint32_t group_commit_min_batch;      // flush as soon as this many committers are waiting
+    uint64_t num_group_commits;           // how many fsyncs did the flusher do?
+    uint64_t num_group_committed_waiters; // how many committers did those fsyncs satisfy?
+
     uint32_t write_block_size;       // How big should the blocks be written to various logs?
 
     uint64_t num_writes_to_disk;         // how many times did we write to disk?
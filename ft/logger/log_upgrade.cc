@@ -266,8 +266,8 @@ toku_maybe_upgrade_log(const char *env_dir, const char *log_dir, LSN * lsn_of_cl
         r = verify_clean_shutdown_of_log_version(log_dir, version_of_logs_on_disk, &last_lsn, &last_xid);
         if (r != 0) {
             if (version_of_logs_on_disk >= TOKU_LOG_VERSION_25 &&
-                version_of_logs_on_disk <= TOKU_LOG_VERSION_29 &&
-                TOKU_LOG_VERSION_29 == TOKU_LOG_VERSION) {
+                version_of_logs_on_disk <= TOKU_LOG_VERSION_30 &&
+                TOKU_LOG_VERSION_30 == TOKU_LOG_VERSION) {
                 r = 0; // can do recovery on dirty shutdown
             } else {
                 fprintf(stderr, "Cannot upgrade PerconaFT version %d database.", version_of_logs_on_disk);
@@ -49,6 +49,7 @@ struct toku_logcursor {
     int n_logfiles;
     int cur_logfiles_index;
     FILE *cur_fp;
+    enum toku_checksum_method cur_checksum_method; // of the entries in cur_fp, from its magic
     size_t buffer_size;
     void *buffer;
     bool is_open;
@@ -119,7 +120,7 @@ static int lc_open_logfile(TOKULOGCURSOR lc, int index) {
     // position fp past header, ignore 0 length file (t:2384)
     unsigned int version=0;
     if ( lc_file_len(lc->logfiles[index]) >= 12 ) {
-        r = toku_read_logmagic(lc->cur_fp, &version);
+        r = toku_read_logmagic(lc->cur_fp, &version, &lc->cur_checksum_method);
         if (r!=0) 
             return DB_BADFORMAT;
         if (version < TOKU_LOG_MIN_SUPPORTED_VERSION || version > TOKU_LOG_VERSION)
@@ -173,6 +174,7 @@ static int lc_create(TOKULOGCURSOR *lc, const char *log_dir) {
     cursor->logfiles = NULL;
     cursor->n_logfiles = 0;
     cursor->cur_fp = NULL;
+    cursor->cur_checksum_method = TOKU_CHECKSUM_X1764;
     cursor->cur_lsn.lsn=0;
     cursor->last_direction=LC_FIRST;
     
@@ -235,7 +237,7 @@ int toku_logcursor_destroy(TOKULOGCURSOR *lc) {
 
 static int lc_log_read(TOKULOGCURSOR lc)
 {
-    int r = toku_log_fread(lc->cur_fp, &(lc->entry));
+    int r = toku_log_fread(lc->cur_fp, &(lc->entry), lc->cur_checksum_method);
     while ( r == EOF ) { 
         // move to next file
         r = lc_close_cur_logfile(lc);                    
@@ -244,7 +246,7 @@ static int lc_log_read(TOKULOGCURSOR lc)
         lc->cur_logfiles_index++;
         r = lc_open_logfile(lc, lc->cur_logfiles_index); 
         if (r!=0) return r;
-        r = toku_log_fread(lc->cur_fp, &(lc->entry));
+        r = toku_log_fread(lc->cur_fp, &(lc->entry), lc->cur_checksum_method);
     }
     if (r!=0) {
         toku_log_free_log_entry_resources(&(lc->entry));
@@ -261,7 +263,7 @@ static int lc_log_read(TOKULOGCURSOR lc)
 
 static int lc_log_read_backward(TOKULOGCURSOR lc) 
 {
-    int r = toku_log_fread_backward(lc->cur_fp, &(lc->entry));
+    int r = toku_log_fread_backward(lc->cur_fp, &(lc->entry), lc->cur_checksum_method);
     while ( -1 == r) { // if within header length of top of file
         // move to previous file
         r = lc_close_cur_logfile(lc);
@@ -276,7 +278,7 @@ static int lc_log_read_backward(TOKULOGCURSOR lc)
         // seek to end
         r = fseek(lc->cur_fp, 0, SEEK_END);
         assert(0==r);
-        r = toku_log_fread_backward(lc->cur_fp, &(lc->entry));
+        r = toku_log_fread_backward(lc->cur_fp, &(lc->entry), lc->cur_checksum_method);
     }
     if (r!=0) {
         toku_log_free_log_entry_resources(&(lc->entry));
@@ -298,7 +300,7 @@ int toku_logcursor_next(TOKULOGCURSOR lc, struct log_entry **le) {
         lc->entry_valid = false;
         if (lc->last_direction == LC_BACKWARD) {
             struct log_entry junk;
-            r = toku_log_fread(lc->cur_fp, &junk);
+            r = toku_log_fread(lc->cur_fp, &junk, lc->cur_checksum_method);
             assert(r == 0);
             toku_log_free_log_entry_resources(&junk);
         }
@@ -324,7 +326,7 @@ int toku_logcursor_prev(TOKULOGCURSOR lc, struct log_entry **le) {
         lc->entry_valid = false;
         if (lc->last_direction == LC_FORWARD) {
             struct log_entry junk;
-            r = toku_log_fread_backward(lc->cur_fp, &junk);
+            r = toku_log_fread_backward(lc->cur_fp, &junk, lc->cur_checksum_method);
             assert(r == 0);
             toku_log_free_log_entry_resources(&junk);
         }
@@ -394,7 +396,7 @@ int toku_logcursor_last(TOKULOGCURSOR lc, struct log_entry **le) {
         // seek to end
         r = fseek(lc->cur_fp, 0, SEEK_END);    assert(r==0);
         // read backward
-        r = toku_log_fread_backward(lc->cur_fp, &(lc->entry));
+        r = toku_log_fread_backward(lc->cur_fp, &(lc->entry), lc->cur_checksum_method);
         if (r==0) // got a good entry
             break;
         if (r>0) { 
@@ -410,7 +412,7 @@ int toku_logcursor_last(TOKULOGCURSOR lc, struct log_entry **le) {
                 return DB_BADFORMAT;
             }
             // try reading again
-            r = toku_log_fread_backward(lc->cur_fp, &(lc->entry));
+            r = toku_log_fread_backward(lc->cur_fp, &(lc->entry), lc->cur_checksum_method);
             if (r==0) // got a good entry
                 break;
         }
@@ -457,7 +459,7 @@ static int lc_fix_bad_logfile(TOKULOGCURSOR lc) {
     r = fseek(lc->cur_fp, 0, SEEK_SET);                
     if ( r!=0 ) 
         return r;
-    r = toku_read_logmagic(lc->cur_fp, &version);      
+    r = toku_read_logmagic(lc->cur_fp, &version, &lc->cur_checksum_method);      
     if ( r!=0 ) 
         return r;
     if (version != TOKU_LOG_VERSION) 
@@ -469,7 +471,7 @@ static int lc_fix_bad_logfile(TOKULOGCURSOR lc) {
         // initialize le 
         //  - reading incomplete entries can result in fields that cannot be freed
         memset(&le, 0, sizeof(le));
-        r = toku_log_fread(lc->cur_fp, &le);
+        r = toku_log_fread(lc->cur_fp, &le, lc->cur_checksum_method);
         toku_log_free_log_entry_resources(&le);
         if ( r!=0 ) 
             break;
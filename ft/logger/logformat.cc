@@ -479,24 +479,25 @@ generate_log_writer (void) {
                         fprintf(cf, "                              +8 // crc + len\n");
                         fprintf(cf, "                     );\n");
                         fprintf(cf, "  struct wbuf wbuf;\n");
+                        fprintf(cf, "  LSN lsn;\n");
                         fprintf(cf, "  ml_lock(&logger->input_lock);\n");
                         fprintf(cf, "  toku_logger_make_space_in_inbuf(logger, buflen);\n");
-                        fprintf(cf, "  wbuf_nocrc_init(&wbuf, logger->inbuf.buf+logger->inbuf.n_in_buf, buflen);\n");
+                        fprintf(cf, "  // only the lsn and the room in the inbuf are handed out under the lock; the entry is written without it\n");
+                        fprintf(cf, "  wbuf_nocrc_init(&wbuf, toku_logger_reserve_in_inbuf(logger, buflen, &lsn), buflen);\n");
+                        fprintf(cf, "  ml_unlock(&logger->input_lock);\n");
                         fprintf(cf, "  wbuf_nocrc_int(&wbuf, buflen);\n");
                         fprintf(cf, "  wbuf_nocrc_char(&wbuf, '%c');\n", (char)(0xff&lt->command_and_flags));
-                        fprintf(cf, "  logger->lsn.lsn++;\n");
-                        fprintf(cf, "  logger->inbuf.max_lsn_in_buf = logger->lsn;\n");
-                        fprintf(cf, "  wbuf_nocrc_LSN(&wbuf, logger->lsn);\n");
-                        fprintf(cf, "  if (lsnp) *lsnp=logger->lsn;\n");
+                        fprintf(cf, "  wbuf_nocrc_LSN(&wbuf, lsn);\n");
+                        fprintf(cf, "  if (lsnp) *lsnp=lsn;\n");
                         DO_FIELDS(field_type, lt,
                                   if (strcmp(field_type->name, "timestamp") == 0)
                                       fprintf(cf, "  if (timestamp == 0) timestamp = toku_get_timestamp();\n");
                                   fprintf(cf, "  wbuf_nocrc_%s(&wbuf, %s);\n", field_type->type, field_type->name));
-                        fprintf(cf, "  wbuf_nocrc_int(&wbuf, toku_x1764_memory(wbuf.buf, wbuf.ndone));\n");
+                        fprintf(cf, "  wbuf_nocrc_int(&wbuf, toku_checksum_memory(logger->checksum_method, wbuf.buf, wbuf.ndone));\n");
                         fprintf(cf, "  wbuf_nocrc_int(&wbuf, buflen);\n");
                         fprintf(cf, "  assert(wbuf.ndone==buflen);\n");
-                        fprintf(cf, "  logger->inbuf.n_in_buf += buflen;\n");
-                        fprintf(cf, "  toku_logger_maybe_fsync(logger, logger->lsn, do_fsync, true);\n");
+                        fprintf(cf, "  toku_logger_fill_reservation_done(logger);\n");
+                        fprintf(cf, "  toku_logger_maybe_fsync(logger, lsn, do_fsync, false);\n");
                         fprintf(cf, "}\n\n");
                     });
 }
@@ -504,7 +505,7 @@ generate_log_writer (void) {
 static void
 generate_log_reader (void) {
     DO_LOGTYPES(lt, {
-                        fprintf(cf, "static int toku_log_fread_%s (FILE *infile, uint32_t len1, struct logtype_%s *data, struct x1764 *checksum)", lt->name, lt->name);
+                        fprintf(cf, "static int toku_log_fread_%s (FILE *infile, uint32_t len1, struct logtype_%s *data, struct toku_checksum *checksum)", lt->name, lt->name);
                         fprintf(cf, " {\n");
                         fprintf(cf, "  int r=0;\n");
                         fprintf(cf, "  uint32_t actual_len=5; // 1 for the command, 4 for the first len.\n");
@@ -514,22 +515,22 @@ generate_log_reader (void) {
                         fprintf(cf, "  uint32_t checksum_in_file, len_in_file;\n");
                         fprintf(cf, "  r=toku_fread_uint32_t_nocrclen(infile, &checksum_in_file); actual_len+=4;   if (r!=0) return r;\n");
                         fprintf(cf, "  r=toku_fread_uint32_t_nocrclen(infile, &len_in_file);    actual_len+=4;   if (r!=0) return r;\n");
-                        fprintf(cf, "  if (checksum_in_file!=toku_x1764_finish(checksum) || len_in_file!=actual_len || len1 != len_in_file) return DB_BADFORMAT;\n");
+                        fprintf(cf, "  if (checksum_in_file!=toku_checksum_finish(checksum) || len_in_file!=actual_len || len1 != len_in_file) return DB_BADFORMAT;\n");
                         fprintf(cf, "  return 0;\n");
                         fprintf(cf, "}\n\n");
                     });
-    fprintf2(cf, hf, "int toku_log_fread (FILE *infile, struct log_entry *le)");
+    fprintf2(cf, hf, "int toku_log_fread (FILE *infile, struct log_entry *le, enum toku_checksum_method checksum_method)");
     fprintf(hf, ";\n");
     fprintf(cf, " {\n");
     fprintf(cf, "  uint32_t len1; int r;\n");
     fprintf(cf, "  uint32_t ignorelen=0;\n");
-    fprintf(cf, "  struct x1764 checksum;\n");
-    fprintf(cf, "  toku_x1764_init(&checksum);\n");
+    fprintf(cf, "  struct toku_checksum checksum;\n");
+    fprintf(cf, "  toku_checksum_init(&checksum, checksum_method);\n");
     fprintf(cf, "  r = toku_fread_uint32_t(infile, &len1, &checksum, &ignorelen); if (r!=0) return r;\n");
     fprintf(cf, "  int cmd=fgetc(infile);\n");
     fprintf(cf, "  if (cmd==EOF) return EOF;\n");
     fprintf(cf, "  char cmdchar = (char)cmd;\n");
-    fprintf(cf, "  toku_x1764_add(&checksum, &cmdchar, 1);\n");
+    fprintf(cf, "  toku_checksum_add(&checksum, &cmdchar, 1);\n");
     fprintf(cf, "  le->cmd=(enum lt_cmd)cmd;\n");
     fprintf(cf, "  switch ((enum lt_cmd)cmd) {\n");
     DO_LOGTYPES(lt, {
@@ -541,7 +542,7 @@ generate_log_reader (void) {
     fprintf(cf, "}\n\n");
     //fprintf2(cf, hf, "// Return 0 if there is something to read, return -1 if nothing to read, abort if an error.\n");
     fprintf2(cf, hf, "// Return 0 if there is something to read, -1 if nothing to read, >0 on error\n");
-    fprintf2(cf, hf, "int toku_log_fread_backward (FILE *infile, struct log_entry *le)");
+    fprintf2(cf, hf, "int toku_log_fread_backward (FILE *infile, struct log_entry *le, enum toku_checksum_method checksum_method)");
     fprintf(hf, ";\n");
     fprintf(cf, "{\n");
     fprintf(cf, "  memset(le, 0, sizeof(*le));\n");
@@ -554,7 +555,7 @@ generate_log_reader (void) {
     fprintf(cf, "  if (r!=0) return 1;\n");
     fprintf(cf, "  r = fseek(infile, -(int)len, SEEK_CUR) ;  \n");//         assert(r==0);\n");
     fprintf(cf, "  if (r!=0) return get_error_errno();\n");
-    fprintf(cf, "  r = toku_log_fread(infile, le); \n");//                   assert(r==0);\n");
+    fprintf(cf, "  r = toku_log_fread(infile, le, checksum_method); \n");//                   assert(r==0);\n");
     fprintf(cf, "  if (r!=0) return 1;\n");
     fprintf(cf, "  long afterpos = ftell(infile);\n");
     fprintf(cf, "  if (afterpos != pos) return 1;\n");
@@ -588,21 +589,21 @@ generate_log_reader (void) {
 static void
 generate_logprint (void) {
     unsigned maxnamelen=0;
-    fprintf2(pf, hf, "int toku_logprint_one_record(FILE *outf, FILE *f)");
+    fprintf2(pf, hf, "int toku_logprint_one_record(FILE *outf, FILE *f, enum toku_checksum_method checksum_method)");
     fprintf(hf, ";\n");
     fprintf(pf, " {\n");
     fprintf(pf, "    int cmd, r;\n");
     fprintf(pf, "    uint32_t len1, crc_in_file;\n");
     fprintf(pf, "    uint32_t ignorelen=0;\n");
-    fprintf(pf, "    struct x1764 checksum;\n");
-    fprintf(pf, "    toku_x1764_init(&checksum);\n");
+    fprintf(pf, "    struct toku_checksum checksum;\n");
+    fprintf(pf, "    toku_checksum_init(&checksum, checksum_method);\n");
     fprintf(pf, "    r=toku_fread_uint32_t(f, &len1, &checksum, &ignorelen);\n");
     fprintf(pf, "    if (r==EOF) return EOF;\n");
     fprintf(pf, "    cmd=fgetc(f);\n");
     fprintf(pf, "    if (cmd==EOF) return DB_BADFORMAT;\n");
     fprintf(pf, "    uint32_t len_in_file, len=1+4; // cmd + len1\n");
     fprintf(pf, "    char charcmd = (char)cmd;\n");
-    fprintf(pf, "    toku_x1764_add(&checksum, &charcmd, 1);\n");
+    fprintf(pf, "    toku_checksum_add(&checksum, &charcmd, 1);\n");
     fprintf(pf, "    switch ((enum lt_cmd)cmd) {\n");
     DO_LOGTYPES(lt, { if (strlen(lt->name)>maxnamelen) maxnamelen=strlen(lt->name); });
     DO_LOGTYPES(lt, {
@@ -620,7 +621,7 @@ generate_logprint (void) {
                             fprintf(pf, "); if (r!=0) return r;\n");
                         });
                 fprintf(pf, "        {\n");
-                fprintf(pf, "          uint32_t actual_murmur = toku_x1764_finish(&checksum);\n");
+                fprintf(pf, "          uint32_t actual_murmur = toku_checksum_finish(&checksum);\n");
                 fprintf(pf, "          r = toku_fread_uint32_t_nocrclen (f, &crc_in_file); len+=4; if (r!=0) return r;\n");
                 fprintf(pf, "          fprintf(outf, \" crc=%%08x\", crc_in_file);\n");
                 fprintf(pf, "          if (crc_in_file!=actual_murmur) fprintf(outf, \" checksum=%%08x\", actual_murmur);\n");
@@ -40,6 +40,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include <ctype.h>
 #include <limits.h>
 #include <unistd.h>
+#include <sys/time.h>
 
 #include "ft/serialize/block_table.h"
 #include "ft/ft.h"
@@ -58,8 +59,30 @@ static const int log_format_version = TOKU_LOG_VERSION;
 
 toku_instr_key *result_output_condition_lock_mutex_key;
 toku_instr_key *result_output_condition_key;
+toku_instr_key *log_flusher_thread_key;
+toku_instr_key *log_flusher_condition_key;
 toku_instr_key *tokudb_file_log_key;
 
+// The magic at the start of a log file names the checksum of its entries.
+// Log files written before layout version 30 always use x1764.
+static const char log_magic_x1764[8] = { 't', 'o', 'k', 'u', 'l', 'o', 'g', 'g' };
+static const char log_magic_crc32c[8] = { 't', 'o', 'k', 'u', 'l', 'o', 'g', 'c' };
+
+static const char *log_magic(enum toku_checksum_method checksum_method) {
+    return checksum_method == TOKU_CHECKSUM_CRC32C ? log_magic_crc32c : log_magic_x1764;
+}
+
+static int log_magic_checksum_method(const char *magic, enum toku_checksum_method *checksum_methodp) {
+    if (memcmp(magic, log_magic_x1764, 8)==0) {
+        *checksum_methodp = TOKU_CHECKSUM_X1764;
+    } else if (memcmp(magic, log_magic_crc32c, 8)==0) {
+        *checksum_methodp = TOKU_CHECKSUM_CRC32C;
+    } else {
+        return DB_BADFORMAT;
+    }
+    return 0;
+}
+
 static int open_logfile(TOKULOGGER logger);
 static void logger_write_buffer(TOKULOGGER logger, LSN *fsynced_lsn);
 static void delete_logfile(TOKULOGGER logger,
@@ -67,6 +90,8 @@ static void delete_logfile(TOKULOGGER logger,
                            uint32_t version);
 static void grab_output(TOKULOGGER logger, LSN *fsynced_lsn);
 static void release_output(TOKULOGGER logger, LSN fsynced_lsn);
+static void start_flusher(TOKULOGGER logger);
+static void stop_flusher(TOKULOGGER logger);
 
 static void toku_print_bytes (FILE *outf, uint32_t len, char *data) {
     fprintf(outf, "\"");
@@ -132,11 +157,13 @@ int toku_logger_create (TOKULOGGER *resultp) {
     // fd is uninitialized on purpose
     // ct is uninitialized on purpose
     result->lg_max = 100<<20; // 100MB default
+    result->checksum_method = TOKU_CHECKSUM_X1764;
     // lsn is uninitialized
     result->inbuf  = (struct logbuf) {0, LOGGER_MIN_BUF_SIZE, (char *) toku_xmalloc(LOGGER_MIN_BUF_SIZE), ZERO_LSN};
     result->outbuf = (struct logbuf) {0, LOGGER_MIN_BUF_SIZE, (char *) toku_xmalloc(LOGGER_MIN_BUF_SIZE), ZERO_LSN};
     // written_lsn is uninitialized
     // fsynced_lsn is uninitialized
+    result->num_unfilled_reservations = 0;
     result->last_completed_checkpoint_lsn = ZERO_LSN;
     // next_log_file_number is uninitialized
     // n_in_file is uninitialized
@@ -151,6 +178,13 @@ int toku_logger_create (TOKULOGGER *resultp) {
         *result_output_condition_key, &result->output_condition, nullptr);
     result->rollback_cachefile = NULL;
     result->output_is_available = true;
+    toku_cond_init(*log_flusher_condition_key, &result->flusher_condition, nullptr);
+    result->flusher_is_running = false;
+    result->flusher_should_stop = false;
+    result->flush_requested_lsn = ZERO_LSN;
+    result->num_flush_waiters = 0;
+    result->group_commit_max_delay_usec = 0;
+    result->group_commit_min_batch = 1;
     toku_txn_manager_init(&result->txn_manager);
     return 0;
 }
@@ -216,6 +250,7 @@ toku_logger_open_with_last_xid(const char *directory, TOKULOGGER logger, TXNID l
     }
     toku_txn_manager_set_last_xid_from_logger(logger->txn_manager, last_xid);
 
+    start_flusher(logger);
     logger->is_open = true;
     return 0;
 }
@@ -311,6 +346,7 @@ int toku_logger_close(TOKULOGGER *loggerp) {
     if (!logger->is_open) {
         goto is_closed;
     }
+    stop_flusher(logger);
     ml_lock(&logger->input_lock);
     LSN fsynced_lsn;
     grab_output(logger, &fsynced_lsn);
@@ -334,6 +370,7 @@ is_closed:
     ml_destroy(&logger->input_lock);
     toku_mutex_destroy(&logger->output_condition_lock);
     toku_cond_destroy(&logger->output_condition);
+    toku_cond_destroy(&logger->flusher_condition);
     toku_txn_manager_destroy(logger->txn_manager);
     if (logger->directory) toku_free(logger->directory);
     toku_logfilemgr_destroy(&logger->logfilemgr);
@@ -458,11 +495,45 @@ release_output (TOKULOGGER logger, LSN fsynced_lsn)
     toku_mutex_unlock(&logger->output_condition_lock);
 }
 
+static void
+wait_for_reservations_to_be_filled (TOKULOGGER logger)
+// Effect: Wait until every log entry reserved in the inbuf has been written.
+//  No new reservations can be made while we hold the input lock, and filling one takes no lock.
+// Entry and exit: Holds the input lock.
+{
+    while (__atomic_load_n(&logger->num_unfilled_reservations, __ATOMIC_ACQUIRE) != 0) {
+        toku_pthread_yield();
+    }
+}
+
+char *
+toku_logger_reserve_in_inbuf (TOKULOGGER logger, int n_bytes, LSN *lsnp)
+// See logger.h for the specification of this function.
+{
+    assert(logger->inbuf.n_in_buf + n_bytes <= logger->inbuf.buf_size);
+    char *result = logger->inbuf.buf + logger->inbuf.n_in_buf;
+    logger->inbuf.n_in_buf += n_bytes;
+    logger->lsn.lsn++;
+    logger->inbuf.max_lsn_in_buf = logger->lsn;
+    *lsnp = logger->lsn;
+    toku_sync_fetch_and_add(&logger->num_unfilled_reservations, 1);
+    return result;
+}
+
+void
+toku_logger_fill_reservation_done (TOKULOGGER logger)
+// See logger.h for the specification of this function.
+{
+    uint32_t old = toku_sync_fetch_and_sub(&logger->num_unfilled_reservations, 1);
+    paranoid_invariant(old > 0);
+}
+
 static void
 swap_inbuf_outbuf (TOKULOGGER logger)
 // Effect: Swap the inbuf and outbuf
 // Entry and exit: Hold the input lock and permission to modify output.
 {
+    wait_for_reservations_to_be_filled(logger);
     struct logbuf tmp = logger->inbuf;
     logger->inbuf = logger->outbuf;
     logger->outbuf = tmp;
@@ -589,6 +660,35 @@ int toku_logger_set_lg_bsize(TOKULOGGER logger, uint32_t bsize) {
     return 0;
 }
 
+// Log entries are checksummed as they are put in the input buffer, so the
+// method cannot change once the logger is open.
+int toku_logger_set_checksum_method(TOKULOGGER logger, enum toku_checksum_method checksum_method) {
+    if (logger==0) return EINVAL; // no logger
+    if (logger->is_open) return EINVAL;
+    if (!toku_checksum_method_is_valid(checksum_method)) return EINVAL;
+    logger->checksum_method = checksum_method;
+    return 0;
+}
+
+void toku_logger_set_group_commit_policy(TOKULOGGER logger, uint32_t max_delay_usec, uint32_t min_batch) {
+    toku_mutex_lock(&logger->output_condition_lock);
+    logger->group_commit_max_delay_usec = max_delay_usec;
+    logger->group_commit_min_batch = min_batch > 0 ? min_batch : 1;
+    toku_cond_signal(&logger->flusher_condition);
+    toku_mutex_unlock(&logger->output_condition_lock);
+}
+
+void toku_logger_get_group_commit_policy(TOKULOGGER logger, uint32_t *max_delay_usec, uint32_t *min_batch) {
+    toku_mutex_lock(&logger->output_condition_lock);
+    *max_delay_usec = logger->group_commit_max_delay_usec;
+    *min_batch = logger->group_commit_min_batch;
+    toku_mutex_unlock(&logger->output_condition_lock);
+}
+
+enum toku_checksum_method toku_logger_get_checksum_method(TOKULOGGER logger) {
+    return logger->checksum_method;
+}
+
 int toku_logger_find_next_unused_log_file(const char *directory, long long *result)
 // This is called during logger initialalization, and no locks are required.
 {
@@ -722,7 +822,7 @@ static int open_logfile (TOKULOGGER logger)
             return get_error_errno();
         }
     }
-    toku_os_full_write(logger->fd, "tokulogg", 8);
+    toku_os_full_write(logger->fd, log_magic(logger->checksum_method), 8);
     int version_l = toku_htonl(log_format_version); //version MUST be in network byte order regardless of disk order
     toku_os_full_write(logger->fd, &version_l, 4);
     if ( logger->write_log_files ) {
@@ -796,43 +896,179 @@ bool toku_logger_txns_exist(TOKULOGGER logger)
 }
 
 
-void toku_logger_maybe_fsync(TOKULOGGER logger, LSN lsn, int do_fsync, bool holds_input_lock)
-// Effect: If fsync is nonzero, then make sure that the log is flushed and synced at least up to lsn.
-// Entry: Holds input lock iff 'holds_input_lock'.  The log entry has already been written to the input buffer.
+static void
+write_and_fsync_log (TOKULOGGER logger, LSN lsn)
+// Effect: Make sure that the log is flushed and synced at least up to lsn.
+//  Everything in the inbuf goes out with it, so whoever else is waiting on a lower lsn is done too.
+// Entry: Holds no locks.
 // Exit:  Holds no locks.
-// The input lock may be released and then reacquired.  Thus this function does not run atomically with respect to other threads.
 {
-    if (holds_input_lock) {
-        ml_unlock(&logger->input_lock);
+    // reacquire the locks (acquire output permission first)
+    LSN  fsynced_lsn;
+    bool already_done = wait_till_output_already_written_or_output_buffer_available(logger, lsn, &fsynced_lsn);
+    if (already_done) {
+        return;
     }
-    if (do_fsync) {
-        // reacquire the locks (acquire output permission first)
-        LSN  fsynced_lsn;
-        bool already_done = wait_till_output_already_written_or_output_buffer_available(logger, lsn, &fsynced_lsn);
-        if (already_done) {
-            return;
+
+    // otherwise we now own the output permission, and our lsn isn't outputed.
+
+    ml_lock(&logger->input_lock);
+
+    swap_inbuf_outbuf(logger);
+
+    ml_unlock(&logger->input_lock); // release the input lock now, so other threads can fill the inbuf.  (Thus enabling group commit.)
+
+    write_outbuf_to_logfile(logger, &fsynced_lsn);
+    if (fsynced_lsn.lsn < lsn.lsn) {
+        // it may have gotten fsynced by the write_outbuf_to_logfile.
+        toku_file_fsync_without_accounting(logger->fd);
+        assert(fsynced_lsn.lsn <= logger->written_lsn.lsn);
+        fsynced_lsn = logger->written_lsn;
+    }
+    // the last lsn is only accessed while holding output permission or else when the log file is old.
+    if (logger->write_log_files) {
+        toku_logfilemgr_update_last_lsn(logger->logfilemgr, logger->written_lsn);
+    }
+    release_output(logger, fsynced_lsn);
+}
+
+// ***********************************************************
+// group commit
+// ***********************************************************
+//
+// While the logger is open a flusher thread does the writing and fsyncing that committers ask
+// for, so that no committer inherits the latency of someone else's fsync while holding the
+// output permission.  A committer raises flush_requested_lsn, signals the flusher and waits on
+// the output condition until fsynced_lsn reaches its lsn (release_output broadcasts it).  The
+// flusher takes everyone who asked as one batch, optionally lingering up to
+// group_commit_max_delay_usec for group_commit_min_batch committers to show up first.
+
+static bool
+flush_is_requested (TOKULOGGER logger)
+// Entry and exit: Holds the output_condition_lock.
+{
+    return logger->flush_requested_lsn.lsn > logger->fsynced_lsn.lsn;
+}
+
+static void
+flusher_wait_for_batch (TOKULOGGER logger)
+// Effect: Give more committers a chance to join the batch, within the group commit policy.
+// Entry and exit: Holds the output_condition_lock.
+{
+    if (logger->group_commit_max_delay_usec == 0) {
+        return;
+    }
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    uint64_t deadline_usec = (uint64_t) tv.tv_usec + logger->group_commit_max_delay_usec;
+    toku_timespec_t wakeup_at;
+    wakeup_at.tv_sec = tv.tv_sec + deadline_usec / 1000000;
+    wakeup_at.tv_nsec = (deadline_usec % 1000000) * 1000;
+    while (!logger->flusher_should_stop && logger->num_flush_waiters < logger->group_commit_min_batch) {
+        int r = toku_cond_timedwait(&logger->flusher_condition, &logger->output_condition_lock, &wakeup_at);
+        if (r == ETIMEDOUT) {
+            break;
         }
+        assert_zero(r);
+    }
+}
 
-        // otherwise we now own the output permission, and our lsn isn't outputed.
+static void *
+flusher_thread (void *arg)
+{
+    TOKULOGGER CAST_FROM_VOIDP(logger, arg);
+    toku_mutex_lock(&logger->output_condition_lock);
+    while (true) {
+        while (!logger->flusher_should_stop && !flush_is_requested(logger)) {
+            toku_cond_wait(&logger->flusher_condition, &logger->output_condition_lock);
+        }
+        if (!flush_is_requested(logger)) {
+            // asked to stop, and nobody is waiting
+            break;
+        }
+        flusher_wait_for_batch(logger);
+        LSN lsn = logger->flush_requested_lsn;
+        uint32_t batch = logger->num_flush_waiters;
+        logger->num_flush_waiters = 0;
+        toku_mutex_unlock(&logger->output_condition_lock);
 
-        ml_lock(&logger->input_lock);
+        write_and_fsync_log(logger, lsn);
 
-        swap_inbuf_outbuf(logger);
+        toku_mutex_lock(&logger->output_condition_lock);
+        logger->num_group_commits++;
+        logger->num_group_committed_waiters += batch;
+    }
+    toku_mutex_unlock(&logger->output_condition_lock);
+    toku_instr_delete_current_thread();
+    return toku_pthread_done(nullptr);
+}
 
-        ml_unlock(&logger->input_lock); // release the input lock now, so other threads can fill the inbuf.  (Thus enabling group commit.)
+static void
+start_flusher (TOKULOGGER logger)
+// Entry: The logger is being opened, so there are no other threads.
+{
+    logger->flusher_should_stop = false;
+    logger->flush_requested_lsn = logger->fsynced_lsn;
+    logger->num_flush_waiters = 0;
+    int r = toku_pthread_create(*log_flusher_thread_key, &logger->flusher_thread, nullptr, flusher_thread, logger);
+    // Without a flusher, committers fsync for themselves.
+    logger->flusher_is_running = (r == 0);
+}
 
-        write_outbuf_to_logfile(logger, &fsynced_lsn);
-        if (fsynced_lsn.lsn < lsn.lsn) {
-            // it may have gotten fsynced by the write_outbuf_to_logfile.
-            toku_file_fsync_without_accounting(logger->fd);
-            assert(fsynced_lsn.lsn <= logger->written_lsn.lsn);
-            fsynced_lsn = logger->written_lsn;
+static void
+stop_flusher (TOKULOGGER logger)
+// Effect: Stop the flusher once it has satisfied every committer that asked.
+// Entry and exit: Holds no locks.
+{
+    toku_mutex_lock(&logger->output_condition_lock);
+    bool was_running = logger->flusher_is_running;
+    logger->flusher_should_stop = true;
+    toku_cond_signal(&logger->flusher_condition);
+    toku_mutex_unlock(&logger->output_condition_lock);
+    if (was_running) {
+        int r = toku_pthread_join(logger->flusher_thread, nullptr);
+        assert_zero(r);
+        toku_mutex_lock(&logger->output_condition_lock);
+        logger->flusher_is_running = false;
+        toku_mutex_unlock(&logger->output_condition_lock);
+    }
+}
+
+static bool
+wait_for_group_commit (TOKULOGGER logger, LSN lsn)
+// Effect: Have the flusher fsync the log up to lsn and wait until it has.
+//  Return false (without waiting) if there is no flusher.
+// Entry and exit: Holds no locks.
+{
+    toku_mutex_lock(&logger->output_condition_lock);
+    bool running = logger->flusher_is_running && !logger->flusher_should_stop;
+    if (running && logger->fsynced_lsn.lsn < lsn.lsn) {
+        if (logger->flush_requested_lsn.lsn < lsn.lsn) {
+            logger->flush_requested_lsn = lsn;
         }
-        // the last lsn is only accessed while holding output permission or else when the log file is old.
-        if (logger->write_log_files) {
-            toku_logfilemgr_update_last_lsn(logger->logfilemgr, logger->written_lsn);
+        logger->num_flush_waiters++;
+        toku_cond_signal(&logger->flusher_condition);
+        while (logger->fsynced_lsn.lsn < lsn.lsn) {
+            toku_cond_wait(&logger->output_condition, &logger->output_condition_lock);
+        }
+    }
+    toku_mutex_unlock(&logger->output_condition_lock);
+    return running;
+}
+
+void toku_logger_maybe_fsync(TOKULOGGER logger, LSN lsn, int do_fsync, bool holds_input_lock)
+// Effect: If fsync is nonzero, then make sure that the log is flushed and synced at least up to lsn.
+// Entry: Holds input lock iff 'holds_input_lock'.  The log entry has already been written to the input buffer.
+// Exit:  Holds no locks.
+// The input lock may be released and then reacquired.  Thus this function does not run atomically with respect to other threads.
+{
+    if (holds_input_lock) {
+        ml_unlock(&logger->input_lock);
+    }
+    if (do_fsync) {
+        if (!wait_for_group_commit(logger, lsn)) {
+            write_and_fsync_log(logger, lsn);
         }
-        release_output(logger, fsynced_lsn);
     }
 }
 
@@ -872,7 +1108,7 @@ int toku_logger_restart(TOKULOGGER logger, LSN lastlsn)
     logger->fd = -1;
 
     // reset the LSN's to the lastlsn when the logger was opened
-    logger->lsn = logger->written_lsn = logger->fsynced_lsn = lastlsn;
+    logger->lsn = logger->written_lsn = logger->fsynced_lsn = logger->flush_requested_lsn = lastlsn;
     logger->write_log_files = true;
     logger->trim_log_files = true;
 
@@ -923,11 +1159,11 @@ static int toku_fread_uint8_t_nocrclen (FILE *f, uint8_t *v) {
     return 0;
 }
 
-int toku_fread_uint8_t (FILE *f, uint8_t *v, struct x1764 *mm, uint32_t *len) {
+int toku_fread_uint8_t (FILE *f, uint8_t *v, struct toku_checksum *mm, uint32_t *len) {
     int vi=fgetc(f);
     if (vi==EOF) return -1;
     uint8_t vc=(uint8_t)vi;
-    toku_x1764_add(mm, &vc, 1);
+    toku_checksum_add(mm, &vc, 1);
     (*len)++;
     *v = vc;
     return 0;
@@ -945,7 +1181,7 @@ int toku_fread_uint32_t_nocrclen (FILE *f, uint32_t *v) {
 
     return 0;
 }
-int toku_fread_uint32_t (FILE *f, uint32_t *v, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_uint32_t (FILE *f, uint32_t *v, struct toku_checksum *checksum, uint32_t *len) {
     uint32_t result;
     uint8_t *cp = (uint8_t*)&result;
     int r;
@@ -957,7 +1193,7 @@ int toku_fread_uint32_t (FILE *f, uint32_t *v, struct x1764 *checksum, uint32_t
     return 0;
 }
 
-int toku_fread_uint64_t (FILE *f, uint64_t *v, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_uint64_t (FILE *f, uint64_t *v, struct toku_checksum *checksum, uint32_t *len) {
     uint32_t v1,v2;
     int r;
     r=toku_fread_uint32_t(f, &v1, checksum, len);    if (r!=0) return r;
@@ -966,7 +1202,7 @@ int toku_fread_uint64_t (FILE *f, uint64_t *v, struct x1764 *checksum, uint32_t
     return 0;
 }
 
-int toku_fread_bool (FILE *f, bool *v, struct x1764 *mm, uint32_t *len) {
+int toku_fread_bool (FILE *f, bool *v, struct toku_checksum *mm, uint32_t *len) {
     uint8_t iv;
     int r = toku_fread_uint8_t(f, &iv, mm, len);
     if (r == 0) {
@@ -975,23 +1211,23 @@ int toku_fread_bool (FILE *f, bool *v, struct x1764 *mm, uint32_t *len) {
     return r;
 }
 
-int toku_fread_LSN     (FILE *f, LSN *lsn, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_LSN     (FILE *f, LSN *lsn, struct toku_checksum *checksum, uint32_t *len) {
     return toku_fread_uint64_t (f, &lsn->lsn, checksum, len);
 }
 
-int toku_fread_BLOCKNUM (FILE *f, BLOCKNUM *b, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_BLOCKNUM (FILE *f, BLOCKNUM *b, struct toku_checksum *checksum, uint32_t *len) {
     return toku_fread_uint64_t (f, (uint64_t*)&b->b, checksum, len);
 }
 
-int toku_fread_FILENUM (FILE *f, FILENUM *filenum, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_FILENUM (FILE *f, FILENUM *filenum, struct toku_checksum *checksum, uint32_t *len) {
     return toku_fread_uint32_t (f, &filenum->fileid, checksum, len);
 }
 
-int toku_fread_TXNID   (FILE *f, TXNID *txnid, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_TXNID   (FILE *f, TXNID *txnid, struct toku_checksum *checksum, uint32_t *len) {
     return toku_fread_uint64_t (f, txnid, checksum, len);
 }
 
-int toku_fread_TXNID_PAIR   (FILE *f, TXNID_PAIR *txnid, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_TXNID_PAIR   (FILE *f, TXNID_PAIR *txnid, struct toku_checksum *checksum, uint32_t *len) {
     TXNID parent;
     TXNID child;
     int r;
@@ -1003,7 +1239,7 @@ int toku_fread_TXNID_PAIR   (FILE *f, TXNID_PAIR *txnid, struct x1764 *checksum,
 }
 
 
-int toku_fread_XIDP    (FILE *f, XIDP *xidp, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_XIDP    (FILE *f, XIDP *xidp, struct toku_checksum *checksum, uint32_t *len) {
     // These reads are verbose because XA defined the fields as "long", but we use 4 bytes, 1 byte and 1 byte respectively.
     TOKU_XA_XID *XMALLOC(xid);
     {
@@ -1035,7 +1271,7 @@ int toku_fread_XIDP    (FILE *f, XIDP *xidp, struct x1764 *checksum, uint32_t *l
 }
 
 // fills in the bs with malloced data.
-int toku_fread_BYTESTRING (FILE *f, BYTESTRING *bs, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_BYTESTRING (FILE *f, BYTESTRING *bs, struct toku_checksum *checksum, uint32_t *len) {
     int r=toku_fread_uint32_t(f, (uint32_t*)&bs->len, checksum, len);
     if (r!=0) return r;
     XMALLOC_N(bs->len, bs->data);
@@ -1052,7 +1288,7 @@ int toku_fread_BYTESTRING (FILE *f, BYTESTRING *bs, struct x1764 *checksum, uint
 }
 
 // fills in the fs with malloced data.
-int toku_fread_FILENUMS (FILE *f, FILENUMS *fs, struct x1764 *checksum, uint32_t *len) {
+int toku_fread_FILENUMS (FILE *f, FILENUMS *fs, struct toku_checksum *checksum, uint32_t *len) {
     int r=toku_fread_uint32_t(f, (uint32_t*)&fs->num, checksum, len);
     if (r!=0) return r;
     XMALLOC_N(fs->num, fs->filenums);
@@ -1068,7 +1304,7 @@ int toku_fread_FILENUMS (FILE *f, FILENUMS *fs, struct x1764 *checksum, uint32_t
     return 0;
 }
 
-int toku_logprint_LSN (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
+int toku_logprint_LSN (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
     LSN v;
     int r = toku_fread_LSN(inf, &v, checksum, len);
     if (r!=0) return r;
@@ -1076,7 +1312,7 @@ int toku_logprint_LSN (FILE *outf, FILE *inf, const char *fieldname, struct x176
     return 0;
 }
 
-int toku_logprint_TXNID (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
+int toku_logprint_TXNID (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
     TXNID v;
     int r = toku_fread_TXNID(inf, &v, checksum, len);
     if (r!=0) return r;
@@ -1084,7 +1320,7 @@ int toku_logprint_TXNID (FILE *outf, FILE *inf, const char *fieldname, struct x1
     return 0;
 }
 
-int toku_logprint_TXNID_PAIR (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
+int toku_logprint_TXNID_PAIR (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
     TXNID_PAIR v;
     int r = toku_fread_TXNID_PAIR(inf, &v, checksum, len);
     if (r!=0) return r;
@@ -1092,7 +1328,7 @@ int toku_logprint_TXNID_PAIR (FILE *outf, FILE *inf, const char *fieldname, stru
     return 0;
 }
 
-int toku_logprint_XIDP (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
+int toku_logprint_XIDP (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
     XIDP vp;
     int r = toku_fread_XIDP(inf, &vp, checksum, len);
     if (r!=0) return r;
@@ -1103,7 +1339,7 @@ int toku_logprint_XIDP (FILE *outf, FILE *inf, const char *fieldname, struct x17
     return 0;
 }
 
-int toku_logprint_uint8_t (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format) {
+int toku_logprint_uint8_t (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format) {
     uint8_t v;
     int r = toku_fread_uint8_t(inf, &v, checksum, len);
     if (r!=0) return r;
@@ -1115,7 +1351,7 @@ int toku_logprint_uint8_t (FILE *outf, FILE *inf, const char *fieldname, struct
     return 0;
 }
 
-int toku_logprint_uint32_t (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format) {
+int toku_logprint_uint32_t (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format) {
     uint32_t v;
     int r = toku_fread_uint32_t(inf, &v, checksum, len);
     if (r!=0) return r;
@@ -1124,7 +1360,7 @@ int toku_logprint_uint32_t (FILE *outf, FILE *inf, const char *fieldname, struct
     return 0;
 }
 
-int toku_logprint_uint64_t (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format) {
+int toku_logprint_uint64_t (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format) {
     uint64_t v;
     int r = toku_fread_uint64_t(inf, &v, checksum, len);
     if (r!=0) return r;
@@ -1133,7 +1369,7 @@ int toku_logprint_uint64_t (FILE *outf, FILE *inf, const char *fieldname, struct
     return 0;
 }
 
-int toku_logprint_bool (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
+int toku_logprint_bool (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
     bool v;
     int r = toku_fread_bool(inf, &v, checksum, len);
     if (r!=0) return r;
@@ -1149,7 +1385,7 @@ void toku_print_BYTESTRING (FILE *outf, uint32_t len, char *data) {
 
 }
 
-int toku_logprint_BYTESTRING (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
+int toku_logprint_BYTESTRING (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
     BYTESTRING bs;
     int r = toku_fread_BYTESTRING(inf, &bs, checksum, len);
     if (r!=0) return r;
@@ -1159,12 +1395,12 @@ int toku_logprint_BYTESTRING (FILE *outf, FILE *inf, const char *fieldname, stru
     return 0;
 }
 
-int toku_logprint_BLOCKNUM (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format) {
+int toku_logprint_BLOCKNUM (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format) {
     return toku_logprint_uint64_t(outf, inf, fieldname, checksum, len, format);
 
 }
 
-int toku_logprint_FILENUM (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format) {
+int toku_logprint_FILENUM (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format) {
     return toku_logprint_uint32_t(outf, inf, fieldname, checksum, len, format);
 
 }
@@ -1182,7 +1418,7 @@ toku_print_FILENUMS (FILE *outf, uint32_t num, FILENUM *filenums) {
 
 }
 
-int toku_logprint_FILENUMS (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
+int toku_logprint_FILENUMS (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__))) {
     FILENUMS bs;
     int r = toku_fread_FILENUMS(inf, &bs, checksum, len);
     if (r!=0) return r;
@@ -1192,15 +1428,16 @@ int toku_logprint_FILENUMS (FILE *outf, FILE *inf, const char *fieldname, struct
     return 0;
 }
 
-int toku_read_and_print_logmagic (FILE *f, uint32_t *versionp) {
+int toku_read_and_print_logmagic (FILE *f, uint32_t *versionp, enum toku_checksum_method *checksum_methodp) {
     {
         char magic[8];
         int r=fread(magic, 1, 8, f);
         if (r!=8) {
             return DB_BADFORMAT;
         }
-        if (memcmp(magic, "tokulogg", 8)!=0) {
-            return DB_BADFORMAT;
+        r = log_magic_checksum_method(magic, checksum_methodp);
+        if (r!=0) {
+            return r;
         }
     }
     {
@@ -1209,22 +1446,23 @@ int toku_read_and_print_logmagic (FILE *f, uint32_t *versionp) {
         if (r!=4) {
             return DB_BADFORMAT;
         }
-        printf("tokulog v.%u\n", toku_ntohl(version));
+        printf("tokulog v.%u%s\n", toku_ntohl(version), *checksum_methodp == TOKU_CHECKSUM_CRC32C ? " crc32c" : "");
         //version MUST be in network order regardless of disk order
         *versionp=toku_ntohl(version);
     }
     return 0;
 }
 
-int toku_read_logmagic (FILE *f, uint32_t *versionp) {
+int toku_read_logmagic (FILE *f, uint32_t *versionp, enum toku_checksum_method *checksum_methodp) {
     {
         char magic[8];
         int r=fread(magic, 1, 8, f);
         if (r!=8) {
             return DB_BADFORMAT;
         }
-        if (memcmp(magic, "tokulogg", 8)!=0) {
-            return DB_BADFORMAT;
+        r = log_magic_checksum_method(magic, checksum_methodp);
+        if (r!=0) {
+            return r;
         }
     }
     {
@@ -1387,6 +1625,8 @@ toku_logger_get_status(TOKULOGGER logger, LOGGER_STATUS statp) {
         LOG_STATUS_VAL(LOGGER_UNCOMPRESSED_BYTES_WRITTEN)  = logger->bytes_written_to_disk;
         LOG_STATUS_VAL(LOGGER_TOKUTIME_WRITES) = logger->time_spent_writing_to_disk;
         LOG_STATUS_VAL(LOGGER_WAIT_BUF_LONG) = logger->num_wait_buf_long;
+        LOG_STATUS_VAL(LOGGER_NUM_GROUP_COMMITS) = logger->num_group_commits;
+        LOG_STATUS_VAL(LOGGER_GROUP_COMMIT_WAITERS) = logger->num_group_committed_waiters;
     }
     *statp = log_status;
 }
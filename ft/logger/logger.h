@@ -41,6 +41,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/serialize/block_table.h"
 #include "ft/serialize/ft_layout_version.h"
 #include "ft/txn/txn.h"
+#include "util/checksum.h"
 
 typedef struct tokulogger *TOKULOGGER;
 
@@ -55,6 +56,7 @@ enum {
     TOKU_LOG_VERSION_27 = 27, // no change from 26
     TOKU_LOG_VERSION_28 = 28, // no change from 27
     TOKU_LOG_VERSION_29 = 29, // no change from 28
+    TOKU_LOG_VERSION_30 = 30, // log file magic selects the checksum of the entries
     TOKU_LOG_VERSION   = FT_LAYOUT_VERSION, 
     TOKU_LOG_MIN_SUPPORTED_VERSION = FT_LAYOUT_MIN_SUPPORTED_VERSION,
 };
@@ -77,6 +79,10 @@ void toku_logger_set_cachetable (TOKULOGGER logger, struct cachetable *ct);
 int toku_logger_set_lg_max(TOKULOGGER logger, uint32_t lg_max);
 int toku_logger_get_lg_max(TOKULOGGER logger, uint32_t *lg_maxp);
 int toku_logger_set_lg_bsize(TOKULOGGER logger, uint32_t bsize);
+int toku_logger_set_checksum_method(TOKULOGGER logger, enum toku_checksum_method checksum_method);
+enum toku_checksum_method toku_logger_get_checksum_method(TOKULOGGER logger);
+void toku_logger_set_group_commit_policy(TOKULOGGER logger, uint32_t max_delay_usec, uint32_t min_batch);
+void toku_logger_get_group_commit_policy(TOKULOGGER logger, uint32_t *max_delay_usec, uint32_t *min_batch);
 
 void toku_logger_write_log_files (TOKULOGGER logger, bool write_log_files);
 void toku_logger_trim_log_files(TOKULOGGER logger, bool trim_log_files);
@@ -112,35 +118,35 @@ void toku_logger_log_fopen(TOKUTXN txn, const char * fname, FILENUM filenum, uin
 // the log generation code requires a typedef if we want to pass by pointer
 typedef TOKU_XA_XID *XIDP;
 
-int toku_fread_uint8_t (FILE *f, uint8_t *v, struct x1764 *mm, uint32_t *len);
+int toku_fread_uint8_t (FILE *f, uint8_t *v, struct toku_checksum *mm, uint32_t *len);
 int toku_fread_uint32_t_nocrclen (FILE *f, uint32_t *v);
-int toku_fread_uint32_t (FILE *f, uint32_t *v, struct x1764 *checksum, uint32_t *len);
-int toku_fread_uint64_t (FILE *f, uint64_t *v, struct x1764 *checksum, uint32_t *len);
-int toku_fread_bool (FILE *f, bool *v, struct x1764 *checksum, uint32_t *len);
-int toku_fread_LSN     (FILE *f, LSN *lsn, struct x1764 *checksum, uint32_t *len);
-int toku_fread_BLOCKNUM (FILE *f, BLOCKNUM *lsn, struct x1764 *checksum, uint32_t *len);
-int toku_fread_FILENUM (FILE *f, FILENUM *filenum, struct x1764 *checksum, uint32_t *len);
-int toku_fread_TXNID   (FILE *f, TXNID *txnid, struct x1764 *checksum, uint32_t *len);
-int toku_fread_TXNID_PAIR   (FILE *f, TXNID_PAIR *txnid, struct x1764 *checksum, uint32_t *len);
-int toku_fread_XIDP    (FILE *f, XIDP  *xidp,  struct x1764 *checksum, uint32_t *len);
-int toku_fread_BYTESTRING (FILE *f, BYTESTRING *bs, struct x1764 *checksum, uint32_t *len);
-int toku_fread_FILENUMS (FILE *f, FILENUMS *fs, struct x1764 *checksum, uint32_t *len);
-
-int toku_logprint_LSN (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
-int toku_logprint_TXNID (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
-int toku_logprint_TXNID_PAIR (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
-int toku_logprint_XIDP (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
-int toku_logprint_uint8_t (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format);
-int toku_logprint_uint32_t (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format);
-int toku_logprint_BLOCKNUM (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format);
-int toku_logprint_uint64_t (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format);
-int toku_logprint_bool (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
+int toku_fread_uint32_t (FILE *f, uint32_t *v, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_uint64_t (FILE *f, uint64_t *v, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_bool (FILE *f, bool *v, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_LSN     (FILE *f, LSN *lsn, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_BLOCKNUM (FILE *f, BLOCKNUM *lsn, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_FILENUM (FILE *f, FILENUM *filenum, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_TXNID   (FILE *f, TXNID *txnid, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_TXNID_PAIR   (FILE *f, TXNID_PAIR *txnid, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_XIDP    (FILE *f, XIDP  *xidp,  struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_BYTESTRING (FILE *f, BYTESTRING *bs, struct toku_checksum *checksum, uint32_t *len);
+int toku_fread_FILENUMS (FILE *f, FILENUMS *fs, struct toku_checksum *checksum, uint32_t *len);
+
+int toku_logprint_LSN (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
+int toku_logprint_TXNID (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
+int toku_logprint_TXNID_PAIR (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
+int toku_logprint_XIDP (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
+int toku_logprint_uint8_t (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format);
+int toku_logprint_uint32_t (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format);
+int toku_logprint_BLOCKNUM (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format);
+int toku_logprint_uint64_t (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format);
+int toku_logprint_bool (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
 void toku_print_BYTESTRING (FILE *outf, uint32_t len, char *data);
-int toku_logprint_BYTESTRING (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
-int toku_logprint_FILENUM (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format);
-int toku_logprint_FILENUMS (FILE *outf, FILE *inf, const char *fieldname, struct x1764 *checksum, uint32_t *len, const char *format);
-int toku_read_and_print_logmagic (FILE *f, uint32_t *versionp);
-int toku_read_logmagic (FILE *f, uint32_t *versionp);
+int toku_logprint_BYTESTRING (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format __attribute__((__unused__)));
+int toku_logprint_FILENUM (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format);
+int toku_logprint_FILENUMS (FILE *outf, FILE *inf, const char *fieldname, struct toku_checksum *checksum, uint32_t *len, const char *format);
+int toku_read_and_print_logmagic (FILE *f, uint32_t *versionp, enum toku_checksum_method *checksum_methodp);
+int toku_read_logmagic (FILE *f, uint32_t *versionp, enum toku_checksum_method *checksum_methodp);
 
 TXNID_PAIR toku_txn_get_txnid (TOKUTXN txn);
 LSN toku_logger_last_lsn(TOKULOGGER logger);
@@ -155,6 +161,16 @@ void toku_logger_note_checkpoint(TOKULOGGER logger, LSN lsn);
 
 void toku_logger_make_space_in_inbuf (TOKULOGGER logger, int n_bytes_needed);
 
+char *toku_logger_reserve_in_inbuf (TOKULOGGER logger, int n_bytes, LSN *lsnp);
+// Effect: Assign the next LSN and reserve the next n_bytes of the inbuf for the log entry that has it.
+//  Returns where to write the entry.  Fill it in after releasing the input lock, then call
+//  toku_logger_fill_reservation_done.  The inbuf is not written out until every reservation in it is filled.
+// Entry and exit: Holds the input lock, and toku_logger_make_space_in_inbuf made space for n_bytes.
+
+void toku_logger_fill_reservation_done (TOKULOGGER logger);
+// Effect: Note that a log entry reserved with toku_logger_reserve_in_inbuf is completely written.
+// Entry and exit: Holds no locks.
+
 int toku_logger_write_inbuf (TOKULOGGER logger);
 // Effect: Write the buffered data (from the inbuf) to a file.  No fsync, however.
 // As a side effect, the inbuf will be made empty.
@@ -190,7 +206,8 @@ void toku_logger_maybe_fsync (TOKULOGGER logger, LSN lsn, int do_fsync, bool hol
 //        acquire the inlock
 //        release the outlock
 //        if the inbuf is still too small, then increase the size of the inbuf
-//    Increment the LSN and fill the inbuf.
+//    Increment the LSN and reserve room in the inbuf.
+//    release the inlock, and fill in the reserved room.  (Swapping the inbuf waits until all such room is filled.)
 //    If fsync is required then
 //      release the inlock
 //      acquire the outlock
@@ -44,6 +44,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/logger/log-internal.h"
 #include "ft/logger/logcursor.h"
 #include "ft/txn/txn_manager.h"
+#include "util/kibbutz.h"
 #include "util/omt.h"
 
 int tokuft_recovery_trace = 0;                    // turn on recovery tracing, default off.
@@ -59,6 +60,9 @@ int tokuft_recovery_trace = 0;                    // turn on recovery tracing, d
 #define TOKUFT_RECOVERY_PROGRESS_TIME 15
 time_t tokuft_recovery_progress_time = TOKUFT_RECOVERY_PROGRESS_TIME;
 
+// number of threads that apply dictionary messages during the forward scan, 0 means the scan applies them itself
+static uint32_t tokuft_recovery_num_threads = 0;
+
 enum ss {
     BACKWARD_NEWER_CHECKPOINT_END = 1,
     BACKWARD_BETWEEN_CHECKPOINT_BEGIN_END,
@@ -125,6 +129,26 @@ struct file_map {
     toku::omt<struct file_map_tuple *> *filenums;
 };
 
+// Parallel forward recovery.
+//  Log entries that send a message to a single dictionary (enq_insert, enq_insert_no_overwrite,
+//  enq_delete_any, enq_update, enq_updatebroadcast) are copied and handed to a worker chosen by
+//  their FILENUM.  Each worker is a one thread kibbutz, which runs its work in FIFO order, so every
+//  dictionary still gets its messages in LSN order.  Every other log entry is a barrier: the forward
+//  scan waits until all the work handed out so far is done and then runs the entry itself, so
+//  transaction begin/commit/abort, fcreate/fdelete/fclose, checkpoints etc. see exactly the state
+//  they would see in a serial replay.
+struct recover_workers {
+    uint32_t num_workers;       // 0 means replay serially
+    KIBBUTZ *workers;
+    toku_mutex_t mutex;
+    toku_cond_t cond;
+    uint64_t num_outstanding;   // handed out but not yet applied, protected by the mutex
+    uint64_t num_applied;       // applied by the workers, protected by the mutex
+};
+
+// the forward scan waits for the workers when it gets this far ahead of them
+static const uint64_t recover_max_outstanding_per_worker = 4096;
+
 // The recovery environment
 struct recover_env {
     DB_ENV *env;
@@ -143,6 +167,7 @@ struct recover_env {
     struct file_map fmap;
     bool goforward;
     bool destroy_logger_at_end; // If true then destroy the logger when we are done.  If false then set the logger into write-files mode when we are done with recovery.*/
+    struct recover_workers workers;
 };
 typedef struct recover_env *RECOVER_ENV;
 
@@ -265,6 +290,7 @@ static int recover_env_init (RECOVER_ENV renv,
     renv->cp = toku_cachetable_get_checkpointer(renv->ct);
     toku_dbt_array_init(&renv->dest_keys, 1);
     toku_dbt_array_init(&renv->dest_vals, 1);
+    memset(&renv->workers, 0, sizeof(renv->workers));
     if (tokuft_recovery_trace)
         fprintf(stderr, "%s:%d\n", __FUNCTION__, __LINE__);
     return r;
@@ -1014,6 +1040,180 @@ static int toku_recover_backward_frename(struct logtype_frename *UU(l),
     return 0;
 }
 
+void toku_recover_set_num_threads(uint32_t num_threads) {
+    tokuft_recovery_num_threads = num_threads;
+}
+
+static void recover_workers_start(struct recover_workers *w, uint32_t num_workers) {
+    w->num_workers = num_workers;
+    w->num_outstanding = 0;
+    w->num_applied = 0;
+    if (num_workers == 0) {
+        return;
+    }
+    toku_mutex_init(toku_uninstrumented, &w->mutex, nullptr);
+    toku_cond_init(toku_uninstrumented, &w->cond, nullptr);
+    XMALLOC_N(num_workers, w->workers);
+    for (uint32_t i = 0; i < num_workers; i++) {
+        int r = toku_kibbutz_create(1, &w->workers[i]);
+        assert_zero(r);
+    }
+}
+
+static void recover_workers_drain(struct recover_workers *w) {
+    if (w->num_workers == 0) {
+        return;
+    }
+    toku_mutex_lock(&w->mutex);
+    while (w->num_outstanding > 0) {
+        toku_cond_wait(&w->cond, &w->mutex);
+    }
+    toku_mutex_unlock(&w->mutex);
+}
+
+static void recover_workers_stop(struct recover_workers *w) {
+    if (w->num_workers == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < w->num_workers; i++) {
+        // finishes the work already handed out
+        toku_kibbutz_destroy(w->workers[i]);
+    }
+    toku_free(w->workers);
+    w->workers = nullptr;
+    w->num_workers = 0;
+    toku_cond_destroy(&w->cond);
+    toku_mutex_destroy(&w->mutex);
+}
+
+static uint64_t recover_workers_num_applied(struct recover_workers *w) {
+    if (w->num_workers == 0) {
+        return 0;
+    }
+    toku_mutex_lock(&w->mutex);
+    uint64_t n = w->num_applied;
+    toku_mutex_unlock(&w->mutex);
+    return n;
+}
+
+// A copy of a dictionary message from the log, for a worker to apply.  The key and value bytes follow it.
+struct recover_work_item {
+    struct recover_workers *w;
+    enum lt_cmd cmd;
+    FT_HANDLE ft_handle;
+    TOKUTXN txn;
+    LSN lsn;
+    bool is_resetting_op;
+    DBT key;
+    DBT val;
+};
+
+static void recover_apply_work_item(void *extra) {
+    struct recover_work_item *CAST_FROM_VOIDP(item, extra);
+    switch (item->cmd) {
+    case LT_enq_insert:
+        toku_ft_maybe_insert(item->ft_handle, &item->key, &item->val, item->txn, true, item->lsn, false, FT_INSERT);
+        toku_txn_maybe_note_ft(item->txn, item->ft_handle->ft);
+        break;
+    case LT_enq_insert_no_overwrite:
+        toku_ft_maybe_insert(item->ft_handle, &item->key, &item->val, item->txn, true, item->lsn, false, FT_INSERT_NO_OVERWRITE);
+        break;
+    case LT_enq_delete_any:
+        toku_ft_maybe_delete(item->ft_handle, &item->key, item->txn, true, item->lsn, false);
+        break;
+    case LT_enq_update:
+        toku_ft_maybe_update(item->ft_handle, &item->key, &item->val, item->txn, true, item->lsn, false);
+        break;
+    case LT_enq_updatebroadcast:
+        toku_ft_maybe_update_broadcast(item->ft_handle, &item->val, item->txn, true, item->lsn, false, item->is_resetting_op);
+        break;
+    default:
+        abort();
+    }
+    struct recover_workers *w = item->w;
+    toku_free(item);
+    toku_mutex_lock(&w->mutex);
+    w->num_outstanding--;
+    w->num_applied++;
+    toku_cond_broadcast(&w->cond);
+    toku_mutex_unlock(&w->mutex);
+}
+
+static bool recover_workers_enqueue(RECOVER_ENV renv, struct log_entry *le) {
+// Effect: If le is a message for a single dictionary, hand it to that dictionary's worker and return true.
+//  Otherwise return false, and the caller runs le itself.
+    struct recover_workers *w = &renv->workers;
+    FILENUM filenum;
+    TXNID_PAIR xid;
+    LSN lsn;
+    const BYTESTRING *key = nullptr, *val = nullptr;
+    bool is_resetting_op = false;
+    switch (le->cmd) {
+    case LT_enq_insert:
+        filenum = le->u.enq_insert.filenum; xid = le->u.enq_insert.xid; lsn = le->u.enq_insert.lsn;
+        key = &le->u.enq_insert.key; val = &le->u.enq_insert.value;
+        break;
+    case LT_enq_insert_no_overwrite:
+        filenum = le->u.enq_insert_no_overwrite.filenum; xid = le->u.enq_insert_no_overwrite.xid; lsn = le->u.enq_insert_no_overwrite.lsn;
+        key = &le->u.enq_insert_no_overwrite.key; val = &le->u.enq_insert_no_overwrite.value;
+        break;
+    case LT_enq_delete_any:
+        filenum = le->u.enq_delete_any.filenum; xid = le->u.enq_delete_any.xid; lsn = le->u.enq_delete_any.lsn;
+        key = &le->u.enq_delete_any.key;
+        break;
+    case LT_enq_update:
+        filenum = le->u.enq_update.filenum; xid = le->u.enq_update.xid; lsn = le->u.enq_update.lsn;
+        key = &le->u.enq_update.key; val = &le->u.enq_update.extra;
+        break;
+    case LT_enq_updatebroadcast:
+        filenum = le->u.enq_updatebroadcast.filenum; xid = le->u.enq_updatebroadcast.xid; lsn = le->u.enq_updatebroadcast.lsn;
+        val = &le->u.enq_updatebroadcast.extra;
+        is_resetting_op = le->u.enq_updatebroadcast.is_resetting_op;
+        break;
+    default:
+        return false;
+    }
+
+    TOKUTXN txn = NULL;
+    toku_txnid2txn(renv->logger, xid, &txn);
+    assert(txn != NULL);
+    struct file_map_tuple *tuple = NULL;
+    int r = file_map_find(&renv->fmap, filenum, &tuple);
+    if (r != 0) {
+        // the dictionary is gone, so there is nothing to apply
+        return true;
+    }
+
+    uint32_t keylen = key ? key->len : 0;
+    uint32_t vallen = val ? val->len : 0;
+    struct recover_work_item *item = (struct recover_work_item *) toku_xmalloc(sizeof(*item) + keylen + vallen);
+    char *bytes = (char *) (item + 1);
+    item->w = w;
+    item->cmd = le->cmd;
+    item->ft_handle = tuple->ft_handle;
+    item->txn = txn;
+    item->lsn = lsn;
+    item->is_resetting_op = is_resetting_op;
+    if (keylen > 0) {
+        memcpy(bytes, key->data, keylen);
+    }
+    if (vallen > 0) {
+        memcpy(bytes + keylen, val->data, vallen);
+    }
+    toku_fill_dbt(&item->key, bytes, keylen);
+    toku_fill_dbt(&item->val, bytes + keylen, vallen);
+
+    toku_mutex_lock(&w->mutex);
+    // don't let the scan read the whole log into memory ahead of the workers
+    while (w->num_outstanding >= recover_max_outstanding_per_worker * w->num_workers) {
+        toku_cond_wait(&w->cond, &w->mutex);
+    }
+    w->num_outstanding++;
+    toku_mutex_unlock(&w->mutex);
+    toku_kibbutz_enq(w->workers[filenum.fileid % w->num_workers], recover_apply_work_item, item);
+    return true;
+}
+
 static int toku_recover_enq_insert (struct logtype_enq_insert *l, RECOVER_ENV renv) {
     int r;
     TOKUTXN txn = NULL;
@@ -1543,7 +1743,14 @@ static int do_recovery(RECOVER_ENV renv, const char *env_dir, const char *log_di
     tnow = time(NULL);
     fprintf(stderr, "%.24s PerconaFT recovery starts scanning forward to %" PRIu64 " from %" PRIu64 " left %" PRIu64 " (%s)\n",
             ctime(&tnow), lastlsn.lsn, thislsn.lsn, lastlsn.lsn - thislsn.lsn, recover_state(renv));
+    recover_workers_start(&renv->workers, tokuft_recovery_num_threads);
+    if (renv->workers.num_workers > 0) {
+        fprintf(stderr, "%.24s PerconaFT recovery applying dictionary messages with %" PRIu32 " threads\n",
+                ctime(&tnow), renv->workers.num_workers);
+    }
 
+    {
+    LSN lastreportlsn = thislsn;
     for (unsigned i=0; 1; i++) {
 
         // trace progress
@@ -1551,16 +1758,30 @@ static int do_recovery(RECOVER_ENV renv, const char *env_dir, const char *log_di
             tnow = time(NULL);
             if (tnow - tlast >= tokuft_recovery_progress_time) {
                 thislsn = toku_log_entry_get_lsn(le);
-                fprintf(stderr, "%.24s PerconaFT recovery scanning forward to %" PRIu64 " at %" PRIu64 " left %" PRIu64 " (%s)\n",
-                        ctime(&tnow), lastlsn.lsn, thislsn.lsn, lastlsn.lsn - thislsn.lsn, recover_state(renv));
+                double rate = (double) (thislsn.lsn - lastreportlsn.lsn) / (tnow - tlast);
+                if (renv->workers.num_workers > 0) {
+                    fprintf(stderr, "%.24s PerconaFT recovery scanning forward to %" PRIu64 " at %" PRIu64 " left %" PRIu64 " (%s) %.0f entries/s, %" PRIu64 " applied by %" PRIu32 " threads\n",
+                            ctime(&tnow), lastlsn.lsn, thislsn.lsn, lastlsn.lsn - thislsn.lsn, recover_state(renv),
+                            rate, recover_workers_num_applied(&renv->workers), renv->workers.num_workers);
+                } else {
+                    fprintf(stderr, "%.24s PerconaFT recovery scanning forward to %" PRIu64 " at %" PRIu64 " left %" PRIu64 " (%s) %.0f entries/s\n",
+                            ctime(&tnow), lastlsn.lsn, thislsn.lsn, lastlsn.lsn - thislsn.lsn, recover_state(renv), rate);
+                }
                 tlast = tnow;
+                lastreportlsn = thislsn;
             }
         }
 
         // dispatch the log entry handler (first time calls the forward handler for the log entry at the turnaround
         assert(renv->ss.ss == FORWARD_BETWEEN_CHECKPOINT_BEGIN_END ||
                renv->ss.ss == FORWARD_NEWER_CHECKPOINT_END);
-        logtype_dispatch_assign(le, toku_recover_, r, renv);
+        if (renv->workers.num_workers > 0 && recover_workers_enqueue(renv, le)) {
+            r = 0;
+        } else {
+            // everything else is a barrier
+            recover_workers_drain(&renv->workers);
+            logtype_dispatch_assign(le, toku_recover_, r, renv);
+        }
         if (tokuft_recovery_trace) 
             recover_trace_le(__FUNCTION__, __LINE__, r, le);
         if (r != 0) {
@@ -1582,6 +1803,8 @@ static int do_recovery(RECOVER_ENV renv, const char *env_dir, const char *log_di
             goto errorexit;
         }        
     }
+    }
+    recover_workers_stop(&renv->workers);
 
     // verify the final recovery state
     assert(renv->ss.ss == FORWARD_NEWER_CHECKPOINT_END);   
@@ -1642,6 +1865,8 @@ static int do_recovery(RECOVER_ENV renv, const char *env_dir, const char *log_di
     tnow = time(NULL);
     fprintf(stderr, "%.24s PerconaFT recovery failed %d\n", ctime(&tnow), rr);
 
+    recover_workers_stop(&renv->workers);
+
     if (logcursor) {
         r = toku_logcursor_destroy(&logcursor);
         assert(r == 0);
@@ -46,7 +46,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 
 #include "ft/comparator.h"
 #include "ft/ft-ops.h"
-#include "util/x1764.h"
+#include "util/checksum.h"
 
 typedef void (*prepared_txn_callback_t)(DB_ENV *env, struct tokutxn *txn);
 typedef void (*keep_cachetable_callback_t)(DB_ENV *env, struct cachetable *ct);
@@ -80,6 +80,10 @@ void toku_recover_set_callback2 (void (*)(void*), void*);
 
 extern int tokuft_recovery_trace;
 
+// Apply the dictionary messages found by the forward scan of recovery on this many threads,
+// keeping each dictionary's messages in LSN order.  0 (the default) applies them on the scanning thread.
+void toku_recover_set_num_threads(uint32_t num_threads);
+
 int toku_recover_lock (const char *lock_dir, int *lockfd);
 
 int toku_recover_unlock(int lockfd);
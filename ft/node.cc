@@ -61,6 +61,7 @@ void toku_initialize_empty_ftnode(FTNODE n, BLOCKNUM blocknum, int height, int n
     n->bp = 0;
     n->n_children = num_children;
     n->oldest_referenced_xid_known = TXNID_NONE;
+    n->readahead_unused = false;
 
     if (num_children > 0) {
         XMALLOC_N(num_children, n->bp);
@@ -997,6 +998,8 @@ void toku_ftnode_leaf_rebalance(FTNODE node, unsigned int basementnodesize) {
             bn_le_sizes[i]  // total le sizes
             );
 
+        toku_bn_count_garbage(BLB(node, i));
+
         BP_STATE(node,i) = PT_AVAIL;
         BP_TOUCH_CLOCK(node,i);
         BLB_MAX_MSN_APPLIED(node,i) = max_msn;
@@ -1144,6 +1147,61 @@ void toku_ft_nonleaf_append_child(FTNODE node, FTNODE child, const DBT *pivotkey
     node->set_dirty();
 }
 
+// Background garbage collection only looks at a basement once it holds at
+// least this many reclaimable uxrs, so the cleaner thread does not dirty a
+// leaf (and cause it to be written) to save a few bytes.  Zero turns it off.
+static uint32_t ft_background_gc_threshold = 1024;
+
+// Each time background gc finds a basement's garbage still referenced, the
+// basement's cleaner priority is halved, down to this many times.
+static const uint8_t ft_background_gc_max_backoff = 8;
+
+void toku_ft_set_background_gc_threshold(uint32_t num_uxrs) {
+    ft_background_gc_threshold = num_uxrs;
+}
+
+static void bn_add_garbage(BASEMENTNODE bn, LEAFENTRY le) {
+    uint32_t num_stale_cxrs, num_pxrs;
+    TXNID newest_xid;
+    toku_le_count_garbage(le, &num_stale_cxrs, &num_pxrs, &newest_xid);
+    bn->gc_stale_cxrs += num_stale_cxrs;
+    bn->gc_pxrs += num_pxrs;
+    if (newest_xid > bn->gc_horizon) {
+        // new garbage, so background gc should give this basement another look
+        bn->gc_horizon = newest_xid;
+        bn->gc_backoff = 0;
+    }
+}
+
+static void bn_remove_garbage(BASEMENTNODE bn, LEAFENTRY le) {
+    uint32_t num_stale_cxrs, num_pxrs;
+    TXNID newest_xid;
+    toku_le_count_garbage(le, &num_stale_cxrs, &num_pxrs, &newest_xid);
+    // The counts only steer background gc, and some tests fill basements
+    // without going through here, so clamp instead of asserting.
+    bn->gc_stale_cxrs -= std::min(bn->gc_stale_cxrs, (uint64_t) num_stale_cxrs);
+    bn->gc_pxrs -= std::min(bn->gc_pxrs, (uint64_t) num_pxrs);
+}
+
+static int bn_count_garbage_fun(const void *UU(key), const uint32_t UU(keylen),
+                                const LEAFENTRY &le, const uint32_t UU(idx),
+                                struct ftnode_leaf_basement_node *const bn) {
+    bn_add_garbage(bn, le);
+    return 0;
+}
+
+// Effect: Recounts the MVCC garbage in bn from scratch, after its leafentries
+//         were read from disk or moved between basements.
+void toku_bn_count_garbage(BASEMENTNODE bn) {
+    const uint8_t backoff = bn->gc_backoff;
+    bn->gc_stale_cxrs = 0;
+    bn->gc_pxrs = 0;
+    bn->gc_horizon = TXNID_NONE;
+    int r = bn->data_buffer.iterate<struct ftnode_leaf_basement_node, bn_count_garbage_fun>(bn);
+    invariant_zero(r);
+    bn->gc_backoff = backoff;
+}
+
 void
 toku_ft_bn_apply_msg_once (
     BASEMENTNODE bn,
@@ -1175,6 +1233,7 @@ toku_ft_bn_apply_msg_once (
     uint32_t key_storage_size = msg.kdbt()->size + sizeof(uint32_t);
     if (le) {
         oldsize = leafentry_memsize(le) + key_storage_size;
+        bn_remove_garbage(bn, le);
     }
 
     // toku_le_apply_msg() may call bn_data::mempool_malloc_and_update_dmt()
@@ -1195,6 +1254,9 @@ toku_ft_bn_apply_msg_once (
     // The dmt may have realloced its mempool and freed the one containing key.
 
     newsize = new_le ? (leafentry_memsize(new_le) +  + key_storage_size) : 0;
+    if (new_le) {
+        bn_add_garbage(bn, new_le);
+    }
     if (le && new_le) {
         workdone_this_le = (oldsize > newsize ? oldsize : newsize);  // work done is max of le size before and after message application
 
@@ -1907,6 +1969,7 @@ ft_basement_node_gc_once(BASEMENTNODE bn,
     // part of the garbage collection.
     int64_t numbytes_delta;
     int64_t numrows_delta;
+    bn_remove_garbage(bn, leaf_entry);
     toku_le_garbage_collect(leaf_entry,
                             &bn->data_buffer,
                             index,
@@ -1919,6 +1982,7 @@ ft_basement_node_gc_once(BASEMENTNODE bn,
     numrows_delta = 0;
     if (new_leaf_entry) {
         numrows_delta = 0;
+        bn_add_garbage(bn, new_leaf_entry);
     } else {
         numrows_delta = -1;
     }
@@ -2019,6 +2083,101 @@ void toku_ftnode_leaf_run_gc(FT ft, FTNODE node) {
     }
 }
 
+// Effect: How much the cleaner thread should want to garbage collect this
+//         leaf: the uxrs background gc may reclaim from its basements in
+//         memory, weighed by the bytes each one frees at least (its xid and
+//         length), and halved for each time a basement was found still
+//         referenced.
+long toku_ftnode_leaf_gc_priority(FTNODE node) {
+    paranoid_invariant_zero(node->height);
+    const uint32_t threshold = ft_background_gc_threshold;
+    if (threshold == 0) {
+        return 0;
+    }
+    long retval = 0;
+    for (int i = 0; i < node->n_children; i++) {
+        if (BP_STATE(node, i) != PT_AVAIL) {
+            continue;
+        }
+        BASEMENTNODE bn = BLB(node, i);
+        uint64_t num_uxrs = bn->gc_stale_cxrs + bn->gc_pxrs;
+        if (num_uxrs >= threshold) {
+            retval += (num_uxrs * (sizeof(TXNID) + sizeof(uint32_t))) >> bn->gc_backoff;
+        }
+    }
+    return retval;
+}
+
+// Effect: Garbage collect the basements of a leaf that the cleaner thread
+//         picked for the MVCC garbage they hold. Only basements that are in
+//         memory and over the threshold are considered, so this never reads
+//         from disk. A basement is collected once the oldest referenced xid
+//         has passed its gc_horizon, when all of its garbage is reclaimable;
+//         otherwise it backs off. Dirties the node if anything was collected.
+void toku_ftnode_leaf_run_background_gc(FT ft, FTNODE node) {
+    paranoid_invariant_zero(node->height);
+    const uint32_t threshold = ft_background_gc_threshold;
+    TOKULOGGER logger = toku_cachefile_logger(ft->cf);
+    TXN_MANAGER txn_manager = logger ? toku_logger_get_txn_manager(logger) : nullptr;
+    const TXNID oldest_referenced_xid = txn_manager ?
+        toku_txn_manager_get_oldest_referenced_xid_estimate(txn_manager) : TXNID_NONE;
+
+    toku::scoped_calloc collect_buf(sizeof(bool) * node->n_children);
+    bool *collect = reinterpret_cast<bool *>(collect_buf.get());
+    int num_to_collect = 0;
+    for (int i = 0; i < node->n_children; i++) {
+        if (BP_STATE(node, i) != PT_AVAIL) {
+            continue;
+        }
+        BASEMENTNODE bn = BLB(node, i);
+        if (threshold == 0 || bn->gc_stale_cxrs + bn->gc_pxrs < threshold) {
+            continue;
+        }
+        if (txn_manager != nullptr && bn->gc_horizon < oldest_referenced_xid) {
+            collect[i] = true;
+            num_to_collect++;
+        } else if (bn->gc_backoff < ft_background_gc_max_backoff) {
+            bn->gc_backoff++;
+            FT_STATUS_INC(FT_BACKGROUND_GC_DEFERRED, 1);
+        }
+    }
+    if (num_to_collect == 0) {
+        return;
+    }
+
+    // Same as toku_ftnode_leaf_run_gc(), see there.
+    txn_manager_state txn_state_for_gc(txn_manager);
+    txn_state_for_gc.init();
+    txn_gc_info gc_info(&txn_state_for_gc,
+                        oldest_referenced_xid,
+                        node->oldest_referenced_xid_known,
+                        true);
+    uint64_t bytes_reclaimed = 0;
+    for (int i = 0; i < node->n_children; i++) {
+        if (!collect[i]) {
+            continue;
+        }
+        BASEMENTNODE bn = BLB(node, i);
+        const uint64_t size_before = bn->data_buffer.get_disk_size();
+        STAT64INFO_S delta;
+        delta.numrows = 0;
+        delta.numbytes = 0;
+        basement_node_gc_all_les(bn, &gc_info, &delta);
+        toku_ft_update_stats(&ft->in_memory_stats, delta);
+        const uint64_t size_after = bn->data_buffer.get_disk_size();
+        bytes_reclaimed += size_before > size_after ? size_before - size_after : 0;
+        if (bn->gc_stale_cxrs + bn->gc_pxrs >= threshold &&
+            bn->gc_backoff < ft_background_gc_max_backoff) {
+            // whatever is left is still referenced after all
+            bn->gc_backoff++;
+        }
+    }
+    node->set_dirty();
+    FT_STATUS_INC(FT_BACKGROUND_GC_LEAVES, 1);
+    FT_STATUS_INC(FT_BACKGROUND_GC_BASEMENTS, num_to_collect);
+    FT_STATUS_INC(FT_BACKGROUND_GC_BYTES, bytes_reclaimed);
+}
+
 void toku_ftnode_put_msg(
     const toku::comparator &cmp,
     ft_update_func update_fun,
@@ -216,6 +216,10 @@ struct ftnode {
     // partition corresponds to the ith basement node
     struct ftnode_partition *bp;
     struct ctpair *ct_pair;
+
+    // transient: true if a cursor read this node ahead of time and no query
+    // has pinned it since.  Feeds the read-ahead hit and waste counters.
+    bool readahead_unused;
 };
 typedef struct ftnode *FTNODE;
 
@@ -230,6 +234,17 @@ struct ftnode_leaf_basement_node {
     // Used to back out tree scoped LRC id node is evicted but not persisted
     int64_t logical_rows_delta;
     STAT64INFO_S stat64_delta;      // change in stat64 counters since basement was last written to disk
+    // MVCC garbage in this basement, as counted by toku_le_count_garbage() over
+    // its leafentries. Kept up to date as messages are applied and leafentries
+    // are garbage collected, and recounted when the basement is rebuilt.
+    // gc_horizon is the newest xid that added garbage: once the oldest
+    // referenced xid passes it, all of it can be reclaimed.
+    uint64_t gc_stale_cxrs;
+    uint64_t gc_pxrs;
+    TXNID gc_horizon;
+    // how many times background garbage collection found nothing it could
+    // reclaim here yet; halves this basement's cleaner priority each time
+    uint8_t gc_backoff;
 };
 typedef struct ftnode_leaf_basement_node *BASEMENTNODE;
 
@@ -328,6 +343,7 @@ BASEMENTNODE toku_create_empty_bn(void);
 BASEMENTNODE toku_create_empty_bn_no_buffer(void); // create a basement node with a null buffer.
 NONLEAF_CHILDINFO toku_clone_nl(NONLEAF_CHILDINFO orig_childinfo);
 BASEMENTNODE toku_clone_bn(BASEMENTNODE orig_bn);
+void toku_bn_count_garbage(BASEMENTNODE bn);
 NONLEAF_CHILDINFO toku_create_empty_nl(void);
 void destroy_basement_node (BASEMENTNODE bn);
 void destroy_nonleaf_childinfo (NONLEAF_CHILDINFO nl);
@@ -392,6 +408,8 @@ uint32_t toku_ftnode_leaf_num_entries(FTNODE node);
 void toku_ftnode_leaf_rebalance(FTNODE node, unsigned int basementnodesize);
 
 void toku_ftnode_leaf_run_gc(FT ft, FTNODE node);
+long toku_ftnode_leaf_gc_priority(FTNODE node);
+void toku_ftnode_leaf_run_background_gc(FT ft, FTNODE node);
 
 enum reactivity {
     RE_STABLE,
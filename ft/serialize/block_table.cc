@@ -51,6 +51,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/serialize/rbuf.h"
 #include "ft/serialize/wbuf.h"
 #include "ft/serialize/block_allocator.h"
+#include "ft/serialize/ft_layout_version.h"
 #include "util/nb_mutex.h"
 #include "util/scoped_malloc.h"
 
@@ -69,6 +70,41 @@ static const DISKOFF size_is_free = (DISKOFF)-1;
 // yet have a diskblock
 static const DISKOFF diskoff_unused = (DISKOFF)-2;
 
+// A delta holds the array of a translation in pages of this many blocknums.
+static const int64_t blocknums_per_translation_page = 256;
+
+// A translation is written in full, and becomes the base of the deltas that
+// follow, once a delta would be more than 1/translation_delta_max_fraction of
+// its full size.
+static const int64_t translation_delta_max_fraction = 4;
+
+// Number of blocknums of a translation's array that are in the given page.
+static int64_t translation_page_length(BLOCKNUM smallest_never_used_blocknum,
+                                       int64_t page) {
+    int64_t n = smallest_never_used_blocknum.b -
+                page * blocknums_per_translation_page;
+    if (n < 0) {
+        return 0;
+    }
+    return n < blocknums_per_translation_page ? n
+                                              : blocknums_per_translation_page;
+}
+
+static int translation_verify_checksum(unsigned char *translation_buffer,
+                                       uint64_t size_on_disk) {
+    uint32_t x1764 = toku_x1764_memory(translation_buffer, size_on_disk - 4);
+    uint64_t offset = size_on_disk - 4;
+    uint32_t stored_x1764 = toku_dtoh32(*(int *)(translation_buffer + offset));
+    if (x1764 != stored_x1764) {
+        fprintf(stderr,
+                "Translation table checksum failure: calc=0x%08x read=0x%08x\n",
+                x1764,
+                stored_x1764);
+        return TOKUDB_BAD_CHECKSUM;
+    }
+    return 0;
+}
+
 void block_table::_mutex_lock() { toku_mutex_lock(&_mutex); }
 
 void block_table::_mutex_unlock() { toku_mutex_unlock(&_mutex); }
@@ -103,6 +139,9 @@ void block_table::_create_internal() {
     memset(&_inprogress, 0, sizeof(struct translation));
     memset(&_checkpointed, 0, sizeof(struct translation));
     memset(&_mutex, 0, sizeof(_mutex));
+    // Current always tracks the pages that changed since its base.
+    XCALLOC_N(1, _current.dirty_pages);
+    _current.length_of_dirty_pages = 1;
     _bt_block_allocator = new BlockAllocator();
     toku_mutex_init(*block_table_mutex_key, &_mutex, nullptr);
     nb_mutex_init(*safe_file_size_lock_mutex_key,
@@ -122,18 +161,41 @@ int block_table::create_from_buffer(
     int fd,
     DISKOFF location_on_disk,  // Location of translation_buffer
     DISKOFF size_on_disk,
-    unsigned char *translation_buffer) {
+    unsigned char *translation_buffer,
+    uint32_t layout_version) {
     // Does not initialize the block allocator
     _create_internal();
 
     // Deserialize the translation and copy it to current
-    int r = _translation_deserialize_from_buffer(
-        &_checkpointed, location_on_disk, size_on_disk, translation_buffer);
+    int r = _translation_deserialize_from_buffer(&_checkpointed,
+                                                 location_on_disk,
+                                                 size_on_disk,
+                                                 translation_buffer,
+                                                 layout_version,
+                                                 fd);
     if (r != 0) {
         return r;
     }
     _copy_translation(&_current, &_checkpointed, TRANSLATION_CURRENT);
 
+    // Current is a delta against the same base as checkpointed, or against
+    // checkpointed itself if it was written in full.  A translation written
+    // before FT_LAYOUT_VERSION_32 has no format field, so it can't be a base.
+    if (_checkpointed.base.size > 0) {
+        _current.base = _checkpointed.base;
+        // The pages in the delta are the ones changed since the base.
+        _free_dirty_pages(&_current);
+        _current.dirty_pages = _checkpointed.dirty_pages;
+        _current.length_of_dirty_pages = _checkpointed.length_of_dirty_pages;
+        _current.num_dirty_pages = _checkpointed.num_dirty_pages;
+        _checkpointed.dirty_pages = nullptr;
+        _checkpointed.length_of_dirty_pages = 0;
+        _checkpointed.num_dirty_pages = 0;
+    } else if (layout_version >= FT_LAYOUT_VERSION_32) {
+        _current.base =
+            _checkpointed.block_translation[RESERVED_BLOCKNUM_TRANSLATION];
+    }
+
     // Determine the file size
     int64_t file_size = 0;
     r = toku_os_get_file_size(fd, &file_size);
@@ -143,8 +205,9 @@ int block_table::create_from_buffer(
 
     // Gather the non-empty translations and use them to create the block
     // allocator
-    toku::scoped_malloc pairs_buf(_checkpointed.smallest_never_used_blocknum.b *
-                                  sizeof(struct BlockAllocator::BlockPair));
+    toku::scoped_malloc pairs_buf(
+        (_checkpointed.smallest_never_used_blocknum.b + 1) *
+        sizeof(struct BlockAllocator::BlockPair));
     struct BlockAllocator::BlockPair *CAST_FROM_VOIDP(pairs, pairs_buf.get());
     uint64_t n_pairs = 0;
     for (int64_t i = 0; i < _checkpointed.smallest_never_used_blocknum.b; i++) {
@@ -155,6 +218,10 @@ int block_table::create_from_buffer(
                 BlockAllocator::BlockPair(pair.u.diskoff, pair.size);
         }
     }
+    if (_checkpointed.base.size > 0) {
+        pairs[n_pairs++] = BlockAllocator::BlockPair(
+            _checkpointed.base.u.diskoff, _checkpointed.base.size);
+    }
 
     _bt_block_allocator->CreateFromBlockPairs(
         BlockAllocator::BLOCK_ALLOCATOR_TOTAL_HEADER_RESERVE,
@@ -282,7 +349,8 @@ int64_t block_table::get_blocks_in_use_unlocked() {
     return num_blocks;
 }
 
-void block_table::_maybe_optimize_translation(struct translation *t) {
+// Returns true if the translation changed.
+bool block_table::_maybe_optimize_translation(struct translation *t) {
     // Reduce 'smallest_never_used_blocknum.b' (completely free blocknums
     // instead of just
     // on a free list.  Doing so requires us to regenerate the free list.
@@ -323,6 +391,39 @@ void block_table::_maybe_optimize_translation(struct translation *t) {
             }
         }
     }
+    return freed > 0;
+}
+
+void block_table::_note_pair_dirty(struct translation *t, BLOCKNUM b) {
+    if (t->dirty_pages == nullptr) {
+        return;
+    }
+    int64_t page = b.b / blocknums_per_translation_page;
+    if (page >= t->length_of_dirty_pages) {
+        int64_t new_length = (page + 1) * 2;
+        XREALLOC_N(new_length, t->dirty_pages);
+        memset(&t->dirty_pages[t->length_of_dirty_pages],
+               0,
+               new_length - t->length_of_dirty_pages);
+        t->length_of_dirty_pages = new_length;
+    }
+    if (!t->dirty_pages[page]) {
+        t->dirty_pages[page] = 1;
+        t->num_dirty_pages++;
+    }
+}
+
+void block_table::_free_dirty_pages(struct translation *t) {
+    toku_free(t->dirty_pages);
+    t->dirty_pages = nullptr;
+    t->length_of_dirty_pages = 0;
+    t->num_dirty_pages = 0;
+}
+
+// Is the full translation at diskoff still needed to read a delta?
+bool block_table::_is_translation_base(DISKOFF diskoff) {
+    return (_current.base.size > 0 && _current.base.u.diskoff == diskoff) ||
+           (_inprogress.base.size > 0 && _inprogress.base.u.diskoff == diskoff);
 }
 
 // block table must be locked by caller of this function
@@ -331,11 +432,37 @@ void block_table::note_start_checkpoint_unlocked() {
 
     // We're going to do O(n) work to copy the translation, so we
     // can afford to do O(n) work by optimizing the translation
-    _maybe_optimize_translation(&_current);
+    bool optimized = _maybe_optimize_translation(&_current);
 
     // Copy current translation to inprogress translation.
     _copy_translation(&_inprogress, &_current, TRANSLATION_INPROGRESS);
 
+    // Write inprogress as a delta against current's base if that is much
+    // smaller than writing it in full.  Optimizing rewrites the free list, so
+    // it always costs a full write.
+    if (!optimized && _current.base.size > 0) {
+        _inprogress.base = _current.base;
+        XMEMDUP_N(_inprogress.dirty_pages,
+                  _current.dirty_pages,
+                  _current.length_of_dirty_pages);
+        _inprogress.length_of_dirty_pages = _current.length_of_dirty_pages;
+        _inprogress.num_dirty_pages = _current.num_dirty_pages;
+        int64_t full_size = _calculate_full_size_on_disk(&_inprogress);
+        if (_calculate_delta_size_on_disk(&_inprogress) *
+                translation_delta_max_fraction >
+            full_size) {
+            _free_dirty_pages(&_inprogress);
+            memset(&_inprogress.base, 0, sizeof(_inprogress.base));
+        }
+    }
+    if (_inprogress.base.size == 0) {
+        // Inprogress will be the new base, so start tracking changes to
+        // current from here.  current.base is set once inprogress is on disk.
+        memset(_current.dirty_pages, 0, _current.length_of_dirty_pages);
+        _current.num_dirty_pages = 0;
+        memset(&_current.base, 0, sizeof(_current.base));
+    }
+
     _checkpoint_skipped = false;
 }
 
@@ -366,6 +493,7 @@ void block_table::note_end_checkpoint(int fd) {
     paranoid_invariant_notnull(_inprogress.block_translation);
     if (_checkpoint_skipped) {
         toku_free(_inprogress.block_translation);
+        _free_dirty_pages(&_inprogress);
         memset(&_inprogress, 0, sizeof(_inprogress));
         goto end;
     }
@@ -383,15 +511,21 @@ void block_table::note_end_checkpoint(int fd) {
             struct block_translation_pair *pair = &t->block_translation[i];
             if (pair->size > 0 &&
                 !_translation_prevents_freeing(
-                    &_inprogress, make_blocknum(i), pair)) {
+                    &_inprogress, make_blocknum(i), pair) &&
+                !(i == RESERVED_BLOCKNUM_TRANSLATION &&
+                  _is_translation_base(pair->u.diskoff))) {
                 invariant(!_translation_prevents_freeing(
                               &_current, make_blocknum(i), pair));
                 _bt_block_allocator->FreeBlock(pair->u.diskoff, pair->size);
             }
         }
+        if (t->base.size > 0 && !_is_translation_base(t->base.u.diskoff)) {
+            _bt_block_allocator->FreeBlock(t->base.u.diskoff, t->base.size);
+        }
         toku_free(_checkpointed.block_translation);
         _checkpointed = _inprogress;
         _checkpointed.type = TRANSLATION_CHECKPOINTED;
+        _free_dirty_pages(&_checkpointed);
         memset(&_inprogress, 0, sizeof(_inprogress));
         _maybe_truncate_file(fd, allocated_limit_at_start);
     }
@@ -429,12 +563,50 @@ void block_table::block_free(uint64_t offset, uint64_t size) {
 }
 
 int64_t block_table::_calculate_size_on_disk(struct translation *t) {
-    return 8 +  // smallest_never_used_blocknum
+    if (t->base.size > 0) {
+        return _calculate_delta_size_on_disk(t);
+    }
+    return _calculate_full_size_on_disk(t);
+}
+
+int64_t block_table::_calculate_full_size_on_disk(struct translation *t) {
+    return 4 +  // format
+           8 +  // smallest_never_used_blocknum
            8 +  // blocknum_freelist_head
            t->smallest_never_used_blocknum.b * 16 +  // Array
            4;                                        // 4 for checksum
 }
 
+// The first page holds the location of the translation itself, so it is
+// always in the delta.
+bool block_table::_translation_page_in_delta(struct translation *t,
+                                             int64_t page) {
+    return translation_page_length(t->smallest_never_used_blocknum, page) >
+               0 &&
+           (page == 0 ||
+            (page < t->length_of_dirty_pages && t->dirty_pages[page]));
+}
+
+int64_t block_table::_calculate_delta_size_on_disk(struct translation *t) {
+    int64_t size = 4 +   // format
+                   8 +   // smallest_never_used_blocknum
+                   8 +   // blocknum_freelist_head
+                   16 +  // base
+                   8 +   // number of pages
+                   4;    // checksum
+    for (int64_t page = 0;
+         translation_page_length(t->smallest_never_used_blocknum, page) > 0;
+         page++) {
+        if (_translation_page_in_delta(t, page)) {
+            size += 8 +  // page
+                    translation_page_length(t->smallest_never_used_blocknum,
+                                            page) *
+                        16;
+        }
+    }
+    return size;
+}
+
 // We cannot free the disk space allocated to this blocknum if it is still in
 // use by the given translation table.
 bool block_table::_translation_prevents_freeing(
@@ -474,12 +646,18 @@ void block_table::_realloc_on_disk_internal(BLOCKNUM b,
     }
     t->block_translation[b.b].u.diskoff = allocator_offset;
     *offset = allocator_offset;
+    // A change made for the checkpoint is in inprogress too, so it is only a
+    // change against current's base if inprogress is a delta.
+    if (!for_checkpoint || _inprogress.base.size > 0) {
+        _note_pair_dirty(t, b);
+    }
 
     // Update inprogress btt if appropriate (if called because Pending bit is
     // set).
     if (for_checkpoint) {
         paranoid_invariant(b.b < _inprogress.length_of_array);
         _inprogress.block_translation[b.b] = t->block_translation[b.b];
+        _note_pair_dirty(&_inprogress, b);
     }
 }
 
@@ -587,18 +765,58 @@ void block_table::serialize_translation_to_wbuf(int fd,
             buf[i] = 0;  // fill in the end of the buffer with zeros.
         wbuf_init(w, buf, size_aligned);
     }
+    wbuf_int(w,
+             t->base.size > 0 ? TRANSLATION_FORMAT_DELTA
+                              : TRANSLATION_FORMAT_FULL);
     wbuf_BLOCKNUM(w, t->smallest_never_used_blocknum);
     wbuf_BLOCKNUM(w, t->blocknum_freelist_head);
-    int64_t i;
-    for (i = 0; i < t->smallest_never_used_blocknum.b; i++) {
-        if (0)
-            printf("%s:%d %" PRId64 ",%" PRId64 "\n",
-                   __FILE__,
-                   __LINE__,
-                   t->block_translation[i].u.diskoff,
-                   t->block_translation[i].size);
-        wbuf_DISKOFF(w, t->block_translation[i].u.diskoff);
-        wbuf_DISKOFF(w, t->block_translation[i].size);
+    if (t->base.size > 0) {
+        // Only the pages changed since the base, so the work here is
+        // proportional to the change and not to the size of the dictionary.
+        wbuf_DISKOFF(w, t->base.u.diskoff);
+        wbuf_DISKOFF(w, t->base.size);
+        uint64_t num_pages = 0;
+        int64_t page;
+        for (page = 0;
+             translation_page_length(t->smallest_never_used_blocknum, page) >
+             0;
+             page++) {
+            if (_translation_page_in_delta(t, page)) {
+                num_pages++;
+            }
+        }
+        wbuf_ulonglong(w, num_pages);
+        for (page = 0;
+             translation_page_length(t->smallest_never_used_blocknum, page) >
+             0;
+             page++) {
+            if (!_translation_page_in_delta(t, page)) {
+                continue;
+            }
+            wbuf_ulonglong(w, page);
+            int64_t first = page * blocknums_per_translation_page;
+            int64_t n =
+                translation_page_length(t->smallest_never_used_blocknum, page);
+            for (int64_t i = first; i < first + n; i++) {
+                wbuf_DISKOFF(w, t->block_translation[i].u.diskoff);
+                wbuf_DISKOFF(w, t->block_translation[i].size);
+            }
+        }
+    } else {
+        int64_t i;
+        for (i = 0; i < t->smallest_never_used_blocknum.b; i++) {
+            if (0)
+                printf("%s:%d %" PRId64 ",%" PRId64 "\n",
+                       __FILE__,
+                       __LINE__,
+                       t->block_translation[i].u.diskoff,
+                       t->block_translation[i].size);
+            wbuf_DISKOFF(w, t->block_translation[i].u.diskoff);
+            wbuf_DISKOFF(w, t->block_translation[i].size);
+        }
+        // Current has been tracking its changes against this translation
+        // since the checkpoint began.
+        _current.base = t->block_translation[b.b];
     }
     uint32_t checksum = toku_x1764_finish(&w->checksum);
     wbuf_int(w, checksum);
@@ -673,6 +891,7 @@ void block_table::_allocate_blocknum_unlocked(BLOCKNUM *res, FT ft) {
     // blocknum is not free anymore
     t->block_translation[result.b].u.diskoff = diskoff_unused;
     t->block_translation[result.b].size = 0;
+    _note_pair_dirty(t, result);
     _verify_valid_freeable_blocknum(t, result);
     *res = result;
     ft_set_dirty(ft, false);
@@ -692,6 +911,7 @@ void block_table::_free_blocknum_in_translation(struct translation *t,
     t->block_translation[b.b].size = size_is_free;
     t->block_translation[b.b].u.next_free_blocknum = t->blocknum_freelist_head;
     t->blocknum_freelist_head = b;
+    _note_pair_dirty(t, b);
 }
 
 // Effect: Free a blocknum.
@@ -817,8 +1037,12 @@ void block_table::_dump_translation_internal(FILE *f, struct translation *t) {
         fprintf(
             f, " size_on_disk[%" PRId64 "]", t->block_translation[b.b].size);
         fprintf(f,
-                " location_on_disk[%" PRId64 "]\n",
+                " location_on_disk[%" PRId64 "]",
                 t->block_translation[b.b].u.diskoff);
+        fprintf(f,
+                " base[%" PRId64 " %" PRId64 "]\n",
+                t->base.u.diskoff,
+                t->base.size);
         int64_t i;
         for (i = 0; i < t->length_of_array; i++) {
             fprintf(f,
@@ -883,6 +1107,9 @@ void block_table::destroy(void) {
     toku_free(_current.block_translation);
     toku_free(_inprogress.block_translation);
     toku_free(_checkpointed.block_translation);
+    _free_dirty_pages(&_current);
+    _free_dirty_pages(&_inprogress);
+    _free_dirty_pages(&_checkpointed);
 
     _bt_block_allocator->Destroy();
     delete _bt_block_allocator;
@@ -895,21 +1122,16 @@ int block_table::_translation_deserialize_from_buffer(
     DISKOFF location_on_disk,
     uint64_t size_on_disk,
     // out: buffer with serialized translation
-    unsigned char *translation_buffer) {
+    unsigned char *translation_buffer,
+    uint32_t layout_version,
+    int fd) {
     int r = 0;
     invariant(location_on_disk != 0);
     t->type = TRANSLATION_CHECKPOINTED;
 
     // check the checksum
-    uint32_t x1764 = toku_x1764_memory(translation_buffer, size_on_disk - 4);
-    uint64_t offset = size_on_disk - 4;
-    uint32_t stored_x1764 = toku_dtoh32(*(int *)(translation_buffer + offset));
-    if (x1764 != stored_x1764) {
-        fprintf(stderr,
-                "Translation table checksum failure: calc=0x%08x read=0x%08x\n",
-                x1764,
-                stored_x1764);
-        r = TOKUDB_BAD_CHECKSUM;
+    r = translation_verify_checksum(translation_buffer, size_on_disk);
+    if (r != 0) {
         goto exit;
     }
 
@@ -918,16 +1140,24 @@ int block_table::_translation_deserialize_from_buffer(
     rb.ndone = 0;
     rb.size = size_on_disk - 4;  // 4==checksum
 
-    t->smallest_never_used_blocknum = rbuf_blocknum(&rb);
-    t->length_of_array = t->smallest_never_used_blocknum.b;
-    invariant(t->smallest_never_used_blocknum.b >= RESERVED_BLOCKNUMS);
-    t->blocknum_freelist_head = rbuf_blocknum(&rb);
-    XMALLOC_N(t->length_of_array, t->block_translation);
-    for (int64_t i = 0; i < t->length_of_array; i++) {
-        t->block_translation[i].u.diskoff = rbuf_DISKOFF(&rb);
-        t->block_translation[i].size = rbuf_DISKOFF(&rb);
+    uint32_t format;
+    format = TRANSLATION_FORMAT_FULL;
+    if (layout_version >= FT_LAYOUT_VERSION_32) {
+        format = rbuf_int(&rb);
     }
-    invariant(_calculate_size_on_disk(t) == (int64_t)size_on_disk);
+    if (format == TRANSLATION_FORMAT_FULL) {
+        _translation_deserialize_full(t, &rb);
+    } else if (format == TRANSLATION_FORMAT_DELTA) {
+        r = _translation_apply_delta(t, &rb, fd);
+        if (r != 0) {
+            goto exit;
+        }
+    } else {
+        fprintf(stderr, "Unknown translation table format %u\n", format);
+        r = EINVAL;
+        goto exit;
+    }
+    invariant(rb.ndone == rb.size);
     invariant(t->block_translation[RESERVED_BLOCKNUM_TRANSLATION].size ==
               (int64_t)size_on_disk);
     invariant(t->block_translation[RESERVED_BLOCKNUM_TRANSLATION].u.diskoff ==
@@ -937,6 +1167,106 @@ exit:
     return r;
 }
 
+void block_table::_translation_deserialize_full(struct translation *t,
+                                                struct rbuf *rb) {
+    t->smallest_never_used_blocknum = rbuf_blocknum(rb);
+    t->length_of_array = t->smallest_never_used_blocknum.b;
+    invariant(t->smallest_never_used_blocknum.b >= RESERVED_BLOCKNUMS);
+    t->blocknum_freelist_head = rbuf_blocknum(rb);
+    XMALLOC_N(t->length_of_array, t->block_translation);
+    for (int64_t i = 0; i < t->length_of_array; i++) {
+        t->block_translation[i].u.diskoff = rbuf_DISKOFF(rb);
+        t->block_translation[i].size = rbuf_DISKOFF(rb);
+    }
+}
+
+// Read the full translation the delta was written against, then overwrite
+// the pages the delta holds.  The pages are noted in t->dirty_pages.
+int block_table::_translation_apply_delta(struct translation *t,
+                                          struct rbuf *rb,
+                                          int fd) {
+    int r = 0;
+    BLOCKNUM smallest_never_used_blocknum = rbuf_blocknum(rb);
+    BLOCKNUM blocknum_freelist_head = rbuf_blocknum(rb);
+    t->base.u.diskoff = rbuf_DISKOFF(rb);
+    t->base.size = rbuf_DISKOFF(rb);
+    invariant(t->base.u.diskoff > 0);
+    invariant(t->base.size > 0);
+
+    {
+        size_t size_to_read = roundup_to_multiple(512, t->base.size);
+        unsigned char *XMALLOC_N_ALIGNED(512, size_to_read, base_buffer);
+        ssize_t readsz =
+            toku_os_pread(fd, base_buffer, size_to_read, t->base.u.diskoff);
+        invariant(readsz >= t->base.size);
+        r = translation_verify_checksum(base_buffer, t->base.size);
+        if (r == 0) {
+            struct rbuf base_rb;
+            base_rb.buf = base_buffer;
+            base_rb.ndone = 0;
+            base_rb.size = t->base.size - 4;  // 4==checksum
+            uint32_t format = rbuf_int(&base_rb);
+            if (format == TRANSLATION_FORMAT_FULL) {
+                _translation_deserialize_full(t, &base_rb);
+                invariant(base_rb.ndone == base_rb.size);
+            } else {
+                fprintf(stderr,
+                        "Translation table base has format %u\n",
+                        format);
+                r = EINVAL;
+            }
+        }
+        toku_free(base_buffer);
+        if (r != 0) {
+            goto exit;
+        }
+    }
+
+    {
+        // Blocknums are only ever given back by rewriting the translation in
+        // full, so a delta never shrinks its base.
+        BLOCKNUM base_smallest_never_used_blocknum =
+            t->smallest_never_used_blocknum;
+        invariant(smallest_never_used_blocknum.b >=
+                  base_smallest_never_used_blocknum.b);
+        XREALLOC_N(smallest_never_used_blocknum.b, t->block_translation);
+        t->length_of_array = smallest_never_used_blocknum.b;
+        t->smallest_never_used_blocknum = smallest_never_used_blocknum;
+        t->blocknum_freelist_head = blocknum_freelist_head;
+
+        XCALLOC_N(1, t->dirty_pages);
+        t->length_of_dirty_pages = 1;
+        uint64_t num_pages = rbuf_ulonglong(rb);
+        for (uint64_t p = 0; p < num_pages; p++) {
+            int64_t page = rbuf_ulonglong(rb);
+            int64_t n =
+                translation_page_length(t->smallest_never_used_blocknum, page);
+            invariant(n > 0);
+            int64_t first = page * blocknums_per_translation_page;
+            for (int64_t i = first; i < first + n; i++) {
+                t->block_translation[i].u.diskoff = rbuf_DISKOFF(rb);
+                t->block_translation[i].size = rbuf_DISKOFF(rb);
+            }
+            _note_pair_dirty(t, make_blocknum(first));
+        }
+
+        // Every blocknum allocated since the base must have been in the delta.
+        if (smallest_never_used_blocknum.b >
+            base_smallest_never_used_blocknum.b) {
+            for (int64_t page = base_smallest_never_used_blocknum.b /
+                                blocknums_per_translation_page;
+                 translation_page_length(t->smallest_never_used_blocknum,
+                                         page) > 0;
+                 page++) {
+                invariant(_translation_page_in_delta(t, page));
+            }
+        }
+    }
+
+exit:
+    return r;
+}
+
 int block_table::iterate(enum translation_type type,
                          BLOCKTABLE_CALLBACK f,
                          void *extra,
@@ -1007,6 +1337,15 @@ void block_table::internal_fragmentation(int64_t *total_sizep,
     frag_extra info = {0, 0};
     int r = iterate(TRANSLATION_CHECKPOINTED, frag_helper, &info, false, true);
     invariant_zero(r);
+    _mutex_lock();
+    struct block_translation_pair base = _checkpointed.base;
+    _mutex_unlock();
+    if (base.size > 0) {
+        frag_helper(make_blocknum(RESERVED_BLOCKNUM_TRANSLATION),
+                    base.size,
+                    base.u.diskoff,
+                    &info);
+    }
 
     if (total_sizep)
         *total_sizep = info.total_space;
@@ -1088,6 +1427,31 @@ void block_table::get_fragmentation_unlocked(TOKU_DB_FRAGMENTATION report) {
         }
     }
 
+    // The full translations that deltas are written against are in no
+    // translation's array.  Count each once, unless it is also the
+    // checkpointed or inprogress translation (counted above).
+    struct block_translation_pair *bases[] = {
+        &current->base, &checkpointed->base, &inprogress->base};
+    for (int i = 0; i < 3; i++) {
+        struct block_translation_pair *base = bases[i];
+        bool counted = base->size == 0;
+        for (int j = 0; !counted && j < i; j++) {
+            counted = bases[j]->size > 0 &&
+                      bases[j]->u.diskoff == base->u.diskoff;
+        }
+        struct translation *translations[] = {checkpointed, inprogress};
+        for (int j = 0; !counted && j < 2; j++) {
+            struct translation *t = translations[j];
+            counted = t->length_of_array > RESERVED_BLOCKNUM_TRANSLATION &&
+                      t->block_translation[RESERVED_BLOCKNUM_TRANSLATION]
+                              .u.diskoff == base->u.diskoff;
+        }
+        if (!counted) {
+            report->checkpoint_bytes_additional += base->size;
+            report->checkpoint_blocks_additional++;
+        }
+    }
+
     _bt_block_allocator->UnusedStatistics(report);
 }
 
@@ -62,6 +62,12 @@ enum {
     RESERVED_BLOCKNUMS
 };
 
+// First field of a translation on disk since FT_LAYOUT_VERSION_32.
+enum {
+    TRANSLATION_FORMAT_FULL = 0,
+    TRANSLATION_FORMAT_DELTA = 1
+};
+
 typedef int (*BLOCKTABLE_CALLBACK)(BLOCKNUM b,
                                    int64_t size,
                                    int64_t address,
@@ -110,7 +116,8 @@ class block_table {
     int create_from_buffer(int fd,
                            DISKOFF location_on_disk,
                            DISKOFF size_on_disk,
-                           unsigned char *translation_buffer);
+                           unsigned char *translation_buffer,
+                           uint32_t layout_version);
 
     void destroy();
 
@@ -194,10 +201,14 @@ class block_table {
     //       size_on_disk
     //       location_on_disk
     //   In block translation table (in order):
+    //       format (full or delta, since FT_LAYOUT_VERSION_32)
     //       smallest_never_used_blocknum
     //       blocknum_freelist_head
     //       array
     //       a checksum
+    //   A delta replaces the array with the location of a full translation
+    //   (its base) followed by the pages of the array that changed since the
+    //   base was written, each preceded by its page number.
     struct translation {
         enum translation_type type;
 
@@ -214,6 +225,16 @@ class block_table {
         // block_translation[RESERVED_BLOCKNUM_TRANSLATION].size
         // location_on is stored in
         // block_translation[RESERVED_BLOCKNUM_TRANSLATION].u.diskoff
+
+        // The full translation on disk that this one is (or will be) written
+        // as a delta against.  size is 0 if there is none.
+        struct block_translation_pair base;
+
+        // One byte per page of the array, set if the page changed since base
+        // was written.  nullptr if changes are not being tracked.
+        uint8_t *dirty_pages;
+        int64_t length_of_dirty_pages;
+        int64_t num_dirty_pages;
     };
 
     void _create_internal();
@@ -222,18 +243,31 @@ class block_table {
         DISKOFF location_on_disk,  // location of translation_buffer
         uint64_t size_on_disk,
         unsigned char *
-            translation_buffer);  // buffer with serialized translation
+            translation_buffer,  // buffer with serialized translation
+        uint32_t layout_version,
+        int fd);
+    void _translation_deserialize_full(struct translation *t,
+                                       struct rbuf *rb);
+    int _translation_apply_delta(struct translation *t,
+                                 struct rbuf *rb,
+                                 int fd);
 
     void _copy_translation(struct translation *dst,
                            struct translation *src,
                            enum translation_type newtype);
-    void _maybe_optimize_translation(struct translation *t);
+    bool _maybe_optimize_translation(struct translation *t);
+    void _note_pair_dirty(struct translation *t, BLOCKNUM b);
+    void _free_dirty_pages(struct translation *t);
+    bool _is_translation_base(DISKOFF diskoff);
     void _maybe_expand_translation(struct translation *t);
     bool _translation_prevents_freeing(struct translation *t,
                                        BLOCKNUM b,
                                        struct block_translation_pair *old_pair);
     void _free_blocknum_in_translation(struct translation *t, BLOCKNUM b);
     int64_t _calculate_size_on_disk(struct translation *t);
+    int64_t _calculate_full_size_on_disk(struct translation *t);
+    int64_t _calculate_delta_size_on_disk(struct translation *t);
+    bool _translation_page_in_delta(struct translation *t, int64_t page);
     bool _pair_is_unallocated(struct block_translation_pair *pair);
     void _alloc_inprogress_translation_on_disk_unlocked();
     void _dump_translation_internal(FILE *f, struct translation *t);
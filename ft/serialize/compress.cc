@@ -37,15 +37,19 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
 
 #include <toku_portability.h>
+#include <toku_race_tools.h>
+#include <toku_time.h>
 #include <util/scoped_malloc.h>
 
 #include <zlib.h>
 #include <lzma.h>
 #include <snappy.h>
 #include <zstd.h>
+#include <zdict.h>
 
 #include "compress.h"
 #include "memory.h"
+#include "ft/ft-status.h"
 #include "quicklz.h"
 #include "toku_assert.h"
 
@@ -61,6 +65,9 @@ normalize_compression_method(enum toku_compression_method method)
         return TOKU_QUICKLZ_METHOD;
     case TOKU_SMALL_COMPRESSION_METHOD:
         return TOKU_LZMA_METHOD;
+    // without a dictionary at hand this is plain zstd
+    case TOKU_ZSTD_DICTIONARY_METHOD:
+        return TOKU_ZSTD_METHOD;
     default:
         return method; // everything else is fine
     }
@@ -69,6 +76,19 @@ normalize_compression_method(enum toku_compression_method method)
 size_t toku_compress_bound (enum toku_compression_method a, size_t size)
 // See compress.h for the specification of this function.
 {
+    if (a == TOKU_ADAPTIVE_COMPRESSION_METHOD) {
+        // the largest bound of the methods adaptive compression picks from
+        size_t bound = toku_compress_bound(TOKU_NO_COMPRESSION, size);
+        const enum toku_compression_method candidates[] = { TOKU_SNAPPY_METHOD, TOKU_ZSTD_METHOD, TOKU_ZLIB_METHOD };
+        for (size_t i = 0; i < sizeof candidates / sizeof candidates[0]; i++) {
+            bound = std::max(bound, toku_compress_bound(candidates[i], size));
+        }
+        return bound;
+    }
+    if (a == TOKU_ZSTD_DICTIONARY_METHOD) {
+        // room for the dictionary id after the header byte
+        return 1 + 4 + ZSTD_compressBound(size);
+    }
     a = normalize_compression_method(a);
     switch (a) {
     case TOKU_NO_COMPRESSION:
@@ -92,11 +112,26 @@ size_t toku_compress_bound (enum toku_compression_method a, size_t size)
     assert(0); return 0;
 }
 
-void toku_compress (enum toku_compression_method a,
-                    // the following types and naming conventions come from zlib.h
-                    Bytef       *dest,   uLongf *destLen,
-                    const Bytef *source, uLong   sourceLen)
-// See compress.h for the specification of this function.
+static void zstd_compress (int compression_level,
+                           Bytef       *dest,   uLongf *destLen,
+                           const Bytef *source, uLong   sourceLen)
+{
+    if (sourceLen == 0) {
+        // requires at least one byte, so we handle this ourselves
+        assert(1 <= *destLen);
+        *destLen = 1;
+    } else {
+        size_t const actual_len = ZSTD_compress((void*)(dest + 1), *destLen - 1, source, sourceLen, compression_level);
+        assert(!ZSTD_isError(actual_len));
+        *destLen = actual_len + 1;
+    }
+    // Fill in that first byte.  The level is not needed to decompress.
+    dest[0] = TOKU_ZSTD_METHOD;
+}
+
+static void compress_with_method (enum toku_compression_method a,
+                                  Bytef       *dest,   uLongf *destLen,
+                                  const Bytef *source, uLong   sourceLen)
 {
     static const int zlib_compression_level = 5;
     static const int zlib_without_checksum_windowbits = -15;
@@ -181,22 +216,10 @@ void toku_compress (enum toku_compression_method a,
         dest[0] = TOKU_SNAPPY_METHOD;
         return;
     }
-    case TOKU_ZSTD_METHOD: {
-         if (sourceLen == 0) {
-             // requires at least one byte, so we handle this ourselves
-             assert(1 <= *destLen);
-             *destLen = 1;
-         } else {
-             // zstd with default compression level 1
-             int compression_level = 1;
-             size_t const actual_len = ZSTD_compress((void*)(dest + 1), *destLen - 1, source, sourceLen, compression_level);
-             assert(!ZSTD_isError(actual_len));
-             *destLen = actual_len + 1;
-         }
-         // Fill in that first byte
-         dest[0] = TOKU_ZSTD_METHOD;
-         return;
-     }
+    case TOKU_ZSTD_METHOD:
+        // zstd with default compression level 1
+        zstd_compress(1, dest, destLen, source, sourceLen);
+        return;
     default:
         break;
     }
@@ -204,9 +227,231 @@ void toku_compress (enum toku_compression_method a,
     assert(0);
 }
 
+// Adaptive compression (TOKU_ADAPTIVE_COMPRESSION_METHOD) picks a method for
+// each sub block on its own.  It compresses a few samples of the sub block
+// with snappy, which is cheap, and the better they compress the further up
+// this ladder it goes: data that does not shrink is stored as is, and the
+// most compressible data is compressed hardest.  Since the method is in the
+// header byte, decompression needs no help.
+enum adaptive_rung {
+    ADAPTIVE_NONE = 0,
+    ADAPTIVE_SNAPPY,
+    ADAPTIVE_ZSTD_FAST,
+    ADAPTIVE_ZLIB,          // only reached by stepping down from ADAPTIVE_ZSTD_STRONG
+    ADAPTIVE_ZSTD_STRONG,
+    ADAPTIVE_NUM_RUNGS
+};
+
+// Sampled snappy compression ratios below which we stay on a lower rung.
+static const double adaptive_incompressible_ratio = 1.1;
+static const double adaptive_snappy_ratio = 1.5;
+static const double adaptive_zstd_fast_ratio = 3.0;
+static const int adaptive_zstd_strong_level = 6;
+
+static const size_t adaptive_sample_size = 4096;
+static const int adaptive_num_samples = 4;
+
+// The measured cost of each rung in nanoseconds per KB of input, as a moving
+// average.  Zero until measured.  Updated racily, which is fine for a hint.
+static uint64_t adaptive_ns_per_kb[ADAPTIVE_NUM_RUNGS];
+
+// Rungs that compress slower than this many MB/s are skipped, going down the
+// ladder until one is fast enough.  Zero means no limit.
+static uint64_t adaptive_min_throughput = 0;
+
+void toku_compress_set_adaptive_min_throughput(uint64_t mb_per_sec) {
+    toku_unsafe_set(&adaptive_min_throughput, mb_per_sec);
+}
+
+static double adaptive_sample_ratio(const Bytef *source, uLong sourceLen) {
+    size_t sample_len = adaptive_sample_size;
+    int num_samples = adaptive_num_samples;
+    if (sourceLen <= sample_len * num_samples) {
+        sample_len = sourceLen;
+        num_samples = 1;
+    }
+    toku::scoped_malloc compressed_buf(snappy::MaxCompressedLength(sample_len));
+    char *compressed = reinterpret_cast<char *>(compressed_buf.get());
+    size_t total_compressed = 0;
+    for (int i = 0; i < num_samples; i++) {
+        // spread the samples evenly over the source
+        size_t offset = (sourceLen - sample_len) * i / std::max(num_samples - 1, 1);
+        size_t compressed_len;
+        snappy::RawCompress((const char *) source + offset, sample_len, compressed, &compressed_len);
+        total_compressed += compressed_len;
+    }
+    return (double) (sample_len * num_samples) / std::max(total_compressed, (size_t) 1);
+}
+
+static bool adaptive_rung_is_fast_enough(int rung) {
+    uint64_t min_throughput = toku_unsafe_fetch(&adaptive_min_throughput);
+    uint64_t ns_per_kb = toku_unsafe_fetch(&adaptive_ns_per_kb[rung]);
+    if (min_throughput == 0 || ns_per_kb == 0) {
+        return true;
+    }
+    // MB/s = (1e9 / 1024) / ns_per_kb
+    return (1000000000ULL / 1024) / ns_per_kb >= min_throughput;
+}
+
+static int adaptive_choose_rung(const Bytef *source, uLong sourceLen) {
+    if (sourceLen == 0) {
+        return ADAPTIVE_NONE;
+    }
+    double ratio = adaptive_sample_ratio(source, sourceLen);
+    int rung;
+    if (ratio < adaptive_incompressible_ratio) {
+        rung = ADAPTIVE_NONE;
+    } else if (ratio < adaptive_snappy_ratio) {
+        rung = ADAPTIVE_SNAPPY;
+    } else if (ratio < adaptive_zstd_fast_ratio) {
+        rung = ADAPTIVE_ZSTD_FAST;
+    } else {
+        rung = ADAPTIVE_ZSTD_STRONG;
+    }
+    while (rung > ADAPTIVE_NONE && !adaptive_rung_is_fast_enough(rung)) {
+        rung--;
+    }
+    return rung;
+}
+
+static void compress_adaptively (Bytef       *dest,   uLongf *destLen,
+                                 const Bytef *source, uLong   sourceLen)
+{
+    int rung = adaptive_choose_rung(source, sourceLen);
+    tokutime_t t0 = toku_time_now();
+    switch (rung) {
+    case ADAPTIVE_NONE:
+        compress_with_method(TOKU_NO_COMPRESSION, dest, destLen, source, sourceLen);
+        return;
+    case ADAPTIVE_SNAPPY:
+        compress_with_method(TOKU_SNAPPY_METHOD, dest, destLen, source, sourceLen);
+        break;
+    case ADAPTIVE_ZSTD_FAST:
+        zstd_compress(1, dest, destLen, source, sourceLen);
+        break;
+    case ADAPTIVE_ZLIB:
+        compress_with_method(TOKU_ZLIB_METHOD, dest, destLen, source, sourceLen);
+        break;
+    case ADAPTIVE_ZSTD_STRONG:
+        zstd_compress(adaptive_zstd_strong_level, dest, destLen, source, sourceLen);
+        break;
+    default:
+        assert(0);
+    }
+    // small inputs make for noisy measurements
+    if (sourceLen >= adaptive_sample_size) {
+        double seconds = tokutime_to_seconds(toku_time_now() - t0);
+        uint64_t ns_per_kb = std::max((uint64_t) (seconds * 1e9 * 1024 / sourceLen), (uint64_t) 1);
+        uint64_t old_ns_per_kb = toku_unsafe_fetch(&adaptive_ns_per_kb[rung]);
+        if (old_ns_per_kb != 0) {
+            ns_per_kb = (old_ns_per_kb * 7 + ns_per_kb) / 8;
+        }
+        toku_unsafe_set(&adaptive_ns_per_kb[rung], ns_per_kb);
+    }
+}
+
+// Count the bytes going into and coming out of each method actually used.
+static void update_compression_status(const Bytef *dest, uLongf destLen, uLong sourceLen) {
+    switch (dest[0] & 0xF) {
+    case TOKU_NO_COMPRESSION:
+        FT_STATUS_INC(FT_COMPRESS_BYTES_IN_NONE, sourceLen);
+        FT_STATUS_INC(FT_COMPRESS_BYTES_OUT_NONE, destLen);
+        break;
+    case TOKU_SNAPPY_METHOD:
+        FT_STATUS_INC(FT_COMPRESS_BYTES_IN_SNAPPY, sourceLen);
+        FT_STATUS_INC(FT_COMPRESS_BYTES_OUT_SNAPPY, destLen);
+        break;
+    case TOKU_ZSTD_METHOD:
+        FT_STATUS_INC(FT_COMPRESS_BYTES_IN_ZSTD, sourceLen);
+        FT_STATUS_INC(FT_COMPRESS_BYTES_OUT_ZSTD, destLen);
+        break;
+    case TOKU_ZLIB_METHOD:
+    case TOKU_ZLIB_WITHOUT_CHECKSUM_METHOD:
+        FT_STATUS_INC(FT_COMPRESS_BYTES_IN_ZLIB, sourceLen);
+        FT_STATUS_INC(FT_COMPRESS_BYTES_OUT_ZLIB, destLen);
+        break;
+    case TOKU_QUICKLZ_METHOD:
+        FT_STATUS_INC(FT_COMPRESS_BYTES_IN_QUICKLZ, sourceLen);
+        FT_STATUS_INC(FT_COMPRESS_BYTES_OUT_QUICKLZ, destLen);
+        break;
+    case TOKU_LZMA_METHOD:
+        FT_STATUS_INC(FT_COMPRESS_BYTES_IN_LZMA, sourceLen);
+        FT_STATUS_INC(FT_COMPRESS_BYTES_OUT_LZMA, destLen);
+        break;
+    }
+}
+
+void toku_compress (enum toku_compression_method a,
+                    // the following types and naming conventions come from zlib.h
+                    Bytef       *dest,   uLongf *destLen,
+                    const Bytef *source, uLong   sourceLen)
+// See compress.h for the specification of this function.
+{
+    if (a == TOKU_ADAPTIVE_COMPRESSION_METHOD) {
+        assert(sourceLen < (1LL << 32));
+        compress_adaptively(dest, destLen, source, sourceLen);
+    } else {
+        compress_with_method(a, dest, destLen, source, sourceLen);
+    }
+    update_compression_status(dest, *destLen, sourceLen);
+}
+
+// Zstd data compressed against a dictionary has this in the high-order nibble
+// of the header byte, followed by the dictionary id.
+static const int zstd_dictionary_flag = 1;
+
+void toku_compress_with_dictionary (enum toku_compression_method a,
+                                    const struct toku_compression_dictionary *dict,
+                                    Bytef       *dest,   uLongf *destLen,
+                                    const Bytef *source, uLong   sourceLen)
+// See compress.h for the specification of this function.
+{
+    if (a != TOKU_ZSTD_DICTIONARY_METHOD || dict == nullptr || sourceLen == 0) {
+        toku_compress(a, dest, destLen, source, sourceLen);
+        return;
+    }
+    assert(sourceLen < (1LL << 32));
+    assert(*destLen >= 5);
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    assert(cctx != nullptr);
+    // Loading a dictionary this small costs little, and unlike a digested
+    // ZSTD_CDict it lets zstd pick parameters for the size of the source.
+    // Same compression level as toku_compress.
+    size_t const actual_len = ZSTD_compress_usingDict(cctx, (void *)(dest + 5), *destLen - 5,
+                                                      source, sourceLen, dict->data, dict->size, 1);
+    assert(!ZSTD_isError(actual_len));
+    ZSTD_freeCCtx(cctx);
+    dest[0] = TOKU_ZSTD_METHOD + (zstd_dictionary_flag << 4);
+    uint32_t id = toku_htod32(dict->id);
+    memcpy(dest + 1, &id, sizeof id);
+    *destLen = actual_len + 5;
+    update_compression_status(dest, *destLen, sourceLen);
+}
+
+uint32_t toku_decompress_dictionary_id (const Bytef *source, uLongf sourceLen)
+// See compress.h for the specification of this function.
+{
+    assert(sourceLen >= 1);
+    if ((source[0] & 0xF) != TOKU_ZSTD_METHOD || (source[0] >> 4) != zstd_dictionary_flag) {
+        return 0;
+    }
+    assert(sourceLen >= 5);
+    uint32_t id;
+    memcpy(&id, source + 1, sizeof id);
+    return toku_dtoh32(id);
+}
+
 void toku_decompress (Bytef       *dest,   uLongf destLen,
                       const Bytef *source, uLongf sourceLen)
 // See compress.h for the specification of this function.
+{
+    toku_decompress_with_dictionary(dest, destLen, source, sourceLen, nullptr);
+}
+
+void toku_decompress_with_dictionary (Bytef       *dest,   uLongf destLen,
+                                      const Bytef *source, uLongf sourceLen,
+                                      const struct toku_compression_dictionary *dict)
+// See compress.h for the specification of this function.
 {
     assert(sourceLen>=1); // need at least one byte for the RFC header.
     switch (source[0] & 0xF) {
@@ -273,7 +518,17 @@ void toku_decompress (Bytef       *dest,   uLongf destLen,
         return;
     }
     case TOKU_ZSTD_METHOD: {
-        if (sourceLen > 1 ) {
+        if ((source[0] >> 4) == zstd_dictionary_flag) {
+            assert(dict != nullptr);
+            assert(dict->id == toku_decompress_dictionary_id(source, sourceLen));
+            ZSTD_DCtx *dctx = ZSTD_createDCtx();
+            assert(dctx != nullptr);
+            size_t const actual_len = ZSTD_decompress_usingDDict(dctx, (void *)dest, destLen,
+                                                                 (void *)(source + 5), sourceLen - 5, dict->ddict);
+            assert(!ZSTD_isError(actual_len));
+            assert(actual_len == destLen);
+            ZSTD_freeDCtx(dctx);
+        } else if (sourceLen > 1 ) {
             size_t const actual_len = ZSTD_decompress((void*)dest, destLen, (void*)(source + 1), sourceLen - 1);
             assert(!ZSTD_isError(actual_len));
         } else {
@@ -285,3 +540,103 @@ void toku_decompress (Bytef       *dest,   uLongf destLen,
     // default fall through to error.
     assert(0);
 }
+
+struct toku_compression_dictionary *toku_compression_dictionary_create(uint32_t id, const void *data, uint32_t size)
+// See compress.h for the specification of this function.
+{
+    assert(id != 0);
+    struct toku_compression_dictionary *XCALLOC(dict);
+    dict->id = id;
+    dict->size = size;
+    dict->data = toku_xmemdup(data, size);
+    dict->ddict = ZSTD_createDDict(dict->data, size);
+    assert(dict->ddict != nullptr);
+    return dict;
+}
+
+void toku_compression_dictionary_destroy(struct toku_compression_dictionary *dict) {
+    ZSTD_freeDDict(dict->ddict);
+    toku_free(dict->data);
+    toku_free(dict);
+}
+
+// The trainer keeps a reservoir sample of fixed size chunks of everything it
+// is offered.  zstd wants a few thousand samples adding up to about a hundred
+// times the size of the dictionary.
+static const size_t trainer_chunk_size = 512;
+static const size_t trainer_max_chunks = 512;
+// Training with less than this much data is not worth it.
+static const size_t trainer_min_chunks = 64;
+
+struct toku_compression_dictionary_trainer {
+    char *chunks;          // trainer_max_chunks chunks of trainer_chunk_size bytes
+    size_t *chunk_sizes;
+    size_t n_chunks;       // in the reservoir
+    uint64_t n_offered;    // chunks ever offered
+    uint64_t random_state;
+};
+
+struct toku_compression_dictionary_trainer *toku_compression_dictionary_trainer_create(void) {
+    struct toku_compression_dictionary_trainer *XCALLOC(trainer);
+    XMALLOC_N(trainer_max_chunks * trainer_chunk_size, trainer->chunks);
+    XMALLOC_N(trainer_max_chunks, trainer->chunk_sizes);
+    trainer->random_state = 0x9e3779b97f4a7c15ULL;
+    return trainer;
+}
+
+static uint64_t trainer_random(struct toku_compression_dictionary_trainer *trainer) {
+    // xorshift64
+    uint64_t x = trainer->random_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    trainer->random_state = x;
+    return x;
+}
+
+void toku_compression_dictionary_trainer_add(struct toku_compression_dictionary_trainer *trainer, const void *buf, size_t len) {
+    const char *CAST_FROM_VOIDP(p, buf);
+    for (size_t off = 0; off < len; off += trainer_chunk_size) {
+        size_t chunk_len = len - off < trainer_chunk_size ? len - off : trainer_chunk_size;
+        size_t slot;
+        if (trainer->n_chunks < trainer_max_chunks) {
+            slot = trainer->n_chunks++;
+        } else {
+            slot = trainer_random(trainer) % (trainer->n_offered + 1);
+        }
+        trainer->n_offered++;
+        if (slot < trainer_max_chunks) {
+            memcpy(trainer->chunks + slot * trainer_chunk_size, p + off, chunk_len);
+            trainer->chunk_sizes[slot] = chunk_len;
+        }
+    }
+}
+
+struct toku_compression_dictionary *toku_compression_dictionary_trainer_finish(struct toku_compression_dictionary_trainer *trainer, uint32_t id) {
+    if (trainer->n_chunks < trainer_min_chunks) {
+        return nullptr;
+    }
+    // ZDICT wants the samples contiguous
+    size_t total = 0;
+    for (size_t i = 0; i < trainer->n_chunks; i++) {
+        if (total != i * trainer_chunk_size) {
+            memmove(trainer->chunks + total, trainer->chunks + i * trainer_chunk_size, trainer->chunk_sizes[i]);
+        }
+        total += trainer->chunk_sizes[i];
+    }
+    char buf[TOKU_COMPRESSION_DICTIONARY_MAX_SIZE];
+    size_t size = ZDICT_trainFromBuffer(buf, sizeof buf, trainer->chunks, trainer->chunk_sizes, trainer->n_chunks);
+    // the reservoir is no longer in chunk order
+    trainer->n_chunks = 0;
+    trainer->n_offered = 0;
+    if (ZDICT_isError(size)) {
+        return nullptr;
+    }
+    return toku_compression_dictionary_create(id, buf, size);
+}
+
+void toku_compression_dictionary_trainer_destroy(struct toku_compression_dictionary_trainer *trainer) {
+    toku_free(trainer->chunks);
+    toku_free(trainer->chunk_sizes);
+    toku_free(trainer);
+}
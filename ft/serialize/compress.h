@@ -70,9 +70,65 @@ void toku_compress (enum toku_compression_method a,
 //     We also use zlib's ugly camel case convention for destLen and sourceLen.
 //     Unlike zlib, we return no error codes.  Instead, we require that the data be OK and the size of the buffers is OK, and assert if there's a problem.
 
+void toku_compress_set_adaptive_min_throughput(uint64_t mb_per_sec);
+// Effect: Make TOKU_ADAPTIVE_COMPRESSION_METHOD avoid methods it has measured compressing slower than
+//  mb_per_sec MB/s.  Zero (the default) means no limit.
+
 void toku_decompress (Bytef       *dest,   uLongf destLen,
 		      const Bytef *source, uLongf sourceLen);
 // Effect: Decompress source (length sourceLen) into dest (length destLen)
 //  This function can decompress data compressed with either zlib or quicklz compression methods (calling toku_compress(), which puts an appropriate header on so we know which it is.)
 // Requires: destLen is equal to the actual decompressed size of the data.
 // Requires: The source must have been properly compressed.
+
+// Dictionary compression.
+// A dictionary is trained by hot optimize from the leaves of one FT and kept in
+// that FT's header.  An FT whose compression method is TOKU_ZSTD_DICTIONARY_METHOD
+// compresses its leaf partitions with zstd against its current dictionary.  The
+// compressed bytes name the dictionary by id, so partitions written against an
+// older dictionary remain readable while the FT still knows it.
+struct toku_compression_dictionary {
+    uint32_t id;       // nonzero, unique within one FT
+    uint32_t size;
+    void *data;
+    struct ZSTD_DDict_s *ddict;
+    // the next older dictionary known to the same FT (see struct ft)
+    struct toku_compression_dictionary *next;
+};
+
+// The largest dictionary we train.  An FT header holds two of them.
+static const uint32_t TOKU_COMPRESSION_DICTIONARY_MAX_SIZE = 1536;
+
+struct toku_compression_dictionary *toku_compression_dictionary_create(uint32_t id, const void *data, uint32_t size);
+// Effect: Make a dictionary with the given id out of a copy of data, ready for decompression.
+
+void toku_compression_dictionary_destroy(struct toku_compression_dictionary *dict);
+
+struct toku_compression_dictionary_trainer;
+
+struct toku_compression_dictionary_trainer *toku_compression_dictionary_trainer_create(void);
+
+void toku_compression_dictionary_trainer_add(struct toku_compression_dictionary_trainer *trainer, const void *buf, size_t len);
+// Effect: Offer the uncompressed contents of a partition as training data.
+//  A bounded, uniformly chosen sample of everything offered is kept.
+
+struct toku_compression_dictionary *toku_compression_dictionary_trainer_finish(struct toku_compression_dictionary_trainer *trainer, uint32_t id);
+// Effect: Train a dictionary of at most TOKU_COMPRESSION_DICTIONARY_MAX_SIZE bytes from the samples.
+// Returns NULL if there was too little training data.
+
+void toku_compression_dictionary_trainer_destroy(struct toku_compression_dictionary_trainer *trainer);
+
+void toku_compress_with_dictionary (enum toku_compression_method a,
+                                    const struct toku_compression_dictionary *dict,
+                                    Bytef       *dest,   uLongf *destLen,
+                                    const Bytef *source, uLong   sourceLen);
+// Effect: Same as toku_compress, except that if A is TOKU_ZSTD_DICTIONARY_METHOD and DICT is not NULL,
+//  compress against DICT.
+
+uint32_t toku_decompress_dictionary_id (const Bytef *source, uLongf sourceLen);
+// Effect: Return the id of the dictionary needed to decompress source, or 0 if it was compressed without one.
+
+void toku_decompress_with_dictionary (Bytef       *dest,   uLongf destLen,
+                                      const Bytef *source, uLongf sourceLen,
+                                      const struct toku_compression_dictionary *dict);
+// Effect: Same as toku_decompress, for source compressed against DICT (which may be NULL if it was not).
@@ -39,6 +39,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/node.h"
 #include "ft/ft-internal.h"
 #include "ft/serialize/ft_node-serialize.h"
+#include "util/checksum.h"
 
 /*
  * ft-node-deserialize.c -
@@ -137,11 +138,11 @@ allocate_and_read_partition_offsets(FTNODE node, struct rbuf *rb, FTNODE_DISK_DA
 // and the checksum of the buffer itself.  If these are NOT
 // equal, this function returns an appropriate error code.
 int
-check_node_info_checksum(struct rbuf *rb)
+check_node_info_checksum(struct rbuf *rb, enum toku_checksum_method checksum_method)
 {
     int r = 0;
     // Verify checksum of header stored.
-    uint32_t checksum = toku_x1764_memory(rb->buf, rb->ndone);
+    uint32_t checksum = toku_checksum_memory(checksum_method, rb->buf, rb->ndone);
     uint32_t stored_checksum = rbuf_int(rb);
 
     if (stored_checksum != checksum) {
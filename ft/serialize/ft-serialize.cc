@@ -43,6 +43,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/serialize/block_table.h"
 #include "ft/serialize/compress.h"
 #include "ft/serialize/ft-serialize.h"
+#include "util/checksum.h"
 
 // not version-sensitive because we only serialize a descriptor using the current layout_version
 uint32_t
@@ -224,7 +225,8 @@ int deserialize_ft_versioned(int fd, struct rbuf *rb, FT *ftp, uint32_t version)
         r = ft->blocktable.create_from_buffer(fd,
                                               translation_address_on_disk,
                                               translation_size_on_disk,
-                                              tbuf);
+                                              tbuf,
+                                              ft->layout_version_read_from_disk);
         toku_free(tbuf);
         if (r != 0) {
             goto exit;
@@ -330,6 +332,37 @@ int deserialize_ft_versioned(int fd, struct rbuf *rb, FT *ftp, uint32_t version)
     }
     ft->in_memory_logical_rows = on_disk_logical_rows;
 
+    // every node of a dictionary created before version 30 uses x1764
+    enum toku_checksum_method checksum_method;
+    checksum_method = TOKU_CHECKSUM_X1764;
+    if (ft->layout_version_read_from_disk >= FT_LAYOUT_VERSION_30) {
+        unsigned char method = rbuf_char(rb);
+        if (!toku_checksum_method_is_valid(method)) {
+            fprintf(stderr, "Unknown checksum method %u in header.\n", method);
+            r = EINVAL;
+            goto exit;
+        }
+        checksum_method = (enum toku_checksum_method) method;
+    }
+
+    // the retired compression dictionary, then the current one
+    const struct toku_compression_dictionary *compression_dictionaries[2];
+    compression_dictionaries[0] = compression_dictionaries[1] = nullptr;
+    if (ft->layout_version_read_from_disk >= FT_LAYOUT_VERSION_31) {
+        for (int i = 0; i < 2; i++) {
+            uint32_t id = rbuf_int(rb);
+            uint32_t dict_size = rbuf_int(rb);
+            const void *data;
+            rbuf_literal_bytes(rb, &data, dict_size);
+            if (id != 0) {
+                struct toku_compression_dictionary *dict =
+                    toku_compression_dictionary_create(id, data, dict_size);
+                toku_ft_add_compression_dictionary(ft, dict);
+                compression_dictionaries[i] = dict;
+            }
+        }
+    }
+
     (void) rbuf_int(rb); //Read in checksum and ignore (already verified).
     if (rb->ndone != rb->size) {
         fprintf(stderr, "Header size did not match contents.\n");
@@ -357,6 +390,9 @@ int deserialize_ft_versioned(int fd, struct rbuf *rb, FT *ftp, uint32_t version)
             .basementnodesize = basementnodesize,
             .compression_method = compression_method,
             .fanout = fanout,
+            .checksum_method = checksum_method,
+            .compression_dictionary = compression_dictionaries[1],
+            .retired_compression_dictionary = compression_dictionaries[0],
             .highest_unused_msn_for_upgrade = highest_unused_msn_for_upgrade,
             .max_msn_in_ft = max_msn_in_ft,
             .time_of_last_optimize_begin = time_of_last_optimize_begin,
@@ -404,6 +440,7 @@ int deserialize_ft_versioned(int fd, struct rbuf *rb, FT *ftp, uint32_t version)
     r = 0;
 exit:
     if (r != 0 && ft != NULL) {
+        toku_ft_free_compression_dictionaries(ft);
         toku_free(ft);
         ft = NULL;
     }
@@ -415,6 +452,14 @@ static size_t serialize_ft_min_size(uint32_t version) {
     size_t size = 0;
 
     switch (version) {
+        case FT_LAYOUT_VERSION_32:
+            // fallthrough
+        case FT_LAYOUT_VERSION_31:
+            size += 2 * 2 * sizeof(uint32_t);  // id and size of two compression dictionaries
+            // fallthrough
+        case FT_LAYOUT_VERSION_30:
+            size += 1;  // checksum method
+            // fallthrough
         case FT_LAYOUT_VERSION_29:
             size += sizeof(uint64_t);  // logrows in ft
             // fallthrough
@@ -805,7 +850,13 @@ exit:
 
 size_t toku_serialize_ft_size(FT_HEADER h) {
     size_t size = serialize_ft_min_size(h->layout_version);
-    // There is no dynamic data.
+    // The compression dictionaries are the only dynamic data.
+    if (h->compression_dictionary) {
+        size += h->compression_dictionary->size;
+    }
+    if (h->retired_compression_dictionary) {
+        size += h->retired_compression_dictionary->size;
+    }
     lazy_assert(size <= BlockAllocator::BLOCK_ALLOCATOR_HEADER_RESERVE);
     return size;
 }
@@ -848,6 +899,16 @@ void toku_serialize_ft_to_wbuf (
     wbuf_MSN(wbuf, h->max_msn_in_ft);
     wbuf_int(wbuf, h->fanout);
     wbuf_ulonglong(wbuf, h->on_disk_logical_rows);
+    wbuf_char(wbuf, (unsigned char) h->checksum_method);
+    const struct toku_compression_dictionary *dicts[2] = { h->retired_compression_dictionary,
+                                                           h->compression_dictionary };
+    for (int i = 0; i < 2; i++) {
+        wbuf_int(wbuf, dicts[i] ? dicts[i]->id : 0);
+        wbuf_int(wbuf, dicts[i] ? dicts[i]->size : 0);
+        if (dicts[i]) {
+            wbuf_literal_bytes(wbuf, dicts[i]->data, dicts[i]->size);
+        }
+    }
     uint32_t checksum = toku_x1764_finish(&wbuf->checksum);
     wbuf_int(wbuf, checksum);
     lazy_assert(wbuf->ndone == wbuf->size);
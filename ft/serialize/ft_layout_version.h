@@ -69,6 +69,9 @@ enum ft_layout_version_e {
     FT_LAYOUT_VERSION_27 = 27, // serialize message trees with nonleaf buffers to avoid key, msn sort on deserialize
     FT_LAYOUT_VERSION_28 = 28, // Add fanout to ft_header
     FT_LAYOUT_VERSION_29 = 29, // Add logrows to ft_header
+    FT_LAYOUT_VERSION_30 = 30, // Add checksum method to ft_header, checksum method in log file magic
+    FT_LAYOUT_VERSION_31 = 31, // Add zstd compression dictionaries to ft_header
+    FT_LAYOUT_VERSION_32 = 32, // Block translation table starts with a format, may be a delta against a full one
     FT_NEXT_VERSION,           // the version after the current version
     FT_LAYOUT_VERSION   = FT_NEXT_VERSION-1, // A hack so I don't have to change this line.
     FT_LAYOUT_MIN_SUPPORTED_VERSION = FT_LAYOUT_VERSION_13, // Minimum version supported
@@ -49,8 +49,9 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/serialize/compress.h"
 #include "ft/serialize/ft_node-serialize.h"
 #include "ft/serialize/sub_block.h"
+#include "util/checksum.h"
 #include "util/sort.h"
-#include "util/threadpool.h"
+#include "util/kibbutz.h"
 #include "util/status.h"
 #include "util/scoped_malloc.h"
 
@@ -80,14 +81,14 @@ toku_ft_upgrade_get_status(FT_UPGRADE_STATUS s) {
 }
 
 static int num_cores = 0; // cache the number of cores for the parallelization
-static struct toku_thread_pool *ft_pool = NULL;
+static KIBBUTZ ft_pool = NULL;
 bool toku_serialize_in_parallel;
 
 int get_num_cores(void) {
     return num_cores;
 }
 
-struct toku_thread_pool *get_ft_pool(void) {
+KIBBUTZ get_ft_pool(void) {
     return ft_pool;
 }
 
@@ -97,13 +98,14 @@ void toku_serialize_set_parallel(bool in_parallel) {
 
 void toku_ft_serialize_layer_init(void) {
     num_cores = toku_os_get_number_active_processors();
-    int r = toku_thread_pool_create(&ft_pool, num_cores);
+    int r = toku_kibbutz_create(num_cores, &ft_pool, KIBBUTZ_WORK_STEALING);
     lazy_assert_zero(r);
     toku_serialize_in_parallel = false;
 }
 
 void toku_ft_serialize_layer_destroy(void) {
-    toku_thread_pool_destroy(&ft_pool);
+    toku_kibbutz_destroy(ft_pool);
+    ft_pool = NULL;
 }
 
 enum { FILE_CHANGE_INCREMENT = (16 << 20) };
@@ -220,7 +222,8 @@ serialize_node_header_size(FTNODE node) {
 }
 
 static void
-serialize_node_header(FTNODE node, FTNODE_DISK_DATA ndd, struct wbuf *wbuf) {
+serialize_node_header(FTNODE node, FTNODE_DISK_DATA ndd, struct wbuf *wbuf,
+                      enum toku_checksum_method checksum_method) {
     if (node->height == 0) 
         wbuf_nocrc_literal_bytes(wbuf, "tokuleaf", 8);
     else 
@@ -236,7 +239,7 @@ serialize_node_header(FTNODE node, FTNODE_DISK_DATA ndd, struct wbuf *wbuf) {
         wbuf_nocrc_int(wbuf, BP_SIZE (ndd, i));         // and the size
     }
     // checksum the header
-    uint32_t end_to_end_checksum = toku_x1764_memory(wbuf->buf, wbuf_get_woffset(wbuf));
+    uint32_t end_to_end_checksum = toku_checksum_memory(checksum_method, wbuf->buf, wbuf_get_woffset(wbuf));
     wbuf_nocrc_int(wbuf, end_to_end_checksum);
     invariant(wbuf->ndone == wbuf->size);
 }
@@ -324,7 +327,8 @@ static void serialize_child_buffer(NONLEAF_CHILDINFO bnc, struct wbuf *wb) {
 // For internal nodes, this would be the i'th internal node
 //
 static void
-serialize_ftnode_partition(FTNODE node, int i, struct sub_block *sb) {
+serialize_ftnode_partition(FTNODE node, int i, struct sub_block *sb,
+                           enum toku_checksum_method checksum_method) {
     // Caller should have allocated memory.
     invariant_notnull(sb->uncompressed_ptr);
     invariant(sb->uncompressed_size > 0);
@@ -348,7 +352,7 @@ serialize_ftnode_partition(FTNODE node, int i, struct sub_block *sb) {
 
         bd->serialize_to_wbuf(&wb);
     }
-    uint32_t end_to_end_checksum = toku_x1764_memory(sb->uncompressed_ptr, wbuf_get_woffset(&wb));
+    uint32_t end_to_end_checksum = toku_checksum_memory(checksum_method, sb->uncompressed_ptr, wbuf_get_woffset(&wb));
     wbuf_nocrc_int(&wb, end_to_end_checksum);
     invariant(wb.ndone == wb.size);
     invariant(sb->uncompressed_size==wb.ndone);
@@ -359,7 +363,9 @@ serialize_ftnode_partition(FTNODE node, int i, struct sub_block *sb) {
 // into a newly allocated buffer sb->compressed_ptr
 // 
 static void
-compress_ftnode_sub_block(struct sub_block *sb, enum toku_compression_method method) {
+compress_ftnode_sub_block(struct sub_block *sb, enum toku_compression_method method,
+                          const struct toku_compression_dictionary *dict,
+                          enum toku_checksum_method checksum_method) {
     invariant(sb->compressed_ptr != nullptr);
     invariant(sb->compressed_size_bound > 0);
     paranoid_invariant(sb->compressed_size_bound == toku_compress_bound(method, sb->uncompressed_size));
@@ -383,7 +389,8 @@ compress_ftnode_sub_block(struct sub_block *sb, enum toku_compression_method met
         sb,
         (char *)sb->compressed_ptr + 8,
         sb->compressed_size_bound,
-        method
+        method,
+        dict
         );
 
     uint32_t* extra = (uint32_t *)(sb->compressed_ptr);
@@ -392,7 +399,7 @@ compress_ftnode_sub_block(struct sub_block *sb, enum toku_compression_method met
     extra[1] = toku_htod32(sb->uncompressed_size);
     // now checksum the entire thing
     sb->compressed_size += 8; // now add the eight bytes that we saved for the sizes
-    sb->xsum = toku_x1764_memory(sb->compressed_ptr,sb->compressed_size);
+    sb->xsum = toku_checksum_memory(checksum_method, sb->compressed_ptr, sb->compressed_size);
 
     //
     // This is the end result for Dr. No and forward. For ftnodes, sb->compressed_ptr contains
@@ -429,7 +436,8 @@ serialize_ftnode_info_size(FTNODE node)
     return retval;
 }
 
-static void serialize_ftnode_info(FTNODE node, SUB_BLOCK sb) {
+static void serialize_ftnode_info(FTNODE node, SUB_BLOCK sb,
+                                  enum toku_checksum_method checksum_method) {
     // Memory must have been allocated by our caller.
     invariant(sb->uncompressed_size > 0);
     invariant_notnull(sb->uncompressed_ptr);
@@ -452,7 +460,7 @@ static void serialize_ftnode_info(FTNODE node, SUB_BLOCK sb) {
         }
     }
 
-    uint32_t end_to_end_checksum = toku_x1764_memory(sb->uncompressed_ptr, wbuf_get_woffset(&wb));
+    uint32_t end_to_end_checksum = toku_checksum_memory(checksum_method, sb->uncompressed_ptr, wbuf_get_woffset(&wb));
     wbuf_nocrc_int(&wb, end_to_end_checksum);
     invariant(wb.ndone == wb.size);
     invariant(sb->uncompressed_size==wb.ndone);
@@ -484,14 +492,16 @@ static void
 serialize_and_compress_partition(FTNODE node,
                                  int childnum,
                                  enum toku_compression_method compression_method,
+                                 const struct toku_compression_dictionary *dict,
+                                 enum toku_checksum_method checksum_method,
                                  SUB_BLOCK sb,
                                  struct serialize_times *st)
 {
     // serialize, compress, update status
     tokutime_t t0 = toku_time_now();
-    serialize_ftnode_partition(node, childnum, sb);
+    serialize_ftnode_partition(node, childnum, sb, checksum_method);
     tokutime_t t1 = toku_time_now();
-    compress_ftnode_sub_block(sb, compression_method);
+    compress_ftnode_sub_block(sb, compression_method, dict, checksum_method);
     tokutime_t t2 = toku_time_now();
 
     st->serialize_time += t1 - t0;
@@ -503,6 +513,7 @@ toku_create_compressed_partition_from_available(
     FTNODE node,
     int childnum,
     enum toku_compression_method compression_method,
+    enum toku_checksum_method checksum_method,
     SUB_BLOCK sb
     )
 {
@@ -512,7 +523,7 @@ toku_create_compressed_partition_from_available(
     sb->uncompressed_size = serialize_ftnode_partition_size(node, childnum);
     toku::scoped_malloc uncompressed_buf(sb->uncompressed_size);
     sb->uncompressed_ptr = uncompressed_buf.get();
-    serialize_ftnode_partition(node, childnum, sb);
+    serialize_ftnode_partition(node, childnum, sb, checksum_method);
 
     tokutime_t t1 = toku_time_now();
 
@@ -532,91 +543,90 @@ toku_create_compressed_partition_from_available(
     toku_ft_status_update_serialize_times(node, t1 - t0, t2 - t1);
 }
 
+void
+toku_ftnode_train_compression_dictionary(FTNODE node, struct toku_compression_dictionary_trainer *trainer)
+{
+    invariant(node->height == 0);
+    toku_ftnode_assert_fully_in_memory(node);
+    for (int i = 0; i < node->n_children; i++) {
+        struct sub_block sb;
+        sub_block_init(&sb);
+        sb.uncompressed_size = serialize_ftnode_partition_size(node, i);
+        toku::scoped_malloc uncompressed_buf(sb.uncompressed_size);
+        sb.uncompressed_ptr = uncompressed_buf.get();
+        serialize_ftnode_partition(node, i, &sb, TOKU_CHECKSUM_X1764);
+        toku_compression_dictionary_trainer_add(trainer, sb.uncompressed_ptr, sb.uncompressed_size);
+    }
+}
+
 static void
 serialize_and_compress_serially(FTNODE node,
                                 int npartitions,
                                 enum toku_compression_method compression_method,
+                                const struct toku_compression_dictionary *dict,
+                                enum toku_checksum_method checksum_method,
                                 struct sub_block sb[],
                                 struct serialize_times *st) {
     for (int i = 0; i < npartitions; i++) {
-        serialize_and_compress_partition(node, i, compression_method, &sb[i], st);
+        serialize_and_compress_partition(node, i, compression_method, dict, checksum_method, &sb[i], st);
     }
 }
 
 struct serialize_compress_work {
-    struct work base;
     FTNODE node;
-    int i;
     enum toku_compression_method compression_method;
+    const struct toku_compression_dictionary *dict;
+    enum toku_checksum_method checksum_method;
     struct sub_block *sb;
-    struct serialize_times st;
+    struct serialize_times *st; // one per partition
 };
 
-static void *
-serialize_and_compress_worker(void *arg) {
-    struct workset *ws = (struct workset *) arg;
-    while (1) {
-        struct serialize_compress_work *w = (struct serialize_compress_work *) workset_get(ws);
-        if (w == NULL)
-            break;
-        int i = w->i;
-        serialize_and_compress_partition(w->node, i, w->compression_method, &w->sb[i], &w->st);
-    }
-    workset_release_ref(ws);
-    return arg;
+static void
+serialize_and_compress_worker(void *arg, int i) {
+    struct serialize_compress_work *w = (struct serialize_compress_work *) arg;
+    serialize_and_compress_partition(w->node, i, w->compression_method, w->dict, w->checksum_method, &w->sb[i], &w->st[i]);
 }
 
 static void
 serialize_and_compress_in_parallel(FTNODE node,
                                    int npartitions,
                                    enum toku_compression_method compression_method,
+                                   const struct toku_compression_dictionary *dict,
+                                   enum toku_checksum_method checksum_method,
                                    struct sub_block sb[],
                                    struct serialize_times *st) {
     if (npartitions == 1) {
-        serialize_and_compress_partition(node, 0, compression_method, &sb[0], st);
+        serialize_and_compress_partition(node, 0, compression_method, dict, checksum_method, &sb[0], st);
     } else {
-        int T = num_cores;
-        if (T > npartitions)
-            T = npartitions;
-        if (T > 0)
-            T = T - 1;
-        struct workset ws;
-        ZERO_STRUCT(ws);
-        workset_init(&ws);
-        struct serialize_compress_work work[npartitions];
-        workset_lock(&ws);
+        struct serialize_times partition_st[npartitions];
         for (int i = 0; i < npartitions; i++) {
-            work[i] = (struct serialize_compress_work) { .base = {{NULL, NULL}},
-                                                         .node = node,
-                                                         .i = i,
-                                                         .compression_method = compression_method,
-                                                         .sb = sb,
-                                                         .st = { .serialize_time = 0, .compress_time = 0} };
-            workset_put_locked(&ws, &work[i].base);
+            partition_st[i] = (struct serialize_times) { .serialize_time = 0, .compress_time = 0 };
         }
-        workset_unlock(&ws);
-        toku_thread_pool_run(ft_pool, 0, &T, serialize_and_compress_worker, &ws);
-        workset_add_ref(&ws, T);
-        serialize_and_compress_worker(&ws);
-        workset_join(&ws);
-        workset_destroy(&ws);
-
-        // gather up the statistics from each thread's work item
+        struct serialize_compress_work work = { .node = node,
+                                                .compression_method = compression_method,
+                                                .dict = dict,
+                                                .checksum_method = checksum_method,
+                                                .sb = sb,
+                                                .st = partition_st };
+        toku_kibbutz_parallel_for(ft_pool, npartitions, num_cores, serialize_and_compress_worker, &work);
+
+        // gather up the statistics from each partition
         for (int i = 0; i < npartitions; i++) {
-            st->serialize_time += work[i].st.serialize_time;
-            st->compress_time += work[i].st.compress_time;
+            st->serialize_time += partition_st[i].serialize_time;
+            st->compress_time += partition_st[i].compress_time;
         }
     }
 }
 
 static void
 serialize_and_compress_sb_node_info(FTNODE node, struct sub_block *sb,
-        enum toku_compression_method compression_method, struct serialize_times *st) {
+        enum toku_compression_method compression_method,
+        enum toku_checksum_method checksum_method, struct serialize_times *st) {
     // serialize, compress, update serialize times.
     tokutime_t t0 = toku_time_now();
-    serialize_ftnode_info(node, sb);
+    serialize_ftnode_info(node, sb, checksum_method);
     tokutime_t t1 = toku_time_now();
-    compress_ftnode_sub_block(sb, compression_method);
+    compress_ftnode_sub_block(sb, compression_method, nullptr, checksum_method);
     tokutime_t t2 = toku_time_now();
 
     st->serialize_time += t1 - t0;
@@ -627,14 +637,17 @@ int toku_serialize_ftnode_to_memory(FTNODE node,
                                     FTNODE_DISK_DATA* ndd,
                                     unsigned int basementnodesize,
                                     enum toku_compression_method compression_method,
+                                    enum toku_checksum_method checksum_method,
                                     bool do_rebalancing,
                                     bool in_parallel, // for loader is true, for toku_ftnode_flush_callback, is false
                             /*out*/ size_t *n_bytes_to_write,
                             /*out*/ size_t *n_uncompressed_bytes,
-                            /*out*/ char  **bytes_to_write)
+                            /*out*/ char  **bytes_to_write,
+                                    const struct toku_compression_dictionary *dict)
 // Effect: Writes out each child to a separate malloc'd buffer, then compresses
 //   all of them, and writes the uncompressed header, to bytes_to_write,
 //   which is malloc'd.
+//   The partitions of a leaf are compressed against dict, if it is not NULL.
 //
 //   The resulting buffer is guaranteed to be 512-byte aligned and the total length is a multiple of 512 (so we pad with zeros at the end if needed).
 //   512-byte padding is for O_DIRECT to work.
@@ -645,6 +658,9 @@ int toku_serialize_ftnode_to_memory(FTNODE node,
         toku_ftnode_leaf_rebalance(node, basementnodesize);
     }
     const int npartitions = node->n_children;
+    if (node->height > 0) {
+        dict = nullptr;
+    }
 
     // Each partition represents a compressed sub block
     // For internal nodes, a sub block is a message buffer
@@ -681,9 +697,9 @@ int toku_serialize_ftnode_to_memory(FTNODE node,
     // do the actual serialization now that we have buffer space
     struct serialize_times st = { 0, 0 };
     if (in_parallel) {
-        serialize_and_compress_in_parallel(node, npartitions, compression_method, sb, &st);
+        serialize_and_compress_in_parallel(node, npartitions, compression_method, dict, checksum_method, sb, &st);
     } else {
-        serialize_and_compress_serially(node, npartitions, compression_method, sb, &st);
+        serialize_and_compress_serially(node, npartitions, compression_method, dict, checksum_method, sb, &st);
     }
 
     //
@@ -704,7 +720,7 @@ int toku_serialize_ftnode_to_memory(FTNODE node,
     sb_node_info.compressed_ptr = sb_node_info_compressed_buf.get();
 
     // do the actual serialization now that we have buffer space
-    serialize_and_compress_sb_node_info(node, &sb_node_info, compression_method, &st);
+    serialize_and_compress_sb_node_info(node, &sb_node_info, compression_method, checksum_method, &st);
 
     //
     // At this point, we have compressed each of our pieces into individual sub_blocks,
@@ -740,7 +756,7 @@ int toku_serialize_ftnode_to_memory(FTNODE node,
     // write the header
     struct wbuf wb;
     wbuf_init(&wb, curr_ptr, serialize_node_header_size(node));
-    serialize_node_header(node, *ndd, &wb);
+    serialize_node_header(node, *ndd, &wb, checksum_method);
     assert(wb.ndone == wb.size);
     curr_ptr += serialize_node_header_size(node);
 
@@ -782,6 +798,17 @@ int toku_serialize_ftnode_to(int fd,
     size_t n_uncompressed_bytes;
     char *compressed_buf = nullptr;
 
+    // Leaves are compressed against the dictionary in the header being
+    // written with them, so a checkpoint never refers to a dictionary it
+    // does not contain.  The ft lock protects the header's dictionaries.
+    const struct toku_compression_dictionary *dict = nullptr;
+    if (node->height == 0 && ft->h->compression_method == TOKU_ZSTD_DICTIONARY_METHOD) {
+        toku_ft_lock(ft);
+        FT_HEADER h = (for_checkpoint && ft->checkpoint_header) ? ft->checkpoint_header : ft->h;
+        dict = h->compression_dictionary;
+        toku_ft_unlock(ft);
+    }
+
     // because toku_serialize_ftnode_to is only called for
     // in toku_ftnode_flush_callback, we pass false
     // for in_parallel. The reasoning is that when we write
@@ -800,11 +827,13 @@ int toku_serialize_ftnode_to(int fd,
         ndd,
         ft->h->basementnodesize,
         ft->h->compression_method,
+        ft->h->checksum_method,
         do_rebalancing,
         toku_unsafe_fetch(&toku_serialize_in_parallel),
         &n_to_write,
         &n_uncompressed_bytes,
-        &compressed_buf);
+        &compressed_buf,
+        dict);
     if (r != 0) {
         return r;
     }
@@ -1004,6 +1033,10 @@ BASEMENTNODE toku_clone_bn(BASEMENTNODE orig_bn) {
     bn->stale_ancestor_messages_applied = orig_bn->stale_ancestor_messages_applied;
     bn->stat64_delta = orig_bn->stat64_delta;
     bn->logical_rows_delta = orig_bn->logical_rows_delta;
+    bn->gc_stale_cxrs = orig_bn->gc_stale_cxrs;
+    bn->gc_pxrs = orig_bn->gc_pxrs;
+    bn->gc_horizon = orig_bn->gc_horizon;
+    bn->gc_backoff = orig_bn->gc_backoff;
     bn->data_buffer.clone(&orig_bn->data_buffer);
     return bn;
 }
@@ -1015,6 +1048,10 @@ BASEMENTNODE toku_create_empty_bn_no_buffer(void) {
     bn->stale_ancestor_messages_applied = false;
     bn->stat64_delta = ZEROSTATS;
     bn->logical_rows_delta = 0;
+    bn->gc_stale_cxrs = 0;
+    bn->gc_pxrs = 0;
+    bn->gc_horizon = TXNID_NONE;
+    bn->gc_backoff = 0;
     bn->data_buffer.init_zero();
     return bn;
 }
@@ -1111,7 +1148,8 @@ static void read_ftnode_header_from_fd_into_rbuf_if_small_enough(int fd, BLOCKNU
 // validate the checksum of the compressed data
 //
 int
-read_compressed_sub_block(struct rbuf *rb, struct sub_block *sb)
+read_compressed_sub_block(struct rbuf *rb, struct sub_block *sb,
+                          enum toku_checksum_method checksum_method)
 {
     int r = 0;
     sb->compressed_size = rbuf_int(rb);
@@ -1120,7 +1158,7 @@ read_compressed_sub_block(struct rbuf *rb, struct sub_block *sb)
     rbuf_literal_bytes(rb, cp, sb->compressed_size);
     sb->xsum = rbuf_int(rb);
     // let's check the checksum
-    uint32_t actual_xsum = toku_x1764_memory((char *)sb->compressed_ptr-8, 8+sb->compressed_size);
+    uint32_t actual_xsum = toku_checksum_memory(checksum_method, (char *)sb->compressed_ptr-8, 8+sb->compressed_size);
     if (sb->xsum != actual_xsum) {
         r = TOKUDB_BAD_CHECKSUM;
     }
@@ -1128,28 +1166,45 @@ read_compressed_sub_block(struct rbuf *rb, struct sub_block *sb)
 }
 
 static int
-read_and_decompress_sub_block(struct rbuf *rb, struct sub_block *sb)
+read_and_decompress_sub_block(struct rbuf *rb, struct sub_block *sb,
+                              enum toku_checksum_method checksum_method, FT ft)
 {
     int r = 0;
-    r = read_compressed_sub_block(rb, sb);
+    r = read_compressed_sub_block(rb, sb, checksum_method);
     if (r != 0) {
         goto exit;
     }
 
-    just_decompress_sub_block(sb);
+    just_decompress_sub_block(sb, ft);
 exit:
     return r;
 }
 
+// Decompress a sub block, looking up the dictionary it was compressed
+// against (if any) among those ft knows.
+static void
+decompress_ftnode_sub_block(FT ft, Bytef *dest, uLongf destLen, const Bytef *source, uLongf sourceLen)
+{
+    const struct toku_compression_dictionary *dict = nullptr;
+    uint32_t id = toku_decompress_dictionary_id(source, sourceLen);
+    if (id != 0) {
+        invariant_notnull(ft);
+        dict = toku_ft_find_compression_dictionary(ft, id);
+        invariant_notnull(dict);
+    }
+    toku_decompress_with_dictionary(dest, destLen, source, sourceLen, dict);
+}
+
 // Allocates space for the sub-block and de-compresses the data from
 // the supplied compressed pointer..
 void
-just_decompress_sub_block(struct sub_block *sb)
+just_decompress_sub_block(struct sub_block *sb, FT ft)
 {
     // <CER> TODO: Add assert that the subblock was read in.
     sb->uncompressed_ptr = toku_xmalloc(sb->uncompressed_size);
 
-    toku_decompress(
+    decompress_ftnode_sub_block(
+        ft,
         (Bytef *) sb->uncompressed_ptr,
         sb->uncompressed_size,
         (Bytef *) sb->compressed_ptr,
@@ -1160,12 +1215,13 @@ just_decompress_sub_block(struct sub_block *sb)
 // verify the checksum
 int verify_ftnode_sub_block(struct sub_block *sb,
                             const char *fname,
-                            BLOCKNUM blocknum) {
+                            BLOCKNUM blocknum,
+                            enum toku_checksum_method checksum_method) {
     int r = 0;
     // first verify the checksum
     uint32_t data_size = sb->uncompressed_size - 4; // checksum is 4 bytes at end
     uint32_t stored_xsum = toku_dtoh32(*((uint32_t *)((char *)sb->uncompressed_ptr + data_size)));
-    uint32_t actual_xsum = toku_x1764_memory(sb->uncompressed_ptr, data_size);
+    uint32_t actual_xsum = toku_checksum_memory(checksum_method, sb->uncompressed_ptr, data_size);
     if (stored_xsum != actual_xsum) {
         fprintf(
             stderr,
@@ -1184,7 +1240,8 @@ int verify_ftnode_sub_block(struct sub_block *sb,
 }
 
 // This function deserializes the data stored by serialize_ftnode_info
-static int deserialize_ftnode_info(struct sub_block *sb, FTNODE node) {
+static int deserialize_ftnode_info(struct sub_block *sb, FTNODE node,
+                                   enum toku_checksum_method checksum_method) {
 
     // sb_node_info->uncompressed_ptr stores the serialized node information
     // this function puts that information into node
@@ -1192,7 +1249,7 @@ static int deserialize_ftnode_info(struct sub_block *sb, FTNODE node) {
     // first verify the checksum
     int r = 0;
     const char *fname = toku_ftnode_get_cachefile_fname_in_env(node);
-    r = verify_ftnode_sub_block(sb, fname, node->blocknum);
+    r = verify_ftnode_sub_block(sb, fname, node->blocknum, checksum_method);
     if (r != 0) {
         fprintf(
             stderr,
@@ -1380,11 +1437,12 @@ static int deserialize_ftnode_partition(
     struct sub_block *sb,
     FTNODE node,
     int childnum,  // which partition to deserialize
-    const toku::comparator &cmp) {
+    const toku::comparator &cmp,
+    enum toku_checksum_method checksum_method) {
 
     int r = 0;
     const char *fname = toku_ftnode_get_cachefile_fname_in_env(node);
-    r = verify_ftnode_sub_block(sb, fname, node->blocknum);
+    r = verify_ftnode_sub_block(sb, fname, node->blocknum, checksum_method);
     if (r != 0) {
         fprintf(stderr,
                 "%s:%d:deserialize_ftnode_partition - "
@@ -1453,6 +1511,7 @@ static int deserialize_ftnode_partition(
         BASEMENTNODE bn = BLB(node, childnum);
         bn->data_buffer.deserialize_from_rbuf(
             num_entries, &rb, data_size, node->layout_version_read_from_disk);
+        toku_bn_count_garbage(bn);
     }
     if (rb.ndone != rb.size) {
         fprintf(stderr,
@@ -1476,11 +1535,12 @@ static int decompress_and_deserialize_worker(struct rbuf curr_rbuf,
                                              struct sub_block curr_sb,
                                              FTNODE node,
                                              int child,
-                                             const toku::comparator &cmp,
+                                             FT ft,
+                                             enum toku_checksum_method checksum_method,
                                              tokutime_t *decompress_time) {
     int r = 0;
     tokutime_t t0 = toku_time_now();
-    r = read_and_decompress_sub_block(&curr_rbuf, &curr_sb);
+    r = read_and_decompress_sub_block(&curr_rbuf, &curr_sb, checksum_method, ft);
     if (r != 0) {
         const char *fname = toku_ftnode_get_cachefile_fname_in_env(node);
         fprintf(stderr,
@@ -1497,7 +1557,7 @@ static int decompress_and_deserialize_worker(struct rbuf curr_rbuf,
     }
     *decompress_time = toku_time_now() - t0;
     // at this point, sb->uncompressed_ptr stores the serialized node partition
-    r = deserialize_ftnode_partition(&curr_sb, node, child, cmp);
+    r = deserialize_ftnode_partition(&curr_sb, node, child, ft->cmp, checksum_method);
     if (r != 0) {
         const char *fname = toku_ftnode_get_cachefile_fname_in_env(node);
         fprintf(stderr,
@@ -1521,9 +1581,10 @@ exit:
 static int check_and_copy_compressed_sub_block_worker(struct rbuf curr_rbuf,
                                                       struct sub_block curr_sb,
                                                       FTNODE node,
-                                                      int child) {
+                                                      int child,
+                                                      enum toku_checksum_method checksum_method) {
     int r = 0;
-    r = read_compressed_sub_block(&curr_rbuf, &curr_sb);
+    r = read_compressed_sub_block(&curr_rbuf, &curr_sb, checksum_method);
     if (r != 0) {
         goto exit;
     }
@@ -1548,6 +1609,7 @@ static FTNODE alloc_ftnode_for_deserialize(uint32_t fullhash, BLOCKNUM blocknum)
     node->oldest_referenced_xid_known = TXNID_NONE;
     node->bp = nullptr;
     node->ct_pair = nullptr;
+    node->readahead_unused = false;
     return node; 
 }
 
@@ -1573,6 +1635,7 @@ static int deserialize_ftnode_header_from_rbuf_if_small_enough(
     // we must get the name from bfe and not through
     // toku_ftnode_get_cachefile_fname_in_env as the node is not set up yet
     const char* fname = toku_cachefile_fname_in_env(bfe->ft->cf);
+    const enum toku_checksum_method checksum_method = bfe->ft->h->checksum_method;
     
     t0 = toku_time_now();
 
@@ -1688,7 +1751,7 @@ static int deserialize_ftnode_header_from_rbuf_if_small_enough(
     }
 
     uint32_t checksum;
-    checksum = toku_x1764_memory(rb->buf, rb->ndone);
+    checksum = toku_checksum_memory(checksum_method, rb->buf, rb->ndone);
     uint32_t stored_checksum;
     stored_checksum = rbuf_int(rb);
     if (stored_checksum != checksum) {
@@ -1738,8 +1801,9 @@ static int deserialize_ftnode_header_from_rbuf_if_small_enough(
     sb_node_info.xsum = rbuf_int(rb);
     // let's check the checksum
     uint32_t actual_xsum;
-    actual_xsum = toku_x1764_memory((char *)sb_node_info.compressed_ptr - 8,
-                                    8 + sb_node_info.compressed_size);
+    actual_xsum = toku_checksum_memory(checksum_method,
+                                       (char *)sb_node_info.compressed_ptr - 8,
+                                       8 + sb_node_info.compressed_size);
     if (sb_node_info.xsum != actual_xsum) {
         fprintf(
             stderr,
@@ -1769,7 +1833,7 @@ static int deserialize_ftnode_header_from_rbuf_if_small_enough(
         decompress_time = decompress_t1 - decompress_t0;
 
         // at this point sb->uncompressed_ptr stores the serialized node info.
-        r = deserialize_ftnode_info(&sb_node_info, node);
+        r = deserialize_ftnode_info(&sb_node_info, node, checksum_method);
         if (r != 0) {
             fprintf(
                 stderr,
@@ -2090,6 +2154,7 @@ deserialize_and_upgrade_leaf_node(FTNODE node,
         }
         bn->data_buffer.deserialize_from_rbuf(n_in_buf, rb, data_size, node->layout_version_read_from_disk);
     }
+    toku_bn_count_garbage(bn);
 
     // Whatever this is must be less than the MSNs of every message above
     // it, so it's ok to take it here.
@@ -2265,6 +2330,7 @@ static int deserialize_ftnode_from_rbuf(FTNODE *ftnode,
     tokutime_t decompress_time = 0;
     tokutime_t deserialize_time = 0;
     const char* fname = toku_cachefile_fname_in_env(bfe->ft->cf);
+    const enum toku_checksum_method checksum_method = bfe->ft->h->checksum_method;
 
     t0 = toku_time_now();
 
@@ -2348,7 +2414,7 @@ static int deserialize_ftnode_from_rbuf(FTNODE *ftnode,
     }
     // verify checksum of header stored
     uint32_t checksum;
-    checksum = toku_x1764_memory(rb->buf, rb->ndone);
+    checksum = toku_checksum_memory(checksum_method, rb->buf, rb->ndone);
     uint32_t stored_checksum;
     stored_checksum = rbuf_int(rb);
     if (stored_checksum != checksum) {
@@ -2370,7 +2436,7 @@ static int deserialize_ftnode_from_rbuf(FTNODE *ftnode,
     sub_block_init(&sb_node_info);
     {
         tokutime_t sb_decompress_t0 = toku_time_now();
-        r = read_and_decompress_sub_block(rb, &sb_node_info);
+        r = read_and_decompress_sub_block(rb, &sb_node_info, checksum_method, bfe->ft);
         tokutime_t sb_decompress_t1 = toku_time_now();
         decompress_time += sb_decompress_t1 - sb_decompress_t0;
         if (r != 0) {
@@ -2393,7 +2459,7 @@ static int deserialize_ftnode_from_rbuf(FTNODE *ftnode,
     }
 
     // at this point, sb->uncompressed_ptr stores the serialized node info
-    r = deserialize_ftnode_info(&sb_node_info, node);
+    r = deserialize_ftnode_info(&sb_node_info, node, checksum_method);
     if (r != 0) {
         fprintf(
             stderr,
@@ -2463,7 +2529,8 @@ static int deserialize_ftnode_from_rbuf(FTNODE *ftnode,
                     curr_sb,
                     node,
                     i,
-                    bfe->ft->cmp,
+                    bfe->ft,
+                    checksum_method,
                     &partition_decompress_time);
                 decompress_time += partition_decompress_time;
                 if (r != 0) {
@@ -2485,7 +2552,7 @@ static int deserialize_ftnode_from_rbuf(FTNODE *ftnode,
             }
         case PT_COMPRESSED:
             // case where we leave the partition in the compressed state
-            r = check_and_copy_compressed_sub_block_worker(curr_rbuf, curr_sb, node, i);
+            r = check_and_copy_compressed_sub_block_worker(curr_rbuf, curr_sb, node, i, checksum_method);
             if (r != 0) {
                 fprintf(
                     stderr,
@@ -2533,80 +2600,118 @@ cleanup:
 
 int
 toku_deserialize_bp_from_disk(FTNODE node, FTNODE_DISK_DATA ndd, int childnum, int fd, ftnode_fetch_extra *bfe) {
+    return toku_deserialize_bps_from_disk(node, ndd, &childnum, 1, fd, nullptr, bfe);
+}
+
+int
+toku_deserialize_bps_from_disk(FTNODE node, FTNODE_DISK_DATA ndd, const int *childnums, int n_childnums,
+                               int fd, TOKU_AIO aio, ftnode_fetch_extra *bfe) {
     int r = 0;
-    assert(BP_STATE(node,childnum) == PT_ON_DISK);
-    assert(node->bp[childnum].ptr.tag == BCT_NULL);
-    
-    //
-    // setup the partition
-    //
-    setup_available_ftnode_partition(node, childnum);
-    BP_STATE(node,childnum) = PT_AVAIL;
-    
-    //
-    // read off disk and make available in memory
-    // 
+    invariant(n_childnums > 0);
+
     // get the file offset and block size for the block
     DISKOFF node_offset, total_node_disk_size;
     bfe->ft->blocktable.translate_blocknum_to_offset_size(node->blocknum, &node_offset, &total_node_disk_size);
 
-    uint32_t curr_offset = BP_START(ndd, childnum);
-    uint32_t curr_size = BP_SIZE (ndd, childnum);
-
-    struct rbuf rb;
-    rbuf_init(&rb, nullptr, 0);
-
-    uint32_t pad_at_beginning = (node_offset+curr_offset)%512;
-    uint32_t padded_size = roundup_to_multiple(512, pad_at_beginning + curr_size);
+    //
+    // setup the partitions and a read request for each of them
+    //
+    toku::scoped_calloc reqs_buf(n_childnums * sizeof(struct toku_aio_request));
+    struct toku_aio_request *reqs = reinterpret_cast<struct toku_aio_request *>(reqs_buf.get());
+    for (int i = 0; i < n_childnums; i++) {
+        int childnum = childnums[i];
+        assert(BP_STATE(node,childnum) == PT_ON_DISK);
+        assert(node->bp[childnum].ptr.tag == BCT_NULL);
+        setup_available_ftnode_partition(node, childnum);
+        BP_STATE(node,childnum) = PT_AVAIL;
+
+        uint32_t curr_offset = BP_START(ndd, childnum);
+        uint32_t curr_size = BP_SIZE (ndd, childnum);
+        uint32_t pad_at_beginning = (node_offset+curr_offset)%512;
+        uint32_t padded_size = roundup_to_multiple(512, pad_at_beginning + curr_size);
+
+        reqs[i].fd = fd;
+        reqs[i].buf = toku_xmalloc_aligned(512, padded_size);
+        reqs[i].len = padded_size;
+        reqs[i].offset = node_offset+curr_offset-pad_at_beginning;
+        reqs[i].is_write = false;
+        // for O_DIRECT
+        assert(0==((unsigned long long)reqs[i].buf)%512);
+        assert(0==(padded_size)%512);
+        assert(0==(reqs[i].offset)%512);
+    }
 
-    toku::scoped_malloc_aligned raw_block_buf(padded_size, 512);
-    uint8_t *raw_block = reinterpret_cast<uint8_t *>(raw_block_buf.get());
-    rbuf_init(&rb, pad_at_beginning+raw_block, curr_size);
+    //
+    // read off disk, all at once if we can
+    //
     tokutime_t t0 = toku_time_now();
-
-    // read the block
-    assert(0==((unsigned long long)raw_block)%512); // for O_DIRECT
-    assert(0==(padded_size)%512);
-    assert(0==(node_offset+curr_offset-pad_at_beginning)%512);
-    ssize_t rlen = toku_os_pread(fd, raw_block, padded_size, node_offset+curr_offset-pad_at_beginning);
-    assert((DISKOFF)rlen >= pad_at_beginning + curr_size); // we read in at least enough to get what we wanted
-    assert((DISKOFF)rlen <= padded_size);                  // we didn't read in too much.
-
+    if (aio != nullptr && n_childnums > 1) {
+        struct toku_aio_batch batch;
+        toku_aio_batch_init(&batch);
+        toku_aio_submit(aio, &batch, reqs, n_childnums);
+        toku_aio_wait(aio, &batch);
+    } else {
+        for (int i = 0; i < n_childnums; i++) {
+            reqs[i].result = toku_os_pread(fd, reqs[i].buf, reqs[i].len, reqs[i].offset);
+        }
+    }
     tokutime_t t1 = toku_time_now();
 
-    // read sub block
-    struct sub_block curr_sb;
-    sub_block_init(&curr_sb);
-    r = read_compressed_sub_block(&rb, &curr_sb);
-    if (r != 0) {
-        return r;
-    }
-    invariant(curr_sb.compressed_ptr != NULL);
+    //
+    // make each partition available in memory
+    //
+    uint64_t bytes_read = 0;
+    for (int i = 0; i < n_childnums && r == 0; i++) {
+        int childnum = childnums[i];
+        uint32_t curr_offset = BP_START(ndd, childnum);
+        uint32_t curr_size = BP_SIZE (ndd, childnum);
+        uint32_t pad_at_beginning = (node_offset+curr_offset)%512;
+        ssize_t rlen = reqs[i].result;
+        assert((DISKOFF)rlen >= pad_at_beginning + curr_size); // we read in at least enough to get what we wanted
+        assert((DISKOFF)rlen <= (DISKOFF)reqs[i].len);         // we didn't read in too much.
+        bytes_read += rlen;
+
+        struct rbuf rb;
+        rbuf_init(&rb, pad_at_beginning + reinterpret_cast<uint8_t *>(reqs[i].buf), curr_size);
+
+        tokutime_t t2 = toku_time_now();
+
+        // read sub block
+        struct sub_block curr_sb;
+        sub_block_init(&curr_sb);
+        r = read_compressed_sub_block(&rb, &curr_sb, bfe->ft->h->checksum_method);
+        if (r != 0) {
+            break;
+        }
+        invariant(curr_sb.compressed_ptr != NULL);
 
-    // decompress
-    toku::scoped_malloc uncompressed_buf(curr_sb.uncompressed_size);
-    curr_sb.uncompressed_ptr = uncompressed_buf.get();
-    toku_decompress((Bytef *) curr_sb.uncompressed_ptr, curr_sb.uncompressed_size,
-                    (Bytef *) curr_sb.compressed_ptr, curr_sb.compressed_size);
+        // decompress
+        toku::scoped_malloc uncompressed_buf(curr_sb.uncompressed_size);
+        curr_sb.uncompressed_ptr = uncompressed_buf.get();
+        decompress_ftnode_sub_block(bfe->ft, (Bytef *) curr_sb.uncompressed_ptr, curr_sb.uncompressed_size,
+                                    (Bytef *) curr_sb.compressed_ptr, curr_sb.compressed_size);
 
-    // deserialize
-    tokutime_t t2 = toku_time_now();
+        // deserialize
+        tokutime_t t3 = toku_time_now();
 
-    r = deserialize_ftnode_partition(&curr_sb, node, childnum, bfe->ft->cmp);
+        r = deserialize_ftnode_partition(&curr_sb, node, childnum, bfe->ft->cmp, bfe->ft->h->checksum_method);
 
-    tokutime_t t3 = toku_time_now();
+        tokutime_t t4 = toku_time_now();
 
-    // capture stats
-    tokutime_t io_time = t1 - t0;
-    tokutime_t decompress_time = t2 - t1;
-    tokutime_t deserialize_time = t3 - t2;
-    bfe->deserialize_time += deserialize_time;
-    bfe->decompress_time += decompress_time;
-    toku_ft_status_update_deserialize_times(node, deserialize_time, decompress_time);
+        // capture stats
+        tokutime_t decompress_time = t3 - t2;
+        tokutime_t deserialize_time = t4 - t3;
+        bfe->deserialize_time += deserialize_time;
+        bfe->decompress_time += decompress_time;
+        toku_ft_status_update_deserialize_times(node, deserialize_time, decompress_time);
+    }
 
-    bfe->bytes_read = rlen;
-    bfe->io_time = io_time;
+    bfe->bytes_read = bytes_read;
+    bfe->io_time = t1 - t0;
 
+    for (int i = 0; i < n_childnums; i++) {
+        toku_free(reqs[i].buf);
+    }
     return r;
 }
 
@@ -2629,14 +2734,15 @@ int toku_deserialize_bp_from_compressed(FTNODE node,
     // decompress the sub_block
     tokutime_t t0 = toku_time_now();
 
-    toku_decompress((Bytef *)curr_sb->uncompressed_ptr,
-                    curr_sb->uncompressed_size,
-                    (Bytef *)curr_sb->compressed_ptr,
-                    curr_sb->compressed_size);
+    decompress_ftnode_sub_block(bfe->ft,
+                                (Bytef *)curr_sb->uncompressed_ptr,
+                                curr_sb->uncompressed_size,
+                                (Bytef *)curr_sb->compressed_ptr,
+                                curr_sb->compressed_size);
 
     tokutime_t t1 = toku_time_now();
 
-    r = deserialize_ftnode_partition(curr_sb, node, childnum, bfe->ft->cmp);
+    r = deserialize_ftnode_partition(curr_sb, node, childnum, bfe->ft->cmp, bfe->ft->h->checksum_method);
     if (r != 0) {
         const char* fname = toku_cachefile_fname_in_env(bfe->ft->cf);
         fprintf(stderr,
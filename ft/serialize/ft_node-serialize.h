@@ -44,6 +44,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/serialize/rbuf.h"
 #include "ft/serialize/wbuf.h"
 #include "ft/serialize/block_table.h"
+#include "util/aio.h"
 
 unsigned int toku_serialize_ftnode_size(FTNODE node);
 int toku_serialize_ftnode_to_memory(
@@ -51,11 +52,13 @@ int toku_serialize_ftnode_to_memory(
     FTNODE_DISK_DATA *ndd,
     unsigned int basementnodesize,
     enum toku_compression_method compression_method,
+    enum toku_checksum_method checksum_method,
     bool do_rebalancing,
     bool in_parallel,
     size_t *n_bytes_to_write,
     size_t *n_uncompressed_bytes,
-    char **bytes_to_write);
+    char **bytes_to_write,
+    const struct toku_compression_dictionary *dict = nullptr);
 int toku_serialize_ftnode_to(int fd,
                              BLOCKNUM,
                              FTNODE node,
@@ -82,6 +85,15 @@ int toku_deserialize_bp_from_disk(FTNODE node,
                                   int childnum,
                                   int fd,
                                   ftnode_fetch_extra *bfe);
+// Read several on-disk partitions of one node.  If aio is not null the reads
+// are submitted together as a single batch so they are all in flight at once.
+int toku_deserialize_bps_from_disk(FTNODE node,
+                                   FTNODE_DISK_DATA ndd,
+                                   const int *childnums,
+                                   int n_childnums,
+                                   int fd,
+                                   TOKU_AIO aio,
+                                   ftnode_fetch_extra *bfe);
 int toku_deserialize_bp_from_compressed(FTNODE node,
                                         int childnum,
                                         ftnode_fetch_extra *bfe);
@@ -96,7 +108,8 @@ void toku_serialize_set_parallel(bool);
 
 // used by nonleaf node partial eviction
 void toku_create_compressed_partition_from_available(FTNODE node, int childnum,
-                                                     enum toku_compression_method compression_method, SUB_BLOCK sb);
+                                                     enum toku_compression_method compression_method,
+                                                     enum toku_checksum_method checksum_method, SUB_BLOCK sb);
 
 // <CER> For verifying old, non-upgraded nodes (versions 13 and 14).
 int decompress_from_raw_block_into_rbuf(uint8_t *raw_block, size_t raw_block_size, struct rbuf *rb, BLOCKNUM blocknum);
@@ -107,11 +120,16 @@ void read_block_from_fd_into_rbuf(int fd,
                                   BLOCKNUM blocknum,
                                   FT ft,
                                   struct rbuf *rb);
-int read_compressed_sub_block(struct rbuf *rb, struct sub_block *sb);
+int read_compressed_sub_block(struct rbuf *rb, struct sub_block *sb,
+                              enum toku_checksum_method checksum_method);
 int verify_ftnode_sub_block(struct sub_block *sb,
                             const char *fname,
-                            BLOCKNUM blocknum);
-void just_decompress_sub_block(struct sub_block *sb);
+                            BLOCKNUM blocknum,
+                            enum toku_checksum_method checksum_method);
+void just_decompress_sub_block(struct sub_block *sb, FT ft);
+
+// Offer the basement nodes of a leaf as training data for a compression dictionary.
+void toku_ftnode_train_compression_dictionary(FTNODE node, struct toku_compression_dictionary_trainer *trainer);
 
 // used by ft-node-deserialize.cc
 void initialize_ftnode(FTNODE node, BLOCKNUM blocknum);
@@ -119,7 +137,7 @@ int read_and_check_magic(struct rbuf *rb);
 int read_and_check_version(FTNODE node, struct rbuf *rb);
 void read_node_info(FTNODE node, struct rbuf *rb, int version);
 void allocate_and_read_partition_offsets(FTNODE node, struct rbuf *rb, FTNODE_DISK_DATA *ndd);
-int check_node_info_checksum(struct rbuf *rb);
+int check_node_info_checksum(struct rbuf *rb, enum toku_checksum_method checksum_method);
 void read_legacy_node_info(FTNODE node, struct rbuf *rb, int version);
 int check_legacy_end_checksum(struct rbuf *rb);
 
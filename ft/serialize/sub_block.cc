@@ -47,12 +47,8 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 
 #include "ft/serialize/compress.h"
 #include "ft/serialize/sub_block.h"
-#include "util/threadpool.h"
 #include "util/x1764.h"
 
-toku_instr_key *workset_lock_mutex_key;
-toku_instr_key *ws_worker_wait_key;
-
 SUB_BLOCK sub_block_creat(void) {
     SUB_BLOCK XMALLOC(sb);
     sub_block_init(sb);
@@ -174,8 +170,6 @@ get_sub_block_index(int n_sub_blocks, struct sub_block sub_block[], size_t offse
     return -1;
 }
 
-#include "workset.h"
-
 void
 compress_work_init(struct compress_work *w, enum toku_compression_method method, struct sub_block *sub_block) {
     w->method = method;
@@ -193,7 +187,8 @@ compress_nocrc_sub_block(
     struct sub_block *sub_block,
     void* sb_compressed_ptr,
     uint32_t cs_bound,
-    enum toku_compression_method method
+    enum toku_compression_method method,
+    const struct toku_compression_dictionary *dict
     )
 {
     // compress it
@@ -201,9 +196,9 @@ compress_nocrc_sub_block(
     Bytef *compressed_ptr = (Bytef *) sb_compressed_ptr;
     uLongf uncompressed_len = sub_block->uncompressed_size;
     uLongf real_compressed_len = cs_bound;
-    toku_compress(method,
-                  compressed_ptr, &real_compressed_len,
-                  uncompressed_ptr, uncompressed_len);
+    toku_compress_with_dictionary(method, dict,
+                                  compressed_ptr, &real_compressed_len,
+                                  uncompressed_ptr, uncompressed_len);
     return real_compressed_len;
 }
 
@@ -219,26 +214,17 @@ compress_sub_block(struct sub_block *sub_block, enum toku_compression_method met
     sub_block->xsum = toku_x1764_memory(sub_block->compressed_ptr, sub_block->compressed_size);
 }
 
-void *
-compress_worker(void *arg) {
-    struct workset *ws = (struct workset *) arg;
-    while (1) {
-        struct compress_work *w = (struct compress_work *) workset_get(ws);
-        if (w == NULL)
-            break;
-        compress_sub_block(w->sub_block, w->method);
-    }
-    workset_release_ref(ws);
-    return arg;
+void
+compress_worker(void *arg, int i) {
+    struct compress_work *w = &((struct compress_work *) arg)[i];
+    compress_sub_block(w->sub_block, w->method);
 }
 
 size_t
-compress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], char *uncompressed_ptr, char *compressed_ptr, int num_cores, struct toku_thread_pool *pool, enum toku_compression_method method) {
+compress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], char *uncompressed_ptr, char *compressed_ptr, int num_cores, KIBBUTZ pool, enum toku_compression_method method) {
     char *compressed_base_ptr = compressed_ptr;
     size_t compressed_len;
 
-    // This is a complex way to write a parallel loop.  Cilk would be better.
-
     if (n_sub_blocks == 1) {
         // single sub-block 
         sub_block[0].uncompressed_ptr = uncompressed_ptr;
@@ -247,37 +233,17 @@ compress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], char *un
         compressed_len = sub_block[0].compressed_size;
     } else {
         // multiple sub-blocks
-        int T = num_cores; // T = min(num_cores, n_sub_blocks) - 1
-        if (T > n_sub_blocks)
-            T = n_sub_blocks;
-        if (T > 0)
-            T = T - 1;     // threads in addition to the running thread
-
-        struct workset ws;
-        ZERO_STRUCT(ws);
-        workset_init(&ws);
-
         struct compress_work work[n_sub_blocks];
-        workset_lock(&ws);
         for (int i = 0; i < n_sub_blocks; i++) {
             sub_block[i].uncompressed_ptr = uncompressed_ptr;
             sub_block[i].compressed_ptr = compressed_ptr;
             compress_work_init(&work[i], method, &sub_block[i]);
-            workset_put_locked(&ws, &work[i].base);
             uncompressed_ptr += sub_block[i].uncompressed_size;
             compressed_ptr += sub_block[i].compressed_size_bound;
         }
-        workset_unlock(&ws);
-
-        // compress the sub-blocks
-        if (0) printf("%s:%d T=%d N=%d\n", __FUNCTION__, __LINE__, T, n_sub_blocks);
-        toku_thread_pool_run(pool, 0, &T, compress_worker, &ws);
-        workset_add_ref(&ws, T);
-        compress_worker(&ws);
 
-        // wait for all of the work to complete
-        workset_join(&ws);
-        workset_destroy(&ws);
+        // compress the sub-blocks, using up to num_cores threads including this one
+        toku_kibbutz_parallel_for(pool, n_sub_blocks, num_cores, compress_worker, work);
 
         // squeeze out the holes not used by the compress bound
         compressed_ptr = compressed_base_ptr + sub_block[0].compressed_size;
@@ -324,60 +290,31 @@ decompress_sub_block(void *compress_ptr, uint32_t compress_size, void *uncompres
     return result;
 }
 
-// decompress blocks until there is no more work to do
-void *
-decompress_worker(void *arg) {
-    struct workset *ws = (struct workset *) arg;
-    while (1) {
-        struct decompress_work *dw = (struct decompress_work *) workset_get(ws);
-        if (dw == NULL)
-            break;
-        dw->error = decompress_sub_block(dw->compress_ptr, dw->compress_size, dw->uncompress_ptr, dw->uncompress_size, dw->xsum);
-    }
-    workset_release_ref(ws);
-    return arg;
+// decompress the i'th sub block
+void
+decompress_worker(void *arg, int i) {
+    struct decompress_work *dw = &((struct decompress_work *) arg)[i];
+    dw->error = decompress_sub_block(dw->compress_ptr, dw->compress_size, dw->uncompress_ptr, dw->uncompress_size, dw->xsum);
 }
 
 int
-decompress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], unsigned char *compressed_data, unsigned char *uncompressed_data, int num_cores, struct toku_thread_pool *pool) {
+decompress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], unsigned char *compressed_data, unsigned char *uncompressed_data, int num_cores, KIBBUTZ pool) {
     int r;
 
     if (n_sub_blocks == 1) {
         r = decompress_sub_block(compressed_data, sub_block[0].compressed_size, uncompressed_data, sub_block[0].uncompressed_size, sub_block[0].xsum);
     } else {
-        // compute the number of additional threads needed for decompressing this node
-        int T = num_cores; // T = min(#cores, #blocks) - 1
-        if (T > n_sub_blocks)
-            T = n_sub_blocks;
-        if (T > 0)
-            T = T - 1;       // threads in addition to the running thread
-
-        // init the decompression work set
-        struct workset ws;
-        ZERO_STRUCT(ws);
-        workset_init(&ws);
-
-        // initialize the decompression work and add to the work set
+        // initialize the decompression work
         struct decompress_work decompress_work[n_sub_blocks];
-        workset_lock(&ws);
         for (int i = 0; i < n_sub_blocks; i++) {
             decompress_work_init(&decompress_work[i], compressed_data, sub_block[i].compressed_size, uncompressed_data, sub_block[i].uncompressed_size, sub_block[i].xsum);
-            workset_put_locked(&ws, &decompress_work[i].base);
 
             uncompressed_data += sub_block[i].uncompressed_size;
             compressed_data += sub_block[i].compressed_size;
         }
-        workset_unlock(&ws);
     
-        // decompress the sub-blocks
-        if (0) printf("%s:%d Cores=%d Blocks=%d T=%d\n", __FUNCTION__, __LINE__, num_cores, n_sub_blocks, T);
-        toku_thread_pool_run(pool, 0, &T, decompress_worker, &ws);
-        workset_add_ref(&ws, T);
-        decompress_worker(&ws);
-
-        // cleanup
-        workset_join(&ws);
-        workset_destroy(&ws);
+        // decompress the sub-blocks, using up to num_cores threads including this one
+        toku_kibbutz_parallel_for(pool, n_sub_blocks, num_cores, decompress_worker, decompress_work);
 
         r = 0;
         for (int i = 0; i < n_sub_blocks; i++) {
@@ -99,10 +99,9 @@ set_all_sub_block_sizes(int total_size, int sub_block_size, int n_sub_blocks, st
 int
 get_sub_block_index(int n_sub_blocks, struct sub_block sub_block[], size_t offset);
 
-#include "workset.h"
+#include "util/kibbutz.h"
 
 struct compress_work {
-    struct work base;
     enum toku_compression_method method;
     struct sub_block *sub_block;
 };
@@ -115,20 +114,21 @@ compress_nocrc_sub_block(
     struct sub_block *sub_block,
     void* sb_compressed_ptr,
     uint32_t cs_bound,
-    enum toku_compression_method method
+    enum toku_compression_method method,
+    const struct toku_compression_dictionary *dict = nullptr
     );
 
 void
 compress_sub_block(struct sub_block *sub_block, enum toku_compression_method method);
 
-void *
-compress_worker(void *arg);
+// compress the i'th sub block of an array of compress_work, for toku_kibbutz_parallel_for
+void
+compress_worker(void *arg, int i);
 
 size_t
-compress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], char *uncompressed_ptr, char *compressed_ptr, int num_cores, struct toku_thread_pool *pool, enum toku_compression_method method);
+compress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], char *uncompressed_ptr, char *compressed_ptr, int num_cores, KIBBUTZ pool, enum toku_compression_method method);
 
 struct decompress_work {
-    struct work base;
     void *compress_ptr;
     void *uncompress_ptr;
     uint32_t compress_size;
@@ -148,13 +148,13 @@ decompress_work_init(struct decompress_work *dw,
 int
 decompress_sub_block(void *compress_ptr, uint32_t compress_size, void *uncompress_ptr, uint32_t uncompress_size, uint32_t expected_xsum);
 
-// decompress blocks until there is no more work to do
-void *
-decompress_worker(void *arg);
+// decompress the i'th sub block of an array of decompress_work, for toku_kibbutz_parallel_for
+void
+decompress_worker(void *arg, int i);
 
 // decompress all sub blocks from the compressed_data buffer to the uncompressed_data buffer
 // Returns 0 if success, otherwise an error
 int
-decompress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], unsigned char *compressed_data, unsigned char *uncompressed_data, int num_cores, struct toku_thread_pool *pool);
+decompress_all_sub_blocks(int n_sub_blocks, struct sub_block sub_block[], unsigned char *compressed_data, unsigned char *uncompressed_data, int num_cores, KIBBUTZ pool);
 
 extern int verbose_decompress_sub_block;
@@ -0,0 +1,158 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+#include "cachetable/cachetable-internal.h"
+
+//
+// Verifies the 2Q eviction policy: pairs fetched once are probationary,
+// hits do not let them accumulate clock count, and a pair that is fetched
+// again after being evicted comes back protected through a ghost hit.
+//
+
+#define STATUS_VALUE(x) ct_test_status.status[CACHETABLE_STATUS_S::x].value.num
+
+static void
+pin_and_unpin(CACHEFILE f1, int64_t b) {
+    void *v;
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    int r = toku_cachetable_get_and_pin(f1, make_blocknum(b), b, &v, wc,
+                                        def_fetch, def_pf_req_callback, def_pf_callback,
+                                        true, NULL);
+    assert_zero(r);
+    r = toku_test_cachetable_unpin(f1, make_blocknum(b), b, CACHETABLE_CLEAN, make_pair_attr(8));
+    assert_zero(r);
+}
+
+static PAIR
+find_pair(CACHETABLE ct, CACHEFILE f1, int64_t b) {
+    ct->list.pair_lock_by_fullhash(b);
+    PAIR p = ct->list.find_pair(f1, make_blocknum(b), b);
+    ct->list.pair_unlock_by_fullhash(b);
+    return p;
+}
+
+// evict the pair the same way the eviction thread would
+static void
+evict(CACHETABLE ct, CACHEFILE f1, int64_t b) {
+    PAIR p = find_pair(ct, f1, b);
+    assert(p != nullptr);
+    toku_mutex_lock(p->mutex);
+    p->value_rwlock.write_lock(true);
+    ct->ev.evict_pair(p, false);
+    assert(find_pair(ct, f1, b) == nullptr);
+}
+
+static void
+cachetable_test (void) {
+    int r;
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, 1024*1024, ZERO_LSN, nullptr);
+    evictor_test_helpers::disable_ev_thread(&ct->ev);
+    assert(toku_get_eviction_policy(ct) == CACHETABLE_EVICTION_POLICY_CLOCK);
+    toku_set_eviction_policy(ct, CACHETABLE_EVICTION_POLICY_2Q);
+    assert(toku_get_eviction_policy(ct) == CACHETABLE_EVICTION_POLICY_2Q);
+
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    CACHEFILE f1;
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+
+    CACHETABLE_STATUS_S ct_test_status;
+    toku_cachetable_get_status(ct, &ct_test_status);
+    assert(STATUS_VALUE(CT_EVICTION_POLICY) == CACHETABLE_EVICTION_POLICY_2Q);
+    assert(STATUS_VALUE(CT_HITS) == 0);
+    assert(STATUS_VALUE(CT_GHOST_HITS) == 0);
+
+    // first fetch: probationary, and hits cannot raise the count past one
+    pin_and_unpin(f1, 1);
+    PAIR p = find_pair(ct, f1, 1);
+    assert(!p->frequent);
+    assert(p->count == 1);
+    for (int i = 0; i < 10; i++) {
+        pin_and_unpin(f1, 1);
+    }
+    assert(!p->frequent);
+    assert(p->count == 1);
+    toku_cachetable_get_status(ct, &ct_test_status);
+    assert(STATUS_VALUE(CT_HITS) == 10);
+
+    // a pair that is never refetched after eviction stays forgotten
+    pin_and_unpin(f1, 2);
+    evict(ct, f1, 2);
+
+    // refetching a recently evicted pair promotes it
+    evict(ct, f1, 1);
+    toku_cachetable_get_status(ct, &ct_test_status);
+    assert(STATUS_VALUE(CT_PROBATIONARY_EVICTIONS) == 2);
+    pin_and_unpin(f1, 1);
+    p = find_pair(ct, f1, 1);
+    assert(p->frequent);
+    for (int i = 0; i < 20; i++) {
+        pin_and_unpin(f1, 1);
+    }
+    assert(p->count == 15);
+    toku_cachetable_get_status(ct, &ct_test_status);
+    assert(STATUS_VALUE(CT_GHOST_HITS) == 1);
+
+    // the ghost entry was consumed by the hit
+    evict(ct, f1, 1);
+    pin_and_unpin(f1, 1);
+    p = find_pair(ct, f1, 1);
+    assert(p->frequent);
+    toku_cachetable_get_status(ct, &ct_test_status);
+    assert(STATUS_VALUE(CT_GHOST_HITS) == 2);
+    assert(STATUS_VALUE(CT_PROBATIONARY_EVICTIONS) == 2);
+
+    // under the clock policy every pair is protected
+    toku_set_eviction_policy(ct, CACHETABLE_EVICTION_POLICY_CLOCK);
+    pin_and_unpin(f1, 3);
+    p = find_pair(ct, f1, 3);
+    assert(p->frequent);
+    assert(p->count == 3);
+
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    cachetable_test();
+    return 0;
+}
@@ -0,0 +1,191 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+#include "cachetable/cachetable-internal.h"
+
+//
+// Verifies NUMA partitioning of the cachetable with fake nodes, where a
+// thread's node is its thread id modulo the number of nodes: pairs are
+// charged to the node of the thread that put them, pins from another node
+// are counted as remote, and eviction takes pairs from the node that is
+// over its share while leaving the other node's pairs alone.
+//
+
+#define STATUS_VALUE(x) ct_test_status.status[CACHETABLE_STATUS_S::x].value.num
+
+static const int test_limit = 16;
+static CACHEFILE f1;
+
+static void
+put_pair(int64_t b) {
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    uint32_t fullhash = toku_cachetable_hash(f1, make_blocknum(b));
+    toku_cachetable_put(f1, make_blocknum(b), fullhash, NULL, make_pair_attr(1), wc, put_callback_nop);
+    int r = toku_test_cachetable_unpin(f1, make_blocknum(b), fullhash, CACHETABLE_CLEAN, make_pair_attr(1));
+    assert_zero(r);
+}
+
+static void
+pin_pair(int64_t b, bool may_modify_value) {
+    void *v;
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    uint32_t fullhash = toku_cachetable_hash(f1, make_blocknum(b));
+    int r = toku_cachetable_get_and_pin(f1, make_blocknum(b), fullhash, &v, wc,
+                                        def_fetch, def_pf_req_callback, def_pf_callback,
+                                        may_modify_value, NULL);
+    assert_zero(r);
+}
+
+static void
+unpin_pair(int64_t b) {
+    uint32_t fullhash = toku_cachetable_hash(f1, make_blocknum(b));
+    int r = toku_test_cachetable_unpin(f1, make_blocknum(b), fullhash, CACHETABLE_CLEAN, make_pair_attr(1));
+    assert_zero(r);
+}
+
+static void *
+put_from_other_node(void *UU(arg)) {
+    // pairs 101..104 are charged to this thread's node
+    for (int64_t b = 101; b <= 104; b++) {
+        put_pair(b);
+    }
+    // and pinning pair 1, put by the main thread, is a remote pin
+    pin_pair(1, false);
+    unpin_pair(1);
+    return arg;
+}
+
+static bool
+pair_is_cached(CACHETABLE ct, int64_t b) {
+    uint32_t fullhash = toku_cachetable_hash(f1, make_blocknum(b));
+    ct->list.pair_lock_by_fullhash(fullhash);
+    PAIR p = ct->list.find_pair(f1, make_blocknum(b), fullhash);
+    ct->list.pair_unlock_by_fullhash(fullhash);
+    return p != NULL;
+}
+
+static void
+run_test(void) {
+    int r;
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, test_limit, ZERO_LSN, nullptr);
+    r = toku_cachetable_set_numa_nodes(ct, 2, true);
+    assert_zero(r);
+    assert(toku_cachetable_get_numa_nodes(ct) == 2);
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+
+    const uint32_t main_node = toku_os_gettid() % 2;
+    for (int64_t b = 1; b <= 8; b++) {
+        put_pair(b);
+    }
+    long size_current, size_limit;
+    toku_cachetable_get_numa_node_state(ct, main_node, &size_current, &size_limit);
+    assert(size_current == 8);
+    assert(size_limit == test_limit / 2);
+
+    // the partitioning can only change while the cachetable is empty
+    r = toku_cachetable_set_numa_nodes(ct, 4, true);
+    assert(r == EINVAL);
+
+    // keep creating threads until one lands on the other fake node
+    toku_pthread_t tid;
+    void *ret;
+    for (;;) {
+        r = toku_pthread_create(toku_uninstrumented, &tid, nullptr, put_from_other_node, nullptr);
+        assert_zero(r);
+        r = toku_pthread_join(tid, &ret);
+        assert_zero(r);
+        long other_size;
+        toku_cachetable_get_numa_node_state(ct, 1 - main_node, &other_size, NULL);
+        if (other_size > 0) {
+            assert(other_size == 4);
+            break;
+        }
+        // that thread was on our node, take its pairs back out
+        for (int64_t b = 101; b <= 104; b++) {
+            pin_pair(b, true);
+            r = toku_test_cachetable_unpin_and_remove(f1, make_blocknum(b), NULL, NULL);
+            assert_zero(r);
+        }
+    }
+
+    CACHETABLE_STATUS_S ct_test_status;
+    toku_cachetable_get_status(ct, &ct_test_status);
+    assert(STATUS_VALUE(CT_NUMA_NODES) == 2);
+    assert(STATUS_VALUE(CT_NUMA_REMOTE_PINS) >= 1);
+    assert(STATUS_VALUE(CT_NUMA_NODES_OVER_LIMIT) == 0);
+
+    // push the main thread's node well over its share and let the
+    // eviction thread bring the cachetable back under its limit
+    for (int64_t b = 9; b <= 20; b++) {
+        put_pair(b);
+    }
+    toku_cachetable_get_status(ct, &ct_test_status);
+    assert(STATUS_VALUE(CT_NUMA_NODES_OVER_LIMIT) == 1);
+    toku_cachetable_maybe_flush_some(ct);
+    for (int i = 0; i < 100; i++) {
+        toku_cachetable_get_state(ct, NULL, NULL, &size_current, NULL);
+        if (size_current <= test_limit) {
+            break;
+        }
+        usleep(100 * 1000);
+    }
+    assert(size_current <= test_limit);
+    long other_size;
+    toku_cachetable_get_numa_node_state(ct, 1 - main_node, &other_size, NULL);
+    assert(other_size == 4);
+    for (int64_t b = 101; b <= 104; b++) {
+        assert(pair_is_cached(ct, b));
+    }
+
+    toku_cachetable_verify(ct);
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    run_test();
+    return 0;
+}
+
+#undef STATUS_VALUE
@@ -0,0 +1,170 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+
+//
+// Measures how pin/unpin throughput of pairs that are already in the
+// cachetable scales with the number of client threads.  The table is
+// created with few buckets so that the first round also runs while the
+// eviction thread grows the pair hash table underneath it.
+//
+// By default this runs a short round per thread count as a test. Run with
+// -v and a larger --ops to print pins/sec for each thread count.
+//
+
+static int n_pairs = 1 << 14;
+static int max_threads = 8;
+static long ops_per_thread = 20000;
+
+static CACHEFILE f1;
+
+struct pin_thread_extra {
+    unsigned int seed;
+    long n_ops;
+};
+
+static void *
+pin_unpin_thread(void *arg) {
+    struct pin_thread_extra *CAST_FROM_VOIDP(e, arg);
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    for (long i = 0; i < e->n_ops; i++) {
+        CACHEKEY key = make_blocknum(rand_r(&e->seed) % n_pairs);
+        uint32_t fullhash = toku_cachetable_hash(f1, key);
+        void *v;
+        int r = toku_cachetable_get_and_pin(f1, key, fullhash, &v, wc,
+                                            def_fetch, def_pf_req_callback, def_pf_callback,
+                                            false, NULL);
+        assert_zero(r);
+        r = toku_test_cachetable_unpin(f1, key, fullhash, CACHETABLE_CLEAN, make_pair_attr(8));
+        assert_zero(r);
+    }
+    return arg;
+}
+
+static void
+run_round(int n_threads) {
+    toku_pthread_t tids[n_threads];
+    struct pin_thread_extra extras[n_threads];
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    for (int i = 0; i < n_threads; i++) {
+        extras[i].seed = i + 1;
+        extras[i].n_ops = ops_per_thread;
+        int r = toku_pthread_create(toku_uninstrumented, &tids[i], nullptr, pin_unpin_thread, &extras[i]);
+        assert_zero(r);
+    }
+    for (int i = 0; i < n_threads; i++) {
+        void *ret;
+        int r = toku_pthread_join(tids[i], &ret);
+        assert_zero(r);
+    }
+    gettimeofday(&end, NULL);
+    double dt = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+    if (verbose) {
+        printf("%d threads: %.0f pins/sec\n", n_threads, (n_threads * ops_per_thread) / dt);
+    }
+}
+
+static void
+run_test(void) {
+    // start with a table much smaller than the number of pairs
+    toku_pair_list_set_lock_size(1 << 8);
+    CACHETABLE ct;
+    toku_cachetable_create(&ct, 1LL << 32, ZERO_LSN, nullptr);
+    const char *fname1 = TOKU_TEST_FILENAME;
+    unlink(fname1);
+    int r = toku_cachetable_openf(&f1, ct, fname1, O_RDWR|O_CREAT, S_IRWXU|S_IRWXG|S_IRWXO); assert(r == 0);
+
+    CACHETABLE_WRITE_CALLBACK wc = def_write_callback(NULL);
+    for (int i = 0; i < n_pairs; i++) {
+        CACHEKEY key = make_blocknum(i);
+        uint32_t fullhash = toku_cachetable_hash(f1, key);
+        toku_cachetable_put(f1, key, fullhash, NULL, make_pair_attr(8), wc, put_callback_nop);
+        r = toku_test_cachetable_unpin(f1, key, fullhash, CACHETABLE_CLEAN, make_pair_attr(8));
+        assert_zero(r);
+    }
+    int n_entries, hash_size;
+    toku_cachetable_get_state(ct, &n_entries, &hash_size, NULL, NULL);
+    assert(n_entries == n_pairs);
+
+    // wake the eviction thread so the table grows while we pin
+    toku_cachetable_maybe_flush_some(ct);
+    for (int n_threads = 1; n_threads <= max_threads; n_threads *= 2) {
+        run_round(n_threads);
+    }
+
+    // the resize may still be going on if the rounds were short
+    for (int i = 0; i < 100 && hash_size < n_pairs; i++) {
+        usleep(100 * 1000);
+        toku_cachetable_get_state(ct, &n_entries, &hash_size, NULL, NULL);
+    }
+    assert(n_entries == n_pairs);
+    assert(hash_size >= n_pairs);
+    toku_cachetable_verify(ct);
+
+    toku_cachefile_close(&f1, false, ZERO_LSN);
+    toku_cachetable_close(&ct);
+}
+
+static void
+usage(const char *progname) {
+    fprintf(stderr, "Usage:\n %s [-v] [-q] [--pairs N] [--threads N] [--ops N]\n", progname);
+    exit(1);
+}
+
+int
+test_main(int argc, const char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose++;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            verbose = 0;
+        } else if (strcmp(argv[i], "--pairs") == 0 && i + 1 < argc) {
+            n_pairs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc) {
+            ops_per_thread = atol(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    run_test();
+    return 0;
+}
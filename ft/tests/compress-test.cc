@@ -143,12 +143,45 @@ static void test_compress_methods () {
     printf("TOKU_ZSTD_METHOD Time=%.6fs, Ratio=%.2f[%d/%d]\n",
             tdiff(&start, &end),
             (float)compress_size / (float)uncompress_size, (int)compress_size, (int)uncompress_size);
+
+    compress_size = 0;
+    uncompress_size = 0;
+    gettimeofday(&start, NULL);
+    test_compress(TOKU_ADAPTIVE_COMPRESSION_METHOD, &compress_size, &uncompress_size);
+    gettimeofday(&end, NULL);
+    printf("TOKU_ADAPTIVE_COMPRESSION_METHOD Time=%.6fs, Ratio=%.2f[%d/%d]\n",
+            tdiff(&start, &end),
+            (float)compress_size / (float)uncompress_size, (int)compress_size, (int)uncompress_size);
+}
+
+// Adaptive compression should store random bytes as is and squeeze runs of zeroes.
+static void test_adaptive_choice (void) {
+    const int n = 64*1024;
+    unsigned char *MALLOC_N(n, b);
+    int bound = toku_compress_bound(TOKU_ADAPTIVE_COMPRESSION_METHOD, n);
+    unsigned char *MALLOC_N(bound, cb);
+
+    for (int j=0; j<n; j++) b[j] = random()%256;
+    uLongf clen = bound;
+    toku_compress(TOKU_ADAPTIVE_COMPRESSION_METHOD, cb, &clen, b, n);
+    assert(cb[0] == TOKU_NO_COMPRESSION);
+    assert(clen == (uLongf) n + 1);
+
+    for (int j=0; j<n; j++) b[j] = 0;
+    clen = bound;
+    toku_compress(TOKU_ADAPTIVE_COMPRESSION_METHOD, cb, &clen, b, n);
+    assert(cb[0] == TOKU_ZSTD_METHOD);
+    assert(clen < (uLongf) n / 100);
+
+    toku_free(cb);
+    toku_free(b);
 }
 
 int test_main (int argc, const char *argv[]) {
     default_parse_args(argc, argv);
     
     test_compress_methods();
+    test_adaptive_choice();
 
     return 0;
 }
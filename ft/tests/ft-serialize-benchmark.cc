@@ -71,13 +71,94 @@ static int long_key_cmp(DB *UU(e), const DBT *a, const DBT *b) {
     return (*x > *y) - (*x < *y);
 }
 
+static void time_serialize_leaf(int fd,
+                                FTNODE sn,
+                                FT ft_h,
+                                const char *label,
+                                int ser_runs,
+                                int deser_runs) {
+    int r;
+    FTNODE dn;
+    struct timeval total_start;
+    struct timeval total_end;
+    total_start.tv_sec = total_start.tv_usec = 0;
+    total_end.tv_sec = total_end.tv_usec = 0;
+    struct timeval t[2];
+    FTNODE_DISK_DATA ndd = NULL;
+    for (int i = 0; i < ser_runs; i++) {
+        gettimeofday(&t[0], NULL);
+        ndd = NULL;
+        sn->set_dirty();
+        r = toku_serialize_ftnode_to(
+            fd, make_blocknum(20), sn, &ndd, true, ft_h, false);
+        invariant(r == 0);
+        gettimeofday(&t[1], NULL);
+        total_start.tv_sec += t[0].tv_sec;
+        total_start.tv_usec += t[0].tv_usec;
+        total_end.tv_sec += t[1].tv_sec;
+        total_end.tv_usec += t[1].tv_usec;
+        toku_free(ndd);
+    }
+    double dt;
+    dt = (total_end.tv_sec - total_start.tv_sec) +
+         ((total_end.tv_usec - total_start.tv_usec) / USECS_PER_SEC);
+    dt *= 1000;
+    dt /= ser_runs;
+    printf("%s:\n", label);
+    printf(
+        "serialize leaf(ms):   %0.05lf (average of %d runs)\n", dt, ser_runs);
+    {
+        DISKOFF offset, size;
+        ft_h->blocktable.translate_blocknum_to_offset_size(make_blocknum(20), &offset, &size);
+        printf("compressed leaf size: %" PRId64 " of %u (ratio %0.02lf)\n",
+               size, toku_serialize_ftnode_size(sn),
+               (double) toku_serialize_ftnode_size(sn) / size);
+    }
+
+    // reset
+    total_start.tv_sec = total_start.tv_usec = 0;
+    total_end.tv_sec = total_end.tv_usec = 0;
+
+    ftnode_fetch_extra bfe;
+    for (int i = 0; i < deser_runs; i++) {
+        bfe.create_for_full_read(ft_h);
+        gettimeofday(&t[0], NULL);
+        FTNODE_DISK_DATA ndd2 = NULL;
+        r = toku_deserialize_ftnode_from(
+            fd, make_blocknum(20), 0 /*pass zero for hash*/, &dn, &ndd2, &bfe);
+        invariant(r == 0);
+        gettimeofday(&t[1], NULL);
+
+        total_start.tv_sec += t[0].tv_sec;
+        total_start.tv_usec += t[0].tv_usec;
+        total_end.tv_sec += t[1].tv_sec;
+        total_end.tv_usec += t[1].tv_usec;
+
+        toku_ftnode_free(&dn);
+        toku_free(ndd2);
+    }
+    dt = (total_end.tv_sec - total_start.tv_sec) +
+         ((total_end.tv_usec - total_start.tv_usec) / USECS_PER_SEC);
+    dt *= 1000;
+    dt /= deser_runs;
+    printf(
+        "deserialize leaf(ms): %0.05lf (average of %d runs)\n", dt, deser_runs);
+    printf(
+        "io time(ms) %lf decompress time(ms) %lf deserialize time(ms) %lf "
+        "(average of %d runs)\n",
+        tokutime_to_seconds(bfe.io_time) * 1000,
+        tokutime_to_seconds(bfe.decompress_time) * 1000,
+        tokutime_to_seconds(bfe.deserialize_time) * 1000,
+        deser_runs);
+}
+
 static void test_serialize_leaf(int valsize,
                                 int nelts,
                                 double entropy,
                                 int ser_runs,
                                 int deser_runs) {
     //    struct ft_handle source_ft;
-    struct ftnode *sn, *dn;
+    struct ftnode *sn;
 
     int fd = open(TOKU_TEST_FILENAME,
                   O_RDWR | O_CREAT | O_BINARY,
@@ -164,69 +245,22 @@ static void test_serialize_leaf(int valsize,
         invariant(size == 100);
     }
 
-    struct timeval total_start;
-    struct timeval total_end;
-    total_start.tv_sec = total_start.tv_usec = 0;
-    total_end.tv_sec = total_end.tv_usec = 0;
-    struct timeval t[2];
-    FTNODE_DISK_DATA ndd = NULL;
-    for (int i = 0; i < ser_runs; i++) {
-        gettimeofday(&t[0], NULL);
-        ndd = NULL;
-        sn->set_dirty();
-        r = toku_serialize_ftnode_to(
-            fd, make_blocknum(20), sn, &ndd, true, ft->ft, false);
-        invariant(r == 0);
-        gettimeofday(&t[1], NULL);
-        total_start.tv_sec += t[0].tv_sec;
-        total_start.tv_usec += t[0].tv_usec;
-        total_end.tv_sec += t[1].tv_sec;
-        total_end.tv_usec += t[1].tv_usec;
-        toku_free(ndd);
-    }
-    double dt;
-    dt = (total_end.tv_sec - total_start.tv_sec) +
-         ((total_end.tv_usec - total_start.tv_usec) / USECS_PER_SEC);
-    dt *= 1000;
-    dt /= ser_runs;
-    printf(
-        "serialize leaf(ms):   %0.05lf (average of %d runs)\n", dt, ser_runs);
-
-    // reset
-    total_start.tv_sec = total_start.tv_usec = 0;
-    total_end.tv_sec = total_end.tv_usec = 0;
-
-    ftnode_fetch_extra bfe;
-    for (int i = 0; i < deser_runs; i++) {
-        bfe.create_for_full_read(ft_h);
-        gettimeofday(&t[0], NULL);
-        FTNODE_DISK_DATA ndd2 = NULL;
-        r = toku_deserialize_ftnode_from(
-            fd, make_blocknum(20), 0 /*pass zero for hash*/, &dn, &ndd2, &bfe);
-        invariant(r == 0);
-        gettimeofday(&t[1], NULL);
-
-        total_start.tv_sec += t[0].tv_sec;
-        total_start.tv_usec += t[0].tv_usec;
-        total_end.tv_sec += t[1].tv_sec;
-        total_end.tv_usec += t[1].tv_usec;
-
-        toku_ftnode_free(&dn);
-        toku_free(ndd2);
-    }
-    dt = (total_end.tv_sec - total_start.tv_sec) +
-         ((total_end.tv_usec - total_start.tv_usec) / USECS_PER_SEC);
-    dt *= 1000;
-    dt /= deser_runs;
-    printf(
-        "deserialize leaf(ms): %0.05lf (average of %d runs)\n", dt, deser_runs);
-    printf(
-        "io time(ms) %lf decompress time(ms) %lf deserialize time(ms) %lf "
-        "(average of %d runs)\n",
-        tokutime_to_seconds(bfe.io_time) * 1000,
-        tokutime_to_seconds(bfe.decompress_time) * 1000,
-        tokutime_to_seconds(bfe.deserialize_time) * 1000,
-        deser_runs);
+    time_serialize_leaf(fd, sn, ft_h, "default", ser_runs, deser_runs);
+
+    // zstd, then zstd against a dictionary trained from this leaf
+    ft_h->h->compression_method = TOKU_ZSTD_METHOD;
+    time_serialize_leaf(fd, sn, ft_h, "zstd", ser_runs, deser_runs);
+    struct toku_compression_dictionary_trainer *trainer =
+        toku_compression_dictionary_trainer_create();
+    toku_ftnode_train_compression_dictionary(sn, trainer);
+    struct toku_compression_dictionary *dict =
+        toku_compression_dictionary_trainer_finish(trainer, 1);
+    toku_compression_dictionary_trainer_destroy(trainer);
+    invariant_notnull(dict);
+    toku_ft_add_compression_dictionary(ft_h, dict);
+    ft_h->h->compression_dictionary = dict;
+    ft_h->h->compression_method = TOKU_ZSTD_DICTIONARY_METHOD;
+    time_serialize_leaf(fd, sn, ft_h, "zstd dictionary", ser_runs, deser_runs);
 
     toku_ftnode_free(&sn);
 
@@ -234,6 +268,7 @@ static void test_serialize_leaf(int valsize,
         BlockAllocator::BLOCK_ALLOCATOR_TOTAL_HEADER_RESERVE, 100);
     ft_h->blocktable.destroy();
     ft_h->cmp.destroy();
+    toku_ft_free_compression_dictionaries(ft_h);
     toku_free(ft_h->h);
     toku_free(ft_h);
     toku_free(ft);
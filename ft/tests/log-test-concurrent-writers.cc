@@ -0,0 +1,143 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "logger/logcursor.h"
+#include "test.h"
+
+// Log comments from many threads at once and verify with a log cursor that
+// the log holds every entry exactly once, in LSN order, with each thread's
+// entries in the order that thread logged them.
+
+static const int NTHREADS = 16;
+static const int NENTRIES = 2000;
+
+static TOKULOGGER logger;
+
+struct writer {
+    int id;
+    toku_pthread_t thread;
+};
+
+static void *writer_thread(void *arg) {
+    struct writer *CAST_FROM_VOIDP(w, arg);
+    LSN prev = ZERO_LSN;
+    for (int i = 0; i < NENTRIES; i++) {
+        char comment[32];
+        int len = snprintf(comment, sizeof comment, "%d.%d", w->id, i);
+        BYTESTRING bs = { .len = (uint32_t) len, .data = comment };
+        LSN lsn;
+        // an occasional fsync makes the logger swap buffers under the writers
+        toku_log_comment(logger, &lsn, (i % 500) == 0, 0, bs);
+        assert(lsn.lsn > prev.lsn);
+        prev = lsn;
+    }
+    return nullptr;
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+
+    int r;
+    toku_os_recursive_delete(TOKU_TEST_FILENAME);
+    r = toku_os_mkdir(TOKU_TEST_FILENAME, S_IRWXU);    assert(r==0);
+
+    r = toku_logger_create(&logger);
+    assert(r == 0);
+    // small log files, so that the writers also race with log file rotation
+    r = toku_logger_set_lg_max(logger, 1<<20);
+    assert(r == 0);
+    r = toku_logger_open(TOKU_TEST_FILENAME, logger);
+    assert(r == 0);
+
+    struct writer writers[NTHREADS];
+    tokutime_t t0 = toku_time_now();
+    for (int i = 0; i < NTHREADS; i++) {
+        writers[i].id = i;
+        r = toku_pthread_create(toku_uninstrumented, &writers[i].thread, nullptr, writer_thread, &writers[i]);
+        assert(r == 0);
+    }
+    for (int i = 0; i < NTHREADS; i++) {
+        r = toku_pthread_join(writers[i].thread, nullptr);
+        assert(r == 0);
+    }
+    if (verbose) {
+        double secs = tokutime_to_seconds(toku_time_now() - t0);
+        printf("%d threads logged %d entries in %.3fs (%.0f entries/s)\n",
+               NTHREADS, NTHREADS * NENTRIES, secs, NTHREADS * NENTRIES / secs);
+    }
+
+    r = toku_logger_close(&logger);
+    assert(r == 0);
+
+    TOKULOGCURSOR lc = NULL;
+    struct log_entry *le;
+    r = toku_logcursor_create(&lc, TOKU_TEST_FILENAME);
+    assert(r == 0 && lc != NULL);
+
+    int next_entry[NTHREADS] = {};
+    uint64_t prev_lsn = 0;
+    int n = 0;
+    while ((r = toku_logcursor_next(lc, &le)) == 0) {
+        assert(le->cmd == LT_comment);
+        assert(le->u.comment.lsn.lsn == prev_lsn + 1 || prev_lsn == 0);
+        prev_lsn = le->u.comment.lsn.lsn;
+        char comment[32];
+        uint32_t len = le->u.comment.comment.len;
+        assert(len < sizeof comment);
+        memcpy(comment, le->u.comment.comment.data, len);
+        comment[len] = 0;
+        int id, i;
+        r = sscanf(comment, "%d.%d", &id, &i);
+        assert(r == 2);
+        assert(0 <= id && id < NTHREADS);
+        assert(i == next_entry[id]);
+        next_entry[id]++;
+        n++;
+    }
+    assert(n == NTHREADS * NENTRIES);
+    for (int i = 0; i < NTHREADS; i++) {
+        assert(next_entry[i] == NENTRIES);
+    }
+
+    r = toku_logcursor_destroy(&lc);
+    assert(r == 0 && lc == NULL);
+
+    toku_os_recursive_delete(TOKU_TEST_FILENAME);
+
+    return 0;
+}
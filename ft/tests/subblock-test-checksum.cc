@@ -44,7 +44,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "serialize/sub_block.h"
 
 #include <toku_portability.h>
-#include <util/threadpool.h>
+#include <util/kibbutz.h>
 
 #include <stdio.h>
 #include <errno.h>
@@ -63,7 +63,7 @@ set_uint8_at_offset(void *vp, size_t offset, uint8_t newv) {
 }
 
 static void
-test_sub_block_checksum(void *buf, int total_size, int my_max_sub_blocks, int n_cores, struct toku_thread_pool *pool, enum toku_compression_method method) {
+test_sub_block_checksum(void *buf, int total_size, int my_max_sub_blocks, int n_cores, KIBBUTZ pool, enum toku_compression_method method) {
     if (verbose)
         printf("%s:%d %d %d\n", __FUNCTION__, __LINE__, total_size, my_max_sub_blocks);
 
@@ -130,7 +130,7 @@ set_random(void *buf, int total_size) {
 }
 
 static void
-run_test(int total_size, int n_cores, struct toku_thread_pool *pool, enum toku_compression_method method) {
+run_test(int total_size, int n_cores, KIBBUTZ pool, enum toku_compression_method method) {
     void *buf = toku_malloc(total_size);
     assert(buf);
 
@@ -174,8 +174,8 @@ test_main (int argc, const char *argv[]) {
         }
     }
 
-    struct toku_thread_pool *pool = NULL;
-    int r = toku_thread_pool_create(&pool, 8); assert(r == 0);
+    KIBBUTZ pool = NULL;
+    int r = toku_kibbutz_create(8, &pool, KIBBUTZ_WORK_STEALING); assert(r == 0);
 
     for (int total_size = 256*1024; total_size <= 4*1024*1024; total_size *= 2) {
         for (int size = total_size - e; size <= total_size + e; size++) {
@@ -187,7 +187,7 @@ test_main (int argc, const char *argv[]) {
         }
     }
 
-    toku_thread_pool_destroy(&pool);
+    toku_kibbutz_destroy(pool);
 
     return 0;
 }
@@ -0,0 +1,150 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Test that a leaf whose basements are all on disk is brought in with one
+// batch of reads, and that every row comes back intact when they complete.
+
+#include "test.h"
+
+#include "cachetable/checkpoint.h"
+
+static TOKUTXN const null_txn = NULL;
+
+static const int nodesize = 1 << 16;
+static const int basementnodesize = 1 << 12;
+static const int n_rows = 4000;
+static const int val_size = 100;
+
+// values don't compress, so the leaf stays bigger than the header read
+static char val_byte(int k, int i) {
+    return (char) (((uint32_t) k * 2654435761U + (uint32_t) i * 40503U) >> 13);
+}
+
+struct scan_extra {
+    int n_seen;
+};
+
+static int
+scan_getf(uint32_t keylen, const void *key, uint32_t vallen, const void *val, void *extra, bool lock_only)
+{
+    struct scan_extra *CAST_FROM_VOIDP(e, extra);
+    // the cursor calls back with no key when it runs off the end
+    if (!lock_only && key != nullptr) {
+        assert(keylen == sizeof(int));
+        assert(vallen == val_size);
+        int k = toku_htonl(*(int *) key);
+        assert(k == e->n_seen);
+        const char *v = (const char *) val;
+        for (int i = 0; i < val_size; i++) {
+            assert(v[i] == val_byte(k, i));
+        }
+        e->n_seen++;
+    }
+    return 0;
+}
+
+static void
+populate(const char *fname)
+{
+    CACHETABLE ct;
+    FT_HANDLE t;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    unlink(fname);
+    int r = toku_open_ft_handle(fname, 1, &t, nodesize, basementnodesize, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    CKERR(r);
+    char v[val_size];
+    for (int i = 0; i < n_rows; i++) {
+        int k = toku_htonl(i);
+        for (int j = 0; j < val_size; j++) {
+            v[j] = val_byte(i, j);
+        }
+        DBT key, val;
+        toku_fill_dbt(&key, &k, sizeof k);
+        toku_fill_dbt(&val, v, sizeof v);
+        toku_ft_insert(t, &key, &val, null_txn);
+    }
+    CHECKPOINTER cp = toku_cachetable_get_checkpointer(ct);
+    r = toku_checkpoint(cp, NULL, NULL, NULL, NULL, NULL, CLIENT_CHECKPOINT);
+    CKERR(r);
+    r = toku_close_ft_handle_nolsn(t, 0);
+    CKERR(r);
+    toku_cachetable_close(&ct);
+}
+
+static void
+scan(const char *fname)
+{
+    CACHETABLE ct;
+    FT_HANDLE t;
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    int r = toku_open_ft_handle(fname, 0, &t, nodesize, basementnodesize, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    CKERR(r);
+
+    // the node is bigger than the header read heuristic, so the first
+    // search reads the header and then, since the cursor covers the whole
+    // range, every basement as one batch
+    FT_CURSOR cursor;
+    r = toku_ft_cursor(t, &cursor, null_txn, false, false);
+    CKERR(r);
+    toku_ft_cursor_set_range_lock(cursor, nullptr, nullptr, true, true, 0);
+    struct scan_extra e = { .n_seen = 0 };
+    r = toku_ft_cursor_first(cursor, scan_getf, &e);
+    CKERR(r);
+    while (r == 0) {
+        r = toku_ft_cursor_next(cursor, scan_getf, &e);
+    }
+    CKERR2(r, DB_NOTFOUND);
+    assert(e.n_seen == n_rows);
+    toku_ft_cursor_close(cursor);
+
+    r = toku_close_ft_handle_nolsn(t, 0);
+    CKERR(r);
+    toku_cachetable_close(&ct);
+}
+
+int
+test_main(int argc, const char *argv[])
+{
+    default_parse_args(argc, argv);
+    const char *fname = TOKU_TEST_FILENAME;
+    populate(fname);
+    scan(fname);
+    scan(fname);
+    unlink(fname);
+    return 0;
+}
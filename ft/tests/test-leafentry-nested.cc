@@ -244,6 +244,28 @@ found_insert:;
     {
         assert((le_latest_is_del(le)==0) == (is_provdel==0));
     }
+    {
+        // the batch extraction must agree with le_val_is_del/le_extract_val.
+        // committed reads only consult the txn for provisional entries.
+        enum cursor_read_type read_types[] = { C_READ_ANY, C_READ_COMMITTED };
+        int num_read_types = ule->num_puxrs == 0 ? 2 : 1;
+        for (int t = 0; t < num_read_types; t++) {
+            for (int leaf_mode = 0; leaf_mode < 2; leaf_mode++) {
+                struct le_cursor_val vals[2];
+                LEAFENTRY les[2] = { le, le };
+                le_extract_vals(les, 2, leaf_mode, read_types[t], nullptr, vals);
+                uint32_t vallen;
+                void *val;
+                le_extract_val(le, leaf_mode, read_types[t], nullptr, &vallen, &val);
+                bool is_del = le_val_is_del(le, read_types[t], nullptr);
+                for (int i = 0; i < 2; i++) {
+                    assert(vals[i].is_del == is_del);
+                    assert(vals[i].vallen == vallen);
+                    assert(vals[i].val == val);
+                }
+            }
+        }
+    }
 }
 
 
@@ -0,0 +1,186 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+
+// Checkpoints that change few blocknums write the block translation table as
+// a delta against the last full one.  Verify the deltas are small, that the
+// fragmentation report accounts for the full translation they depend on, and
+// that the dictionary reads back correctly after it is reopened from a delta.
+
+#include "cachetable/checkpoint.h"
+#include "test.h"
+
+static TOKUTXN const null_txn = 0;
+
+static const int nrows = 200000;
+
+static CACHETABLE ct;
+static FT_HANDLE t;
+
+static void open_ft(bool create) {
+    toku_cachetable_create(&ct, 0, ZERO_LSN, nullptr);
+    int r = toku_open_ft_handle(TOKU_TEST_FILENAME, create, &t, 1024, 256, TOKU_DEFAULT_COMPRESSION_METHOD, ct, null_txn, toku_builtin_compare_fun);
+    assert(r == 0);
+}
+
+static void close_ft(void) {
+    int r = toku_close_ft_handle_nolsn(t, 0);
+    assert(r == 0);
+    toku_cachetable_close(&ct);
+}
+
+static void checkpoint(void) {
+    CHECKPOINTER cp = toku_cachetable_get_checkpointer(ct);
+    int r = toku_checkpoint(cp, NULL, NULL, NULL, NULL, NULL, CLIENT_CHECKPOINT);
+    assert(r == 0);
+}
+
+static void fill_row(int i, int round, char *key, size_t keylen, char *val, size_t vallen) {
+    snprintf(key, keylen, "key%08d", i);
+    snprintf(val, vallen, "val%08d.%04d", i, round);
+}
+
+static void insert_row(int i, int round) {
+    char key[20], val[20];
+    fill_row(i, round, key, sizeof key, val, sizeof val);
+    DBT k, v;
+    toku_ft_insert(t, toku_fill_dbt(&k, key, strlen(key) + 1), toku_fill_dbt(&v, val, strlen(val) + 1), null_txn);
+}
+
+static void check_row(int i, int round) {
+    char key[20], val[20];
+    fill_row(i, round, key, sizeof key, val, sizeof val);
+    ft_lookup_and_check_nodup(t, key, val);
+}
+
+struct translation_info {
+    int64_t num_blocknums;
+    int64_t translation_size;
+};
+
+static int translation_info_helper(BLOCKNUM b, int64_t size, int64_t UU(address), void *extra) {
+    struct translation_info *info = (struct translation_info *) extra;
+    info->num_blocknums++;
+    if (b.b == RESERVED_BLOCKNUM_TRANSLATION) {
+        info->translation_size = size;
+    }
+    return 0;
+}
+
+// Returns true if the last checkpoint wrote the translation as a delta.
+static bool checkpointed_translation_is_delta(void) {
+    struct translation_info info = { 0, 0 };
+    int r = t->ft->blocktable.iterate(block_table::TRANSLATION_CHECKPOINTED, translation_info_helper, &info, false, false);
+    assert(r == 0);
+    assert(info.translation_size > 0);
+    int64_t full_size = 4 + 8 + 8 + info.num_blocknums * 16 + 4;
+    if (verbose) {
+        printf("%" PRId64 " blocknums, translation of %" PRId64 " bytes (full is %" PRId64 ")\n",
+               info.num_blocknums, info.translation_size, full_size);
+    }
+    assert(info.translation_size <= full_size);
+    return info.translation_size < full_size;
+}
+
+// get_fragmentation_unlocked checks that every allocated byte is accounted
+// for as data or as additional checkpoint space.
+static void check_fragmentation(void) {
+    TOKU_DB_FRAGMENTATION_S report;
+    int r = toku_ft_get_fragmentation(t, &report);
+    assert(r == 0);
+    assert(report.data_bytes + report.checkpoint_bytes_additional <= report.file_size_bytes);
+}
+
+static void test_translation_delta(void) {
+    unlink(TOKU_TEST_FILENAME);
+    open_ft(true);
+    for (int i = 0; i < nrows; i++) {
+        insert_row(i, 0);
+    }
+    checkpoint();
+    checkpoint();
+    check_fragmentation();
+
+    // Updating a few neighbouring rows dirties a few nodes.
+    int ndeltas = 0;
+    for (int round = 1; round <= 8; round++) {
+        for (int i = round * 10; i < round * 10 + 5; i++) {
+            insert_row(i, round);
+        }
+        checkpoint();
+        if (checkpointed_translation_is_delta()) {
+            ndeltas++;
+        }
+        check_fragmentation();
+    }
+    assert(ndeltas > 0);
+    close_ft();
+
+    // Reopen from what may be a delta, then keep writing deltas against the
+    // same full translation.
+    open_ft(false);
+    check_fragmentation();
+    for (int i = 0; i < nrows; i++) {
+        int round = (i >= 10 && i < 90 && i % 10 < 5) ? i / 10 : 0;
+        check_row(i, round);
+    }
+    insert_row(0, 9);
+    checkpoint();
+    check_fragmentation();
+
+    // Growing the tree changes most of the table, which writes it in full.
+    for (int i = nrows; i < 2 * nrows; i++) {
+        insert_row(i, 0);
+    }
+    checkpoint();
+    check_fragmentation();
+    close_ft();
+
+    open_ft(false);
+    check_fragmentation();
+    check_row(0, 9);
+    check_row(10, 1);
+    for (int i = nrows; i < 2 * nrows; i++) {
+        check_row(i, 0);
+    }
+    close_ft();
+}
+
+int test_main(int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    test_translation_delta();
+    return 0;
+}
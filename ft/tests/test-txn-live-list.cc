@@ -0,0 +1,152 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+
+#include "toku_os.h"
+#include "cachetable/checkpoint.h"
+
+#include "test-ft-txns.h"
+
+// snapshots taken while the set of live root txns does not change share one
+// live list, and a new one is made once the set changes. read only txns
+// share one snapshot epoch too, which garbage collection still sees.
+
+extern bool garbage_collection_debug;
+
+static TOKUTXN begin_root_txn(TOKULOGGER logger, bool read_only) {
+    TOKUTXN txn = NULL;
+    int r = toku_txn_begin_txn(
+        (DB_TXN *)NULL,
+        NULL,
+        &txn,
+        logger,
+        TXN_SNAPSHOT_ROOT,
+        read_only
+        );
+    CKERR(r);
+    return txn;
+}
+
+static bool gc_sees_snapshot(TOKULOGGER logger, TXNID snapshot_txnid) {
+    xid_omt_t snapshot_xids;
+    rx_omt_t referenced_xids;
+    xid_omt_t live_root_txns;
+    toku_txn_manager_clone_state_for_gc(
+        toku_logger_get_txn_manager(logger),
+        &snapshot_xids,
+        &referenced_xids,
+        &live_root_txns
+        );
+    int r = snapshot_xids.find_zero<TXNID, toku_find_xid_by_xid>(snapshot_txnid, nullptr, nullptr);
+    snapshot_xids.destroy();
+    referenced_xids.destroy();
+    live_root_txns.destroy();
+    return r == 0;
+}
+
+static void commit_txn(TOKUTXN txn) {
+    int r = toku_txn_commit_txn(txn, true, NULL, NULL);
+    CKERR(r);
+    toku_txn_close_txn(txn);
+}
+
+static void run_test(void) {
+    TOKULOGGER logger;
+    CACHETABLE ct;
+    test_setup(TOKU_TEST_FILENAME, &logger, &ct);
+    // check the snapshot system on every txn begin and end
+    garbage_collection_debug = true;
+
+    TOKUTXN writer_1 = begin_root_txn(logger, false);
+    TOKUTXN reader_1 = begin_root_txn(logger, true);
+    TOKUTXN reader_2 = begin_root_txn(logger, true);
+    assert(reader_1->live_root_txn_list == writer_1->live_root_txn_list);
+    assert(reader_2->live_root_txn_list == writer_1->live_root_txn_list);
+    assert(reader_1->live_root_txn_list->size() == 1);
+    assert(toku_is_txn_in_live_root_txn_list(*reader_1->live_root_txn_list, writer_1->txnid.parent_id64));
+
+    // the read only txns share one epoch, and its snapshot
+    assert(writer_1->snapshot_epoch == NULL);
+    assert(reader_1->snapshot_epoch != NULL);
+    assert(reader_2->snapshot_epoch == reader_1->snapshot_epoch);
+    assert(reader_2->snapshot_txnid64 == reader_1->snapshot_txnid64);
+    assert(reader_1->snapshot_txnid64 > writer_1->snapshot_txnid64);
+    assert(gc_sees_snapshot(logger, reader_1->snapshot_txnid64));
+
+    // a new writer changes the live root txns, so it gets a new list
+    TOKUTXN writer_2 = begin_root_txn(logger, false);
+    TOKUTXN reader_3 = begin_root_txn(logger, true);
+    assert(writer_2->live_root_txn_list != reader_1->live_root_txn_list);
+    assert(reader_3->live_root_txn_list == writer_2->live_root_txn_list);
+    assert(reader_3->live_root_txn_list->size() == 2);
+    assert(reader_3->snapshot_epoch != reader_1->snapshot_epoch);
+    assert(reader_3->snapshot_txnid64 > writer_2->snapshot_txnid64);
+
+    // committing a writer does too. readers that began before the commit
+    // still do not read it, readers that began after do.
+    TXNID writer_1_xid = writer_1->txnid.parent_id64;
+    commit_txn(writer_1);
+    TOKUTXN reader_4 = begin_root_txn(logger, true);
+    assert(reader_4->live_root_txn_list != reader_3->live_root_txn_list);
+    assert(reader_4->live_root_txn_list->size() == 1);
+    assert(toku_txn_reads_txnid(writer_1_xid, reader_2, false) == 0);
+    assert(toku_txn_reads_txnid(writer_1_xid, reader_3, false) == 0);
+    assert(toku_txn_reads_txnid(writer_1_xid, reader_4, false) == TOKUDB_ACCEPT);
+    assert(toku_txn_reads_txnid(writer_2->txnid.parent_id64, reader_4, false) == 0);
+
+    // the epoch lives on while any of its txns does
+    TXNID reader_1_snapshot_txnid = reader_1->snapshot_txnid64;
+    commit_txn(reader_1);
+    assert(toku_txn_reads_txnid(writer_1_xid, reader_2, false) == 0);
+    assert(gc_sees_snapshot(logger, reader_1_snapshot_txnid));
+    commit_txn(reader_2);
+    assert(!gc_sees_snapshot(logger, reader_1_snapshot_txnid));
+    commit_txn(writer_2);
+    commit_txn(reader_3);
+    commit_txn(reader_4);
+
+    garbage_collection_debug = false;
+    clean_shutdown(&logger, &ct);
+}
+
+int test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    run_test();
+    return 0;
+}
@@ -58,9 +58,11 @@ static void run_recovery(const char *testdir) {
     FILE *f = fopen(logfiles[n_logfiles-1], "r");
     assert(f);
     uint32_t real_log_version;
-    r = toku_read_logmagic(f, &real_log_version);
+    enum toku_checksum_method checksum_method;
+    r = toku_read_logmagic(f, &real_log_version, &checksum_method);
     CKERR(r);
     assert((uint32_t)log_version == (uint32_t)real_log_version);
+    assert(checksum_method == TOKU_CHECKSUM_X1764);
     r = fclose(f);
     CKERR(r);
 
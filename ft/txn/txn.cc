@@ -240,6 +240,8 @@ struct tokutxn new_txn = {
     .child_manager = NULL,
     .container_db_txn = container_db_txn,
     .live_root_txn_list = nullptr,
+    .live_list = nullptr,
+    .snapshot_epoch = nullptr,
     .xids = NULL,
     .snapshot_next = NULL,
     .snapshot_prev = NULL,
@@ -90,6 +90,23 @@ typedef toku::omt<struct tokutxn *> txn_omt_t;
 typedef toku::omt<TXNID> xid_omt_t;
 typedef toku::omt<struct referenced_xid_tuple, struct referenced_xid_tuple *> rx_omt_t;
 
+// An immutable list of the root txns that were live when a snapshot was taken.
+// Every snapshot taken while the set of live root txns does not change shares
+// the same list, so taking a snapshot does not have to copy it.
+struct txn_live_list {
+    xid_omt_t ids;
+    // number of txns holding a reference to this list, changed atomically
+    uint32_t refs;
+    // number of snapshots using this list, protected by the txn manager lock
+    uint32_t num_snapshots;
+    // the txn manager's last xid when the list was made. every root txn that
+    // began before then and is still live is in the list.
+    TXNID newest_xid;
+    // in the txn manager's list of live lists used by snapshots
+    struct txn_live_list *snapshot_next;
+    struct txn_live_list *snapshot_prev;
+};
+
 inline bool txn_pair_is_none(TXNID_PAIR txnid) {
     return txnid.parent_id64 == TXNID_NONE && txnid.child_id64 == TXNID_NONE;
 }
@@ -158,6 +175,8 @@ struct tokutxn {
     // strictly const.
     DB_TXN *container_db_txn; // reference to DB_TXN that contains this tokutxn
     xid_omt_t *live_root_txn_list; // the root txns live when the root ancestor (self if a root) started.
+    struct txn_live_list *live_list; // the shared list holding live_root_txn_list, if this txn holds a reference to it
+    struct txn_snapshot_epoch *snapshot_epoch; // the snapshot shared with other read only root txns, if this txn took one
     struct XIDS_S *xids; // Represents the xid list
 
     struct tokutxn *snapshot_next;
@@ -57,6 +57,7 @@ void set_test_txn_sync_callback(void (*cb) (pthread_t, void *), void *extra) {
 bool garbage_collection_debug = false;
 
 toku_instr_key *txn_manager_lock_mutex_key;
+toku_instr_key *txn_manager_epoch_rwlock_key;
 
 static bool txn_records_snapshot(TXN_SNAPSHOT_TYPE snapshot_type,
                                  struct tokutxn *parent) {
@@ -105,9 +106,9 @@ static void toku_txn_manager_clone_state_for_gc_unlocked(
 
 static void
 verify_snapshot_system(TXN_MANAGER txn_manager UU()) {
-    uint32_t    num_snapshot_txnids = txn_manager->num_snapshots;
+    uint32_t    num_snapshot_txnids = txn_manager->num_snapshots + txn_manager->num_epochs;
     TXNID       snapshot_txnids[num_snapshot_txnids];
-    TOKUTXN     snapshot_txns[num_snapshot_txnids];
+    xid_omt_t  *snapshot_live_root_txn_lists[num_snapshot_txnids];
     uint32_t    num_live_txns = txn_manager->live_root_txns.size();
     TOKUTXN     live_txns[num_live_txns];
     uint32_t    num_referenced_xid_tuples = txn_manager->referenced_xids.size();
@@ -132,11 +133,19 @@ verify_snapshot_system(TXN_MANAGER txn_manager UU()) {
         TOKUTXN curr_txn = txn_manager->snapshot_head;
         uint32_t curr_index = 0;
         while (curr_txn != NULL) {
-            snapshot_txns[curr_index] = curr_txn;
+            snapshot_live_root_txn_lists[curr_index] = curr_txn->live_root_txn_list;
             snapshot_txnids[curr_index] = curr_txn->snapshot_txnid64;
             curr_txn = curr_txn->snapshot_next;
             curr_index++;
         }
+        struct txn_snapshot_epoch *curr_epoch = txn_manager->epoch_head;
+        while (curr_epoch != NULL) {
+            snapshot_live_root_txn_lists[curr_index] = &curr_epoch->live_list->ids;
+            snapshot_txnids[curr_index] = curr_epoch->snapshot_txnid64;
+            curr_epoch = curr_epoch->next;
+            curr_index++;
+        }
+        invariant(curr_index == num_snapshot_txnids);
     }
 
     for (i = 0; i < num_live_txns; i++) {
@@ -152,12 +161,12 @@ verify_snapshot_system(TXN_MANAGER txn_manager UU()) {
         //Verify snapshot_txnids
         for (i = 0; i < num_snapshot_txnids; i++) {
             TXNID snapshot_xid = snapshot_txnids[i];
-            TOKUTXN snapshot_txn = snapshot_txns[i];
-            uint32_t num_live_root_txn_list = snapshot_txn->live_root_txn_list->size();
+            xid_omt_t *snapshot_live_root_txn_list = snapshot_live_root_txn_lists[i];
+            uint32_t num_live_root_txn_list = snapshot_live_root_txn_list->size();
             TXNID     live_root_txn_list[num_live_root_txn_list];
             {
                 for (j = 0; j < num_live_root_txn_list; j++) {
-                    r = snapshot_txn->live_root_txn_list->fetch(j, &live_root_txn_list[j]);
+                    r = snapshot_live_root_txn_list->fetch(j, &live_root_txn_list[j]);
                     assert_zero(r);
                 }
             }
@@ -217,15 +226,21 @@ verify_snapshot_system(TXN_MANAGER txn_manager UU()) {
                 }
             }
             {
-                // Verify number of references is correct
+                // Verify number of references is correct. A tuple is referenced
+                // once by each live list used by a snapshot, however many
+                // snapshots share it.
                 uint32_t refs_found = 0;
-                for (j = 0; j < num_snapshot_txnids; j++) {
-                    TOKUTXN snapshot_txn = snapshot_txns[j];
-                    if (toku_is_txn_in_live_root_txn_list(*snapshot_txn->live_root_txn_list, tuple->begin_id)) {
+                for (struct txn_live_list *live_list = txn_manager->snapshot_live_lists_head;
+                     live_list != nullptr;
+                     live_list = live_list->snapshot_next) {
+                    invariant(live_list->num_snapshots > 0);
+                    if (toku_is_txn_in_live_root_txn_list(live_list->ids, tuple->begin_id)) {
                         refs_found++;
                     }
+                }
+                for (j = 0; j < num_snapshot_txnids; j++) {
                     invariant(!toku_is_txn_in_live_root_txn_list(
-                                *snapshot_txn->live_root_txn_list,
+                                *snapshot_live_root_txn_lists[j],
                                 tuple->end_id));
                 }
                 invariant(refs_found == tuple->references);
@@ -261,6 +276,15 @@ void toku_txn_manager_init(TXN_MANAGER *txn_managerp) {
     txn_manager->snapshot_tail = NULL;
     txn_manager->num_snapshots = 0;
     txn_manager->referenced_xids.create();
+    txn_manager->live_list = nullptr;
+    txn_manager->snapshot_live_lists_head = nullptr;
+    txn_manager->snapshot_live_lists_tail = nullptr;
+    toku_pthread_rwlock_init(
+        *txn_manager_epoch_rwlock_key, &txn_manager->epoch_lock, nullptr);
+    txn_manager->current_epoch = nullptr;
+    txn_manager->epoch_head = nullptr;
+    txn_manager->epoch_tail = nullptr;
+    txn_manager->num_epochs = 0;
     txn_manager->last_xid = 0;
 
     txn_manager->last_xid_seen_for_recover = TXNID_NONE;
@@ -269,7 +293,13 @@ void toku_txn_manager_init(TXN_MANAGER *txn_managerp) {
     *txn_managerp = txn_manager;
 }
 
+static void txn_manager_invalidate_live_list_unlocked(TXN_MANAGER txn_manager);
+
 void toku_txn_manager_destroy(TXN_MANAGER txn_manager) {
+    txn_manager_invalidate_live_list_unlocked(txn_manager);
+    invariant(txn_manager->epoch_head == nullptr);
+    invariant(txn_manager->snapshot_live_lists_head == nullptr);
+    toku_pthread_rwlock_destroy(&txn_manager->epoch_lock);
     toku_mutex_destroy(&txn_manager->txn_manager_lock);
     invariant(txn_manager->live_root_txns.size() == 0);
     txn_manager->live_root_txns.destroy();
@@ -319,6 +349,63 @@ setup_live_root_txn_list(xid_omt_t* live_root_txnid, xid_omt_t* live_root_txn_li
     }
 }
 
+// Release a reference to a live list, destroying it with the last one.
+static void txn_live_list_release(struct txn_live_list *live_list) {
+    if (toku_sync_sub_and_fetch(&live_list->refs, 1) == 0) {
+        live_list->ids.destroy();
+        toku_free(live_list);
+    }
+}
+
+// Get a reference to the live list of the current live root txns.
+// The list is only built if the set of live root txns changed since the
+// last snapshot was taken, otherwise this is O(1).
+static struct txn_live_list *txn_manager_get_live_list_unlocked(TXN_MANAGER txn_manager) {
+    struct txn_live_list *live_list = txn_manager->live_list;
+    if (live_list == nullptr) {
+        XMALLOC(live_list);
+        setup_live_root_txn_list(&txn_manager->live_root_ids, &live_list->ids);
+        live_list->refs = 1; // the txn manager's reference
+        live_list->num_snapshots = 0;
+        live_list->newest_xid = toku_unsafe_fetch(&txn_manager->last_xid);
+        live_list->snapshot_next = nullptr;
+        live_list->snapshot_prev = nullptr;
+        txn_manager->live_list = live_list;
+    }
+    toku_sync_fetch_and_add(&live_list->refs, 1);
+    return live_list;
+}
+
+static void txn_manager_reference_live_list_unlocked(TXN_MANAGER txn_manager, TOKUTXN txn) {
+    invariant(txn->live_list == nullptr);
+    txn->live_list = txn_manager_get_live_list_unlocked(txn_manager);
+    txn->live_root_txn_list = &txn->live_list->ids;
+}
+
+// Note that a snapshot uses live_list. Only the current live list gets new
+// snapshots, so the lists used by snapshots stay ordered by newest_xid.
+static void txn_manager_add_snapshot_live_list_unlocked(TXN_MANAGER txn_manager, struct txn_live_list *live_list) {
+    if (live_list->num_snapshots++ > 0) {
+        return;
+    }
+    invariant(live_list == txn_manager->live_list);
+    live_list->snapshot_next = nullptr;
+    live_list->snapshot_prev = txn_manager->snapshot_live_lists_tail;
+    if (txn_manager->snapshot_live_lists_tail != nullptr) {
+        txn_manager->snapshot_live_lists_tail->snapshot_next = live_list;
+    } else {
+        txn_manager->snapshot_live_lists_head = live_list;
+    }
+    txn_manager->snapshot_live_lists_tail = live_list;
+}
+
+static void txn_release_live_list(TOKUTXN txn) {
+    invariant(txn->live_list != nullptr);
+    txn_live_list_release(txn->live_list);
+    txn->live_list = nullptr;
+    txn->live_root_txn_list = nullptr;
+}
+
 //Heaviside function to search through an OMT by a TXNID
 int
 find_by_xid (const TOKUTXN &txn, const TXNID &txnidfind) {
@@ -355,8 +442,16 @@ static void set_oldest_referenced_xid(TXN_MANAGER txn_manager) {
             oldest_referenced_xid = id;
         }
     }
-    if (txn_manager->last_xid < oldest_referenced_xid) {
-        oldest_referenced_xid = txn_manager->last_xid;
+    if (txn_manager->epoch_head != NULL) {
+        TXNID id = txn_manager->epoch_head->snapshot_txnid64;
+        if (id < oldest_referenced_xid) {
+            oldest_referenced_xid = id;
+        }
+    }
+    // read only txns take xids without the txn_manager_lock
+    const TXNID last_xid = toku_unsafe_fetch(&txn_manager->last_xid);
+    if (last_xid < oldest_referenced_xid) {
+        oldest_referenced_xid = last_xid;
     }
     invariant(oldest_referenced_xid != TXNID_MAX);
     toku_unsafe_set(&txn_manager->last_calculated_oldest_referenced_xid, oldest_referenced_xid);
@@ -378,7 +473,9 @@ static inline void txn_manager_create_snapshot_unlocked(
     TOKUTXN txn
     ) 
 {    
-    txn->snapshot_txnid64 = ++txn_manager->last_xid;    
+    txn->snapshot_txnid64 = toku_sync_add_and_fetch(&txn_manager->last_xid, 1);
+    txn_manager_reference_live_list_unlocked(txn_manager, txn);
+    txn_manager_add_snapshot_live_list_unlocked(txn_manager, txn->live_list);
     // Add this txn to the global list of txns that have their own snapshots.
     // (Note, if a txn is a child that creates its own snapshot, then that child xid
     // is the xid stored in the global list.) 
@@ -483,6 +580,97 @@ note_snapshot_txn_end_by_txn_live_list(TXN_MANAGER mgr, xid_omt_t* live_root_txn
     return 0;
 }
 
+// Note that a snapshot no longer uses live_list. Referenced xids are
+// referenced once per live list, not per snapshot, so only the last
+// snapshot using a live list releases them.
+static void txn_manager_remove_snapshot_live_list_unlocked(TXN_MANAGER txn_manager, struct txn_live_list *live_list) {
+    invariant(live_list->num_snapshots > 0);
+    if (--live_list->num_snapshots > 0) {
+        return;
+    }
+    if (live_list->snapshot_prev != nullptr) {
+        live_list->snapshot_prev->snapshot_next = live_list->snapshot_next;
+    } else {
+        txn_manager->snapshot_live_lists_head = live_list->snapshot_next;
+    }
+    if (live_list->snapshot_next != nullptr) {
+        live_list->snapshot_next->snapshot_prev = live_list->snapshot_prev;
+    } else {
+        txn_manager->snapshot_live_lists_tail = live_list->snapshot_prev;
+    }
+    live_list->snapshot_next = nullptr;
+    live_list->snapshot_prev = nullptr;
+
+    uint32_t ref_xids_size = txn_manager->referenced_xids.size();
+    uint32_t live_list_size = live_list->ids.size();
+    if (ref_xids_size > 0 && live_list_size > 0) {
+        if (live_list_size > ref_xids_size && ref_xids_size < 2000) {
+            note_snapshot_txn_end_by_txn_live_list(txn_manager, &live_list->ids);
+        }
+        else {
+            note_snapshot_txn_end_by_ref_xids(txn_manager, live_list->ids);
+        }
+    }
+}
+
+static void txn_manager_destroy_epoch_unlocked(TXN_MANAGER txn_manager, struct txn_snapshot_epoch *epoch) {
+    if (epoch->prev != nullptr) {
+        epoch->prev->next = epoch->next;
+    } else {
+        txn_manager->epoch_head = epoch->next;
+    }
+    if (epoch->next != nullptr) {
+        epoch->next->prev = epoch->prev;
+    } else {
+        txn_manager->epoch_tail = epoch->prev;
+    }
+    txn_manager->num_epochs--;
+    txn_manager_remove_snapshot_live_list_unlocked(txn_manager, epoch->live_list);
+    txn_live_list_release(epoch->live_list);
+    toku_free(epoch);
+}
+
+// The set of live root txns changed, so the next snapshot needs a new live
+// list and the next read only txn a new epoch.
+static void txn_manager_invalidate_live_list_unlocked(TXN_MANAGER txn_manager) {
+    if (txn_manager->live_list != nullptr) {
+        txn_live_list_release(txn_manager->live_list);
+        txn_manager->live_list = nullptr;
+    }
+    struct txn_snapshot_epoch *epoch = txn_manager->current_epoch;
+    if (epoch != nullptr) {
+        toku_pthread_rwlock_wrlock(&txn_manager->epoch_lock);
+        txn_manager->current_epoch = nullptr;
+        toku_pthread_rwlock_wrunlock(&txn_manager->epoch_lock);
+        if (toku_sync_sub_and_fetch(&epoch->refs, 1) == 0) {
+            txn_manager_destroy_epoch_unlocked(txn_manager, epoch);
+        }
+    }
+}
+
+// Make a new current epoch for read only txns, registered as one snapshot.
+static void txn_manager_create_epoch_unlocked(TXN_MANAGER txn_manager) {
+    invariant(txn_manager->current_epoch == nullptr);
+    struct txn_snapshot_epoch *XMALLOC(epoch);
+    epoch->snapshot_txnid64 = toku_sync_add_and_fetch(&txn_manager->last_xid, 1);
+    epoch->live_list = txn_manager_get_live_list_unlocked(txn_manager);
+    txn_manager_add_snapshot_live_list_unlocked(txn_manager, epoch->live_list);
+    epoch->refs = 1; // the txn manager's reference
+    epoch->next = nullptr;
+    epoch->prev = txn_manager->epoch_tail;
+    if (txn_manager->epoch_tail != nullptr) {
+        txn_manager->epoch_tail->next = epoch;
+    } else {
+        txn_manager->epoch_head = epoch;
+    }
+    txn_manager->epoch_tail = epoch;
+    txn_manager->num_epochs++;
+
+    toku_pthread_rwlock_wrlock(&txn_manager->epoch_lock);
+    txn_manager->current_epoch = epoch;
+    toku_pthread_rwlock_wrunlock(&txn_manager->epoch_lock);
+}
+
 static inline void txn_manager_remove_snapshot_unlocked(
     TOKUTXN txn, 
     TXN_MANAGER txn_manager
@@ -502,16 +690,7 @@ static inline void txn_manager_remove_snapshot_unlocked(
         txn->snapshot_prev->snapshot_next = txn->snapshot_next;
     }    
     txn_manager->num_snapshots--;
-    uint32_t ref_xids_size = txn_manager->referenced_xids.size();
-    uint32_t live_list_size = txn->live_root_txn_list->size();
-    if (ref_xids_size > 0 && live_list_size > 0) {
-        if (live_list_size > ref_xids_size && ref_xids_size < 2000) {
-            note_snapshot_txn_end_by_txn_live_list(txn_manager, txn->live_root_txn_list);
-        }
-        else {
-            note_snapshot_txn_end_by_ref_xids(txn_manager, *txn->live_root_txn_list);
-        }
-    }
+    txn_manager_remove_snapshot_live_list_unlocked(txn_manager, txn->live_list);
 }
 
 static inline void inherit_snapshot_from_parent(TOKUTXN child) {
@@ -533,8 +712,6 @@ void toku_txn_manager_handle_snapshot_create_for_child_txn(
     // assert that if records_snapshot is true, then copies_snapshot is true
     invariant(!records_snapshot || copies_snapshot);
     if (records_snapshot) {
-        invariant(txn->live_root_txn_list == nullptr);
-        XMALLOC(txn->live_root_txn_list);
         txn_manager_lock(txn_manager);
         txn_manager_create_snapshot_unlocked(txn_manager, txn);
     }
@@ -545,10 +722,11 @@ void toku_txn_manager_handle_snapshot_create_for_child_txn(
     toku_debug_txn_sync(pthread_self());
     
     if (copies_snapshot) { 
-	if(!records_snapshot) 
-    	    txn_manager_lock(txn_manager);
-	setup_live_root_txn_list(&txn_manager->live_root_ids, txn->live_root_txn_list);  
-       txn_manager_unlock(txn_manager);
+        if (!records_snapshot) {
+            txn_manager_lock(txn_manager);
+            txn_manager_reference_live_list_unlocked(txn_manager, txn);
+        }
+        txn_manager_unlock(txn_manager);
     } 
 }
 
@@ -568,9 +746,7 @@ void toku_txn_manager_handle_snapshot_destroy_for_child_txn(
         txn_manager_unlock(txn_manager);
     }
     if (copies_snapshot) {
-        invariant(txn->live_root_txn_list != nullptr);
-        txn->live_root_txn_list->destroy();
-        toku_free(txn->live_root_txn_list);
+        txn_release_live_list(txn);
     }
 }
 
@@ -592,10 +768,73 @@ void toku_txn_manager_start_txn_for_recovery(
     invariant_zero(r);
     r = txn_manager->live_root_ids.insert_at(txn->txnid.parent_id64, idx);
     invariant_zero(r);
+    txn_manager_invalidate_live_list_unlocked(txn_manager);
 
     txn_manager_unlock(txn_manager);
 }
 
+// A read only root txn is never in a live list, so it only needs a unique
+// xid, and it shares the current epoch's snapshot. Neither needs the
+// txn_manager_lock unless the epoch has to be made.
+static void txn_manager_start_read_only_snapshot_txn(
+    TOKUTXN txn,
+    TXN_MANAGER txn_manager
+    )
+{
+    TXNID xid = toku_sync_add_and_fetch(&txn_manager->last_xid, 1);
+    toku_txn_update_xids_in_txn(txn, xid);
+
+    struct txn_snapshot_epoch *epoch = nullptr;
+    toku_pthread_rwlock_rdlock(&txn_manager->epoch_lock);
+    if (txn_manager->current_epoch != nullptr) {
+        epoch = txn_manager->current_epoch;
+        toku_sync_fetch_and_add(&epoch->refs, 1);
+    }
+    toku_pthread_rwlock_rdunlock(&txn_manager->epoch_lock);
+
+    if (epoch == nullptr) {
+        txn_manager_lock(txn_manager);
+        if (garbage_collection_debug) {
+            verify_snapshot_system(txn_manager);
+        }
+        if (txn_manager->current_epoch == nullptr) {
+            txn_manager_create_epoch_unlocked(txn_manager);
+            set_oldest_referenced_xid(txn_manager);
+        }
+        // the current epoch cannot be retired while we hold the txn_manager_lock
+        epoch = txn_manager->current_epoch;
+        toku_sync_fetch_and_add(&epoch->refs, 1);
+        if (garbage_collection_debug) {
+            verify_snapshot_system(txn_manager);
+        }
+        txn_manager_unlock(txn_manager);
+    }
+
+    txn->snapshot_epoch = epoch;
+    txn->snapshot_txnid64 = epoch->snapshot_txnid64;
+    txn->live_root_txn_list = &epoch->live_list->ids;
+}
+
+static void txn_manager_finish_read_only_snapshot_txn(
+    TXN_MANAGER txn_manager,
+    TOKUTXN txn
+    )
+{
+    struct txn_snapshot_epoch *epoch = txn->snapshot_epoch;
+    txn->snapshot_epoch = nullptr;
+    txn->live_root_txn_list = nullptr;
+    // the txn manager holds a reference to the current epoch, so this
+    // can only be the last reference to a retired one
+    if (toku_sync_sub_and_fetch(&epoch->refs, 1) == 0) {
+        txn_manager_lock(txn_manager);
+        txn_manager_destroy_epoch_unlocked(txn_manager, epoch);
+        if (garbage_collection_debug) {
+            verify_snapshot_system(txn_manager);
+        }
+        txn_manager_unlock(txn_manager);
+    }
+}
+
 void toku_txn_manager_start_txn(
     TOKUTXN txn,
     TXN_MANAGER txn_manager,
@@ -611,12 +850,11 @@ void toku_txn_manager_start_txn(
     // assert that if records_snapshot is true, then copies_snapshot is true
     invariant(!records_snapshot || copies_snapshot);
 
-    // perform a malloc outside of the txn_manager lock
-    // will be used in txn_manager_create_snapshot_unlocked below
-    if (copies_snapshot) {
-        invariant(txn->live_root_txn_list == nullptr);
-        XMALLOC(txn->live_root_txn_list);
+    if (read_only && records_snapshot) {
+        txn_manager_start_read_only_snapshot_txn(txn, txn_manager);
+        return;
     }
+
     // the act of getting a transaction ID and adding the
     // txn to the proper OMTs must be atomic. MVCC depends
     // on this.
@@ -629,7 +867,8 @@ void toku_txn_manager_start_txn(
     // maintain the data structures necessary for MVCC:
     //  1. add txn to list of live_root_txns if this is a root transaction
     //  2. if the transaction is creating a snapshot:
-    //    - create a live list for the transaction
+    //    - reference the live list shared by snapshots of the current
+    //      live root txns, creating it if they changed
     //    - add the id to the list of snapshot ids
     //
     // The order of operations is important here, and must be taken
@@ -639,7 +878,7 @@ void toku_txn_manager_start_txn(
     // is taken into account when the transaction is closed.
 
     // add ancestor information, and maintain global live root txn list
-    xid = ++txn_manager->last_xid; // we always need an ID, needed for lock tree
+    xid = toku_sync_add_and_fetch(&txn_manager->last_xid, 1); // we always need an ID, needed for lock tree
     toku_txn_update_xids_in_txn(txn, xid);
     if (!read_only) {
         uint32_t idx = txn_manager->live_root_txns.size();
@@ -647,6 +886,7 @@ void toku_txn_manager_start_txn(
         invariant_zero(r);
         r = txn_manager->live_root_ids.insert_at(txn->txnid.parent_id64, idx);
         invariant_zero(r);
+        txn_manager_invalidate_live_list_unlocked(txn_manager);
     }
     set_oldest_referenced_xid(txn_manager);
     
@@ -655,9 +895,8 @@ void toku_txn_manager_start_txn(
             txn_manager,
             txn
             );
-    }
-    if (copies_snapshot) {
-        setup_live_root_txn_list(&txn_manager->live_root_ids, txn->live_root_txn_list);  
+    } else if (copies_snapshot) {
+        txn_manager_reference_live_list_unlocked(txn_manager, txn);
     }
 
     if (garbage_collection_debug) {
@@ -694,6 +933,11 @@ done:
 void toku_txn_manager_finish_txn(TXN_MANAGER txn_manager, TOKUTXN txn) {
     int r;
     invariant(txn->parent == NULL);
+    if (txn->snapshot_epoch != nullptr) {
+        invariant(txn_declared_read_only(txn));
+        txn_manager_finish_read_only_snapshot_txn(txn_manager, txn);
+        return;
+    }
     bool records_snapshot = txn_records_snapshot(txn->snapshot_type, NULL);
     txn_manager_lock(txn_manager);
 
@@ -720,25 +964,23 @@ void toku_txn_manager_finish_txn(TXN_MANAGER txn_manager, TOKUTXN txn) {
         invariant_zero(r);
         r = txn_manager->live_root_ids.delete_at(idx);
         invariant_zero(r);
+        txn_manager_invalidate_live_list_unlocked(txn_manager);
 
         if (!toku_txn_is_read_only(txn) || garbage_collection_debug) {
+            // count the live lists used by snapshots that this txn is in,
+            // which are the ones made after it began.
             uint32_t num_references = 0;
-            TOKUTXN curr_txn = txn_manager->snapshot_tail;
-            while(curr_txn != NULL) {
-                if (curr_txn->snapshot_txnid64 > txn->txnid.parent_id64) {
-                    num_references++;
-                }
-                else {
-                    break;
-                }
-                curr_txn = curr_txn->snapshot_prev;
+            struct txn_live_list *live_list = txn_manager->snapshot_live_lists_tail;
+            while (live_list != nullptr && live_list->newest_xid >= txn->txnid.parent_id64) {
+                num_references++;
+                live_list = live_list->snapshot_prev;
             }
             
             if (num_references > 0) {
                 // This transaction exists in a live list of another transaction.
                 struct referenced_xid_tuple tuple = {
                     .begin_id = txn->txnid.parent_id64,
-                    .end_id = ++txn_manager->last_xid,
+                    .end_id = toku_sync_add_and_fetch(&txn_manager->last_xid, 1),
                     .references = num_references
                 };
                 r = txn_manager->referenced_xids.insert<TXNID, find_tuple_by_xid>(tuple, txn->txnid.parent_id64, nullptr);
@@ -753,9 +995,8 @@ void toku_txn_manager_finish_txn(TXN_MANAGER txn_manager, TOKUTXN txn) {
     txn_manager_unlock(txn_manager);
 
     //Cleanup that does not require the txn_manager lock
-    if (txn->live_root_txn_list) {
-        txn->live_root_txn_list->destroy();
-        toku_free(txn->live_root_txn_list);
+    if (txn->live_list) {
+        txn_release_live_list(txn);
     }
     return;
 }
@@ -767,19 +1008,30 @@ static void toku_txn_manager_clone_state_for_gc_unlocked(
     xid_omt_t* live_root_txns
     )
 {
+    // merge the snapshot txns and the epochs of read only txns, which are
+    // each already sorted by snapshot xid
+    const uint32_t num_snapshot_xids = txn_manager->num_snapshots + txn_manager->num_epochs;
     TXNID* snapshot_xids_array = NULL;
-    XMALLOC_N(txn_manager->num_snapshots, snapshot_xids_array);
+    XMALLOC_N(num_snapshot_xids, snapshot_xids_array);
     TOKUTXN curr_txn = txn_manager->snapshot_head;
+    struct txn_snapshot_epoch *curr_epoch = txn_manager->epoch_head;
     uint32_t curr_index = 0;
-    while (curr_txn != NULL) {
-        snapshot_xids_array[curr_index] = curr_txn->snapshot_txnid64;
-        curr_txn = curr_txn->snapshot_next;
+    while (curr_txn != NULL || curr_epoch != NULL) {
+        if (curr_epoch == NULL ||
+            (curr_txn != NULL && curr_txn->snapshot_txnid64 < curr_epoch->snapshot_txnid64)) {
+            snapshot_xids_array[curr_index] = curr_txn->snapshot_txnid64;
+            curr_txn = curr_txn->snapshot_next;
+        } else {
+            snapshot_xids_array[curr_index] = curr_epoch->snapshot_txnid64;
+            curr_epoch = curr_epoch->next;
+        }
         curr_index++;
     }
+    invariant(curr_index == num_snapshot_xids);
     snapshot_xids->create_steal_sorted_array(
         &snapshot_xids_array, 
-        txn_manager->num_snapshots,
-        txn_manager->num_snapshots
+        num_snapshot_xids,
+        num_snapshot_xids
         );
     
     referenced_xids->clone(txn_manager->referenced_xids);
@@ -1034,7 +1286,7 @@ toku_txn_manager_txns_exist(TXN_MANAGER mgr) {
 void
 toku_txn_manager_increase_last_xid(TXN_MANAGER mgr, uint64_t increment) {
     txn_manager_lock(mgr);
-    mgr->last_xid += increment;
+    toku_sync_fetch_and_add(&mgr->last_xid, increment);
     txn_manager_unlock(mgr);
 }
 
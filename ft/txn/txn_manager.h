@@ -60,6 +60,20 @@ struct referenced_xid_tuple {
     uint32_t references;
 };
 
+// A snapshot shared by the read only root txns that begin while the set of
+// live root txns does not change. They reference the current epoch without
+// taking the txn_manager_lock, and the txn manager counts the whole epoch as
+// one snapshot for mvcc and garbage collection.
+struct txn_snapshot_epoch {
+    TXNID snapshot_txnid64;
+    struct txn_live_list *live_list;
+    // number of txns referencing the epoch, changed atomically. the txn
+    // manager holds one more reference while the epoch is current.
+    uint32_t refs;
+    struct txn_snapshot_epoch *next;
+    struct txn_snapshot_epoch *prev;
+};
+
 struct txn_manager {
     toku_mutex_t txn_manager_lock;  // a lock protecting this object
     txn_omt_t live_root_txns; // a sorted tree.
@@ -70,6 +84,24 @@ struct txn_manager {
     // Contains 3-tuples: (TXNID begin_id, TXNID end_id, uint64_t num_live_list_references)
     //                    for committed root transaction ids that are still referenced by a live list.
     rx_omt_t referenced_xids;
+    // the live list shared by the snapshots taken since live_root_ids last
+    // changed, or null if none was taken yet
+    struct txn_live_list *live_list;
+    // live lists used by at least one snapshot, oldest first. a referenced
+    // xid is referenced once by each of them that it is in.
+    struct txn_live_list *snapshot_live_lists_head;
+    struct txn_live_list *snapshot_live_lists_tail;
+
+    // the epoch that read only txns beginning now share, or null if none
+    // began since live_root_ids last changed. protected by epoch_lock, and
+    // only changed with the txn_manager_lock held too.
+    toku_pthread_rwlock_t epoch_lock;
+    struct txn_snapshot_epoch *current_epoch;
+    // epochs still referenced by some txn, oldest first. protected by the
+    // txn_manager_lock.
+    struct txn_snapshot_epoch *epoch_head;
+    struct txn_snapshot_epoch *epoch_tail;
+    uint32_t num_epochs;
 
     TXNID last_xid;
     TXNID last_xid_seen_for_recover;
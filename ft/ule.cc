@@ -602,6 +602,29 @@ bool toku_le_worth_running_garbage_collection(
            gc_info->oldest_referenced_xid_for_implicit_promotion;
 }
 
+void toku_le_count_garbage(
+    LEAFENTRY le,
+    uint32_t* num_stale_cxrs,
+    uint32_t* num_pxrs,
+    TXNID* newest_xid) {
+    if (le == nullptr || le->type != LE_MVCC) {
+        *num_stale_cxrs = 0;
+        *num_pxrs = 0;
+        *newest_xid = TXNID_NONE;
+        return;
+    }
+    *num_stale_cxrs = toku_dtoh32(le->u.mvcc.num_cxrs) - 1;
+    *num_pxrs = le->u.mvcc.num_pxrs;
+    // the first xid stored is the outermost provisional xid if there are
+    // provisional uxrs, otherwise the newest committed xid.  the outermost
+    // committed uxr's xid (TXNID_NONE) is not stored.
+    if (*num_stale_cxrs > 0 || *num_pxrs > 0) {
+        *newest_xid = toku_dtoh64(*(TXNID *) le->u.mvcc.xrs);
+    } else {
+        *newest_xid = TXNID_NONE;
+    }
+}
+
 // Garbage collect one leaf entry, using the given OMT's.
 // Parameters:
 // -- old_leaf_entry : the leaf we intend to clean up through garbage
@@ -2290,13 +2313,15 @@ int le_val_is_del(LEAFENTRY le, enum cursor_read_type read_type, TOKUTXN txn) {
 //        associated value should be examined.
 //    valpp - output parameter that returns pointer to value
 //    vallenp - output parameter that returns length of value
+//    is_delp - output parameter that returns whether the value is a delete
 //    context - parameter for f
 //
-int le_iterate_val(
+static int le_iterate_val_and_is_del(
     LEAFENTRY le,
     LE_ITERATE_CALLBACK f,
     void** valpp,
     uint32_t* vallenp,
+    bool* is_delp,
     TOKUTXN context) {
 
 #if ULE_DEBUG
@@ -2308,6 +2333,7 @@ int le_iterate_val(
     int r;
     uint32_t vallen = 0;
     void *valp = NULL;
+    bool is_del = false;
     switch (type) {
         case LE_CLEAN: {
             vallen = toku_dtoh32(le->u.clean.vallen);
@@ -2392,6 +2418,7 @@ int le_iterate_val(
 #endif
             if (0) {
 verify_is_empty:;
+                is_del = true;
 #if ULE_DEBUG
                 uint32_t has_p = (ule.num_puxrs != 0);
                 UXR uxr = ule.uxrs + ule.num_cuxrs - 1 + has_p - index;
@@ -2409,10 +2436,21 @@ cleanup:
     if (!r) {
         *valpp   = valp;
         *vallenp = vallen;
+        *is_delp = is_del;
     }
     return r;
 }
 
+int le_iterate_val(
+    LEAFENTRY le,
+    LE_ITERATE_CALLBACK f,
+    void** valpp,
+    uint32_t* vallenp,
+    TOKUTXN context) {
+    bool is_del;
+    return le_iterate_val_and_is_del(le, f, valpp, vallenp, &is_del, context);
+}
+
 void le_extract_val(
     LEAFENTRY le,
     // should we return the entire leafentry as the val?
@@ -2438,6 +2476,46 @@ void le_extract_val(
     }
 }
 
+void le_extract_vals(
+    LEAFENTRY *les,
+    uint32_t num_les,
+    // should we return the entire leafentry as the val?
+    bool is_leaf_mode,
+    enum cursor_read_type read_type,
+    TOKUTXN ttxn,
+    struct le_cursor_val *vals) {
+
+    LE_ITERATE_CALLBACK f = nullptr;
+    if (read_type == C_READ_SNAPSHOT) {
+        f = toku_txn_reads_txnid;
+    } else if (read_type == C_READ_COMMITTED) {
+        f = le_iterate_read_committed_callback;
+    } else {
+        invariant(read_type == C_READ_ANY);
+    }
+    for (uint32_t i = 0; i < num_les; i++) {
+        LEAFENTRY le = les[i];
+        struct le_cursor_val *v = &vals[i];
+        if (le->type == LE_CLEAN) {
+            // every reader accepts the only, committed insert of a clean
+            // leafentry, so there is no xid stack to walk
+            v->val = le->u.clean.val;
+            v->vallen = toku_dtoh32(le->u.clean.vallen);
+            v->is_del = false;
+        } else if (f != nullptr) {
+            int r = le_iterate_val_and_is_del(le, f, &v->val, &v->vallen, &v->is_del, ttxn);
+            lazy_assert_zero(r);
+        } else {
+            v->val = le_latest_val_and_len(le, &v->vallen);
+            v->is_del = le_latest_is_del(le);
+        }
+        if (is_leaf_mode) {
+            v->val = le;
+            v->vallen = leafentry_memsize(le);
+        }
+    }
+}
+
 // This is an on-disk format.  static_asserts verify everything is packed and aligned correctly.
 struct __attribute__ ((__packed__)) leafentry_13 {
     struct leafentry_committed_13 {
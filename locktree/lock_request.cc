@@ -71,6 +71,7 @@ void lock_request::create(void) {
 
     m_type = type::UNKNOWN;
     m_lt = nullptr;
+    m_point_request = false;
 
     m_complete_r = 0;
     m_state = state::UNINITIALIZED;
@@ -133,43 +134,66 @@ void lock_request::get_conflicts(txnid_set *conflicts) {
     m_lt->get_conflicts(is_write_request, m_txnid, m_left_key, m_right_key, conflicts);
 }
 
-// build a wait-for-graph for this lock request and the given conflict set
-// for each transaction B that blocks A's lock request
-//     if B is blocked then
-//         add (A,T) to the WFG and if B is new, fill in the WFG from B
-void lock_request::build_wait_graph(wfg *wait_graph, const txnid_set &conflicts) {
-    size_t num_conflicts = conflicts.size();
-    for (size_t i = 0; i < num_conflicts; i++) {
-        TXNID conflicting_txnid = conflicts.get(i);
-        lock_request *conflicting_request = find_lock_request(conflicting_txnid);
-        invariant(conflicting_txnid != m_txnid);
-        invariant(conflicting_request != this);
-        if (conflicting_request) {
-            bool already_exists = wait_graph->node_exists(conflicting_txnid);
-            wait_graph->add_edge(m_txnid, conflicting_txnid);
-            if (!already_exists) {
-                // recursively build the wait for graph rooted at the conflicting
-                // request, given its set of lock conflicts.
-                txnid_set other_conflicts;
-                other_conflicts.create();
-                conflicting_request->get_conflicts(&other_conflicts);
-                conflicting_request->build_wait_graph(wait_graph, other_conflicts);
-                other_conflicts.destroy();
+// pick the txn on a wait-for cycle through this request that should fail,
+// according to the manager's victim policy.
+TXNID lock_request::choose_deadlock_victim(const txnid_set &cycle) {
+    locktree_manager *mgr = m_lt->get_manager();
+    const TOKU_DEADLOCK_VICTIM policy =
+        mgr ? mgr->get_deadlock_victim() : TOKU_DEADLOCK_VICTIM_REQUESTER;
+
+    // txnids are handed out in increasing order, so the set's last
+    // txnid is the youngest txn, which is also the tie breaker for
+    // the least work.
+    const size_t cycle_size = cycle.size();
+    TXNID victim = m_txnid;
+    if (policy == TOKU_DEADLOCK_VICTIM_YOUNGEST) {
+        victim = cycle.get(cycle_size - 1);
+    } else if (policy == TOKU_DEADLOCK_VICTIM_LEAST_WORK) {
+        uint64_t victim_locks = UINT64_MAX;
+        for (size_t i = cycle_size; i > 0; i--) {
+            const TXNID txnid = cycle.get(i - 1);
+            const uint64_t num_locks = m_lt->count_row_locks(txnid);
+            if (num_locks < victim_locks) {
+                victim = txnid;
+                victim_locks = num_locks;
             }
         }
     }
+    return victim;
 }
 
-// returns: true if the current set of lock requests contains
-//          a deadlock, false otherwise.
-bool lock_request::deadlock_exists(const txnid_set &conflicts) {
-    wfg wait_graph;
-    wait_graph.create();
-
-    build_wait_graph(&wait_graph, conflicts);
-    bool deadlock = wait_graph.cycle_exists_from_txnid(m_txnid);
-
-    wait_graph.destroy();
+// this request's txn just got new edges in the wait-for graph, so any new
+// cycle goes through it. fail one txn on each such cycle.
+// returns: true if this request's txn was picked to fail, in which case
+//          the caller is expected to fail it.
+bool lock_request::deadlock_exists(void) {
+    uint64_t t_start = toku_current_time_microsec();
+    bool deadlock = false;
+    while (!deadlock) {
+        txnid_set cycle;
+        cycle.create();
+        bool cycle_found = m_info->wait_graph.find_cycle_from_txnid(m_txnid, &cycle);
+        if (cycle_found) {
+            m_info->counters.deadlock_count += 1;
+            TXNID victim = choose_deadlock_victim(cycle);
+            if (victim == m_txnid) {
+                deadlock = true;
+            } else {
+                // every txn on the cycle is waiting on this locktree
+                lock_request *request = find_lock_request(victim);
+                invariant_notnull(request);
+                request->remove_from_lock_requests();
+                request->complete(DB_LOCK_DEADLOCK);
+                toku_cond_broadcast(&request->m_wait_cond);
+            }
+        }
+        cycle.destroy();
+        if (!cycle_found) {
+            break;
+        }
+    }
+    m_info->counters.deadlock_detect_count += 1;
+    m_info->counters.deadlock_detect_time += toku_current_time_microsec() - t_start;
     return deadlock;
 }
 
@@ -197,7 +221,8 @@ int lock_request::start(void) {
             m_start_before_pending_test_callback();
         toku_mutex_lock(&m_info->mutex);
         insert_into_lock_requests();
-        if (deadlock_exists(conflicts)) {
+        m_info->wait_graph.set_edges(m_txnid, conflicts);
+        if (deadlock_exists()) {
             remove_from_lock_requests();
             r = DB_LOCK_DEADLOCK;
         }
@@ -312,6 +337,7 @@ int lock_request::retry(void) {
     int r;
     txnid_set conflicts;
     conflicts.create();
+    m_info->counters.retry_count += 1;
 
     if (m_type == type::WRITE) {
         r = m_lt->acquire_write_lock(
@@ -324,12 +350,21 @@ int lock_request::retry(void) {
     // if the acquisition succeeded then remove ourselves from the
     // set of lock requests, complete, and signal the waiting thread.
     if (r == 0) {
+        m_info->counters.retry_success_count += 1;
         remove_from_lock_requests();
         complete(r);
         if (m_retry_test_callback)
             m_retry_test_callback();  // test callback
         toku_cond_broadcast(&m_wait_cond);
     } else {
+        if (r == TOKUDB_OUT_OF_LOCKS) {
+            m_info->retry_all_needed = true;
+        } else {
+            // keep the wait-for graph current. as before, cycles are only
+            // looked for when a request first blocks, so one that only
+            // forms on a retry is left to the lock wait timeout.
+            m_info->wait_graph.set_edges(m_txnid, conflicts);
+        }
         m_conflicting_txnid = conflicts.get(0);
     }
     conflicts.destroy();
@@ -381,6 +416,7 @@ void lock_request::retry_all_lock_requests(
 
 void lock_request::retry_all_lock_requests_info(lt_lock_request_info *info) {
     toku_mutex_lock(&info->mutex);
+    info->retry_all_needed = false;
     // retry all of the pending lock requests.
     for (size_t i = 0; i < info->pending_lock_requests.size();) {
         lock_request *request;
@@ -403,6 +439,93 @@ void lock_request::retry_all_lock_requests_info(lt_lock_request_info *info) {
     toku_mutex_unlock(&info->mutex);
 }
 
+// a key and txnid to search the pending point requests with
+struct point_request_key {
+    const comparator *cmp;
+    const DBT *key;
+    TXNID txnid;
+};
+
+static int find_by_key_and_txnid(lock_request *const &request,
+                                 const point_request_key &key) {
+    int c = (*key.cmp)(request->get_left_key(), key.key);
+    if (c != 0) {
+        return c;
+    }
+    TXNID request_txnid = request->get_txnid();
+    if (request_txnid < key.txnid) {
+        return -1;
+    } else if (request_txnid == key.txnid) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+void lock_request::retry_lock_requests(locktree *lt, const range_buffer *released_ranges) {
+    lt_lock_request_info *info = lt->get_lock_request_info();
+
+    // same unlocked race as in retry_all_lock_requests
+    if (info->pending_is_empty)
+        return;
+
+    const comparator &cmp = lt->get_comparator();
+    toku_mutex_lock(&info->mutex);
+    if (info->retry_all_needed) {
+        toku_mutex_unlock(&info->mutex);
+        retry_all_lock_requests(lt);
+        return;
+    }
+
+    // find the txnids of the requests overlapping each released range
+    // first, since a request that gets its lock leaves the indexes.
+    txnid_set waiters;
+    waiters.create();
+    range_buffer::iterator iter(released_ranges);
+    range_buffer::iterator::record rec;
+    while (iter.current(&rec)) {
+        const DBT *left_key = rec.get_left_key();
+        const DBT *right_key = rec.get_right_key();
+
+        // the first point request at or after left_key, and on until right_key
+        const point_request_key key = { .cmp = &cmp, .key = left_key, .txnid = TXNID_NONE };
+        lock_request *request;
+        uint32_t idx;
+        int r = info->pending_point_requests.find<point_request_key, find_by_key_and_txnid>(
+            key, +1, &request, &idx);
+        while (r == 0 && cmp(request->get_left_key(), right_key) <= 0) {
+            waiters.add(request->get_txnid());
+            r = info->pending_point_requests.fetch(++idx, &request);
+        }
+
+        const size_t num_range_requests = info->pending_range_requests.size();
+        for (size_t i = 0; i < num_range_requests; i++) {
+            r = info->pending_range_requests.fetch(i, &request);
+            invariant_zero(r);
+            if (cmp(request->get_left_key(), right_key) <= 0 &&
+                cmp(request->get_right_key(), left_key) >= 0) {
+                waiters.add(request->get_txnid());
+            }
+        }
+        iter.next();
+    }
+
+    const size_t num_waiters = waiters.size();
+    for (size_t i = 0; i < num_waiters; i++) {
+        lock_request *request;
+        int r = info->pending_lock_requests.find_zero<TXNID, find_by_txnid>(
+            waiters.get(i), &request, nullptr);
+        if (r == 0) {
+            request->retry();
+        }
+    }
+    waiters.destroy();
+
+    info->should_retry_lock_requests = info->pending_lock_requests.size() > 0;
+
+    toku_mutex_unlock(&info->mutex);
+}
+
 void *lock_request::get_extra(void) const {
     return m_extra;
 }
@@ -446,6 +569,18 @@ void lock_request::insert_into_lock_requests(void) {
     invariant(r == DB_NOTFOUND);
     r = m_info->pending_lock_requests.insert_at(this, idx);
     invariant_zero(r);
+
+    const comparator &cmp = m_lt->get_comparator();
+    m_point_request = cmp(m_left_key, m_right_key) == 0;
+    if (m_point_request) {
+        const point_request_key key = { .cmp = &cmp, .key = m_left_key, .txnid = m_txnid };
+        r = m_info->pending_point_requests.insert<point_request_key, find_by_key_and_txnid>(
+            this, key, nullptr);
+    } else {
+        r = m_info->pending_range_requests.insert<TXNID, find_by_txnid>(
+            this, m_txnid, nullptr);
+    }
+    invariant_zero(r);
     m_info->pending_is_empty = false;
 }
 
@@ -459,6 +594,23 @@ void lock_request::remove_from_lock_requests(void) {
     invariant(request == this);
     r = m_info->pending_lock_requests.delete_at(idx);
     invariant_zero(r);
+
+    if (m_point_request) {
+        const point_request_key key = { .cmp = &m_lt->get_comparator(), .key = m_left_key, .txnid = m_txnid };
+        r = m_info->pending_point_requests.find_zero<point_request_key, find_by_key_and_txnid>(
+            key, &request, &idx);
+        invariant_zero(r);
+        invariant(request == this);
+        r = m_info->pending_point_requests.delete_at(idx);
+    } else {
+        r = m_info->pending_range_requests.find_zero<TXNID, find_by_txnid>(
+            m_txnid, &request, &idx);
+        invariant_zero(r);
+        invariant(request == this);
+        r = m_info->pending_range_requests.delete_at(idx);
+    }
+    invariant_zero(r);
+    m_info->wait_graph.remove_node(m_txnid);
     if (m_info->pending_lock_requests.size() == 0)
         m_info->pending_is_empty = true;
 }
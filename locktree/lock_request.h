@@ -130,6 +130,13 @@ public:
         void (*after_retry_test_callback)(void) = nullptr);
     static void retry_all_lock_requests_info(lt_lock_request_info *info);
 
+    // effect: Retries only the lock requests for the given locktree that
+    //         overlap one of the given ranges, which were just released.
+    // requires: Every lock released was contained in one of the ranges
+    //           (see locktree::release_locks), otherwise requests blocked
+    //           by the rest of such a lock may not be retried.
+    static void retry_lock_requests(locktree *lt, const range_buffer *released_ranges);
+
     void set_start_test_callback(void (*f)(void));
     void set_start_before_pending_test_callback(void (*f)(void));
     void set_retry_test_callback(void (*f)(void));
@@ -164,6 +171,9 @@ public:
     type m_type;
     locktree *m_lt;
 
+    // Whether the pending request is indexed as a point or a range request
+    bool m_point_request;
+
     // If the lock request is in the completed state, then its
     // final return value is stored in m_complete_r
     int m_complete_r;
@@ -203,11 +213,13 @@ public:
     //          is blocked on
     void get_conflicts(txnid_set *conflicts);
 
-    // effect: Builds a wait-for-graph for this lock request and the given conflict set
-    void build_wait_graph(wfg *wait_graph, const txnid_set &conflicts);
+    // returns: The txn on the given wait-for cycle that should be failed
+    TXNID choose_deadlock_victim(const txnid_set &cycle);
 
-    // returns: True if this lock request is in deadlock with the given conflicts set
-    bool deadlock_exists(const txnid_set &conflicts);
+    // effect: Fails the waiters picked as victims on the wait-for cycles
+    //         through this lock request's txn, if there are any.
+    // returns: True if this lock request was picked as a victim
+    bool deadlock_exists(void);
 
     void copy_keys(void);
 
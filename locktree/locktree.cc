@@ -53,6 +53,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include <memory.h>
 
 #include <util/growable_array.h>
+#include <util/sort.h>
 
 #include <portability/toku_pthread.h>
 #include <portability/toku_time.h>
@@ -87,6 +88,14 @@ void locktree::create(locktree_manager *mgr, DICTIONARY_ID dict_id, const compar
     XCALLOC(m_rangetree);
     m_rangetree->create(&m_cmp);
 
+    m_num_partitions = 1;
+    m_initial_partitions.num_partitions = 1;
+    m_initial_partitions.bounds = nullptr;
+    m_initial_partitions.trees = m_rangetree;
+    m_partitions = &m_initial_partitions;
+    m_partition_samples = nullptr;
+    m_num_partition_samples = 0;
+
     m_sto_txnid = TXNID_NONE;
     m_sto_buffer.create();
     m_sto_score = STO_SCORE_THRESHOLD;
@@ -98,7 +107,11 @@ void locktree::create(locktree_manager *mgr, DICTIONARY_ID dict_id, const compar
 
 void lt_lock_request_info::init(void) {
     pending_lock_requests.create();
+    pending_point_requests.create();
+    pending_range_requests.create();
     pending_is_empty = true;
+    retry_all_needed = false;
+    wait_graph.create();
     ZERO_STRUCT(mutex);
     toku_mutex_init(*locktree_request_info_mutex_key, &mutex, nullptr);
     retry_want = retry_done = 0;
@@ -117,6 +130,21 @@ void lt_lock_request_info::init(void) {
 void locktree::destroy(void) {
     invariant(m_reference_count == 0);
     invariant(m_lock_request_info.pending_lock_requests.size() == 0);
+    if (m_partitions != &m_initial_partitions) {
+        for (uint32_t i = 0; i < m_partitions->num_partitions; i++) {
+            m_partitions->trees[i].destroy();
+            if (i > 0) {
+                toku_destroy_dbt(&m_partitions->bounds[i - 1]);
+            }
+        }
+        toku_free(m_partitions->trees);
+        toku_free(m_partitions->bounds);
+        toku_free(m_partitions);
+    }
+    for (uint32_t i = 0; i < m_num_partition_samples; i++) {
+        toku_destroy_dbt(&m_partition_samples[i]);
+    }
+    toku_free(m_partition_samples);
     m_cmp.destroy();
     m_rangetree->destroy();
     toku_free(m_rangetree);
@@ -124,8 +152,26 @@ void locktree::destroy(void) {
     m_lock_request_info.destroy();
 }
 
+void locktree::set_num_partitions(uint32_t num_partitions) {
+    invariant(num_partitions > 0);
+    invariant(m_partitions == &m_initial_partitions);
+    invariant(m_rangetree->is_empty() && m_sto_buffer.is_empty());
+    invariant(m_partition_samples == nullptr);
+    m_num_partitions = num_partitions;
+    if (num_partitions > 1) {
+        XCALLOC_N(num_partitions * PARTITION_SAMPLES_PER_PARTITION, m_partition_samples);
+    }
+}
+
+bool locktree::is_partitioned(void) const {
+    return m_num_partitions > 1;
+}
+
 void lt_lock_request_info::destroy(void) {
     pending_lock_requests.destroy();
+    pending_point_requests.destroy();
+    pending_range_requests.destroy();
+    wait_graph.destroy();
     toku_mutex_destroy(&mutex);
     toku_mutex_destroy(&retry_mutex);
     toku_cond_destroy(&retry_cv);
@@ -187,6 +233,13 @@ static bool determine_conflicting_txnids(const GrowableArray<row_lock> &row_lock
     return conflicts_exist;
 }
 
+// returns: true if the row lock's range is contained in [left_key, right_key]
+static bool row_lock_within(const comparator &cmp, const row_lock &lock,
+                            const DBT *left_key, const DBT *right_key) {
+    return cmp(lock.range.get_left_key(), left_key) >= 0 &&
+           cmp(lock.range.get_right_key(), right_key) <= 0;
+}
+
 // how much memory does a row lock take up in a concurrent tree?
 static uint64_t row_lock_size_in_tree(const row_lock &lock) {
     const uint64_t overhead = concurrent_tree::get_insertion_memory_overhead();
@@ -385,6 +438,10 @@ int locktree::acquire_lock(bool is_write_request,
     // we are only supporting write locks for simplicity
     invariant(is_write_request);
 
+    if (is_partitioned()) {
+        return acquire_lock_partitioned(txnid, left_key, right_key, conflicts);
+    }
+
     // acquire and prepare a locked keyrange over the requested range.
     // prepare is a serialzation point, so we take the opportunity to
     // try the single txnid optimization first.
@@ -432,6 +489,11 @@ void locktree::get_conflicts(bool is_write_request,
     // because we only support write locks, ignore this bit for now.
     (void) is_write_request;
 
+    if (is_partitioned()) {
+        get_conflicts_partitioned(txnid, left_key, right_key, conflicts);
+        return;
+    }
+
     // preparing and acquire a locked keyrange over the range
     keyrange range;
     range.create(left_key, right_key);
@@ -476,9 +538,16 @@ void locktree::get_conflicts(bool is_write_request,
 //  In our example, the txn unlocks key 1, which actually removes the
 //  whole lock [1,3].  Now, someone else can lock 2 before our txn gets
 //  around to unlocking 2, so we should not remove that lock.
-void locktree::remove_overlapping_locks_for_txnid(TXNID txnid,
+//
+//  Removing a lock like [1,3] while releasing 1 also matters to anyone
+//  waiting for 3, so we report it to the caller.
+bool locktree::remove_overlapping_locks_for_txnid(TXNID txnid,
                                                   const DBT *left_key,
                                                   const DBT *right_key) {
+    if (is_partitioned()) {
+        return remove_overlapping_locks_for_txnid_partitioned(txnid, left_key, right_key);
+    }
+
     keyrange release_range;
     release_range.create(left_key, right_key);
 
@@ -493,11 +562,15 @@ void locktree::remove_overlapping_locks_for_txnid(TXNID txnid,
     iterate_and_get_overlapping_row_locks(&lkr, &overlapping_row_locks);
     size_t num_overlapping_row_locks = overlapping_row_locks.get_size();
 
+    bool removed_within_range = true;
     for (size_t i = 0; i < num_overlapping_row_locks; i++) {
         row_lock lock = overlapping_row_locks.fetch_unchecked(i);
         // If this isn't our lock, that's ok, just don't remove it.
         // See rationale above.
         if (lock.txnid == txnid) {
+            if (!row_lock_within(m_cmp, lock, left_key, right_key)) {
+                removed_within_range = false;
+            }
             remove_row_lock_from_tree(&lkr, lock, m_mgr);
         }
     }
@@ -505,6 +578,7 @@ void locktree::remove_overlapping_locks_for_txnid(TXNID txnid,
     lkr.release();
     overlapping_row_locks.deinit();
     release_range.destroy();
+    return removed_within_range;
 }
 
 bool locktree::sto_txnid_is_valid_unsafe(void) const {
@@ -537,9 +611,11 @@ bool locktree::sto_try_release(TXNID txnid) {
 
 // release all of the locks for a txnid whose endpoints are pairs
 // in the given range buffer.
-void locktree::release_locks(TXNID txnid, const range_buffer *ranges) {
+bool locktree::release_locks(TXNID txnid, const range_buffer *ranges) {
     // try the single txn optimization. if it worked, then all of the
     // locks are already released, otherwise we need to do it here.
+    // the single txnid buffer holds exactly the ranges that were locked.
+    bool released_within_ranges = true;
     bool released = sto_try_release(txnid);
     if (!released) {
         range_buffer::iterator iter(ranges);
@@ -550,7 +626,9 @@ void locktree::release_locks(TXNID txnid, const range_buffer *ranges) {
             // All ranges in the locktree must have left endpoints <= right endpoints.
             // Range comparisons rely on this fact, so we make a paranoid invariant here.
             paranoid_invariant(m_cmp(left_key, right_key) <= 0);
-            remove_overlapping_locks_for_txnid(txnid, left_key, right_key);
+            if (!remove_overlapping_locks_for_txnid(txnid, left_key, right_key)) {
+                released_within_ranges = false;
+            }
             iter.next();
         }
         // Increase the sto score slightly. Eventually it will hit
@@ -561,6 +639,7 @@ void locktree::release_locks(TXNID txnid, const range_buffer *ranges) {
             toku_sync_fetch_and_add(&m_sto_score, 1);
         }
     }
+    return released_within_ranges;
 }
 
 // iterate over a locked keyrange and extract copies of the first N
@@ -624,6 +703,107 @@ struct txnid_range_buffer {
     }
 };
 
+typedef omt<struct txnid_range_buffer *, struct txnid_range_buffer *> txnid_range_buffers;
+
+// merge adjacent locks with the same txnid in a batch of range-sorted
+// row locks into one dominating lock each, appending every dominating
+// lock to the range buffer for its txnid. a TXNID_NONE lock only keeps
+// the locks on either side of it apart.
+static void escalate_row_locks(txnid_range_buffers *range_buffers,
+                               const row_lock *locks, int num_locks) {
+    int current_index = 0;
+    while (current_index < num_locks) {
+        if (locks[current_index].txnid == TXNID_NONE) {
+            current_index++;
+            continue;
+        }
+
+        // every batch of extracted locks is in range-sorted order. search
+        // through them and merge adjacent locks with the same txnid into
+        // one dominating lock and save it to a set of escalated locks.
+        //
+        // first, find the index of the next row lock with a different txnid
+        int next_txnid_index = current_index + 1;
+        while (next_txnid_index < num_locks &&
+                locks[current_index].txnid == locks[next_txnid_index].txnid) {
+            next_txnid_index++;
+        }
+
+        // Create an escalated range for the current txnid that dominates
+        // each range between the current indext and the next txnid's index.
+        const TXNID current_txnid = locks[current_index].txnid;
+        const DBT *escalated_left_key = locks[current_index].range.get_left_key(); 
+        const DBT *escalated_right_key = locks[next_txnid_index - 1].range.get_right_key();
+
+        // Try to find a range buffer for the current txnid. Create one if it doesn't exist.
+        // Then, append the new escalated range to the buffer.
+        uint32_t idx;
+        struct txnid_range_buffer *existing_range_buffer;
+        int r = range_buffers->find_zero<TXNID, txnid_range_buffer::find_by_txnid>(
+                current_txnid,
+                &existing_range_buffer,
+                &idx
+                );
+        if (r == DB_NOTFOUND) {
+            struct txnid_range_buffer *XMALLOC(new_range_buffer);
+            new_range_buffer->txnid = current_txnid;
+            new_range_buffer->buffer.create();
+            new_range_buffer->buffer.append(escalated_left_key, escalated_right_key);
+            range_buffers->insert_at(new_range_buffer, idx);
+        } else {
+            invariant_zero(r);
+            invariant(existing_range_buffer->txnid == current_txnid);
+            existing_range_buffer->buffer.append(escalated_left_key, escalated_right_key);
+        }
+
+        current_index = next_txnid_index;
+    }
+}
+
+// insert every escalated range of each txnid into the locked keyrange, then
+// notify higher layers that the txnid's locks have changed.
+static void insert_escalated_row_locks(locktree *lt, concurrent_tree::locked_keyrange *lkr,
+                                       locktree_manager *mgr,
+                                       txnid_range_buffers *range_buffers,
+                                       lt_escalate_cb after_escalate_callback,
+                                       void *after_escalate_callback_extra) {
+    const size_t num_range_buffers = range_buffers->size();
+    for (size_t i = 0; i < num_range_buffers; i++) {
+        struct txnid_range_buffer *current_range_buffer;
+        int r = range_buffers->fetch(i, &current_range_buffer);
+        invariant_zero(r);
+
+        const TXNID current_txnid = current_range_buffer->txnid;
+        range_buffer::iterator iter(&current_range_buffer->buffer);
+        range_buffer::iterator::record rec;
+        while (iter.current(&rec)) {
+            keyrange range;
+            range.create(rec.get_left_key(), rec.get_right_key());
+            row_lock lock = { .range = range, .txnid = current_txnid };
+            insert_row_lock_into_tree(lkr, lock, mgr);
+            iter.next();
+        }
+
+        // Notify higher layers that locks have changed for the current txnid
+        if (after_escalate_callback) {
+            after_escalate_callback(current_txnid, lt, current_range_buffer->buffer, after_escalate_callback_extra);
+        }
+        current_range_buffer->buffer.destroy();
+    }
+}
+
+static void destroy_txnid_range_buffers(txnid_range_buffers *range_buffers) {
+    while (range_buffers->size() > 0) {
+        struct txnid_range_buffer *buffer;
+        int r = range_buffers->fetch(0, &buffer);
+        invariant_zero(r);
+        r = range_buffers->delete_at(0);
+        invariant_zero(r);
+        toku_free(buffer);
+    }
+    range_buffers->destroy();
+}
+
 // escalate the locks in the locktree by merging adjacent
 // locks that have the same txnid into one larger lock.
 //
@@ -632,7 +812,12 @@ struct txnid_range_buffer {
 // has locks in a random/alternating order, then this does
 // not work so well.
 void locktree::escalate(lt_escalate_cb after_escalate_callback, void *after_escalate_callback_extra) {
-    omt<struct txnid_range_buffer *, struct txnid_range_buffer *> range_buffers;
+    if (is_partitioned()) {
+        escalate_partitioned(after_escalate_callback, after_escalate_callback_extra);
+        return;
+    }
+
+    txnid_range_buffers range_buffers;
     range_buffers.create();
 
     // prepare and acquire a locked keyrange on the entire locktree
@@ -660,59 +845,526 @@ void locktree::escalate(lt_escalate_cb after_escalate_callback, void *after_esca
     while ((num_extracted =
                 extract_first_n_row_locks(&lkr, m_mgr, extracted_buf,
                                           num_row_locks_per_batch)) > 0) {
-        int current_index = 0;
-        while (current_index < num_extracted) {
-            // every batch of extracted locks is in range-sorted order. search
-            // through them and merge adjacent locks with the same txnid into
-            // one dominating lock and save it to a set of escalated locks.
-            //
-            // first, find the index of the next row lock with a different txnid
-            int next_txnid_index = current_index + 1;
-            while (next_txnid_index < num_extracted &&
-                    extracted_buf[current_index].txnid == extracted_buf[next_txnid_index].txnid) {
-                next_txnid_index++;
+        escalate_row_locks(&range_buffers, extracted_buf, num_extracted);
+
+        // destroy the ranges copied during the extraction
+        for (int i = 0; i < num_extracted; i++) {
+            extracted_buf[i].range.destroy();
+        }
+    }
+    toku_free(extracted_buf);
+
+    // Rebuild the locktree from each range in each range buffer,
+    // then notify higher layers that the txnid's locks have changed.
+    invariant(m_rangetree->is_empty());
+    insert_escalated_row_locks(this, &lkr, m_mgr, &range_buffers,
+                               after_escalate_callback, after_escalate_callback_extra);
+
+    destroy_txnid_range_buffers(&range_buffers);
+
+    lkr.release();
+}
+
+void locktree::escalate_txns(const txnid_set &txnids,
+                             lt_escalate_cb after_escalate_callback,
+                             void *after_escalate_callback_extra) {
+    if (is_partitioned()) {
+        escalate(after_escalate_callback, after_escalate_callback_extra);
+        return;
+    }
+
+    concurrent_tree::locked_keyrange lkr;
+    keyrange infinite_range = keyrange::get_infinite_range();
+    lkr.prepare(m_rangetree);
+    lkr.acquire(infinite_range);
+
+    // see escalate()
+    if (m_sto_txnid != TXNID_NONE) {
+        sto_end_early_no_accounting(&lkr);
+    }
+
+    // get the locks of the given txnids in range-sorted order. the
+    // locks of other txnids in between become TXNID_NONE placeholders.
+    struct copy_fn_obj {
+        const txnid_set *txnids;
+        row_lock *locks;
+        size_t num_locks;
+        size_t locks_limit;
+        bool fn(const keyrange &range, TXNID txnid) {
+            const bool escalated = txnids->contains(txnid);
+            if (!escalated && num_locks > 0 && locks[num_locks - 1].txnid == TXNID_NONE) {
+                return true;
+            }
+            if (num_locks == locks_limit) {
+                locks_limit = locks_limit == 0 ? 128 : 2 * locks_limit;
+                XREALLOC_N(locks_limit, locks);
             }
+            row_lock &lock = locks[num_locks++];
+            if (escalated) {
+                lock.range = range;
+                lock.txnid = txnid;
+            } else {
+                lock.range.create(nullptr, nullptr);
+                lock.txnid = TXNID_NONE;
+            }
+            return true;
+        }
+    } copy_fn;
+    copy_fn.txnids = &txnids;
+    copy_fn.locks = nullptr;
+    copy_fn.num_locks = 0;
+    copy_fn.locks_limit = 0;
+    lkr.iterate(&copy_fn);
+
+    // copy each range out of the tree before removing it
+    for (size_t i = 0; i < copy_fn.num_locks; i++) {
+        if (copy_fn.locks[i].txnid != TXNID_NONE) {
+            const keyrange range = copy_fn.locks[i].range;
+            copy_fn.locks[i].range.create_copy(range);
+            remove_row_lock_from_tree(&lkr, copy_fn.locks[i], m_mgr);
+        }
+    }
+
+    txnid_range_buffers range_buffers;
+    range_buffers.create();
+    escalate_row_locks(&range_buffers, copy_fn.locks, copy_fn.num_locks);
+    insert_escalated_row_locks(this, &lkr, m_mgr, &range_buffers,
+                               after_escalate_callback, after_escalate_callback_extra);
+    destroy_txnid_range_buffers(&range_buffers);
+
+    for (size_t i = 0; i < copy_fn.num_locks; i++) {
+        copy_fn.locks[i].range.destroy();
+    }
+    toku_free(copy_fn.locks);
+
+    lkr.release();
+}
+
+int lt_txn_lock_memory::find_by_txnid(lt_txn_lock_memory *const &txn_memory, const TXNID &txnid) {
+    if (txn_memory->txnid < txnid) {
+        return -1;
+    } else if (txn_memory->txnid == txnid) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+static void add_txn_lock_memory(lt_txn_lock_memory_tally *tally, TXNID txnid, uint64_t memory) {
+    lt_txn_lock_memory *txn_memory;
+    uint32_t idx;
+    int r = tally->find_zero<TXNID, lt_txn_lock_memory::find_by_txnid>(txnid, &txn_memory, &idx);
+    if (r == DB_NOTFOUND) {
+        XMALLOC(txn_memory);
+        txn_memory->txnid = txnid;
+        txn_memory->memory = 0;
+        r = tally->insert_at(txn_memory, idx);
+    }
+    invariant_zero(r);
+    txn_memory->memory += memory;
+}
 
-            // Create an escalated range for the current txnid that dominates
-            // each range between the current indext and the next txnid's index.
-            const TXNID current_txnid = extracted_buf[current_index].txnid;
-            const DBT *escalated_left_key = extracted_buf[current_index].range.get_left_key(); 
-            const DBT *escalated_right_key = extracted_buf[next_txnid_index - 1].range.get_right_key();
-
-            // Try to find a range buffer for the current txnid. Create one if it doesn't exist.
-            // Then, append the new escalated range to the buffer.
-            uint32_t idx;
-            struct txnid_range_buffer *existing_range_buffer;
-            int r = range_buffers.find_zero<TXNID, txnid_range_buffer::find_by_txnid>(
-                    current_txnid,
-                    &existing_range_buffer,
-                    &idx
-                    );
-            if (r == DB_NOTFOUND) {
-                struct txnid_range_buffer *XMALLOC(new_range_buffer);
-                new_range_buffer->txnid = current_txnid;
-                new_range_buffer->buffer.create();
-                new_range_buffer->buffer.append(escalated_left_key, escalated_right_key);
-                range_buffers.insert_at(new_range_buffer, idx);
+// Partitioned locktrees.
+//
+// Each operation locks the run of partitions overlapped by its range,
+// lowest partition first, and otherwise does what the unpartitioned
+// operation does on every one of them. Point locks, the common case,
+// only ever touch one partition. A range that crosses a boundary is
+// stored once per partition it overlaps, so finding every lock that
+// overlaps some range never needs to look outside the partitions that
+// range overlaps. Conversely, consolidating or removing such a lock has
+// to reach every copy, so when a lock reaches beyond the partitions
+// already held we release them and start over with a bigger range.
+
+// returns: the partition whose key range contains the given key, i.e. the
+//          number of partition boundaries less than or equal to the key.
+static uint32_t partition_for_key(const comparator &cmp,
+                                  const lt_partition_table *table, const DBT *key) {
+    uint32_t lo = 0;
+    uint32_t hi = table->num_partitions - 1;
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi + 1) / 2;
+        if (cmp(&table->bounds[mid - 1], key) <= 0) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+// effect: sets lo and hi to the first and last partition the range overlaps
+static void partitions_for_range(const comparator &cmp, const lt_partition_table *table,
+                                 const keyrange &range, uint32_t *lo, uint32_t *hi) {
+    const DBT *left_key = range.get_left_key();
+    const DBT *right_key = range.get_right_key();
+    *lo = partition_for_key(cmp, table, left_key);
+    // point ranges share one key, so save the second search
+    *hi = right_key == left_key ? *lo : partition_for_key(cmp, table, right_key);
+}
+
+// A locked keyrange over each partition in [lo, hi] of some partition
+// table. Each partition is acquired before the next one is prepared, so
+// every thread holds its tree node mutexes in (partition, depth) order and
+// spans never deadlock against each other.
+class locked_partition_span {
+public:
+    void lock(lt_partition_table **tablep, const comparator &cmp, const keyrange &range) {
+        while (true) {
+            m_table = __atomic_load_n(tablep, __ATOMIC_ACQUIRE);
+            partitions_for_range(cmp, m_table, range, &m_lo, &m_hi);
+            if (m_lo == m_hi) {
+                m_lkrs = &m_single_lkr;
             } else {
-                invariant_zero(r);
-                invariant(existing_range_buffer->txnid == current_txnid);
-                existing_range_buffer->buffer.append(escalated_left_key, escalated_right_key);
+                XMALLOC_N(m_hi - m_lo + 1, m_lkrs);
+            }
+            m_lkrs[0].prepare(&m_table->trees[m_lo]);
+            // the initial table is only ever replaced while its one tree is
+            // prepared, so if the table did not change we locked the right one.
+            if (__atomic_load_n(tablep, __ATOMIC_ACQUIRE) == m_table) {
+                break;
             }
+            m_lkrs[0].release();
+            free_lkrs();
+        }
+        m_lkrs[0].acquire(range);
+        for (uint32_t i = m_lo + 1; i <= m_hi; i++) {
+            lkr(i)->prepare(&m_table->trees[i]);
+            lkr(i)->acquire(range);
+        }
+    }
 
-            current_index = next_txnid_index;
+    void release(void) {
+        for (uint32_t i = m_lo; i <= m_hi; i++) {
+            lkr(i)->release();
         }
+        free_lkrs();
+    }
 
-        // destroy the ranges copied during the extraction
+    // returns: true if every partition the given range overlaps is locked
+    bool covers(const comparator &cmp, const keyrange &range) const {
+        if (m_lo == 0 && m_hi == m_table->num_partitions - 1) {
+            return true;
+        }
+        uint32_t lo, hi;
+        partitions_for_range(cmp, m_table, range, &lo, &hi);
+        return lo >= m_lo && hi <= m_hi;
+    }
+
+    concurrent_tree::locked_keyrange *lkr(uint32_t partition) {
+        paranoid_invariant(partition >= m_lo && partition <= m_hi);
+        return &m_lkrs[partition - m_lo];
+    }
+
+    const lt_partition_table *table(void) const { return m_table; }
+    uint32_t lo(void) const { return m_lo; }
+    uint32_t hi(void) const { return m_hi; }
+
+private:
+    void free_lkrs(void) {
+        if (m_lkrs != &m_single_lkr) {
+            toku_free(m_lkrs);
+        }
+    }
+
+    lt_partition_table *m_table;
+    uint32_t m_lo;
+    uint32_t m_hi;
+    concurrent_tree::locked_keyrange *m_lkrs;
+    concurrent_tree::locked_keyrange m_single_lkr;
+};
+
+// a row lock and the partition it was found in
+struct partition_row_lock {
+    row_lock lock;
+    uint32_t partition;
+};
+
+// copy out the row locks that overlap the span's range in each of its
+// partitions. a lock that crosses a boundary shows up once per partition.
+static void get_overlapping_partition_row_locks(locked_partition_span *span,
+                                                GrowableArray<partition_row_lock> *locks) {
+    struct copy_fn_obj {
+        GrowableArray<partition_row_lock> *locks;
+        uint32_t partition;
+        bool fn(const keyrange &range, TXNID txnid) {
+            partition_row_lock lock = { .lock = { .range = range, .txnid = txnid },
+                                        .partition = partition };
+            locks->push(lock);
+            return true;
+        }
+    } copy_fn;
+    copy_fn.locks = locks;
+    for (uint32_t i = span->lo(); i <= span->hi(); i++) {
+        copy_fn.partition = i;
+        span->lkr(i)->iterate(&copy_fn);
+    }
+}
+
+static int compare_partition_samples(const comparator &cmp, const DBT &a, const DBT &b) {
+    return cmp(&a, &b);
+}
+
+void locktree::sample_partition_key(const DBT *key) {
+    if (toku_dbt_is_infinite(key)) {
+        return;
+    }
+    // the samples, like the initial partition table, are protected
+    // by the root of m_rangetree
+    concurrent_tree::locked_keyrange lkr;
+    lkr.prepare(m_rangetree);
+    if (m_partitions == &m_initial_partitions) {
+        toku_clone_dbt(&m_partition_samples[m_num_partition_samples++], *key);
+        if (m_num_partition_samples == m_num_partitions * PARTITION_SAMPLES_PER_PARTITION) {
+            split_partitions(&lkr);
+        }
+    }
+    lkr.release();
+}
+
+void locktree::split_partitions(void *prepared_lkr) {
+    // choose evenly spaced samples as the boundaries, skipping duplicates
+    const uint32_t num_samples = m_num_partition_samples;
+    sort<DBT, const comparator, compare_partition_samples>::mergesort_r(
+        m_partition_samples, num_samples, m_cmp);
+    DBT *XMALLOC_N(m_num_partitions - 1, bounds);
+    uint32_t num_bounds = 0;
+    for (uint32_t i = 1; i < m_num_partitions; i++) {
+        const DBT *bound = &m_partition_samples[i * num_samples / m_num_partitions];
+        if (num_bounds == 0 || m_cmp(&bounds[num_bounds - 1], bound) < 0) {
+            toku_clone_dbt(&bounds[num_bounds++], *bound);
+        }
+    }
+    for (uint32_t i = 0; i < num_samples; i++) {
+        toku_destroy_dbt(&m_partition_samples[i]);
+    }
+    m_num_partition_samples = 0;
+    if (num_bounds == 0) {
+        // every sample was the same key. there is nothing to split
+        // on yet, so throw the samples away and try again later.
+        toku_free(bounds);
+        return;
+    }
+
+    lt_partition_table *XMALLOC(table);
+    table->num_partitions = num_bounds + 1;
+    table->bounds = bounds;
+    XMALLOC_N(table->num_partitions, table->trees);
+    for (uint32_t i = 0; i < table->num_partitions; i++) {
+        table->trees[i].create(&m_cmp);
+    }
+
+    // move every lock into the new table. nobody else can see it yet,
+    // so locking its trees is only a formality.
+    concurrent_tree::locked_keyrange *lkr =
+        static_cast<concurrent_tree::locked_keyrange *>(prepared_lkr);
+    int num_extracted;
+    const int num_row_locks_per_batch = 128;
+    row_lock *XCALLOC_N(num_row_locks_per_batch, extracted_buf);
+    while ((num_extracted =
+                extract_first_n_row_locks(lkr, m_mgr, extracted_buf,
+                                          num_row_locks_per_batch)) > 0) {
         for (int i = 0; i < num_extracted; i++) {
+            const row_lock &lock = extracted_buf[i];
+            uint32_t lo, hi;
+            partitions_for_range(m_cmp, table, lock.range, &lo, &hi);
+            for (uint32_t p = lo; p <= hi; p++) {
+                concurrent_tree::locked_keyrange new_lkr;
+                new_lkr.prepare(&table->trees[p]);
+                new_lkr.acquire(lock.range);
+                insert_row_lock_into_tree(&new_lkr, lock, m_mgr);
+                new_lkr.release();
+            }
             extracted_buf[i].range.destroy();
         }
     }
     toku_free(extracted_buf);
-
-    // Rebuild the locktree from each range in each range buffer,
-    // then notify higher layers that the txnid's locks have changed.
     invariant(m_rangetree->is_empty());
+
+    toku_free(m_partition_samples);
+    m_partition_samples = nullptr;
+    __atomic_store_n(&m_partitions, table, __ATOMIC_RELEASE);
+}
+
+int locktree::acquire_lock_partitioned(TXNID txnid,
+                                       const DBT *left_key, const DBT *right_key,
+                                       txnid_set *conflicts) {
+    if (__atomic_load_n(&m_partitions, __ATOMIC_ACQUIRE) == &m_initial_partitions) {
+        sample_partition_key(left_key);
+    }
+
+    int r = 0;
+    keyrange requested_range;
+    requested_range.create(left_key, right_key);
+    while (true) {
+        locked_partition_span span;
+        span.lock(&m_partitions, m_cmp, requested_range);
+
+        GrowableArray<partition_row_lock> overlapping_row_locks;
+        overlapping_row_locks.init();
+        get_overlapping_partition_row_locks(&span, &overlapping_row_locks);
+        const size_t num_overlapping_row_locks = overlapping_row_locks.get_size();
+
+        // same as acquire_lock_consolidated(), except the dominating
+        // range may reach past the partitions we locked.
+        bool conflicts_exist = false;
+        for (size_t i = 0; i < num_overlapping_row_locks; i++) {
+            const TXNID other_txnid = overlapping_row_locks.fetch_unchecked(i).lock.txnid;
+            if (other_txnid != txnid) {
+                if (conflicts) {
+                    conflicts->add(other_txnid);
+                }
+                conflicts_exist = true;
+            }
+        }
+        bool retry = false;
+        if (conflicts_exist) {
+            r = DB_LOCK_NOTGRANTED;
+        } else {
+            for (size_t i = 0; i < num_overlapping_row_locks; i++) {
+                requested_range.extend(m_cmp, overlapping_row_locks.fetch_unchecked(i).lock.range);
+            }
+            if (num_overlapping_row_locks > 0 && !span.covers(m_cmp, requested_range)) {
+                retry = true;
+            } else {
+                for (size_t i = 0; i < num_overlapping_row_locks; i++) {
+                    const partition_row_lock &overlapping_lock = overlapping_row_locks.fetch_unchecked(i);
+                    remove_row_lock_from_tree(span.lkr(overlapping_lock.partition),
+                                              overlapping_lock.lock, m_mgr);
+                }
+                // the dominating range overlaps exactly the locked partitions,
+                // since it contains the requested range and is covered by them
+                row_lock new_lock = { .range = requested_range, .txnid = txnid };
+                for (uint32_t p = span.lo(); p <= span.hi(); p++) {
+                    insert_row_lock_into_tree(span.lkr(p), new_lock, m_mgr);
+                }
+            }
+        }
+
+        overlapping_row_locks.deinit();
+        span.release();
+        if (!retry) {
+            break;
+        }
+    }
+    requested_range.destroy();
+    return r;
+}
+
+void locktree::get_conflicts_partitioned(TXNID txnid,
+                                         const DBT *left_key, const DBT *right_key,
+                                         txnid_set *conflicts) {
+    keyrange range;
+    range.create(left_key, right_key);
+    locked_partition_span span;
+    span.lock(&m_partitions, m_cmp, range);
+
+    GrowableArray<row_lock> overlapping_row_locks;
+    overlapping_row_locks.init();
+    for (uint32_t i = span.lo(); i <= span.hi(); i++) {
+        iterate_and_get_overlapping_row_locks(span.lkr(i), &overlapping_row_locks);
+    }
+    (void) determine_conflicting_txnids(overlapping_row_locks, txnid, conflicts);
+
+    span.release();
+    overlapping_row_locks.deinit();
+    range.destroy();
+}
+
+bool locktree::remove_overlapping_locks_for_txnid_partitioned(TXNID txnid,
+                                                              const DBT *left_key,
+                                                              const DBT *right_key) {
+    // only locks overlapping the release range are removed (see the
+    // rationale for remove_overlapping_locks_for_txnid), but all of their
+    // copies are, so the range we lock may have to grow to reach them.
+    keyrange release_range;
+    release_range.create(left_key, right_key);
+    keyrange locked_range;
+    locked_range.create(left_key, right_key);
+    bool removed_within_range;
+    while (true) {
+        locked_partition_span span;
+        span.lock(&m_partitions, m_cmp, locked_range);
+
+        GrowableArray<partition_row_lock> overlapping_row_locks;
+        overlapping_row_locks.init();
+        get_overlapping_partition_row_locks(&span, &overlapping_row_locks);
+        const size_t num_overlapping_row_locks = overlapping_row_locks.get_size();
+
+        bool retry = false;
+        removed_within_range = true;
+        for (size_t i = 0; i < num_overlapping_row_locks; i++) {
+            const row_lock &lock = overlapping_row_locks.fetch_unchecked(i).lock;
+            // a point lock only lives in the partition it was found in
+            const bool is_point = lock.range.get_left_key() == lock.range.get_right_key();
+            if (lock.txnid == txnid && !is_point && lock.range.overlaps(m_cmp, release_range) &&
+                !span.covers(m_cmp, lock.range)) {
+                locked_range.extend(m_cmp, lock.range);
+                retry = true;
+            }
+        }
+        if (!retry) {
+            for (size_t i = 0; i < num_overlapping_row_locks; i++) {
+                const partition_row_lock &lock = overlapping_row_locks.fetch_unchecked(i);
+                if (lock.lock.txnid == txnid && lock.lock.range.overlaps(m_cmp, release_range)) {
+                    if (!row_lock_within(m_cmp, lock.lock, left_key, right_key)) {
+                        removed_within_range = false;
+                    }
+                    remove_row_lock_from_tree(span.lkr(lock.partition), lock.lock, m_mgr);
+                }
+            }
+        }
+
+        overlapping_row_locks.deinit();
+        span.release();
+        if (!retry) {
+            break;
+        }
+    }
+    locked_range.destroy();
+    release_range.destroy();
+    return removed_within_range;
+}
+
+void locktree::escalate_partitioned(lt_escalate_cb after_escalate_callback,
+                                    void *after_escalate_callback_extra) {
+    txnid_range_buffers range_buffers;
+    range_buffers.create();
+
+    // lock every partition
+    locked_partition_span span;
+    keyrange infinite_range = keyrange::get_infinite_range();
+    span.lock(&m_partitions, m_cmp, infinite_range);
+    const lt_partition_table *table = span.table();
+
+    // extract and remove batches of row locks from each partition, in
+    // order, so each batch is still range-sorted. a lock that crosses into
+    // this partition from the one before it was already escalated there.
+    int num_extracted;
+    const int num_row_locks_per_batch = 128;
+    row_lock *XCALLOC_N(num_row_locks_per_batch, extracted_buf);
+    for (uint32_t p = span.lo(); p <= span.hi(); p++) {
+        while ((num_extracted =
+                    extract_first_n_row_locks(span.lkr(p), m_mgr, extracted_buf,
+                                              num_row_locks_per_batch)) > 0) {
+            int num_owned = 0;
+            for (int i = 0; i < num_extracted; i++) {
+                if (partition_for_key(m_cmp, table, extracted_buf[i].range.get_left_key()) == p) {
+                    extracted_buf[num_owned++] = extracted_buf[i];
+                } else {
+                    extracted_buf[i].range.destroy();
+                }
+            }
+            escalate_row_locks(&range_buffers, extracted_buf, num_owned);
+            for (int i = 0; i < num_owned; i++) {
+                extracted_buf[i].range.destroy();
+            }
+        }
+    }
+    toku_free(extracted_buf);
+
+    // Rebuild each partition from the escalated ranges, then notify
+    // higher layers that the txnid's locks have changed.
     const size_t num_range_buffers = range_buffers.size();
     for (size_t i = 0; i < num_range_buffers; i++) {
         struct txnid_range_buffer *current_range_buffer;
@@ -726,28 +1378,105 @@ void locktree::escalate(lt_escalate_cb after_escalate_callback, void *after_esca
             keyrange range;
             range.create(rec.get_left_key(), rec.get_right_key());
             row_lock lock = { .range = range, .txnid = current_txnid };
-            insert_row_lock_into_tree(&lkr, lock, m_mgr);
+            uint32_t lo, hi;
+            partitions_for_range(m_cmp, table, range, &lo, &hi);
+            for (uint32_t p = lo; p <= hi; p++) {
+                insert_row_lock_into_tree(span.lkr(p), lock, m_mgr);
+            }
             iter.next();
         }
 
-        // Notify higher layers that locks have changed for the current txnid
         if (after_escalate_callback) {
             after_escalate_callback(current_txnid, this, current_range_buffer->buffer, after_escalate_callback_extra);
         }
         current_range_buffer->buffer.destroy();
     }
+    destroy_txnid_range_buffers(&range_buffers);
 
-    while (range_buffers.size() > 0) {
-        struct txnid_range_buffer *buffer;
-        int r = range_buffers.fetch(0, &buffer);
-        invariant_zero(r);
-        r = range_buffers.delete_at(0);
-        invariant_zero(r);
-        toku_free(buffer);
+    span.release();
+}
+
+uint64_t locktree::count_row_locks(TXNID txnid) {
+    // a lock stored in several partitions is only counted in the
+    // partition that its left key falls in.
+    struct count_fn_obj {
+        TXNID txnid;
+        uint64_t count;
+        const comparator *cmp;
+        const lt_partition_table *table;
+        uint32_t partition;
+        bool fn(const keyrange &range, TXNID lock_txnid) {
+            if (lock_txnid == txnid &&
+                (table == nullptr || partition_for_key(*cmp, table, range.get_left_key()) == partition)) {
+                count++;
+            }
+            return true;
+        }
+    } count_fn;
+    count_fn.txnid = txnid;
+    count_fn.count = 0;
+    count_fn.cmp = &m_cmp;
+    count_fn.table = nullptr;
+    count_fn.partition = 0;
+
+    keyrange infinite_range = keyrange::get_infinite_range();
+    if (is_partitioned()) {
+        locked_partition_span span;
+        span.lock(&m_partitions, m_cmp, infinite_range);
+        count_fn.table = span.table();
+        for (uint32_t i = span.lo(); i <= span.hi(); i++) {
+            count_fn.partition = i;
+            span.lkr(i)->iterate(&count_fn);
+        }
+        span.release();
+    } else {
+        concurrent_tree::locked_keyrange lkr;
+        lkr.prepare(m_rangetree);
+        if (m_sto_txnid != TXNID_NONE) {
+            // the sto txn's locks are all in the buffer
+            if (m_sto_txnid == txnid) {
+                count_fn.count = m_sto_buffer.get_num_ranges();
+            }
+        } else {
+            lkr.acquire(infinite_range);
+            lkr.iterate(&count_fn);
+        }
+        lkr.release();
     }
-    range_buffers.destroy();
+    return count_fn.count;
+}
 
-    lkr.release();
+void locktree::tally_lock_memory(lt_txn_lock_memory_tally *tally) {
+    struct tally_fn_obj {
+        lt_txn_lock_memory_tally *tally;
+        bool fn(const keyrange &range, TXNID txnid) {
+            row_lock lock = { .range = range, .txnid = txnid };
+            add_txn_lock_memory(tally, txnid, row_lock_size_in_tree(lock));
+            return true;
+        }
+    } tally_fn;
+    tally_fn.tally = tally;
+
+    keyrange infinite_range = keyrange::get_infinite_range();
+    if (is_partitioned()) {
+        // a lock stored in several partitions takes memory in each
+        locked_partition_span span;
+        span.lock(&m_partitions, m_cmp, infinite_range);
+        for (uint32_t i = span.lo(); i <= span.hi(); i++) {
+            span.lkr(i)->iterate(&tally_fn);
+        }
+        span.release();
+    } else {
+        concurrent_tree::locked_keyrange lkr;
+        lkr.prepare(m_rangetree);
+        if (m_sto_txnid != TXNID_NONE) {
+            add_txn_lock_memory(tally, m_sto_txnid, m_sto_buffer.total_memory_size());
+        } else {
+            lkr.acquire(infinite_range);
+            lkr.iterate(&tally_fn);
+        }
+        lkr.release();
+    }
 }
 
 void *locktree::get_userdata(void) const {
@@ -766,6 +1495,10 @@ void locktree::set_comparator(const comparator &cmp) {
     m_cmp.inherit(cmp);
 }
 
+const comparator &locktree::get_comparator(void) const {
+    return m_cmp;
+}
+
 locktree_manager *locktree::get_manager(void) const {
     return m_mgr;
 }
@@ -83,6 +83,9 @@ namespace toku {
         uint64_t wait_count, wait_time;
         uint64_t long_wait_count, long_wait_time;
         uint64_t timeout_count;
+        uint64_t retry_count, retry_success_count;
+        uint64_t deadlock_count;
+        uint64_t deadlock_detect_count, deadlock_detect_time;
 
         void add(const lt_counters &rhs) {
             wait_count += rhs.wait_count;
@@ -90,15 +93,54 @@ namespace toku {
             long_wait_count += rhs.long_wait_count;
             long_wait_time += rhs.long_wait_time;
             timeout_count += rhs.timeout_count;
+            retry_count += rhs.retry_count;
+            retry_success_count += rhs.retry_success_count;
+            deadlock_count += rhs.deadlock_count;
+            deadlock_detect_count += rhs.deadlock_detect_count;
+            deadlock_detect_time += rhs.deadlock_detect_time;
         }
     };
 
+    // The lock memory one txn holds, as tallied from the locktrees by
+    // locktree::tally_lock_memory() for background escalation.
+    struct lt_txn_lock_memory {
+        TXNID txnid;
+        uint64_t memory;
+
+        static int find_by_txnid(lt_txn_lock_memory *const &txn_memory, const TXNID &txnid);
+    };
+    typedef omt<lt_txn_lock_memory *, lt_txn_lock_memory *> lt_txn_lock_memory_tally;
+
+    // The key space of a partitioned locktree (see locktree::set_num_partitions)
+    // is split into ranges, each with its own concurrent_tree. Partition i
+    // covers the keys in [bounds[i - 1], bounds[i]), with the first and the
+    // last partition open ended. A lock whose range crosses a boundary is
+    // stored in every partition it overlaps.
+    struct lt_partition_table {
+        uint32_t num_partitions;
+        DBT *bounds;
+        concurrent_tree *trees;
+    };
+
     // Lock request state for some locktree
     struct lt_lock_request_info {
         omt<lock_request *> pending_lock_requests;
+        // The pending requests again, indexed by key so that releasing
+        // some locks only retries the requests those locks could have
+        // been blocking. Point requests are ordered by (key, txnid). Range
+        // requests are rare, so they are kept by txnid and checked one by one.
+        omt<lock_request *> pending_point_requests;
+        omt<lock_request *> pending_range_requests;
         std::atomic_bool pending_is_empty;
         toku_mutex_t mutex;
         bool should_retry_lock_requests;
+        // Set when a retry ran out of locks instead of into a conflict. Such
+        // a request can be granted after any release, so the next release
+        // retries every request instead of only the overlapping ones.
+        bool retry_all_needed;
+        // Which txns are waiting on which, kept up to date as requests
+        // block, retry and finish. Protected by the mutex.
+        wfg wait_graph;
         lt_counters counters;
         std::atomic_ullong retry_want;
         unsigned long long retry_done;
@@ -130,6 +172,33 @@ namespace toku {
 
         int set_max_lock_memory(size_t max_lock_memory);
 
+        uint32_t get_lock_partitions(void);
+
+        // effect: Locktrees created from now on are range partitioned into
+        //         up to num_partitions concurrent trees. 1 disables partitioning.
+        // returns: EINVAL if num_partitions is 0 or above MAX_LOCK_PARTITIONS
+        int set_lock_partitions(uint32_t num_partitions);
+
+        static const uint32_t MAX_LOCK_PARTITIONS = 64;
+
+        uint32_t get_escalation_soft_limit(void);
+
+        // effect: Once lock memory reaches percent of the max lock memory, a
+        //         background thread escalates the locks of the txns holding
+        //         the most lock memory until it is back under. Clients only
+        //         escalate, and wait for it, at the max. 100 turns it off.
+        // returns: EINVAL if percent is 0 or above 100
+        int set_escalation_soft_limit(uint32_t percent);
+
+        static const uint32_t DEFAULT_ESCALATION_SOFT_LIMIT = 75;
+
+        TOKU_DEADLOCK_VICTIM get_deadlock_victim(void);
+
+        // effect: Lock requests that close a wait-for cycle from now on fail
+        //         the txn on the cycle picked by the given policy.
+        // returns: EINVAL if the policy is unknown
+        int set_deadlock_victim(TOKU_DEADLOCK_VICTIM victim);
+
         // effect: Get a locktree from the manager. If a locktree exists with the given
         //         dict_id, it is referenced and then returned. If one did not exist, it
         //         is created. It will use the comparator for comparing keys. The on_create
@@ -178,6 +247,10 @@ namespace toku {
         // Escalate a set of locktrees
         void escalate_locktrees(locktree **locktrees, int num_locktrees);
 
+        // Escalate the locks of the txns holding the most lock memory,
+        // biggest first, until lock memory is under the soft limit
+        void escalate_biggest_txns(void);
+
         // effect: calls the private function run_escalation(), only ok to
         //         do for tests.
         // rationale: to get better stress test coverage, we want a way to
@@ -197,6 +270,10 @@ namespace toku {
         uint64_t m_max_lock_memory;
         uint64_t m_current_lock_memory;
 
+        // the number of partitions given to newly created locktrees
+        uint32_t m_lock_partitions;
+        TOKU_DEADLOCK_VICTIM m_deadlock_victim;
+
         struct lt_counters m_lt_counters;
 
         // the create and destroy callbacks for the locktrees
@@ -233,12 +310,35 @@ namespace toku {
         uint64_t m_wait_escalation_time;
         uint64_t m_long_wait_escalation_count;
         uint64_t m_long_wait_escalation_time;
+        uint64_t m_background_escalation_count;
+        tokutime_t m_background_escalation_time;
+
+        // The background escalator sleeps on m_background_escalation_cond,
+        // under m_escalation_mutex, until a client that finds lock memory
+        // at or above m_background_escalation_wake_at asks it to run.
+        // After a pass that could not get under the soft limit, it waits
+        // for lock memory to grow some more before it is woken again.
+        uint32_t m_escalation_soft_limit;
+        uint64_t m_background_escalation_wake_at;
+        toku_cond_t m_background_escalation_cond;
+        toku_pthread_t m_background_escalation_thread;
+        bool m_background_escalation_thread_running;
+        bool m_background_escalation_requested;
+        bool m_background_escalation_should_stop;
+
+        uint64_t escalation_soft_limit_bytes(void) const;
+        void reset_background_escalation_wake_at(void);
+        void maybe_wake_background_escalator(void);
+        static void *background_escalation_thread(void *arg);
 
         // the escalator coordinates escalation on a set of locktrees for a bunch of threads
         class locktree_escalator {
         public:
             void create(void);
             void destroy(void);
+            // effect: runs escalate_locktrees_fun, or waits for the run already
+            //         in progress to finish. if mgr is not null, the time spent
+            //         is added to its escalator wait time statistics.
             void run(locktree_manager *mgr, void (*escalate_locktrees_fun)(void *extra), void *extra);
 
         private:
@@ -274,6 +374,14 @@ namespace toku {
 
         void destroy(void);
 
+        // effect: Range partition this locktree into up to num_partitions
+        //         concurrent trees, so that locks on different parts of the
+        //         key space do not serialize behind one root mutex. The
+        //         boundaries are chosen from a sample of the first locks taken.
+        //         The single txnid optimization is not used when partitioned.
+        // requires: the locktree has no locks and was never partitioned
+        void set_num_partitions(uint32_t num_partitions);
+
         // For thread-safe, external reference counting
         void add_reference(void);
 
@@ -304,11 +412,30 @@ namespace toku {
                 const DBT *left_key, const DBT *right_key, txnid_set *conflicts);
 
         // effect: Release all of the lock ranges represented by the range buffer for a txnid.
-        void release_locks(TXNID txnid, const range_buffer *ranges);
+        // returns: false if some lock that was released reached beyond the given
+        //          ranges, because it was consolidated or escalated. Then requests
+        //          waiting on it may not overlap any of the ranges.
+        bool release_locks(TXNID txnid, const range_buffer *ranges);
 
         // effect: Runs escalation on this locktree
         void escalate(lt_escalate_cb after_escalate_callback, void *extra);
 
+        // effect: Escalates the locks of the given txnids only, leaving the
+        //         locks of every other txn alone. Since a lock cannot be
+        //         merged across another txn's lock, each txn ends up with one
+        //         lock per run of its locks. A partitioned locktree is
+        //         escalated whole.
+        void escalate_txns(const txnid_set &txnids, lt_escalate_cb after_escalate_callback, void *extra);
+
+        // effect: Adds the memory taken by each txn's locks in this locktree
+        //         to the tally.
+        void tally_lock_memory(lt_txn_lock_memory_tally *tally);
+
+        // returns: The number of row locks txnid holds in this locktree.
+        // note: Visits every lock, so this is only meant for rare events
+        //       like picking a deadlock victim.
+        uint64_t count_row_locks(TXNID txnid);
+
         // returns: The userdata associated with this locktree, or null if it has not been set.
         void *get_userdata(void) const;
 
@@ -318,6 +445,8 @@ namespace toku {
 
         void set_comparator(const comparator &cmp);
 
+        const comparator &get_comparator(void) const;
+
         int compare(const locktree *lt) const;
 
         DICTIONARY_ID get_dict_id() const;
@@ -345,6 +474,20 @@ namespace toku {
 
         concurrent_tree *m_rangetree;
 
+        // When m_num_partitions > 1, locks live in the trees of m_partitions
+        // instead. It starts out as m_initial_partitions, a single partition
+        // over m_rangetree, while the left keys of the first locks are sampled.
+        // Once there are enough samples it is replaced, exactly once and
+        // while m_rangetree is prepared, by a table with up to m_num_partitions
+        // partitions. The initial table lives as long as the locktree, so a
+        // thread that loaded the old pointer only has to notice the swap.
+        static const uint32_t PARTITION_SAMPLES_PER_PARTITION = 64;
+        uint32_t m_num_partitions;
+        struct lt_partition_table *m_partitions;
+        struct lt_partition_table m_initial_partitions;
+        DBT *m_partition_samples;
+        uint32_t m_num_partition_samples;
+
         void *m_userdata;
         struct lt_lock_request_info m_lock_request_info;
 
@@ -496,7 +639,8 @@ namespace toku {
         //  m_sto_score
         int sto_get_score_unsafe(void )const;
 
-        void remove_overlapping_locks_for_txnid(TXNID txnid,
+        // returns: false if a removed lock was not contained in [left_key, right_key]
+        bool remove_overlapping_locks_for_txnid(TXNID txnid,
                                                 const DBT *left_key, const DBT *right_key);
 
         int acquire_lock_consolidated(void *prepared_lkr, TXNID txnid,
@@ -511,6 +655,34 @@ namespace toku {
                              const DBT *left_key, const DBT *right_key,
                              txnid_set *conflicts, bool big_txn);
 
+        bool is_partitioned(void) const;
+
+        // effect: Record the left key of a lock on a partitioned locktree whose
+        //         boundaries are not chosen yet, and choose them once enough
+        //         keys have been sampled.
+        void sample_partition_key(const DBT *key);
+
+        // params: prepared_lkr is a void * to a prepared locked keyrange on
+        //         m_rangetree. see above.
+        // effect: Choose partition boundaries from the sampled keys, move
+        //         every lock into a new partition table and publish it.
+        void split_partitions(void *prepared_lkr);
+
+        int acquire_lock_partitioned(TXNID txnid,
+                                     const DBT *left_key, const DBT *right_key,
+                                     txnid_set *conflicts);
+
+        void get_conflicts_partitioned(TXNID txnid,
+                                       const DBT *left_key, const DBT *right_key,
+                                       txnid_set *conflicts);
+
+        bool remove_overlapping_locks_for_txnid_partitioned(TXNID txnid,
+                                                            const DBT *left_key,
+                                                            const DBT *right_key);
+
+        void escalate_partitioned(lt_escalate_cb after_escalate_callback,
+                                  void *after_escalate_callback_extra);
+
 
         friend class locktree_unit_test;
         friend class manager_unit_test;
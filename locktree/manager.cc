@@ -57,6 +57,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "locktree.h"
 #include "lock_request.h"
 
+#include <util/sort.h>
 #include <util/status.h>
 
 namespace toku {
@@ -64,6 +65,9 @@ namespace toku {
 void locktree_manager::create(lt_create_cb create_cb, lt_destroy_cb destroy_cb, lt_escalate_cb escalate_cb, void *escalate_extra) {
     m_max_lock_memory = DEFAULT_MAX_LOCK_MEMORY;
     m_current_lock_memory = 0;
+    m_lock_partitions = 1;
+    m_deadlock_victim = TOKU_DEADLOCK_VICTIM_REQUESTER;
+    m_escalation_soft_limit = DEFAULT_ESCALATION_SOFT_LIMIT;
 
     m_locktree_map.create();
     m_lt_create_callback = create_cb;
@@ -105,11 +109,71 @@ int locktree_manager::set_max_lock_memory(size_t max_lock_memory) {
         r = EDOM;
     } else {
         m_max_lock_memory = max_lock_memory;
+        reset_background_escalation_wake_at();
     }
     mutex_unlock();
     return r;
 }
 
+uint32_t locktree_manager::get_escalation_soft_limit(void) {
+    return m_escalation_soft_limit;
+}
+
+int locktree_manager::set_escalation_soft_limit(uint32_t percent) {
+    int r = 0;
+    mutex_lock();
+    if (percent == 0 || percent > 100) {
+        r = EINVAL;
+    } else {
+        m_escalation_soft_limit = percent;
+        reset_background_escalation_wake_at();
+    }
+    mutex_unlock();
+    return r;
+}
+
+uint64_t locktree_manager::escalation_soft_limit_bytes(void) const {
+    return m_max_lock_memory * m_escalation_soft_limit / 100;
+}
+
+// wake the background escalator once lock memory reaches the soft limit
+void locktree_manager::reset_background_escalation_wake_at(void) {
+    const uint64_t wake_at = m_escalation_soft_limit < 100 ? escalation_soft_limit_bytes() : UINT64_MAX;
+    toku_unsafe_set(m_background_escalation_wake_at, wake_at);
+}
+
+uint32_t locktree_manager::get_lock_partitions(void) {
+    return m_lock_partitions;
+}
+
+int locktree_manager::set_lock_partitions(uint32_t num_partitions) {
+    int r = 0;
+    mutex_lock();
+    if (num_partitions == 0 || num_partitions > MAX_LOCK_PARTITIONS) {
+        r = EINVAL;
+    } else {
+        m_lock_partitions = num_partitions;
+    }
+    mutex_unlock();
+    return r;
+}
+
+TOKU_DEADLOCK_VICTIM locktree_manager::get_deadlock_victim(void) {
+    return m_deadlock_victim;
+}
+
+int locktree_manager::set_deadlock_victim(TOKU_DEADLOCK_VICTIM victim) {
+    switch (victim) {
+    case TOKU_DEADLOCK_VICTIM_REQUESTER:
+    case TOKU_DEADLOCK_VICTIM_YOUNGEST:
+    case TOKU_DEADLOCK_VICTIM_LEAST_WORK:
+        m_deadlock_victim = victim;
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
 int locktree_manager::find_by_dict_id(locktree *const &lt, const DICTIONARY_ID &dict_id) {
     if (lt->get_dict_id().dictid < dict_id.dictid) {
         return -1;
@@ -153,6 +217,9 @@ locktree *locktree_manager::get_lt(DICTIONARY_ID dict_id,
     if (lt == nullptr) {
         XCALLOC(lt);
         lt->create(this, dict_id, cmp);
+        if (m_lock_partitions > 1) {
+            lt->set_num_partitions(m_lock_partitions);
+        }
 
         // new locktree created - call the on_create callback
         // and put it in the locktree map
@@ -354,9 +421,53 @@ int locktree_manager::check_current_lock_constraints(bool big_txn) {
             r = TOKUDB_OUT_OF_LOCKS;
         }
     }
+    if (r == 0) {
+        maybe_wake_background_escalator();
+    }
     return r;
 }
 
+void locktree_manager::maybe_wake_background_escalator(void) {
+    if (m_current_lock_memory < toku_unsafe_fetch(m_background_escalation_wake_at) ||
+        toku_unsafe_fetch(m_background_escalation_requested)) {
+        return;
+    }
+    toku_mutex_lock(&m_escalation_mutex);
+    if (!m_background_escalation_requested) {
+        m_background_escalation_requested = true;
+        toku_cond_signal(&m_background_escalation_cond);
+    }
+    toku_mutex_unlock(&m_escalation_mutex);
+}
+
+void *locktree_manager::background_escalation_thread(void *arg) {
+    locktree_manager *mgr = static_cast<locktree_manager *>(arg);
+    struct escalation_fn {
+        static void run(void *extra) {
+            locktree_manager *escalation_mgr = static_cast<locktree_manager *>(extra);
+            escalation_mgr->escalate_biggest_txns();
+        }
+    };
+    toku_mutex_lock(&mgr->m_escalation_mutex);
+    while (true) {
+        while (!mgr->m_background_escalation_should_stop &&
+               !mgr->m_background_escalation_requested) {
+            toku_cond_wait(&mgr->m_background_escalation_cond, &mgr->m_escalation_mutex);
+        }
+        if (mgr->m_background_escalation_should_stop) {
+            break;
+        }
+        toku_mutex_unlock(&mgr->m_escalation_mutex);
+        // a client escalation already in progress does the job instead
+        mgr->m_escalator.run(nullptr, escalation_fn::run, mgr);
+        toku_mutex_lock(&mgr->m_escalation_mutex);
+        // clients that asked during the pass saw memory it has dealt with
+        mgr->m_background_escalation_requested = false;
+    }
+    toku_mutex_unlock(&mgr->m_escalation_mutex);
+    return arg;
+}
+
 void locktree_manager::escalator_init(void) {
     ZERO_STRUCT(m_escalation_mutex);
     toku_mutex_init(
@@ -368,10 +479,32 @@ void locktree_manager::escalator_init(void) {
     m_long_wait_escalation_count = 0;
     m_long_wait_escalation_time = 0;
     m_escalation_latest_result = 0;
+    m_background_escalation_count = 0;
+    m_background_escalation_time = 0;
     m_escalator.create();
+
+    reset_background_escalation_wake_at();
+    toku_cond_init(*manager_background_escalation_cond_key, &m_background_escalation_cond, nullptr);
+    m_background_escalation_requested = false;
+    m_background_escalation_should_stop = false;
+    int r = toku_pthread_create(*manager_background_escalation_thread_key,
+                                &m_background_escalation_thread, nullptr,
+                                background_escalation_thread, this);
+    // without the thread, clients still escalate at the max lock memory
+    m_background_escalation_thread_running = (r == 0);
 }
 
 void locktree_manager::escalator_destroy(void) {
+    if (m_background_escalation_thread_running) {
+        toku_mutex_lock(&m_escalation_mutex);
+        m_background_escalation_should_stop = true;
+        toku_cond_signal(&m_background_escalation_cond);
+        toku_mutex_unlock(&m_escalation_mutex);
+        void *ret;
+        int r = toku_pthread_join(m_background_escalation_thread, &ret);
+        invariant_zero(r);
+    }
+    toku_cond_destroy(&m_background_escalation_cond);
     m_escalator.destroy();
     toku_mutex_destroy(&m_escalation_mutex);
 }
@@ -409,6 +542,103 @@ void locktree_manager::escalate_locktrees(locktree **locktrees, int num_locktree
     toku_mutex_unlock(&m_escalation_mutex);
 }
 
+static int compare_txn_lock_memory_biggest_first(const int &UU(extra),
+                                                 lt_txn_lock_memory *const &a,
+                                                 lt_txn_lock_memory *const &b) {
+    if (a->memory > b->memory) {
+        return -1;
+    } else if (a->memory == b->memory) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+void locktree_manager::escalate_biggest_txns(void) {
+    // get all locktrees
+    mutex_lock();
+    int num_locktrees = m_locktree_map.size();
+    locktree **locktrees = new locktree *[num_locktrees];
+    for (int i = 0; i < num_locktrees; i++) {
+        int r = m_locktree_map.fetch(i, &locktrees[i]);
+        invariant_zero(r);
+        reference_lt(locktrees[i]);
+    }
+    mutex_unlock();
+
+    tokutime_t t0 = toku_time_now();
+
+    // tally the lock memory of each txn over all of the locktrees
+    lt_txn_lock_memory_tally tally;
+    tally.create();
+    for (int i = 0; i < num_locktrees; i++) {
+        locktrees[i]->tally_lock_memory(&tally);
+    }
+    const uint32_t num_txns = tally.size();
+    lt_txn_lock_memory **XMALLOC_N(num_txns, txns);
+    for (uint32_t i = 0; i < num_txns; i++) {
+        int r = tally.fetch(i, &txns[i]);
+        invariant_zero(r);
+    }
+    const int extra = 0;
+    sort<lt_txn_lock_memory *, const int, compare_txn_lock_memory_biggest_first>::mergesort_r(
+        txns, num_txns, extra);
+
+    // escalate the biggest txns that are left, as many as it would take to
+    // get under the soft limit if escalation freed all of their memory,
+    // until lock memory actually is under it or every txn is escalated.
+    const uint64_t soft_limit = escalation_soft_limit_bytes();
+    uint32_t next_txn = 0;
+    while (next_txn < num_txns) {
+        const uint64_t current_lock_memory = m_current_lock_memory;
+        if (current_lock_memory <= soft_limit) {
+            break;
+        }
+        txnid_set txnids;
+        txnids.create();
+        uint64_t txnids_memory = 0;
+        while (next_txn < num_txns && txnids_memory < current_lock_memory - soft_limit) {
+            txnids.add(txns[next_txn]->txnid);
+            txnids_memory += txns[next_txn]->memory;
+            next_txn++;
+        }
+        for (int i = 0; i < num_locktrees; i++) {
+            locktrees[i]->escalate_txns(txnids, m_lt_escalate_callback, m_lt_escalate_callback_extra);
+        }
+        txnids.destroy();
+    }
+
+    for (uint32_t i = 0; i < num_txns; i++) {
+        toku_free(txns[i]);
+    }
+    toku_free(txns);
+    tally.destroy();
+    for (int i = 0; i < num_locktrees; i++) {
+        release_lt(locktrees[i]);
+    }
+    delete [] locktrees;
+
+    tokutime_t t1 = toku_time_now();
+
+    const uint64_t latest_result = m_current_lock_memory;
+    toku_mutex_lock(&m_escalation_mutex);
+    m_escalation_count++;
+    m_escalation_time += (t1 - t0);
+    m_escalation_latest_result = latest_result;
+    m_background_escalation_count++;
+    m_background_escalation_time += (t1 - t0);
+    toku_mutex_unlock(&m_escalation_mutex);
+
+    // if the soft limit could not be met, leave the locks be until
+    // there are a fair amount more of them
+    if (latest_result <= soft_limit) {
+        reset_background_escalation_wake_at();
+    } else {
+        toku_unsafe_set(m_background_escalation_wake_at,
+                        latest_result + (m_max_lock_memory - soft_limit) / 4);
+    }
+}
+
 struct escalate_args {
     locktree_manager *mgr;
     locktree **locktrees;
@@ -443,7 +673,9 @@ void locktree_manager::locktree_escalator::run(locktree_manager *mgr, void (*esc
     }
     toku_mutex_unlock(&m_escalator_mutex);
     uint64_t t1 = toku_current_time_microsec();
-    mgr->add_escalator_wait_time(t1 - t0);
+    if (mgr) {
+        mgr->add_escalator_wait_time(t1 - t0);
+    }
 }
 
 void locktree_manager::get_status(LTM_STATUS statp) {
@@ -457,6 +689,8 @@ void locktree_manager::get_status(LTM_STATUS statp) {
     LTM_STATUS_VAL(LTM_WAIT_ESCALATION_TIME) = m_wait_escalation_time;
     LTM_STATUS_VAL(LTM_LONG_WAIT_ESCALATION_COUNT) = m_long_wait_escalation_count;
     LTM_STATUS_VAL(LTM_LONG_WAIT_ESCALATION_TIME) = m_long_wait_escalation_time;    
+    LTM_STATUS_VAL(LTM_BACKGROUND_ESCALATION_COUNT) = m_background_escalation_count;
+    LTM_STATUS_VAL(LTM_BACKGROUND_ESCALATION_TIME) = m_background_escalation_time;
 
     uint64_t lock_requests_pending = 0;
     uint64_t sto_num_eligible = 0;
@@ -494,6 +728,11 @@ void locktree_manager::get_status(LTM_STATUS statp) {
     LTM_STATUS_VAL(LTM_LONG_WAIT_COUNT) = lt_counters.long_wait_count;
     LTM_STATUS_VAL(LTM_LONG_WAIT_TIME) = lt_counters.long_wait_time;
     LTM_STATUS_VAL(LTM_TIMEOUT_COUNT) = lt_counters.timeout_count;
+    LTM_STATUS_VAL(LTM_RETRY_COUNT) = lt_counters.retry_count;
+    LTM_STATUS_VAL(LTM_RETRY_SUCCESS_COUNT) = lt_counters.retry_success_count;
+    LTM_STATUS_VAL(LTM_DEADLOCK_COUNT) = lt_counters.deadlock_count;
+    LTM_STATUS_VAL(LTM_DEADLOCK_DETECT_COUNT) = lt_counters.deadlock_detect_count;
+    LTM_STATUS_VAL(LTM_DEADLOCK_DETECT_TIME) = lt_counters.deadlock_detect_time;
     *statp = ltm_status;
 }
 
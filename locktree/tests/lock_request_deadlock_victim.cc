@@ -0,0 +1,139 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// make sure the manager's deadlock victim policy picks which txn on a
+// wait-for cycle fails
+
+#include "locktree.h"
+#include "lock_request.h"
+#include "test.h"
+
+namespace toku {
+
+static void release_locks_and_retry(locktree *lt, TXNID txnid, const DBT *keys[], int num_keys) {
+    range_buffer buffer;
+    buffer.create();
+    for (int i = 0; i < num_keys; i++) {
+        buffer.append(keys[i], keys[i]);
+    }
+    lt->release_locks(txnid, &buffer);
+    lock_request::retry_all_lock_requests(lt);
+    buffer.destroy();
+}
+
+// txn a is older than txn b. b holds 3 locks, a holds 1 + a_extra_locks.
+// b waits on a, then a closes the cycle by waiting on b.
+static void test_victim(TOKU_DEADLOCK_VICTIM policy, int a_extra_locks, bool expect_a_victim) {
+    int r;
+    locktree_manager mgr;
+    mgr.create(nullptr, nullptr, nullptr, nullptr);
+    r = mgr.set_deadlock_victim(policy);
+    invariant_zero(r);
+
+    DICTIONARY_ID dict_id = { 1 };
+    locktree *lt = mgr.get_lt(dict_id, dbt_comparator, nullptr);
+
+    const TXNID txnid_a = 1001;
+    const TXNID txnid_b = 2001;
+    const DBT *a_keys[] = { get_dbt(1), get_dbt(10), get_dbt(11), get_dbt(12), get_dbt(13) };
+    const DBT *b_keys[] = { get_dbt(2), get_dbt(3), get_dbt(4) };
+    const int num_a_keys = 1 + a_extra_locks;
+    invariant(num_a_keys <= 5);
+
+    for (int i = 0; i < num_a_keys; i++) {
+        r = lt->acquire_write_lock(txnid_a, a_keys[i], a_keys[i], nullptr, false);
+        invariant_zero(r);
+    }
+    for (int i = 0; i < 3; i++) {
+        r = lt->acquire_write_lock(txnid_b, b_keys[i], b_keys[i], nullptr, false);
+        invariant_zero(r);
+    }
+    invariant(lt->count_row_locks(txnid_a) == (uint64_t) num_a_keys);
+    invariant(lt->count_row_locks(txnid_b) == 3);
+
+    lock_request request_a, request_b;
+    request_a.create();
+    request_b.create();
+    request_b.set(lt, txnid_b, a_keys[0], a_keys[0], lock_request::type::WRITE, false);
+    r = request_b.start();
+    invariant(r == DB_LOCK_NOTGRANTED);
+    request_a.set(lt, txnid_a, b_keys[0], b_keys[0], lock_request::type::WRITE, false);
+    r = request_a.start();
+
+    lt_lock_request_info *info = lt->get_lock_request_info();
+    invariant(info->counters.deadlock_count == 1);
+    invariant(info->pending_lock_requests.size() == 1);
+
+    if (expect_a_victim) {
+        // a failed right away, so b gets its lock once a is done
+        invariant(r == DB_LOCK_DEADLOCK);
+        release_locks_and_retry(lt, txnid_a, a_keys, num_a_keys);
+        r = request_b.wait(0);
+        invariant_zero(r);
+        const DBT *granted[] = { a_keys[0] };
+        release_locks_and_retry(lt, txnid_b, granted, 1);
+        release_locks_and_retry(lt, txnid_b, b_keys, 3);
+    } else {
+        // b was failed while it waited, and a keeps waiting for b to finish
+        invariant(r == DB_LOCK_NOTGRANTED);
+        r = request_b.wait(0);
+        invariant(r == DB_LOCK_DEADLOCK);
+        release_locks_and_retry(lt, txnid_b, b_keys, 3);
+        r = request_a.wait(0);
+        invariant_zero(r);
+        const DBT *granted[] = { b_keys[0] };
+        release_locks_and_retry(lt, txnid_a, granted, 1);
+        release_locks_and_retry(lt, txnid_a, a_keys, num_a_keys);
+    }
+    invariant(info->pending_lock_requests.size() == 0);
+
+    request_a.destroy();
+    request_b.destroy();
+    mgr.release_lt(lt);
+    mgr.destroy();
+}
+
+} /* namespace toku */
+
+int main(void) {
+    toku::test_victim(TOKU_DEADLOCK_VICTIM_REQUESTER, 0, true);
+    toku::test_victim(TOKU_DEADLOCK_VICTIM_YOUNGEST, 0, false);
+    toku::test_victim(TOKU_DEADLOCK_VICTIM_LEAST_WORK, 0, true);
+    toku::test_victim(TOKU_DEADLOCK_VICTIM_LEAST_WORK, 4, false);
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "lock_request_unit_test.h"
+
+namespace toku {
+
+// releasing a range should only retry the pending requests overlapping it
+void lock_request_unit_test::test_retry_overlapping(void) {
+    int r;
+    locktree lt;
+
+    DICTIONARY_ID dict_id = { 1 };
+    lt.create(nullptr, dict_id, dbt_comparator);
+
+    TXNID txnid_a = 1001;
+    TXNID txnid_b = 2001;
+    TXNID txnid_c = 3001;
+    TXNID txnid_d = 4001;
+
+    const DBT *one = get_dbt(1);
+    const DBT *four = get_dbt(4);
+    const DBT *five = get_dbt(5);
+    const DBT *six = get_dbt(6);
+
+    // txnid a holds 1 and 5
+    r = lt.acquire_write_lock(txnid_a, one, one, nullptr, false);
+    invariant_zero(r);
+    r = lt.acquire_write_lock(txnid_a, five, five, nullptr, false);
+    invariant_zero(r);
+
+    lt_lock_request_info *info = lt.get_lock_request_info();
+
+    // b waits for 1, c waits for 5, d waits for [4,6]
+    lock_request request_b, request_c, request_d;
+    request_b.create();
+    request_b.set(&lt, txnid_b, one, one, lock_request::type::WRITE, false);
+    r = request_b.start();
+    invariant(r == DB_LOCK_NOTGRANTED);
+    request_c.create();
+    request_c.set(&lt, txnid_c, five, five, lock_request::type::WRITE, false);
+    r = request_c.start();
+    invariant(r == DB_LOCK_NOTGRANTED);
+    request_d.create();
+    request_d.set(&lt, txnid_d, four, six, lock_request::type::WRITE, false);
+    r = request_d.start();
+    invariant(r == DB_LOCK_NOTGRANTED);
+    invariant(info->pending_lock_requests.size() == 3);
+    invariant(info->pending_point_requests.size() == 2);
+    invariant(info->pending_range_requests.size() == 1);
+
+    // releasing 1 retries only b, which gets its lock
+    release_lock_and_retry_overlapping(&lt, txnid_a, one);
+    invariant(request_b.m_state == lock_request::state::COMPLETE);
+    invariant(request_b.m_complete_r == 0);
+    invariant(request_c.m_state == lock_request::state::PENDING);
+    invariant(request_d.m_state == lock_request::state::PENDING);
+    invariant(info->counters.retry_count == 1);
+    invariant(info->counters.retry_success_count == 1);
+
+    // releasing 5 retries c and d. whichever goes first gets the lock,
+    // the other stays pending behind it.
+    release_lock_and_retry_overlapping(&lt, txnid_a, five);
+    invariant(info->pending_lock_requests.size() == 1);
+    invariant(info->counters.retry_count == 3);
+    invariant(info->counters.retry_success_count == 2);
+    invariant(request_c.m_state == lock_request::state::COMPLETE);
+    invariant(request_c.m_complete_r == 0);
+    invariant(request_d.m_state == lock_request::state::PENDING);
+
+    // releasing 1 again overlaps nothing pending
+    release_lock_and_retry_overlapping(&lt, txnid_b, one);
+    invariant(request_d.m_state == lock_request::state::PENDING);
+    invariant(info->counters.retry_count == 3);
+
+    // releasing 5 lets d through
+    release_lock_and_retry_overlapping(&lt, txnid_c, five);
+    invariant(request_d.m_state == lock_request::state::COMPLETE);
+    invariant(request_d.m_complete_r == 0);
+    invariant(info->pending_lock_requests.size() == 0);
+    invariant(info->pending_point_requests.size() == 0);
+    invariant(info->pending_range_requests.size() == 0);
+    invariant(info->counters.retry_count == 4);
+    invariant(info->counters.retry_success_count == 3);
+
+    locktree_unit_test::locktree_test_release_lock(&lt, txnid_d, four, six);
+
+    request_b.destroy();
+    request_c.destroy();
+    request_d.destroy();
+
+    lt.release_reference();
+    lt.destroy();
+}
+
+} /* namespace toku */
+
+int main(void) {
+    toku::lock_request_unit_test test;
+    test.test_retry_overlapping();
+    return 0;
+}
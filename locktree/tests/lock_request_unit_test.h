@@ -65,6 +65,9 @@ public:
     // test that the get_wait_time callback works
     void test_wait_time_callback(void);
 
+    // releasing a range should only retry the pending requests overlapping it
+    void test_retry_overlapping(void);
+
 private:
     // releases a single range lock and retries all lock requests.
     // this is kind of like what the ydb layer does, except that
@@ -75,6 +78,17 @@ private:
         locktree_unit_test::locktree_test_release_lock(lt, txnid, left_key, right_key);
         lock_request::retry_all_lock_requests(lt);
     }
+
+    // releases a single point lock and retries only the lock requests
+    // overlapping it, like the ydb layer does for a released key range.
+    void release_lock_and_retry_overlapping(locktree *lt, TXNID txnid, const DBT *key) {
+        range_buffer buffer;
+        buffer.create();
+        buffer.append(key, key);
+        locktree_unit_test::locktree_test_release_lock(lt, txnid, key, key);
+        lock_request::retry_lock_requests(lt, &buffer);
+        buffer.destroy();
+    }
 };
 
 }
@@ -0,0 +1,137 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+#include "locktree.h"
+
+// escalating some txns merges their own runs of locks and leaves the
+// locks of every other txn alone
+
+using namespace toku;
+
+static int num_escalated;
+static TXNID escalated_txnid;
+static int escalated_num_ranges;
+
+static void e_callback(TXNID txnid, const locktree *lt UU(), const range_buffer &buffer, void *extra UU()) {
+    num_escalated++;
+    escalated_txnid = txnid;
+    escalated_num_ranges = buffer.get_num_ranges();
+}
+
+static void write_lock(locktree *lt, TXNID txnid, int k) {
+    int r = lt->acquire_write_lock(txnid, get_dbt(k), get_dbt(k), nullptr, false);
+    invariant_zero(r);
+}
+
+static void release_lock(locktree *lt, TXNID txnid, int left_k, int right_k) {
+    range_buffer buffer;
+    buffer.create();
+    buffer.append(get_dbt(left_k), get_dbt(right_k));
+    lt->release_locks(txnid, &buffer);
+    buffer.destroy();
+}
+
+static uint64_t tallied_memory(lt_txn_lock_memory_tally *tally, TXNID txnid) {
+    lt_txn_lock_memory *txn_memory;
+    int r = tally->find_zero<TXNID, lt_txn_lock_memory::find_by_txnid>(txnid, &txn_memory, nullptr);
+    invariant_zero(r);
+    return txn_memory->memory;
+}
+
+static void test_escalate_txns(void) {
+    locktree_manager mgr;
+    mgr.create(nullptr, nullptr, e_callback, nullptr);
+    DICTIONARY_ID dict_id = { .dictid = 1 };
+    locktree *lt = mgr.get_lt(dict_id, dbt_comparator, nullptr);
+
+    // a holds 0..8 except 5, which b holds. c holds 20 and 21.
+    const TXNID txnid_a = 1001, txnid_b = 2001, txnid_c = 3001;
+    write_lock(lt, txnid_b, 5);
+    for (int k = 0; k <= 8; k++) {
+        if (k != 5) {
+            write_lock(lt, txnid_a, k);
+        }
+    }
+    write_lock(lt, txnid_c, 20);
+    write_lock(lt, txnid_c, 21);
+
+    lt_txn_lock_memory_tally tally;
+    tally.create();
+    lt->tally_lock_memory(&tally);
+    invariant(tally.size() == 3);
+    invariant(tallied_memory(&tally, txnid_a) == 4 * tallied_memory(&tally, txnid_c));
+    invariant(tallied_memory(&tally, txnid_b) * 2 == tallied_memory(&tally, txnid_c));
+    for (uint32_t i = 0; i < tally.size(); i++) {
+        lt_txn_lock_memory *txn_memory;
+        int r = tally.fetch(i, &txn_memory);
+        invariant_zero(r);
+        toku_free(txn_memory);
+    }
+    tally.destroy();
+
+    // only a is escalated, into [0,4] and [6,8]
+    txnid_set txnids;
+    txnids.create();
+    txnids.add(txnid_a);
+    lt->escalate_txns(txnids, e_callback, nullptr);
+    txnids.destroy();
+    invariant(num_escalated == 1);
+    invariant(escalated_txnid == txnid_a);
+    invariant(escalated_num_ranges == 2);
+    invariant(lt->count_row_locks(txnid_a) == 2);
+    invariant(lt->count_row_locks(txnid_b) == 1);
+    invariant(lt->count_row_locks(txnid_c) == 2);
+
+    // a's escalated locks still conflict with other txns
+    int r = lt->acquire_write_lock(txnid_c, get_dbt(3), get_dbt(3), nullptr, false);
+    invariant(r == DB_LOCK_NOTGRANTED);
+
+    release_lock(lt, txnid_a, 0, 8);
+    release_lock(lt, txnid_b, 5, 5);
+    release_lock(lt, txnid_c, 20, 21);
+    invariant(lt->count_row_locks(txnid_a) == 0);
+
+    mgr.release_lt(lt);
+    mgr.destroy();
+}
+
+int main(int argc UU(), const char *argv[] UU()) {
+    test_escalate_txns();
+    return 0;
+}
@@ -0,0 +1,148 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+#include "locktree_unit_test.h"
+
+namespace toku {
+
+static void note_escalated_txn(TXNID txnid, const locktree *lt,
+                               const range_buffer &buffer, void *extra) {
+    (void) txnid; (void) lt; (void) buffer;
+    (*(int *) extra)++;
+}
+
+// test conflicts, consolidation, release and escalation of locks
+// that cross partition boundaries in a range partitioned locktree
+void locktree_unit_test::test_partitions(void) {
+    locktree lt;
+
+    DICTIONARY_ID dict_id = { 1 };
+    lt.create(nullptr, dict_id, dbt_comparator);
+    const uint32_t num_partitions = 4;
+    lt.set_num_partitions(num_partitions);
+
+    int r;
+    TXNID txnid_a = 1001;
+    TXNID txnid_b = 2001;
+    const int num_keys = num_partitions * locktree::PARTITION_SAMPLES_PER_PARTITION;
+
+    // the first locks taken choose the partition boundaries
+    for (int i = 0; i < num_keys; i++) {
+        invariant(lt.m_partitions == &lt.m_initial_partitions);
+        r = lt.acquire_write_lock(txnid_a, get_dbt(i), get_dbt(i), nullptr, false);
+        invariant_zero(r);
+    }
+    invariant(lt.m_partitions != &lt.m_initial_partitions);
+    invariant(lt.m_partitions->num_partitions == num_partitions);
+    invariant(lt.m_rangetree->is_empty());
+    for (uint32_t i = 0; i < num_partitions; i++) {
+        invariant(!lt.m_partitions->trees[i].is_empty());
+    }
+
+    // every lock moved over, so a range over all of them conflicts
+    txnid_set conflicts;
+    conflicts.create();
+    r = lt.acquire_write_lock(txnid_b, get_dbt(0), get_dbt(num_keys - 1), &conflicts, false);
+    invariant(r == DB_LOCK_NOTGRANTED);
+    invariant(conflicts.size() == 1 && conflicts.contains(txnid_a));
+    conflicts.destroy();
+    for (int i = 0; i < num_keys; i++) {
+        lt.remove_overlapping_locks_for_txnid(txnid_a, get_dbt(i), get_dbt(i));
+    }
+    invariant(no_row_locks(&lt));
+
+    // a range lock across every boundary conflicts in each partition
+    const DBT *left = get_dbt(10);
+    const DBT *right = get_dbt(num_keys - 10);
+    r = lt.acquire_write_lock(txnid_b, left, right, nullptr, false);
+    invariant_zero(r);
+    for (int i = 0; i < num_keys; i += 7) {
+        r = lt.acquire_write_lock(txnid_a, get_dbt(i), get_dbt(i), nullptr, false);
+        invariant(r == ((i < 10 || i > num_keys - 10) ? 0 : DB_LOCK_NOTGRANTED));
+        if (r == 0) {
+            lt.remove_overlapping_locks_for_txnid(txnid_a, get_dbt(i), get_dbt(i));
+        }
+    }
+    conflicts.create();
+    lt.get_conflicts(true, txnid_a, get_dbt(num_keys / 2), get_dbt(num_keys / 2), &conflicts);
+    invariant(conflicts.size() == 1 && conflicts.contains(txnid_b));
+    conflicts.destroy();
+
+    // locks that only touch one partition but overlap the range have to
+    // consolidate with its copies in every other partition
+    r = lt.acquire_write_lock(txnid_b, get_dbt(100), get_dbt(100), nullptr, false);
+    invariant_zero(r);
+    r = lt.acquire_write_lock(txnid_b, get_dbt(5), get_dbt(10), nullptr, false);
+    invariant_zero(r);
+    r = lt.acquire_write_lock(txnid_a, get_dbt(7), get_dbt(7), nullptr, false);
+    invariant(r == DB_LOCK_NOTGRANTED);
+
+    // releasing one point of the range removes every copy of it
+    lt.remove_overlapping_locks_for_txnid(txnid_b, get_dbt(num_keys - 20), get_dbt(num_keys - 20));
+    invariant(no_row_locks(&lt));
+
+    // escalation merges each txnid's locks, keeping them in their partitions
+    for (int i = 0; i < num_keys; i++) {
+        TXNID txnid = i < num_keys / 2 + 5 ? txnid_a : txnid_b;
+        r = lt.acquire_write_lock(txnid, get_dbt(i), get_dbt(i), nullptr, false);
+        invariant_zero(r);
+    }
+    int num_escalated_txns = 0;
+    lt.escalate(note_escalated_txn, &num_escalated_txns);
+    invariant(num_escalated_txns == 2);
+    for (int i = 0; i < num_keys; i++) {
+        TXNID other = i < num_keys / 2 + 5 ? txnid_b : txnid_a;
+        conflicts.create();
+        lt.get_conflicts(true, other, get_dbt(i), get_dbt(i), &conflicts);
+        invariant(conflicts.size() == 1 && !conflicts.contains(other));
+        conflicts.destroy();
+    }
+    lt.remove_overlapping_locks_for_txnid(txnid_a, get_dbt(0), get_dbt(num_keys / 2 + 4));
+    lt.remove_overlapping_locks_for_txnid(txnid_b, get_dbt(num_keys / 2 + 5), get_dbt(num_keys - 1));
+    invariant(no_row_locks(&lt));
+
+    lt.release_reference();
+    lt.destroy();
+}
+
+} /* namespace toku */
+
+int main(void) {
+    toku::locktree_unit_test test;
+    test.test_partitions();
+    return 0;
+}
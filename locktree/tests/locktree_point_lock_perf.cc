@@ -0,0 +1,154 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+// Measure the point lock acquire/release rate of one locktree against the
+// number of threads, unpartitioned and range partitioned. Every thread runs
+// small transactions that each lock a few random keys and then release them.
+
+// locktree_point_lock_perf -v --seconds 5 --max_threads 32 --partitions 16
+
+#include <stdio.h>
+#include "locktree.h"
+#include "test.h"
+
+using namespace toku;
+
+static int verbose = 0;
+static volatile bool stop_workers;
+
+static const int64_t num_keys = 1000000;
+static const int locks_per_txn = 4;
+
+struct worker_arg {
+    locktree *lt;
+    TXNID txnid;
+    uint64_t num_locks;
+};
+
+static void *worker(void *extra) {
+    struct worker_arg *arg = (struct worker_arg *) extra;
+    unsigned int seed = arg->txnid;
+    int64_t keys[locks_per_txn];
+    DBT key_dbts[locks_per_txn];
+    while (!stop_workers) {
+        range_buffer buffer;
+        buffer.create();
+        for (int i = 0; i < locks_per_txn; i++) {
+            keys[i] = ((int64_t) rand_r(&seed) * RAND_MAX + rand_r(&seed)) % num_keys;
+            toku_fill_dbt(&key_dbts[i], &keys[i], sizeof keys[i]);
+            int r = arg->lt->acquire_write_lock(arg->txnid, &key_dbts[i], &key_dbts[i], nullptr, false);
+            if (r == 0) {
+                buffer.append(&key_dbts[i], &key_dbts[i]);
+                arg->num_locks++;
+            } else {
+                assert(r == DB_LOCK_NOTGRANTED);
+            }
+        }
+        arg->lt->release_locks(arg->txnid, &buffer);
+        buffer.destroy();
+    }
+    return arg;
+}
+
+static double run(uint32_t num_partitions, int num_threads, double seconds) {
+    locktree_manager mgr;
+    mgr.create(nullptr, nullptr, nullptr, nullptr);
+    int r = mgr.set_lock_partitions(num_partitions);
+    assert(r == 0);
+    DICTIONARY_ID dict_id = { .dictid = 1 };
+    locktree *lt = mgr.get_lt(dict_id, dbt_comparator, nullptr);
+
+    stop_workers = false;
+    pthread_t ids[num_threads];
+    struct worker_arg args[num_threads];
+    uint64_t t_start = toku_current_time_microsec();
+    for (int i = 0; i < num_threads; i++) {
+        args[i] = { lt, (TXNID) (1000 + i), 0 };
+        r = toku_pthread_create(toku_uninstrumented, &ids[i], nullptr, worker, &args[i]);
+        assert(r == 0);
+    }
+    usleep((useconds_t) (seconds * 1000000));
+    stop_workers = true;
+    uint64_t num_locks = 0;
+    for (int i = 0; i < num_threads; i++) {
+        void *ret;
+        r = toku_pthread_join(ids[i], &ret);
+        assert(r == 0);
+        num_locks += args[i].num_locks;
+    }
+    uint64_t t_end = toku_current_time_microsec();
+
+    mgr.release_lt(lt);
+    mgr.destroy();
+    return num_locks * 1000000.0 / (t_end - t_start);
+}
+
+int main(int argc, const char *argv[]) {
+    double seconds = 0.1;
+    int max_threads = 8;
+    uint32_t num_partitions = 16;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            verbose++;
+            continue;
+        }
+        if (strcmp(argv[i], "--seconds") == 0 && i+1 < argc) {
+            seconds = atof(argv[++i]);
+            continue;
+        }
+        if (strcmp(argv[i], "--max_threads") == 0 && i+1 < argc) {
+            max_threads = atoi(argv[++i]);
+            continue;
+        }
+        if (strcmp(argv[i], "--partitions") == 0 && i+1 < argc) {
+            num_partitions = atoi(argv[++i]);
+            continue;
+        }
+    }
+
+    if (verbose) {
+        printf("%8s %16s %16s\n", "threads", "locks/s", "partitioned/s");
+    }
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        double rate = run(1, num_threads, seconds);
+        double partitioned_rate = run(num_partitions, num_threads, seconds);
+        if (verbose) {
+            printf("%8d %16.0f %16.0f\n", num_threads, rate, partitioned_rate);
+        }
+    }
+    return 0;
+}
@@ -73,6 +73,10 @@ public:
     // up when there is more than one txnid with locks in the tree
     void test_single_txnid_optimization(void);
 
+    // test conflicts, consolidation, release and escalation of locks
+    // that cross partition boundaries in a range partitioned locktree
+    void test_partitions(void);
+
 private:
 
 
@@ -88,6 +92,11 @@ private:
     }
 
     static bool no_row_locks(const locktree *lt) {
+        for (uint32_t i = 0; i < lt->m_partitions->num_partitions; i++) {
+            if (!lt->m_partitions->trees[i].is_empty()) {
+                return false;
+            }
+        }
         return lt->m_rangetree->is_empty() && lt->m_sto_buffer.is_empty();
     }
 
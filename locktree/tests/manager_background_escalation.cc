@@ -0,0 +1,133 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include <string.h>
+#include "test.h"
+#include "locktree.h"
+
+// a txn that takes lock memory past the escalation soft limit gets its
+// locks escalated by the background escalator, without ever waiting on
+// escalation itself, and without touching the locks of a small txn
+
+using namespace toku;
+
+static void e_callback(TXNID txnid UU(), const locktree *lt UU(), const range_buffer &buffer UU(), void *extra UU()) {
+}
+
+static uint64_t get_status_value(locktree_manager &mgr, const char *keyname) {
+    LTM_STATUS_S ltm_status_test;
+    mgr.get_status(&ltm_status_test);
+
+    TOKU_ENGINE_STATUS_ROW key_status = NULL;
+    for (int i = 0; ; i++) {
+        TOKU_ENGINE_STATUS_ROW status = &ltm_status_test.status[i];
+        if (status->keyname == NULL)
+            break;
+        if (strcmp(status->keyname, keyname) == 0) {
+            key_status = status;
+            break;
+        }
+    }
+    invariant(key_status);
+    return key_status->value.num;
+}
+
+static void test_background_escalation(void) {
+    const uint64_t max_lock_memory = 40000;
+    const uint32_t soft_limit = 50;
+
+    locktree_manager mgr;
+    mgr.create(nullptr, nullptr, e_callback, nullptr);
+    int r = mgr.set_max_lock_memory(max_lock_memory);
+    invariant_zero(r);
+    invariant(mgr.get_escalation_soft_limit() == locktree_manager::DEFAULT_ESCALATION_SOFT_LIMIT);
+    r = mgr.set_escalation_soft_limit(0);
+    invariant(r == EINVAL);
+    r = mgr.set_escalation_soft_limit(101);
+    invariant(r == EINVAL);
+    r = mgr.set_escalation_soft_limit(soft_limit);
+    invariant_zero(r);
+    invariant(mgr.get_escalation_soft_limit() == soft_limit);
+
+    DICTIONARY_ID dict_id = { .dictid = 1 };
+    locktree *lt = mgr.get_lt(dict_id, dbt_comparator, nullptr);
+
+    const TXNID txnid_small = 1001, txnid_big = 2001;
+    r = lt->acquire_write_lock(txnid_small, get_dbt(0), get_dbt(0), nullptr, false);
+    invariant_zero(r);
+
+    // the big txn takes locks until the background escalator has run.
+    // none of its requests may fail, since the hard limit is never hit.
+    int64_t k;
+    for (k = 1; k < 999; k++) {
+        r = lt->acquire_write_lock(txnid_big, get_dbt(k), get_dbt(k), nullptr, false);
+        invariant_zero(r);
+        if (get_status_value(mgr, "LTM_BACKGROUND_ESCALATION_COUNT") > 0) {
+            break;
+        }
+    }
+    for (int i = 0; i < 10000 && get_status_value(mgr, "LTM_BACKGROUND_ESCALATION_COUNT") == 0; i++) {
+        usleep(1000);
+    }
+    invariant(get_status_value(mgr, "LTM_BACKGROUND_ESCALATION_COUNT") > 0);
+    invariant(get_status_value(mgr, "LTM_SIZE_CURRENT") <= max_lock_memory * soft_limit / 100);
+
+    // the big txn's locks were merged into one range, except for at most
+    // the one it took after the escalator finished. the small txn's lock
+    // is untouched.
+    invariant(lt->count_row_locks(txnid_big) <= 2);
+    invariant(lt->count_row_locks(txnid_small) == 1);
+
+    range_buffer buffer;
+    buffer.create();
+    buffer.append(get_dbt(1), get_dbt(k));
+    lt->release_locks(txnid_big, &buffer);
+    buffer.destroy();
+    buffer.create();
+    buffer.append(get_dbt(0), get_dbt(0));
+    lt->release_locks(txnid_small, &buffer);
+    buffer.destroy();
+
+    mgr.release_lt(lt);
+    mgr.destroy();
+}
+
+int main(int argc UU(), const char *argv[] UU()) {
+    test_background_escalation();
+    return 0;
+}
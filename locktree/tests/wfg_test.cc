@@ -158,7 +158,54 @@ static void test_find_cycles() {
     wfg g;
     g.create();
 
-    // TODO: verify that finding cycles works
+    // 1 -> 2 -> 3 -> 1, and 0 -> 1 hanging off the cycle
+    txnid_set edges;
+    edges.create();
+    edges.add(2);
+    g.set_edges(1, edges);
+    edges.destroy();
+    edges.create();
+    edges.add(3);
+    g.set_edges(2, edges);
+    edges.destroy();
+    edges.create();
+    edges.add(1);
+    g.set_edges(3, edges);
+    edges.destroy();
+    edges.create();
+    edges.add(1);
+    g.set_edges(0, edges);
+    edges.destroy();
+
+    // the cycle is found from any of its members, and only has them
+    txnid_set cycle;
+    cycle.create();
+    invariant(!g.find_cycle_from_txnid(0, &cycle));
+    invariant(cycle.size() == 0);
+    invariant(g.find_cycle_from_txnid(2, &cycle));
+    invariant(cycle.size() == 3);
+    invariant(cycle.contains(1) && cycle.contains(2) && cycle.contains(3));
+    cycle.destroy();
+
+    // set_edges replaces the old edges, breaking the cycle at 3
+    edges.create();
+    edges.add(4);
+    g.set_edges(3, edges);
+    edges.destroy();
+    invariant(!g.cycle_exists_from_txnid(1));
+    invariant(!g.node_exists(4));
+
+    // 3 waits on 1 again, then stops waiting altogether
+    edges.create();
+    edges.add(1);
+    g.set_edges(3, edges);
+    edges.destroy();
+    invariant(g.cycle_exists_from_txnid(1));
+    g.remove_node(3);
+    invariant(!g.node_exists(3));
+    invariant(!g.cycle_exists_from_txnid(1));
+    invariant(!g.cycle_exists_from_txnid(2));
+    g.remove_node(3);
 
     g.destroy();
 }
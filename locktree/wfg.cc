@@ -63,6 +63,7 @@ namespace toku {
 // Create a lock request graph
 void wfg::create(void) {
     m_nodes.create();
+    m_search = 0;
 }
 
 // Destroy the internals of the lock request graph
@@ -85,6 +86,31 @@ void wfg::add_edge(TXNID a_txnid, TXNID b_txnid) {
     a_node->edges.add(b_node->txnid);
 }
 
+// Replace the edges out of txnid with one edge to each of the given txnids.
+void wfg::set_edges(TXNID txnid, const txnid_set &edges) {
+    node *n = find_create_node(txnid);
+    n->edges.destroy();
+    n->edges.create();
+    size_t n_edges = edges.size();
+    for (size_t i = 0; i < n_edges; i++) {
+        n->edges.add(edges.get(i));
+    }
+}
+
+// Remove the node for txnid and the edges out of it, if it exists.
+void wfg::remove_node(TXNID txnid) {
+    node *n;
+    uint32_t idx;
+    int r = m_nodes.find_zero<TXNID, find_by_txnid>(txnid, &n, &idx);
+    if (r == 0) {
+        r = m_nodes.delete_at(idx);
+        invariant_zero(r);
+        node::free(n);
+    } else {
+        invariant(r == DB_NOTFOUND);
+    }
+}
+
 // Return true if a node with the given transaction id exists in the graph.
 // Return false otherwise.
 bool wfg::node_exists(TXNID txnid) {
@@ -92,9 +118,9 @@ bool wfg::node_exists(TXNID txnid) {
     return n != NULL;
 }
 
-bool wfg::cycle_exists_from_node(node *target, node *head) {
+bool wfg::cycle_exists_from_node(node *target, node *head, txnid_set *cycle) {
     bool cycle_found = false;
-    head->visited = true;
+    head->visited = m_search;
     size_t n_edges = head->edges.size();
     for (size_t i = 0; i < n_edges && !cycle_found; i++) {
         TXNID edge_id = head->edges.get(i);
@@ -102,22 +128,29 @@ bool wfg::cycle_exists_from_node(node *target, node *head) {
             cycle_found = true;
         } else {
             node *new_head = find_node(edge_id);
-            if (new_head && !new_head->visited) {
-                cycle_found = cycle_exists_from_node(target, new_head);
+            if (new_head && new_head->visited != m_search) {
+                cycle_found = cycle_exists_from_node(target, new_head, cycle);
             }
         }
     }
-    head->visited = false;
+    if (cycle_found && cycle) {
+        cycle->add(head->txnid);
+    }
     return cycle_found;
 }
 
 // Return true if there exists a cycle from a given transaction id in the graph.
 // Return false otherwise.
 bool wfg::cycle_exists_from_txnid(TXNID txnid) {
+    return find_cycle_from_txnid(txnid, nullptr);
+}
+
+bool wfg::find_cycle_from_txnid(TXNID txnid, txnid_set *cycle) {
     node *a_node = find_node(txnid);
     bool cycles_found = false;
     if (a_node) {
-        cycles_found = cycle_exists_from_node(a_node, a_node);
+        m_search++;
+        cycles_found = cycle_exists_from_node(a_node, a_node, cycle);
     }
     return cycles_found;
 }
@@ -189,7 +222,7 @@ wfg::node *wfg::find_create_node(TXNID txnid) {
 wfg::node *wfg::node::alloc(TXNID txnid) {
     node *XCALLOC(n);
     n->txnid = txnid;
-    n->visited = false;
+    n->visited = 0;
     n->edges.create();
     return n;
 }
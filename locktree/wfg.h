@@ -59,6 +59,12 @@ namespace toku {
 
 // A wfg is a 'wait-for' graph. A directed edge in represents one
 // txn waiting for another to finish before it can acquire a lock.
+//
+// A locktree keeps one wfg for as long as it lives. A txn gets a node with
+// set_edges() when its lock request blocks, and loses it with remove_node()
+// once the request is granted or fails, so the graph only ever holds the
+// txns that are waiting. A new cycle must pass through the edges that were
+// just set, so it is found by searching from their origin alone.
 
 class wfg {
 public:
@@ -71,6 +77,14 @@ public:
     // Add an edge (a_id, b_id) to the graph
     void add_edge(TXNID a_txnid, TXNID b_txnid);
 
+    // Replace the edges out of txnid with one edge to each of the given txnids.
+    // Unlike add_edge, only txnid gets a node.
+    void set_edges(TXNID txnid, const txnid_set &edges);
+
+    // Remove the node for txnid and the edges out of it, if it exists.
+    // Edges into it are left alone, they just no longer lead anywhere.
+    void remove_node(TXNID txnid);
+
     // Return true if a node with the given transaction id exists in the graph.
     // Return false otherwise.
     bool node_exists(TXNID txnid);
@@ -79,6 +93,10 @@ public:
     // Return false otherwise.
     bool cycle_exists_from_txnid(TXNID txnid);
 
+    // Like cycle_exists_from_txnid, but also add the txnids on the cycle
+    // that was found, txnid included, to the given set.
+    bool find_cycle_from_txnid(TXNID txnid, txnid_set *cycle);
+
     // Apply a given function f to all of the nodes in the graph.  The apply function
     // returns when the function f is called for all of the nodes in the graph, or the 
     // function f returns non-zero.
@@ -95,7 +113,8 @@ private:
         // txnid for this node and the associated set of edges
         TXNID txnid;
         txnid_set edges;
-        bool visited;
+        // the search that last visited this node, see m_search
+        uint64_t visited;
 
         static node *alloc(TXNID txnid);
 
@@ -105,11 +124,16 @@ private:
 
     toku::omt<node *> m_nodes;
 
+    // Each cycle search gets a new number, and marks the nodes it visits
+    // with it. A node that was explored once without finding the target
+    // cannot lead there later on in the same search.
+    uint64_t m_search;
+
     node *find_node(TXNID txnid);
 
     node *find_create_node(TXNID txnid);
 
-    bool cycle_exists_from_node(node *target, node *head);
+    bool cycle_exists_from_node(node *target, node *head, txnid_set *cycle);
 
     static int find_by_txnid(node *const &node_a, const TXNID &txnid_b);
 };
@@ -195,6 +195,10 @@ void toku_set_func_pread (ssize_t (*pread_fun)(int, void *, size_t, off_t)) {
     t_pread = pread_fun;
 }
 
+bool toku_os_io_funcs_overridden(void) {
+    return t_pread != nullptr || t_pwrite != nullptr;
+}
+
 int toku_os_delete_with_source_location(const char *name,
                                         const char *src_file,
                                         uint src_line) {
@@ -755,6 +759,15 @@ void toku_file_fsync_without_accounting(int fd) {
     file_fsync_internal(fd);
 }
 
+void toku_os_readahead_hint(int fd, toku_off_t offset, toku_off_t len) {
+#if defined(POSIX_FADV_WILLNEED)
+    // errors are not interesting, the caller reads the range regardless
+    (void) posix_fadvise(fd, offset, len, POSIX_FADV_WILLNEED);
+#else
+    (void) fd; (void) offset; (void) len;
+#endif
+}
+
 void toku_fsync_dirfd_without_accounting(DIR *dir) {
     int fd = dirfd(dir);
     toku_file_fsync_without_accounting(fd);
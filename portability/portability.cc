@@ -72,6 +72,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 # include <sys/resource.h>
 #endif
 #include <sys/statvfs.h>
+#include <sched.h>
 #include "toku_portability.h"
 #include "toku_os.h"
 #include "toku_time.h"
@@ -140,6 +141,39 @@ toku_os_get_number_active_processors(void) {
     return n;
 }
 
+int
+toku_os_get_current_processor(void) {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+int
+toku_os_get_processor_numa_node(int processor) {
+    int node = -1;
+#if defined(__linux__)
+    // the cpu's sysfs directory links to the node it belongs to
+    char dirname[64];
+    snprintf(dirname, sizeof dirname, "/sys/devices/system/cpu/cpu%d", processor);
+    DIR *dir = opendir(dirname);
+    if (dir) {
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL) {
+            if (strncmp(ent->d_name, "node", 4) == 0 && ent->d_name[4] >= '0' && ent->d_name[4] <= '9') {
+                node = atoi(ent->d_name + 4);
+                break;
+            }
+        }
+        closedir(dir);
+    }
+#else
+    (void) processor;
+#endif
+    return node;
+}
+
 int toku_cached_pagesize = 0;
 
 int
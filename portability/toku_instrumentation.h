@@ -308,6 +308,8 @@ extern toku_instr_key *eviction_thread_key;
 extern toku_instr_key *kibbutz_thread_key;
 extern toku_instr_key *minicron_thread_key;
 extern toku_instr_key *tp_internal_thread_key;
+extern toku_instr_key *log_flusher_thread_key;
+extern toku_instr_key *manager_background_escalation_thread_key;
 
 // Files
 extern toku_instr_key *tokudb_file_data_key;
@@ -317,10 +319,11 @@ extern toku_instr_key *tokudb_file_log_key;
 
 // Mutexes
 extern toku_instr_key *kibbutz_mutex_key;
+extern toku_instr_key *kibbutz_queue_mutex_key;
+extern toku_instr_key *aio_mutex_key;
 extern toku_instr_key *minicron_p_mutex_key;
 extern toku_instr_key *queue_result_mutex_key;
 extern toku_instr_key *tpool_lock_mutex_key;
-extern toku_instr_key *workset_lock_mutex_key;
 extern toku_instr_key *bjm_jobs_lock_mutex_key;
 extern toku_instr_key *log_internal_lock_mutex_key;
 extern toku_instr_key *cachetable_ev_thread_lock_mutex_key;
@@ -341,6 +344,7 @@ extern toku_instr_key *txn_lock_mutex_key;
 extern toku_instr_key *txn_state_lock_mutex_key;
 extern toku_instr_key *txn_child_manager_mutex_key;
 extern toku_instr_key *txn_manager_lock_mutex_key;
+extern toku_instr_key *txn_manager_epoch_rwlock_key;
 extern toku_instr_key *treenode_mutex_key;
 extern toku_instr_key *manager_mutex_key;
 extern toku_instr_key *manager_escalation_mutex_key;
@@ -359,10 +363,11 @@ extern toku_instr_key *cachetable_m_flow_control_cond_key;
 extern toku_instr_key *cachetable_m_ev_thread_cond_key;
 extern toku_instr_key *bfs_cond_key;
 extern toku_instr_key *result_output_condition_key;
+extern toku_instr_key *log_flusher_condition_key;
 extern toku_instr_key *manager_m_escalator_done_key;
+extern toku_instr_key *manager_background_escalation_cond_key;
 extern toku_instr_key *lock_request_m_wait_cond_key;
 extern toku_instr_key *queue_result_cond_key;
-extern toku_instr_key *ws_worker_wait_key;
 extern toku_instr_key *rwlock_wait_read_key;
 extern toku_instr_key *rwlock_wait_write_key;
 extern toku_instr_key *rwlock_cond_key;
@@ -370,6 +375,8 @@ extern toku_instr_key *tp_thread_wait_key;
 extern toku_instr_key *tp_pool_wait_free_key;
 extern toku_instr_key *frwlock_m_wait_read_key;
 extern toku_instr_key *kibbutz_k_cond_key;
+extern toku_instr_key *kibbutz_parallel_for_cond_key;
+extern toku_instr_key *aio_cond_key;
 extern toku_instr_key *minicron_p_condvar_key;
 extern toku_instr_key *locktree_request_info_retry_cv_key;
 
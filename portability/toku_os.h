@@ -56,6 +56,12 @@ int toku_os_get_number_processors(void);
 // Returns: the number of active processors in the system
 int toku_os_get_number_active_processors(void);
 
+// Returns: the processor the calling thread is running on, or -1 if unknown
+int toku_os_get_current_processor(void);
+
+// Returns: the NUMA node that the given processor belongs to, or -1 if unknown
+int toku_os_get_processor_numa_node(int processor);
+
 // Returns: the system page size (in bytes)
 int toku_os_get_pagesize(void);
 
@@ -541,6 +541,11 @@ void toku_file_fsync(int fd);
 int toku_fsync_directory(const char *fname);
 void toku_file_fsync_without_accounting(int fd);
 
+// Hint that [offset, offset+len) of fd will be read soon, so the kernel can
+// start reading it into the page cache as one request.  Purely advisory, a
+// no-op where the platform has no such hint.
+void toku_os_readahead_hint(int fd, toku_off_t offset, toku_off_t len);
+
 // get the number of fsync calls and the fsync times (total)
 void toku_get_fsync_times(uint64_t *fsync_count,
                           uint64_t *fsync_time,
@@ -561,6 +566,10 @@ void toku_set_func_read(ssize_t (*)(int, void *, size_t));
 void toku_set_func_pread(ssize_t (*)(int, void *, size_t, off_t));
 void toku_set_func_fwrite(
     size_t (*fwrite_fun)(const void *, size_t, size_t, FILE *));
+// Returns true if pread or pwrite have been replaced by one of the above.
+// Asynchronous I/O paths fall back to toku_os_pread/toku_os_pwrite when this
+// is set so that the replacement still sees every call.
+bool toku_os_io_funcs_overridden(void);
 
 int toku_portability_init(void);
 void toku_portability_destroy(void);
@@ -0,0 +1,196 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// verify that recovery applying messages on several threads ends up with the
+// same dictionaries as a serial replay: interleave inserts and deletes into
+// several dictionaries across committed, aborted and live transactions, crash,
+// and recover with db_env_set_recovery_threads
+
+#include <sys/stat.h>
+#include "test.h"
+
+enum { NDBS = 8, NROWS = 2000 };
+static const int envflags = DB_INIT_LOCK|DB_INIT_LOG|DB_INIT_MPOOL|DB_INIT_TXN|DB_CREATE|DB_PRIVATE|DB_THREAD;
+
+static DB_ENV *env;
+static DB *dbs[NDBS];
+
+static void open_dbs(uint32_t flags) {
+    DB_TXN *txn;
+    int r = env->txn_begin(env, 0, &txn, 0); CKERR(r);
+    for (int i = 0; i < NDBS; i++) {
+        char name[32];
+        snprintf(name, sizeof name, "db%d", i);
+        r = db_create(&dbs[i], env, 0); CKERR(r);
+        r = dbs[i]->open(dbs[i], txn, name, 0, DB_BTREE, flags, S_IRWXU+S_IRWXG+S_IRWXO); CKERR(r);
+    }
+    r = txn->commit(txn, 0); CKERR(r);
+}
+
+static void put_row(DB_TXN *txn, int db, int k) {
+    int v = k * NDBS + db;
+    DBT key, val;
+    int r = dbs[db]->put(dbs[db], txn, dbt_init(&key, &k, sizeof k), dbt_init(&val, &v, sizeof v), 0);
+    CKERR(r);
+}
+
+static void del_row(DB_TXN *txn, int db, int k) {
+    DBT key;
+    int r = dbs[db]->del(dbs[db], txn, dbt_init(&key, &k, sizeof k), DB_DELETE_ANY);
+    CKERR(r);
+}
+
+// row k of db is expected to exist iff this says so
+static bool row_survives(int db, int k) {
+    if (k % 5 == 4) return false;         // inserted by the aborted or the live transaction
+    if ((k + db) % 7 == 0) return false;  // deleted by a committed transaction
+    return true;
+}
+
+static void run_test(void) {
+    int r;
+    toku_os_recursive_delete(TOKU_TEST_FILENAME);
+    r = toku_os_mkdir(TOKU_TEST_FILENAME, S_IRWXU+S_IRWXG+S_IRWXO); CKERR(r);
+    r = db_env_create(&env, 0); CKERR(r);
+    env->set_errfile(env, stderr);
+    r = env->open(env, TOKU_TEST_FILENAME, envflags, S_IRWXU+S_IRWXG+S_IRWXO); CKERR(r);
+    open_dbs(DB_CREATE);
+    r = env->txn_checkpoint(env, 0, 0, 0); CKERR(r);
+
+    DB_TXN *live;
+    r = env->txn_begin(env, 0, &live, 0); CKERR(r);
+    DB_TXN *txn = NULL;
+    for (int k = 0; k < NROWS; k++) {
+        if (k % 100 == 0) {
+            if (txn) { r = txn->commit(txn, 0); CKERR(r); }
+            r = env->txn_begin(env, 0, &txn, 0); CKERR(r);
+        }
+        for (int db = 0; db < NDBS; db++) {
+            if (k % 5 == 4) {
+                put_row(live, db, k);
+            } else {
+                put_row(txn, db, k);
+            }
+        }
+    }
+    r = txn->commit(txn, 0); CKERR(r);
+
+    // a checkpoint in the middle makes the forward scan cross a barrier or two
+    r = env->txn_checkpoint(env, 0, 0, 0); CKERR(r);
+
+    r = env->txn_begin(env, 0, &txn, 0); CKERR(r);
+    for (int k = 0; k < NROWS; k++) {
+        if (k % 5 == 4) continue;  // locked by the live transaction
+        for (int db = 0; db < NDBS; db++) {
+            if ((k + db) % 7 == 0) del_row(txn, db, k);
+        }
+    }
+    r = txn->commit(txn, 0); CKERR(r);
+
+    DB_TXN *aborted;
+    r = env->txn_begin(env, 0, &aborted, 0); CKERR(r);
+    for (int k = 0; k < NROWS; k += 3) {
+        for (int db = 0; db < NDBS; db++) {
+            if (row_survives(db, k)) del_row(aborted, db, k);
+        }
+    }
+    r = aborted->abort(aborted); CKERR(r);
+
+    // flush the log, then crash with the live transaction still open
+    r = env->log_flush(env, NULL); CKERR(r);
+    toku_hard_crash_on_purpose();
+}
+
+static void run_recover(void) {
+    int r;
+    db_env_set_recovery_threads(4);
+    r = db_env_create(&env, 0); CKERR(r);
+    env->set_errfile(env, stderr);
+    r = env->open(env, TOKU_TEST_FILENAME, envflags|DB_RECOVER, S_IRWXU+S_IRWXG+S_IRWXO); CKERR(r);
+    open_dbs(0);
+
+    DB_TXN *txn;
+    r = env->txn_begin(env, 0, &txn, 0); CKERR(r);
+    for (int db = 0; db < NDBS; db++) {
+        int n = 0;
+        for (int k = 0; k < NROWS; k++) {
+            DBT key, val;
+            dbt_init(&key, &k, sizeof k);
+            dbt_init_malloc(&val);
+            r = dbs[db]->get(dbs[db], txn, &key, &val, 0);
+            if (row_survives(db, k)) {
+                CKERR(r);
+                assert(val.size == sizeof(int) && *(int *) val.data == k * NDBS + db);
+                n++;
+            } else {
+                CKERR2(r, DB_NOTFOUND);
+            }
+            toku_free(val.data);
+        }
+        if (verbose) printf("db%d: %d rows\n", db, n);
+    }
+    r = txn->commit(txn, 0); CKERR(r);
+
+    for (int db = 0; db < NDBS; db++) {
+        r = dbs[db]->close(dbs[db], 0); CKERR(r);
+    }
+    r = env->close(env, 0); CKERR(r);
+}
+
+int test_main(int argc, char * const argv[]) {
+    bool do_test = false, do_recover = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose++;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            verbose = 0;
+        } else if (strcmp(argv[i], "--test") == 0) {
+            do_test = true;
+        } else if (strcmp(argv[i], "--recover") == 0) {
+            do_recover = true;
+        } else {
+            fprintf(stderr, "Usage: %s [-v|-q] --test | --recover\n", argv[0]);
+            return 1;
+        }
+    }
+    if (do_test) {
+        run_test();
+    } else if (do_recover) {
+        run_recover();
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+// Verify that the cleaner thread garbage collects leaves holding MVCC garbage
+// that no message touches again: it defers while a snapshot still references
+// the old versions, and reclaims them once the snapshot is gone.
+
+#include "test.h"
+
+static const int num_rows = 200;
+static const int num_rounds = 4;
+
+static void put_all_rows(DB_ENV *env, DB *db, int round) {
+    DB_TXN *txn;
+    int r = env->txn_begin(env, NULL, &txn, 0); CKERR(r);
+    for (int k = 0; k < num_rows; k++) {
+        int v = round * num_rows + k;
+        DBT key, val;
+        r = db->put(db, txn, dbt_init(&key, &k, sizeof k), dbt_init(&val, &v, sizeof v), 0); CKERR(r);
+    }
+    r = txn->commit(txn, 0); CKERR(r);
+}
+
+// The background gc rows are partitioned counters, so read them the way
+// get_engine_status_text() prints them.
+static uint64_t get_gc_status(DB_ENV *env, const char *legend) {
+    const int buf_size = 1 << 20;
+    char *XMALLOC_N(buf_size, buf);
+    int r = env->get_engine_status_text(env, buf, buf_size); CKERR(r);
+    char *row = strstr(buf, legend);
+    invariant_notnull(row);
+    uint64_t val = strtoull(row + strlen(legend), nullptr, 10);
+    toku_free(buf);
+    return val;
+}
+
+static uint64_t wait_for_gc_status(DB_ENV *env, const char *legend) {
+    uint64_t val = 0;
+    for (int i = 0; i < 100 && val == 0; i++) {
+        usleep(100 * 1000);
+        val = get_gc_status(env, legend);
+    }
+    return val;
+}
+
+static void test_background_gc(void) {
+    int r;
+
+    db_env_set_background_gc_threshold(num_rows);
+
+    DB_ENV *env;
+    r = db_env_create(&env, 0); CKERR(r);
+    r = env->set_cachesize(env, 1, 0, 1); CKERR(r);
+    r = env->open(env, TOKU_TEST_FILENAME, DB_CREATE+DB_PRIVATE+DB_INIT_MPOOL+DB_INIT_TXN+DB_INIT_LOG, 0); CKERR(r);
+    // only the cleaner thread may collect the leaf, and only when we say so
+    r = env->checkpointing_set_period(env, 0); CKERR(r);
+    r = env->cleaner_set_period(env, 0); CKERR(r);
+
+    DB *db;
+    r = db_create(&db, env, 0); CKERR(r);
+    r = db->open(db, NULL, "db", NULL, DB_BTREE, DB_CREATE, 0666); CKERR(r);
+
+    put_all_rows(env, db, 0);
+
+    // The snapshot keeps round 0 alive, so every later round adds a
+    // committed uxr to every row.
+    DB_TXN *snapshot_txn;
+    r = env->txn_begin(env, NULL, &snapshot_txn, DB_TXN_SNAPSHOT); CKERR(r);
+    for (int round = 1; round <= num_rounds; round++) {
+        put_all_rows(env, db, round);
+    }
+
+    r = env->cleaner_set_period(env, 1); CKERR(r);
+    invariant(wait_for_gc_status(env, "background gc: basements deferred (garbage still referenced): ") > 0);
+    invariant(get_gc_status(env, "background gc: bytes reclaimed: ") == 0);
+
+    // the snapshot still reads round 0
+    {
+        int k = 0, v;
+        DBT key, val;
+        dbt_init(&key, &k, sizeof k);
+        dbt_init(&val, &v, sizeof v);
+        val.flags = DB_DBT_USERMEM;
+        val.ulen = sizeof v;
+        r = db->get(db, snapshot_txn, &key, &val, 0); CKERR(r);
+        invariant(v == 0);
+    }
+    r = snapshot_txn->commit(snapshot_txn, 0); CKERR(r);
+
+    // begin and commit a txn so the oldest referenced xid moves past the
+    // snapshot
+    DB_TXN *txn;
+    r = env->txn_begin(env, NULL, &txn, 0); CKERR(r);
+    r = txn->commit(txn, 0); CKERR(r);
+
+    invariant(wait_for_gc_status(env, "background gc: bytes reclaimed: ") > 0);
+    invariant(get_gc_status(env, "background gc: leaves collected: ") > 0);
+
+    // collection must not change what anyone reads
+    r = env->txn_begin(env, NULL, &txn, DB_TXN_SNAPSHOT); CKERR(r);
+    for (int k = 0; k < num_rows; k++) {
+        int v;
+        DBT key, val;
+        dbt_init(&key, &k, sizeof k);
+        dbt_init(&val, &v, sizeof v);
+        val.flags = DB_DBT_USERMEM;
+        val.ulen = sizeof v;
+        r = db->get(db, txn, &key, &val, 0); CKERR(r);
+        invariant(v == num_rounds * num_rows + k);
+    }
+    r = txn->commit(txn, 0); CKERR(r);
+
+    r = db->close(db, 0); CKERR(r);
+    r = env->close(env, 0); CKERR(r);
+}
+
+int
+test_main(int argc, char *const argv[]) {
+    parse_args(argc, argv);
+
+    toku_os_recursive_delete(TOKU_TEST_FILENAME);
+    int r = toku_os_mkdir(TOKU_TEST_FILENAME, S_IRWXU+S_IRWXG+S_IRWXO); CKERR(r);
+
+    test_background_gc();
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+/*
+ * Test that dictionaries and log files written with the crc32c checksum can
+ * be read back, including by an env that writes x1764 for new files.
+ */
+
+#include <db.h>
+#include "test.h"
+
+static const int VAL_SIZE = 248;
+static const int NUM_ROWS = 1 << 12;
+
+static void
+insert(DB_ENV *env, DB *db, int base)
+{
+    int val[VAL_SIZE/sizeof(int)];
+    memset(val, 0, sizeof val);
+    DB_TXN *txn;
+    int r = env->txn_begin(env, 0, &txn, 0);
+    CKERR(r);
+    for (int i = base; i < base + NUM_ROWS; ++i) {
+        DBT k, v;
+        val[0] = i;
+        r = db->put(db, txn, dbt_init(&k, &i, sizeof i), dbt_init(&v, val, sizeof val), 0);
+        CKERR(r);
+    }
+    r = txn->commit(txn, 0);
+    CKERR(r);
+}
+
+static void
+lookup(DB_ENV *env, DB *db, int nrows)
+{
+    DB_TXN *txn;
+    int r = env->txn_begin(env, 0, &txn, 0);
+    CKERR(r);
+    for (int i = 0; i < nrows; ++i) {
+        DBT k, v;
+        r = db->get(db, txn, dbt_init(&k, &i, sizeof i), dbt_init(&v, NULL, 0), 0);
+        CKERR(r);
+        assert(v.size == (size_t) VAL_SIZE);
+        assert(*(int *) v.data == i);
+    }
+    r = txn->commit(txn, 0);
+    CKERR(r);
+}
+
+// Open the env with the given checksum method, insert NUM_ROWS more rows into
+// foo.db (created if needed), and verify all of the rows written so far.
+static void
+run_env(TOKU_CHECKSUM_METHOD method, int pass)
+{
+    DB_ENV *env;
+    DB *db;
+    int r;
+    r = db_env_create(&env, 0);
+    CKERR(r);
+    r = env->set_checksum_method(env, (TOKU_CHECKSUM_METHOD) 99);
+    CKERR2(r, EINVAL);
+    r = env->set_checksum_method(env, method);
+    CKERR(r);
+    r = env->open(env, TOKU_TEST_FILENAME, DB_INIT_LOCK|DB_INIT_LOG|DB_INIT_MPOOL|DB_INIT_TXN|DB_CREATE|DB_PRIVATE|DB_RECOVER, S_IRWXU+S_IRWXG+S_IRWXO);
+    CKERR(r);
+    r = env->set_checksum_method(env, method);
+    CKERR2(r, EINVAL);
+    {
+        TOKU_CHECKSUM_METHOD saved_method;
+        r = env->get_checksum_method(env, &saved_method);
+        CKERR(r);
+        assert(saved_method == method);
+    }
+
+    r = db_create(&db, env, 0);
+    CKERR(r);
+    r = db->open(db, NULL, "foo.db", 0, DB_BTREE, DB_CREATE|DB_AUTO_COMMIT, S_IRWXU+S_IRWXG+S_IRWXO);
+    CKERR(r);
+    insert(env, db, pass * NUM_ROWS);
+    lookup(env, db, (pass + 1) * NUM_ROWS);
+    r = env->txn_checkpoint(env, 0, 0, 0);
+    CKERR(r);
+    lookup(env, db, (pass + 1) * NUM_ROWS);
+
+    r = db->close(db, 0);
+    CKERR(r);
+    r = env->close(env, 0);
+    CKERR(r);
+}
+
+static void
+run_test(TOKU_CHECKSUM_METHOD first, TOKU_CHECKSUM_METHOD second)
+{
+    int r;
+    toku_os_recursive_delete(TOKU_TEST_FILENAME);
+    r = toku_os_mkdir(TOKU_TEST_FILENAME, S_IRWXU+S_IRWXG+S_IRWXO);
+    CKERR(r);
+
+    run_env(first, 0);
+    run_env(second, 1);
+    run_env(first, 2);
+}
+
+int
+test_main(int argc, char *const argv[])
+{
+    parse_args(argc, argv);
+    run_test(TOKU_CHECKSUM_CRC32C, TOKU_CHECKSUM_CRC32C);
+    run_test(TOKU_CHECKSUM_CRC32C, TOKU_CHECKSUM_X1764);
+    run_test(TOKU_CHECKSUM_X1764, TOKU_CHECKSUM_CRC32C);
+    return 0;
+}
@@ -0,0 +1,172 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+/*
+ * Test that hot optimize trains compression dictionaries for a dictionary
+ * compressed db, and that leaves written against the current and retired
+ * dictionaries can be read back, before and after reopening the env.
+ */
+
+#include <db.h>
+#include "test.h"
+
+static const int NUM_ROWS = 1 << 14;
+
+static void
+make_val(char *val, size_t len, int i)
+{
+    // rows that look alike, so that a dictionary has something to learn
+    snprintf(val, len, "{\"id\": %d, \"name\": \"customer-%08d\", \"status\": \"%s\", \"region\": \"region-%d\"}",
+             i, i * 7, (i % 3) ? "active" : "suspended", i % 11);
+}
+
+static void
+insert(DB_ENV *env, DB *db)
+{
+    DB_TXN *txn;
+    int r = env->txn_begin(env, 0, &txn, 0);
+    CKERR(r);
+    for (int i = 0; i < NUM_ROWS; ++i) {
+        char val[128];
+        make_val(val, sizeof val, i);
+        int k = toku_htonl(i);
+        DBT key, v;
+        r = db->put(db, txn, dbt_init(&key, &k, sizeof k), dbt_init(&v, val, strlen(val) + 1), 0);
+        CKERR(r);
+    }
+    r = txn->commit(txn, 0);
+    CKERR(r);
+}
+
+static void
+lookup(DB_ENV *env, DB *db)
+{
+    DB_TXN *txn;
+    int r = env->txn_begin(env, 0, &txn, 0);
+    CKERR(r);
+    for (int i = 0; i < NUM_ROWS; ++i) {
+        char val[128];
+        make_val(val, sizeof val, i);
+        int k = toku_htonl(i);
+        DBT key, v;
+        r = db->get(db, txn, dbt_init(&key, &k, sizeof k), dbt_init(&v, NULL, 0), 0);
+        CKERR(r);
+        assert(v.size == strlen(val) + 1);
+        assert(memcmp(v.data, val, v.size) == 0);
+    }
+    r = txn->commit(txn, 0);
+    CKERR(r);
+}
+
+static void
+open_env_and_db(DB_ENV **envp, DB **dbp, bool create)
+{
+    int r;
+    r = db_env_create(envp, 0);
+    CKERR(r);
+    // a small cachetable, so leaves get evicted and read back
+    r = (*envp)->set_cachesize(*envp, 0, 4 << 20, 1);
+    CKERR(r);
+    r = (*envp)->open(*envp, TOKU_TEST_FILENAME, DB_INIT_LOCK|DB_INIT_LOG|DB_INIT_MPOOL|DB_INIT_TXN|DB_CREATE|DB_PRIVATE, S_IRWXU+S_IRWXG+S_IRWXO);
+    CKERR(r);
+    r = db_create(dbp, *envp, 0);
+    CKERR(r);
+    if (create) {
+        r = (*dbp)->set_compression_method(*dbp, TOKU_ZSTD_DICTIONARY_METHOD);
+        CKERR(r);
+        r = (*dbp)->set_pagesize(*dbp, 64 << 10);
+        CKERR(r);
+        r = (*dbp)->set_readpagesize(*dbp, 4 << 10);
+        CKERR(r);
+    }
+    r = (*dbp)->open(*dbp, NULL, "foo.db", 0, DB_BTREE, DB_CREATE|DB_AUTO_COMMIT, S_IRWXU+S_IRWXG+S_IRWXO);
+    CKERR(r);
+    enum toku_compression_method method;
+    r = (*dbp)->get_compression_method(*dbp, &method);
+    CKERR(r);
+    assert(method == TOKU_ZSTD_DICTIONARY_METHOD);
+}
+
+static void
+close_env_and_db(DB_ENV *env, DB *db)
+{
+    int r;
+    r = db->close(db, 0);
+    CKERR(r);
+    r = env->close(env, 0);
+    CKERR(r);
+}
+
+int
+test_main(int argc, char *const argv[])
+{
+    parse_args(argc, argv);
+    int r;
+    toku_os_recursive_delete(TOKU_TEST_FILENAME);
+    r = toku_os_mkdir(TOKU_TEST_FILENAME, S_IRWXU+S_IRWXG+S_IRWXO);
+    CKERR(r);
+
+    DB_ENV *env;
+    DB *db;
+    open_env_and_db(&env, &db, true);
+    insert(env, db);
+    r = env->txn_checkpoint(env, 0, 0, 0);
+    CKERR(r);
+
+    // The first optimize trains a dictionary, the second retires it for
+    // a new one, and the third drops the retired one, because the second
+    // rewrote every leaf.  Checkpoint in between so that leaves compressed
+    // against each of them reach disk.
+    uint64_t trained = get_engine_status_val(env, "FT_HOT_NUM_DICTIONARIES_TRAINED");
+    for (int i = 0; i < 3; i++) {
+        uint64_t loops_run;
+        r = db->hot_optimize(db, NULL, NULL, NULL, NULL, &loops_run);
+        CKERR(r);
+        assert(get_engine_status_val(env, "FT_HOT_NUM_DICTIONARIES_TRAINED") == trained + i + 1);
+        lookup(env, db);
+        r = env->txn_checkpoint(env, 0, 0, 0);
+        CKERR(r);
+        lookup(env, db);
+    }
+    close_env_and_db(env, db);
+
+    open_env_and_db(&env, &db, false);
+    lookup(env, db);
+    close_env_and_db(env, db);
+    return 0;
+}
@@ -151,5 +151,6 @@ test_main(int argc, char *const argv[])
     run_test(TOKU_ZLIB_WITHOUT_CHECKSUM_METHOD);
     run_test(TOKU_QUICKLZ_METHOD);
     run_test(TOKU_LZMA_METHOD);
+    run_test(TOKU_ADAPTIVE_COMPRESSION_METHOD);
     return 0;
 }
@@ -49,89 +49,100 @@ DB_ENV *env;
 DB *db;
 
 #define NITER 100
+#define MAX_THREADS 256
+
+struct committer {
+    int which_thread;
+    int niter;
+    tokutime_t *latencies;  // how long each commit took
+};
 
 static void *
-start_a_thread (void *i_p) {
-    int *CAST_FROM_VOIDP(which_thread_p, i_p);
+start_a_thread (void *arg) {
+    struct committer *CAST_FROM_VOIDP(c, arg);
     int i,r;
-    for (i=0; i<NITER; i++) {
+    for (i=0; i<c->niter; i++) {
 	DB_TXN *tid;
 	char keystr[100];
 	DBT key,data;
-	snprintf(keystr, sizeof(key), "%ld.%d.%d", random(), *which_thread_p, i);
+	snprintf(keystr, sizeof(keystr), "%ld.%d.%d", random(), c->which_thread, i);
 	r=env->txn_begin(env, 0, &tid, 0); CKERR(r);
 	r=db->put(db, tid,
 		  dbt_init(&key, keystr, 1+strlen(keystr)),
 		  dbt_init(&data, keystr, 1+strlen(keystr)),
 		  0);
+	tokutime_t t0 = toku_time_now();
 	r=tid->commit(tid, 0); CKERR(r);
+	c->latencies[i] = toku_time_now() - t0;
     }
     return 0;
 }
 
+static int
+compare_tokutime (const void *a, const void *b) {
+    tokutime_t x = *(const tokutime_t *) a, y = *(const tokutime_t *) b;
+    return x < y ? -1 : x > y;
+}
+
+static double
+percentile_usec (tokutime_t *sorted, int n, int pct) {
+    int i = (n - 1) * pct / 100;
+    return tokutime_to_seconds(sorted[i]) * 1e6;
+}
+
 static void
-test_groupcommit (int nthreads) {
+test_groupcommit (int nthreads, uint32_t max_delay_usec, uint32_t min_batch) {
     int r;
     DB_TXN *tid;
 
     r=db_env_create(&env, 0); assert(r==0);
+    r=env->set_group_commit_policy(env, max_delay_usec, min_batch); CKERR(r);
     r=env->open(env, TOKU_TEST_FILENAME, DB_INIT_LOCK|DB_INIT_LOG|DB_INIT_MPOOL|DB_INIT_TXN|DB_CREATE|DB_PRIVATE|DB_THREAD, S_IRWXU+S_IRWXG+S_IRWXO); CKERR(r);
     r=db_create(&db, env, 0); CKERR(r);
     r=env->txn_begin(env, 0, &tid, 0); assert(r==0);
     r=db->open(db, tid, "foo.db", 0, DB_BTREE, DB_CREATE, S_IRWXU+S_IRWXG+S_IRWXO); CKERR(r);
     r=tid->commit(tid, 0);    assert(r==0);
 
+    // keep the total number of commits bounded as the thread count grows
+    int niter = NITER * 16 / nthreads;
+    if (niter > NITER) niter = NITER;
+    if (niter < 10) niter = 10;
+    int ncommits = nthreads * niter;
+    tokutime_t *XMALLOC_N(ncommits, latencies);
+
     int i;
     toku_pthread_t threads[nthreads];
-    int whichthread[nthreads];
+    struct committer committers[nthreads];
+    struct timeval start, end;
+    gettimeofday(&start, 0);
     for (i = 0; i < nthreads; i++) {
-        whichthread[i] = i;
+        committers[i] = (struct committer) { i, niter, &latencies[i * niter] };
         r = toku_pthread_create(toku_uninstrumented,
                                 &threads[i],
                                 nullptr,
                                 start_a_thread,
-                                &whichthread[i]);
+                                &committers[i]);
+        assert_zero(r);
     }
     for (i = 0; i < nthreads; i++) {
         toku_pthread_join(threads[i], 0);
     }
-#if 0
-    r=env->txn_begin(env, 0, &tid, 0); CKERR(r);
-    char there[1000];
-    memset(there, 'a',sizeof(there));
-    there[999]=0;
-    for (i=0; sum<(effective_max*3)/2; i++) {
-	DBT key,data;
-	char hello[20];
-	snprintf(hello, 20, "hello%d", i);
-	r=db->put(db, tid,
-		  dbt_init(&key, hello, strlen(hello)+1),
-		  dbt_init(&data, there, sizeof(there)),
-		  0);
-	assert(r==0);
-	sum+=strlen(hello)+1+sizeof(there);
-	if ((i+1)%10==0) {
-	    r=tid->commit(tid, 0); assert(r==0);
-	    r=env->txn_begin(env, 0, &tid, 0); CKERR(r);
-	}
+    gettimeofday(&end, 0);
+
+    qsort(latencies, ncommits, sizeof latencies[0], compare_tokutime);
+    if (verbose) {
+        double secs = toku_tdiff(&end, &start);
+        printf("%3d threads delay=%uus batch=%u: %8.1f commits/s, latency p50=%.0fus p95=%.0fus p99=%.0fus max=%.0fus\n",
+               nthreads, max_delay_usec, min_batch, ncommits / secs,
+               percentile_usec(latencies, ncommits, 50),
+               percentile_usec(latencies, ncommits, 95),
+               percentile_usec(latencies, ncommits, 99),
+               percentile_usec(latencies, ncommits, 100));
     }
-    if (verbose) printf("i=%d sum=%d effmax=%d\n", i, sum, effective_max);
-    r=tid->commit(tid, 0); assert(r==0);
-#endif
+    toku_free(latencies);
 
     r=db->close(db, 0); assert(r==0);
     r=env->close(env, 0); assert(r==0);
-
-}
-
-static struct timeval prevtime;
-
-static void
-printtdiff (const char *str) {
-    struct timeval thistime;
-    gettimeofday(&thistime, 0);
-    if (verbose) printf("%10.6f %s\n", toku_tdiff(&thistime, &prevtime), str);
-    prevtime = thistime;
 }
 
 int
@@ -142,10 +153,13 @@ test_main (int argc, char *const argv[]) {
     toku_os_recursive_delete(TOKU_TEST_FILENAME);
     { r=toku_os_mkdir(TOKU_TEST_FILENAME, S_IRWXU+S_IRWXG+S_IRWXO);       assert(r==0); }
 
-    gettimeofday(&prevtime, 0);
-    test_groupcommit(1);  printtdiff("1 thread");
-    test_groupcommit(2);  printtdiff("2 threads");
-    test_groupcommit(10); printtdiff("10 threads");
-    test_groupcommit(20); printtdiff("20 threads");
+    // fsync as soon as anyone commits
+    for (int nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2) {
+        test_groupcommit(nthreads, 0, 1);
+    }
+    // let the flusher wait up to half a millisecond for a batch of 8
+    for (int nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 4) {
+        test_groupcommit(nthreads, 500, 8);
+    }
     return 0;
 }
@@ -158,6 +158,7 @@ struct cli_args {
     bool disperse_keys; // spread the keys out during a load (by reversing the bits in the loop index) to make a wide tree we can spread out random inserts into
     bool memcmp_keys; // pack keys big endian and use the builtin key comparison function in the fractal tree
     bool direct_io; // use direct I/O
+    uint32_t readahead_window; // most leaves a cursor reads ahead of itself, 0 disables read-ahead
     const char *print_engine_status; // print engine status rows matching a simple regex "a|b|c", matching strings where a or b or c is a subtring.
 };
 
@@ -2268,6 +2269,7 @@ static struct cli_args UU() get_default_args(void) {
         .disperse_keys = false,
         .memcmp_keys = false,
         .direct_io = false,
+        .readahead_window = 8,
         };
     DEFAULT_ARGS.env_args.envdir = TOKU_TEST_FILENAME;
     return DEFAULT_ARGS;
@@ -2623,6 +2625,7 @@ static inline void parse_stress_test_args (int argc, char *const argv[], struct
 
         UINT32_ARG("--txn_size",                      txn_size,                      " rows"),
         UINT32_ARG("--num_bucket_mutexes",            env_args.num_bucket_mutexes,   " mutexes"),
+        UINT32_ARG("--readahead_window",              readahead_window,              " leaves"),
 
         INT32_ARG_R("--join_timeout",                 join_timeout,                  "s", 1, INT32_MAX),
         INT32_ARG_R("--performance_period",           performance_period,            "s", 1, INT32_MAX),
@@ -2868,6 +2871,7 @@ open_and_stress_tables(struct cli_args *args, bool fill_with_zeroes, int (*cmp)(
     memset(dbs, 0, sizeof(dbs));
     db_env_enable_engine_status(args->nocrashstatus ? false : true);
     db_env_set_direct_io(args->direct_io ? true : false);
+    db_env_set_cursor_readahead_window(args->readahead_window);
     if (!args->only_stress) {
         create_tables(
             &env,
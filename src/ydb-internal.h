@@ -101,6 +101,9 @@ struct __toku_db_env_internal {
     unsigned long client_pool_threads;
     unsigned long cachetable_pool_threads;
     unsigned long checkpoint_pool_threads;
+    uint32_t cachetable_numa_nodes;
+    bool cachetable_fake_numa_nodes;
+    enum toku_checksum_method checksum_method;          // for dictionaries created and log files opened by this env
     CACHETABLE cachetable;
     TOKULOGGER logger;
     toku::locktree_manager ltm;
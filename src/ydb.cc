@@ -1032,6 +1032,16 @@ env_open(DB_ENV * env, const char *home, uint32_t flags, int mode) {
         }
     }
 
+    if (env->i->cachetable_numa_nodes > 0) {
+        r = toku_cachetable_set_numa_nodes(env->i->cachetable,
+                                           env->i->cachetable_numa_nodes,
+                                           env->i->cachetable_fake_numa_nodes);
+        if (r != 0) {
+            r = toku_ydb_do_error(env, r, "Cant split the cachetable across numa nodes\n");
+            goto cleanup;
+        }
+    }
+
     toku_cachetable_set_env_dir(env->i->cachetable, env->i->dir);
 
     int using_txns;
@@ -1341,6 +1351,54 @@ env_set_checkpoint_pool_threads(DB_ENV * env, uint32_t threads) {
     return 0;
 }
 
+static int 
+env_set_cachetable_numa_nodes(DB_ENV * env, uint32_t num_nodes, bool fake_nodes) {
+    HANDLE_PANICKED_ENV(env);
+    if (env_opened(env)) {
+        return EINVAL;
+    }
+    env->i->cachetable_numa_nodes = num_nodes;
+    env->i->cachetable_fake_numa_nodes = fake_nodes;
+    return 0;
+}
+
+static int
+env_set_checksum_method(DB_ENV * env, TOKU_CHECKSUM_METHOD method) {
+    HANDLE_PANICKED_ENV(env);
+    if (env_opened(env)) {
+        return toku_ydb_do_error(env, EINVAL, "Cannot set checksum method after opening the env\n");
+    }
+    if (!toku_checksum_method_is_valid(method)) {
+        return EINVAL;
+    }
+    int r = toku_logger_set_checksum_method(env->i->logger, method);
+    if (r == 0) {
+        env->i->checksum_method = method;
+    }
+    return r;
+}
+
+static int
+env_get_checksum_method(DB_ENV * env, TOKU_CHECKSUM_METHOD *method) {
+    HANDLE_PANICKED_ENV(env);
+    *method = env->i->checksum_method;
+    return 0;
+}
+
+static int
+env_set_group_commit_policy(DB_ENV * env, uint32_t max_delay_usec, uint32_t min_batch) {
+    HANDLE_PANICKED_ENV(env);
+    toku_logger_set_group_commit_policy(env->i->logger, max_delay_usec, min_batch);
+    return 0;
+}
+
+static int
+env_get_group_commit_policy(DB_ENV * env, uint32_t *max_delay_usec, uint32_t *min_batch) {
+    HANDLE_PANICKED_ENV(env);
+    toku_logger_get_group_commit_policy(env->i->logger, max_delay_usec, min_batch);
+    return 0;
+}
+
 static void
 env_set_check_thp(DB_ENV * env, bool new_val) {
     assert(env);
@@ -1714,6 +1772,50 @@ env_get_lk_max_memory(DB_ENV *env, uint64_t *lk_maxp) {
     return 0;
 }
 
+// Locktrees for dictionaries opened from now on are range partitioned
+// into up to num_partitions concurrent trees.
+static int
+env_set_lock_partitions(DB_ENV *env, uint32_t num_partitions) {
+    HANDLE_PANICKED_ENV(env);
+    return env->i->ltm.set_lock_partitions(num_partitions);
+}
+
+static int
+env_get_lock_partitions(DB_ENV *env, uint32_t *num_partitions) {
+    HANDLE_PANICKED_ENV(env);
+    *num_partitions = env->i->ltm.get_lock_partitions();
+    return 0;
+}
+
+static int
+env_set_lock_deadlock_victim(DB_ENV *env, TOKU_DEADLOCK_VICTIM victim) {
+    HANDLE_PANICKED_ENV(env);
+    return env->i->ltm.set_deadlock_victim(victim);
+}
+
+static int
+env_get_lock_deadlock_victim(DB_ENV *env, TOKU_DEADLOCK_VICTIM *victim) {
+    HANDLE_PANICKED_ENV(env);
+    *victim = env->i->ltm.get_deadlock_victim();
+    return 0;
+}
+
+// Once lock memory reaches percent of the max, a background thread
+// escalates the biggest txns' locks. 100 leaves escalation to the clients
+// that run out of lock memory.
+static int
+env_set_lock_escalation_soft_limit(DB_ENV *env, uint32_t percent) {
+    HANDLE_PANICKED_ENV(env);
+    return env->i->ltm.set_escalation_soft_limit(percent);
+}
+
+static int
+env_get_lock_escalation_soft_limit(DB_ENV *env, uint32_t *percent) {
+    HANDLE_PANICKED_ENV(env);
+    *percent = env->i->ltm.get_escalation_soft_limit();
+    return 0;
+}
+
 //void toku__env_set_noticecall (DB_ENV *env, void (*noticecall)(DB_ENV *, db_notices)) {
 //    env->i->noticecall = noticecall;
 //}
@@ -1906,6 +2008,44 @@ env_evictor_get_enable_partial_eviction(DB_ENV* env, bool *enabled) {
     return r;
 }
 
+static int
+env_evictor_set_eviction_policy(DB_ENV* env, TOKU_EVICTION_POLICY policy) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else {
+        switch (policy) {
+        case TOKU_EVICTION_POLICY_CLOCK:
+            toku_set_eviction_policy(env->i->cachetable, CACHETABLE_EVICTION_POLICY_CLOCK);
+            break;
+        case TOKU_EVICTION_POLICY_2Q:
+            toku_set_eviction_policy(env->i->cachetable, CACHETABLE_EVICTION_POLICY_2Q);
+            break;
+        default:
+            r = EINVAL;
+        }
+    }
+    return r;
+}
+
+static int
+env_evictor_get_eviction_policy(DB_ENV* env, TOKU_EVICTION_POLICY *policy) {
+    HANDLE_PANICKED_ENV(env);
+    int r = 0;
+    if (!env_opened(env)) r = EINVAL;
+    else {
+        switch (toku_get_eviction_policy(env->i->cachetable)) {
+        case CACHETABLE_EVICTION_POLICY_CLOCK:
+            *policy = TOKU_EVICTION_POLICY_CLOCK;
+            break;
+        case CACHETABLE_EVICTION_POLICY_2Q:
+            *policy = TOKU_EVICTION_POLICY_2Q;
+            break;
+        }
+    }
+    return r;
+}
+
 static int
 env_checkpointing_postpone(DB_ENV * env) {
     HANDLE_PANICKED_ENV(env);
@@ -2887,6 +3027,12 @@ toku_env_create(DB_ENV ** envp, uint32_t flags) {
     USENV(get_lg_max);
     USENV(set_lk_max_memory);
     USENV(get_lk_max_memory);
+    USENV(set_lock_partitions);
+    USENV(get_lock_partitions);
+    USENV(set_lock_deadlock_victim);
+    USENV(get_lock_deadlock_victim);
+    USENV(set_lock_escalation_soft_limit);
+    USENV(get_lock_escalation_soft_limit);
     USENV(get_iname);
     USENV(set_errcall);
     USENV(set_errfile);
@@ -2900,10 +3046,17 @@ toku_env_create(DB_ENV ** envp, uint32_t flags) {
     USENV(cleaner_get_iterations);
     USENV(evictor_set_enable_partial_eviction);
     USENV(evictor_get_enable_partial_eviction);
+    USENV(evictor_set_eviction_policy);
+    USENV(evictor_get_eviction_policy);
     USENV(set_cachesize);
     USENV(set_client_pool_threads);
     USENV(set_cachetable_pool_threads);
     USENV(set_checkpoint_pool_threads);
+    USENV(set_cachetable_numa_nodes);
+    USENV(set_checksum_method);
+    USENV(get_checksum_method);
+    USENV(set_group_commit_policy);
+    USENV(get_group_commit_policy);
 #if DB_VERSION_MAJOR == 4 && DB_VERSION_MINOR >= 3
     USENV(get_cachesize);
 #endif
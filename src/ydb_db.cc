@@ -1116,6 +1116,7 @@ toku_db_create(DB ** db, DB_ENV * env, uint32_t flags) {
 
     FT_HANDLE ft_handle;
     toku_ft_handle_create(&ft_handle);
+    toku_ft_handle_set_checksum_method(ft_handle, env->i->checksum_method);
 
     int r = toku_setup_db_internal(db, env, flags, ft_handle, false);
     if (r != 0) return r;
@@ -47,6 +47,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include <ft/ft-flusher.h>
 #include <ft/logger/recover.h>
 #include <ft/loader/loader.h>
+#include <ft/serialize/compress.h>
 
 #include "ydb_env_func.h"
 
@@ -68,6 +69,22 @@ void db_env_set_compress_buffers_before_eviction (bool compress_buffers) {
     toku_ft_set_compress_buffers_before_eviction(compress_buffers);
 }
 
+void db_env_set_cursor_readahead_window (uint32_t num_leaves) {
+    toku_ft_set_cursor_readahead_window(num_leaves);
+}
+
+void db_env_set_background_gc_threshold (uint32_t num_uxrs) {
+    toku_ft_set_background_gc_threshold(num_uxrs);
+}
+
+void db_env_set_adaptive_compression_min_throughput (uint64_t mb_per_sec) {
+    toku_compress_set_adaptive_min_throughput(mb_per_sec);
+}
+
+void db_env_set_recovery_threads (uint32_t num_threads) {
+    toku_recover_set_num_threads(num_threads);
+}
+
 void db_env_set_func_fsync (int (*fsync_function)(int)) {
     toku_set_func_fsync(fsync_function);
 }
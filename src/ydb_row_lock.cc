@@ -279,15 +279,21 @@ void toku_db_release_lt_key_ranges(DB_TXN *txn, txn_lt_key_ranges *ranges) {
 
     // release all of the locks this txn has ever successfully
     // acquired and stored in the range buffer for this locktree
-    lt->release_locks(txnid, ranges->buffer);
+    bool released_within_ranges = lt->release_locks(txnid, ranges->buffer);
     lt->get_manager()->note_mem_released(ranges->buffer->total_memory_size());
+
+    // all of our locks have been released, so first try to wake up the
+    // pending lock requests they may have blocked, then release our
+    // reference on the lt. if a lock we held was escalated or consolidated
+    // past our ranges we cannot tell who it blocked, so retry everyone.
+    if (released_within_ranges) {
+        toku::lock_request::retry_lock_requests(lt, ranges->buffer);
+    } else {
+        toku::lock_request::retry_all_lock_requests(lt);
+    }
     ranges->buffer->destroy();
     toku_free(ranges->buffer);
 
-    // all of our locks have been released, so first try to wake up
-    // pending lock requests, then release our reference on the lt
-    toku::lock_request::retry_all_lock_requests(lt);
-
     // Release our reference on this locktree
     toku::locktree_manager *ltm = &txn->mgrp->i->ltm;
     ltm->release_lt(lt);
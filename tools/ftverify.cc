@@ -53,7 +53,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "ft/node.h"
 #include "ft/serialize/rbuf.h"
 #include "ft/serialize/sub_block.h"
-#include "util/threadpool.h"
+#include "util/kibbutz.h"
 
 #include <fcntl.h>
 #include <math.h>
@@ -65,7 +65,7 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include <unistd.h>
 
 static int num_cores = 0; // cache the number of cores for the parallelization
-static struct toku_thread_pool *ft_pool = NULL;
+static KIBBUTZ ft_pool = NULL;
 static FILE *outf;
 static double pct = 0.5;
 
@@ -287,7 +287,7 @@ check_block(BLOCKNUM blocknum, int64_t UU(blocksize), int64_t UU(address), void
     FTNODE_DISK_DATA ndd;
     allocate_and_read_partition_offsets(node, &rb, &ndd);
 
-    r = check_node_info_checksum(&rb);
+    r = check_node_info_checksum(&rb, ft->h->checksum_method);
     if (r == TOKUDB_BAD_CHECKSUM) {
        	printf(" Node info checksum failed.\n");
         failure++;
@@ -296,13 +296,13 @@ check_block(BLOCKNUM blocknum, int64_t UU(blocksize), int64_t UU(address), void
     // Get the partition info sub block.
     struct sub_block sb;
     sub_block_init(&sb);
-    r = read_compressed_sub_block(&rb, &sb);
+    r = read_compressed_sub_block(&rb, &sb, ft->h->checksum_method);
     if (r != 0) {
        	printf(" Partition info checksum failed.\n");
         failure++;
     }
 
-    just_decompress_sub_block(&sb);
+    just_decompress_sub_block(&sb, ft);
 
     // If we want to inspect the data inside the partitions, we need
     // to call setup_ftnode_partitions(node, bfe, true)
@@ -318,14 +318,14 @@ check_block(BLOCKNUM blocknum, int64_t UU(blocksize), int64_t UU(address), void
         struct sub_block curr_sb;
         sub_block_init(&curr_sb);
 
-        r = read_compressed_sub_block(&rb, &sb);
+        r = read_compressed_sub_block(&rb, &sb, ft->h->checksum_method);
         if (r != 0) {
             printf(" Compressed child partition %d checksum failed.\n", i);
             failure++;
         }
-        just_decompress_sub_block(&sb);
+        just_decompress_sub_block(&sb, ft);
 	
-        r = verify_ftnode_sub_block(&sb, nullptr, blocknum);
+        r = verify_ftnode_sub_block(&sb, nullptr, blocknum, ft->h->checksum_method);
         if (r != 0) {
             printf(" Uncompressed child partition %d checksum failed.\n", i);
             failure++;
@@ -426,7 +426,7 @@ main(int argc, char const * const argv[])
 
     // body of toku_ft_serialize_init();
     num_cores = toku_os_get_number_active_processors();
-    r = toku_thread_pool_create(&ft_pool, num_cores); lazy_assert_zero(r);
+    r = toku_kibbutz_create(num_cores, &ft_pool, KIBBUTZ_WORK_STEALING); lazy_assert_zero(r);
     assert_zero(r);
 
     // deserialize the header(s)
@@ -446,7 +446,7 @@ main(int argc, char const * const argv[])
         printf("Both headers have a corruption and could not be used.\n");
     }
 
-    toku_thread_pool_destroy(&ft_pool);
+    toku_kibbutz_destroy(ft_pool);
 exit:
     return r;
 }
@@ -59,9 +59,10 @@ int main (int argc, const char *const argv[]) {
     }
     int i;
     uint32_t version;
-    r = toku_read_and_print_logmagic(stdin, &version);
+    enum toku_checksum_method checksum_method;
+    r = toku_read_and_print_logmagic(stdin, &version, &checksum_method);
     for (i=0; i!=count; i++) {
-        r = toku_logprint_one_record(stdout, stdin);
+        r = toku_logprint_one_record(stdout, stdin, checksum_method);
         if (r==EOF) break;
         if (r!=0) {
             fflush(stdout);
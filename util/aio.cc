@@ -0,0 +1,447 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include <errno.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <portability/toku_config.h>
+#include <portability/toku_atomic.h>
+#include <portability/memory.h>
+#include <portability/toku_os.h>
+#include <toku_pthread.h>
+
+#if defined(HAVE_LINUX_IO_URING_H)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "aio.h"
+#include "kibbutz.h"
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TOKU_AIO_IO_URING 1
+#endif
+
+toku_instr_key *aio_mutex_key;
+toku_instr_key *aio_cond_key;
+
+#if defined(TOKU_AIO_IO_URING)
+// The rings shared with the kernel.  We talk to io_uring through the raw
+// system calls so we do not depend on liburing.
+struct aio_uring {
+    int fd;
+    void *sq_ptr;
+    size_t sq_ring_size;
+    void *cq_ptr;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned sq_entries;
+
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+};
+#endif
+
+struct toku_aio {
+    // protects n_in_flight, reaping and every batch's n_pending
+    toku_mutex_t mutex;
+    toku_cond_t cond;
+    uint32_t queue_depth;
+    uint32_t n_in_flight;
+    // true while some waiter is reaping completions from the ring,
+    // other waiters sleep on cond until it is done
+    bool reaping;
+    bool use_io_uring;
+#if defined(TOKU_AIO_IO_URING)
+    struct aio_uring ring;
+#endif
+    KIBBUTZ workers;
+};
+
+static void aio_do_sync(struct toku_aio_request *req) {
+    if (req->is_write) {
+        ssize_t r = toku_os_pwrite(req->fd, req->buf, req->len, req->offset);
+        req->result = (r == 0) ? (ssize_t) req->len : -r;
+    } else {
+        ssize_t r = toku_os_pread(req->fd, req->buf, req->len, req->offset);
+        req->result = (r < 0) ? -get_error_errno() : r;
+    }
+}
+
+// requires: aio->mutex held
+static void aio_complete_locked(struct toku_aio_request *req) {
+    invariant(req->batch->n_pending > 0);
+    req->batch->n_pending--;
+}
+
+//
+// thread pool backend
+//
+
+static void aio_work(void *extra) {
+    struct toku_aio_request *req = (struct toku_aio_request *) extra;
+    TOKU_AIO aio = req->aio;
+    aio_do_sync(req);
+    toku_mutex_lock(&aio->mutex);
+    aio_complete_locked(req);
+    toku_cond_broadcast(&aio->cond);
+    toku_mutex_unlock(&aio->mutex);
+}
+
+//
+// io_uring backend
+//
+
+#if defined(TOKU_AIO_IO_URING)
+static int aio_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int aio_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+static int aio_uring_init(struct aio_uring *ring, uint32_t entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof p);
+    memset(ring, 0, sizeof *ring);
+    ring->fd = aio_uring_setup(entries, &p);
+    if (ring->fd < 0) {
+        return get_error_errno();
+    }
+    ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        ring->sq_ring_size = ring->cq_ring_size = std::max(ring->sq_ring_size, ring->cq_ring_size);
+    }
+
+    int r = 0;
+    ring->sq_ptr = mmap(nullptr, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        r = get_error_errno();
+        ring->sq_ptr = nullptr;
+        goto cleanup;
+    }
+    if (single_mmap) {
+        ring->cq_ptr = ring->sq_ptr;
+    } else {
+        ring->cq_ptr = mmap(nullptr, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) {
+            r = get_error_errno();
+            ring->cq_ptr = nullptr;
+            goto cleanup;
+        }
+    }
+    ring->sqes = (struct io_uring_sqe *) mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        r = get_error_errno();
+        ring->sqes = nullptr;
+        goto cleanup;
+    }
+
+    ring->sq_head = (unsigned *) ((char *) ring->sq_ptr + p.sq_off.head);
+    ring->sq_tail = (unsigned *) ((char *) ring->sq_ptr + p.sq_off.tail);
+    ring->sq_mask = (unsigned *) ((char *) ring->sq_ptr + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned *) ((char *) ring->sq_ptr + p.sq_off.array);
+    ring->sq_entries = p.sq_entries;
+    ring->cq_head = (unsigned *) ((char *) ring->cq_ptr + p.cq_off.head);
+    ring->cq_tail = (unsigned *) ((char *) ring->cq_ptr + p.cq_off.tail);
+    ring->cq_mask = (unsigned *) ((char *) ring->cq_ptr + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) ((char *) ring->cq_ptr + p.cq_off.cqes);
+
+cleanup:
+    if (r != 0) {
+        if (ring->sqes) {
+            munmap(ring->sqes, ring->sqes_size);
+        }
+        if (ring->cq_ptr && ring->cq_ptr != ring->sq_ptr) {
+            munmap(ring->cq_ptr, ring->cq_ring_size);
+        }
+        if (ring->sq_ptr) {
+            munmap(ring->sq_ptr, ring->sq_ring_size);
+        }
+        close(ring->fd);
+    }
+    return r;
+}
+
+static void aio_uring_destroy(struct aio_uring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ptr != ring->sq_ptr) {
+        munmap(ring->cq_ptr, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ptr, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+// Queue one request on the submission ring.
+// requires: aio->mutex held, and a free slot in the ring
+static void aio_uring_queue(struct aio_uring *ring, struct toku_aio_request *req) {
+    unsigned tail = *ring->sq_tail;
+    unsigned idx = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[idx];
+    memset(sqe, 0, sizeof *sqe);
+    sqe->opcode = req->is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = req->fd;
+    sqe->addr = (uint64_t) (uintptr_t) &req->iov;
+    sqe->len = 1;
+    sqe->off = req->offset;
+    sqe->user_data = (uint64_t) (uintptr_t) req;
+    ring->sq_array[idx] = idx;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// Hand everything queued on the submission ring to the kernel.
+// requires: aio->mutex held
+static void aio_uring_submit(struct aio_uring *ring, unsigned to_submit) {
+    while (to_submit > 0) {
+        int r = aio_uring_enter(ring->fd, to_submit, 0, 0);
+        if (r < 0) {
+            int e = get_error_errno();
+            // The completion ring is twice the size of the submission ring
+            // and we never have more than sq_entries requests in flight, so
+            // the only transient failures are signals and memory pressure.
+            resource_assert(e == EINTR || e == EAGAIN);
+            continue;
+        }
+        to_submit -= r;
+    }
+}
+
+// Requests that io_uring could not finish in one go are finished
+// synchronously, so callers see the same results as from pread/pwrite.
+static void aio_uring_fixup(struct toku_aio_request *req, int res) {
+    if (res == -EAGAIN || res == -EINTR) {
+        aio_do_sync(req);
+    } else if (res > 0 && (size_t) res < req->len && req->is_write) {
+        // short write, toku_os_pwrite loops until it is all out
+        aio_do_sync(req);
+    } else if (res > 0 && (size_t) res < req->len) {
+        // short read, keep reading until we hit end of file
+        ssize_t done = res;
+        while ((size_t) done < req->len) {
+            ssize_t r = pread(req->fd, (char *) req->buf + done, req->len - done, req->offset + done);
+            if (r < 0 && get_error_errno() == EINTR) {
+                continue;
+            }
+            if (r <= 0) {
+                break;
+            }
+            done += r;
+        }
+        req->result = done;
+    } else {
+        req->result = res;
+    }
+}
+
+// Block until at least one completion is posted, then retire every posted
+// completion.  Only one thread reaps at a time.
+// requires: aio->mutex not held, aio->reaping set by the caller
+static void aio_uring_reap(TOKU_AIO aio) {
+    struct aio_uring *ring = &aio->ring;
+    const uint32_t max_reaped = 64;
+    struct toku_aio_request *reaped[max_reaped];
+    uint32_t n_reaped = 0;
+
+    unsigned head = *ring->cq_head;
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+        int r = aio_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS);
+        if (r < 0) {
+            resource_assert(get_error_errno() == EINTR);
+        }
+    }
+    while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE) && n_reaped < max_reaped) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        struct toku_aio_request *req = (struct toku_aio_request *) (uintptr_t) cqe->user_data;
+        int res = cqe->res;
+        head++;
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+        aio_uring_fixup(req, res);
+        reaped[n_reaped++] = req;
+    }
+
+    toku_mutex_lock(&aio->mutex);
+    for (uint32_t i = 0; i < n_reaped; i++) {
+        aio_complete_locked(reaped[i]);
+    }
+    aio->n_in_flight -= n_reaped;
+    toku_mutex_unlock(&aio->mutex);
+}
+#endif
+
+int toku_aio_create(TOKU_AIO *aiop, uint32_t queue_depth, bool use_io_uring) {
+    int r = 0;
+    *aiop = nullptr;
+    TOKU_AIO XCALLOC(aio);
+    toku_mutex_init(*aio_mutex_key, &aio->mutex, nullptr);
+    toku_cond_init(*aio_cond_key, &aio->cond, nullptr);
+    aio->queue_depth = queue_depth > 0 ? queue_depth : 1;
+    aio->n_in_flight = 0;
+    aio->reaping = false;
+    aio->use_io_uring = false;
+#if defined(TOKU_AIO_IO_URING)
+    if (use_io_uring && aio_uring_init(&aio->ring, aio->queue_depth) == 0) {
+        aio->use_io_uring = true;
+        aio->queue_depth = aio->ring.sq_entries;
+    }
+#else
+    (void) use_io_uring;
+#endif
+    if (!aio->use_io_uring) {
+        // the workers mostly wait on the device, so like the cachetable's
+        // own pool, run more of them than there are processors
+        int n_workers = std::min((int) aio->queue_depth, 2 * toku_os_get_number_active_processors());
+        r = toku_kibbutz_create(n_workers, &aio->workers);
+        if (r != 0) {
+            toku_cond_destroy(&aio->cond);
+            toku_mutex_destroy(&aio->mutex);
+            toku_free(aio);
+            return r;
+        }
+    }
+    *aiop = aio;
+    return r;
+}
+
+void toku_aio_batch_init(struct toku_aio_batch *batch) {
+    batch->n_pending = 0;
+}
+
+void toku_aio_submit(TOKU_AIO aio, struct toku_aio_batch *batch, struct toku_aio_request *reqs, uint32_t n) {
+    const bool overridden = toku_os_io_funcs_overridden();
+    for (uint32_t i = 0; i < n; i++) {
+        struct toku_aio_request *req = &reqs[i];
+        req->result = 0;
+        req->iov.iov_base = req->buf;
+        req->iov.iov_len = req->len;
+        req->batch = batch;
+        req->aio = aio;
+    }
+    if (!aio->use_io_uring) {
+        toku_mutex_lock(&aio->mutex);
+        batch->n_pending += n;
+        toku_mutex_unlock(&aio->mutex);
+        for (uint32_t i = 0; i < n; i++) {
+            toku_kibbutz_enq(aio->workers, aio_work, &reqs[i]);
+        }
+        return;
+    }
+#if defined(TOKU_AIO_IO_URING)
+    uint32_t i = 0;
+    while (i < n) {
+        if (overridden) {
+            // a test replaced pread/pwrite, make sure it sees this request
+            aio_do_sync(&reqs[i++]);
+            continue;
+        }
+        toku_mutex_lock(&aio->mutex);
+        unsigned queued = 0;
+        while (i < n && aio->n_in_flight < aio->queue_depth) {
+            aio_uring_queue(&aio->ring, &reqs[i++]);
+            aio->n_in_flight++;
+            queued++;
+        }
+        batch->n_pending += queued;
+        if (queued > 0) {
+            aio_uring_submit(&aio->ring, queued);
+        }
+        toku_mutex_unlock(&aio->mutex);
+        if (queued == 0) {
+            // the ring is full, rather than wait for room do this one ourselves
+            aio_do_sync(&reqs[i++]);
+        }
+    }
+#else
+    (void) overridden;
+#endif
+}
+
+void toku_aio_wait(TOKU_AIO aio, struct toku_aio_batch *batch) {
+    toku_mutex_lock(&aio->mutex);
+    while (batch->n_pending > 0) {
+#if defined(TOKU_AIO_IO_URING)
+        if (aio->use_io_uring && !aio->reaping) {
+            aio->reaping = true;
+            toku_mutex_unlock(&aio->mutex);
+            aio_uring_reap(aio);
+            toku_mutex_lock(&aio->mutex);
+            aio->reaping = false;
+            toku_cond_broadcast(&aio->cond);
+            continue;
+        }
+#endif
+        toku_cond_wait(&aio->cond, &aio->mutex);
+    }
+    toku_mutex_unlock(&aio->mutex);
+}
+
+const char *toku_aio_backend_name(TOKU_AIO aio) {
+    return aio->use_io_uring ? "io_uring" : "threadpool";
+}
+
+void toku_aio_destroy(TOKU_AIO aio) {
+    invariant(aio->n_in_flight == 0);
+    if (aio->use_io_uring) {
+#if defined(TOKU_AIO_IO_URING)
+        aio_uring_destroy(&aio->ring);
+#endif
+    } else {
+        toku_kibbutz_destroy(aio->workers);
+    }
+    toku_cond_destroy(&aio->cond);
+    toku_mutex_destroy(&aio->mutex);
+    toku_free(aio);
+}
@@ -0,0 +1,113 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#pragma once
+
+#include <portability/toku_portability.h>
+
+#include <sys/uio.h>
+
+//
+// An asynchronous I/O engine.  Callers fill in an array of requests, submit
+// them together as one batch and later wait for the whole batch to complete.
+// Submission never blocks on the device, so a single thread can keep many
+// reads or writes in flight.
+//
+// On Linux the requests go through io_uring.  Where io_uring is not
+// available (old kernels, seccomp, or other platforms) a small pool of
+// threads issues ordinary pread/pwrite calls on the caller's behalf.
+//
+// Buffers, lengths and offsets must satisfy the same alignment rules as
+// toku_os_pread and toku_os_pwrite, since files may be opened with O_DIRECT.
+//
+
+typedef struct toku_aio *TOKU_AIO;
+
+struct toku_aio_batch;
+
+struct toku_aio_request {
+    int fd;
+    void *buf;
+    size_t len;
+    toku_off_t offset;
+    bool is_write;
+    // Set when the request completes.  For reads, the number of bytes read
+    // (as pread would return), for writes the number of bytes written.
+    // Negative errno values report a failure.
+    ssize_t result;
+
+    // private to the aio engine
+    struct iovec iov;
+    struct toku_aio_batch *batch;
+    TOKU_AIO aio;
+};
+
+struct toku_aio_batch {
+    // number of submitted requests that have not completed yet,
+    // protected by the engine's mutex
+    uint32_t n_pending;
+};
+
+//
+// create an aio engine that keeps at most queue_depth requests in flight.
+// if use_io_uring is false, or io_uring cannot be set up, requests are
+// serviced by a thread pool instead.
+//
+int toku_aio_create(TOKU_AIO *aiop, uint32_t queue_depth, bool use_io_uring);
+//
+// initialize an empty batch
+//
+void toku_aio_batch_init(struct toku_aio_batch *batch);
+//
+// submit n requests as part of batch.  Returns without waiting for
+// the requests to complete.  The requests and their buffers must stay
+// valid until toku_aio_wait returns for the batch.
+//
+void toku_aio_submit(TOKU_AIO aio, struct toku_aio_batch *batch, struct toku_aio_request *reqs, uint32_t n);
+//
+// block until every request submitted as part of batch has completed
+//
+void toku_aio_wait(TOKU_AIO aio, struct toku_aio_batch *batch);
+//
+// name of the backend in use, "io_uring" or "threadpool"
+//
+const char *toku_aio_backend_name(TOKU_AIO aio);
+//
+// destroys the aio engine.  There must be no outstanding batches.
+//
+void toku_aio_destroy(TOKU_AIO aio);
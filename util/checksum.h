@@ -0,0 +1,89 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#pragma once
+
+#include <db.h>
+
+#include "util/crc32c.h"
+#include "util/x1764.h"
+
+// The checksum protecting ftnode blocks and log entries is selectable (see
+// TOKU_CHECKSUM_METHOD in db.h).  The method is recorded on disk, in the ft
+// header for dictionaries and in the magic of each log file, so data always
+// verifies with the function that wrote it.  Headers, block translation
+// tables, descriptors and rollback logs are always checksummed with x1764.
+
+static inline bool toku_checksum_method_is_valid(int method) {
+    return method == TOKU_CHECKSUM_X1764 || method == TOKU_CHECKSUM_CRC32C;
+}
+
+static inline uint32_t toku_checksum_memory(enum toku_checksum_method method, const void *buf, int len) {
+    if (method == TOKU_CHECKSUM_CRC32C) {
+        return toku_crc32c_memory(buf, len);
+    }
+    return toku_x1764_memory(buf, len);
+}
+
+// For incrementally computing a checksum, use the following interfaces.
+struct toku_checksum {
+    enum toku_checksum_method method;
+    struct x1764 x1764;
+    uint32_t crc32c;
+};
+
+static inline void toku_checksum_init(struct toku_checksum *c, enum toku_checksum_method method) {
+    c->method = method;
+    toku_x1764_init(&c->x1764);
+    c->crc32c = 0;
+}
+
+static inline void toku_checksum_add(struct toku_checksum *c, const void *buf, int len) {
+    if (c->method == TOKU_CHECKSUM_CRC32C) {
+        c->crc32c = toku_crc32c_add(c->crc32c, buf, len);
+    } else {
+        toku_x1764_add(&c->x1764, buf, len);
+    }
+}
+
+static inline uint32_t toku_checksum_finish(struct toku_checksum *c) {
+    if (c->method == TOKU_CHECKSUM_CRC32C) {
+        return c->crc32c;
+    }
+    return toku_x1764_finish(&c->x1764);
+}
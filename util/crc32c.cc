@@ -0,0 +1,292 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include <string.h>
+
+#include <portability/memory.h>
+#include <portability/toku_portability.h>
+
+#include "crc32c.h"
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+// CRC-32C polynomial, bit reflected.
+static const uint32_t crc32c_poly = 0x82f63b78;
+
+// The hardware version runs three independent streams of crc32 instructions
+// over adjacent blocks of the input, which hides the three cycle latency of
+// the instruction, and then merges the three crcs by "shifting" the first two
+// past the bytes covered by the others.  A shift by a fixed number of zero
+// bytes is a linear operator, so it is precomputed into tables for the two
+// block sizes we use.  This follows Mark Adler's public domain crc32c.c.
+static const size_t crc32c_long_block = 8192;
+static const size_t crc32c_short_block = 256;
+
+struct crc32c_tables {
+    uint32_t software[8][256];
+    uint32_t long_shift[4][256];
+    uint32_t short_shift[4][256];
+    bool hardware;
+};
+
+// Multiply the GF(2) 32x32 matrix mat by vec.
+static uint32_t gf2_matrix_times(const uint32_t *mat, uint32_t vec) {
+    uint32_t sum = 0;
+    while (vec) {
+        if (vec & 1) {
+            sum ^= *mat;
+        }
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+static void gf2_matrix_square(uint32_t *square, const uint32_t *mat) {
+    for (int n = 0; n < 32; n++) {
+        square[n] = gf2_matrix_times(mat, mat[n]);
+    }
+}
+
+// Construct the operator that applies len zero bytes to a crc.  len must be
+// a power of two.
+static void crc32c_zeros_op(uint32_t *even, size_t len) {
+    uint32_t odd[32];
+    // operator for one zero bit in odd
+    odd[0] = crc32c_poly;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    // two zero bits in even, four in odd
+    gf2_matrix_square(even, odd);
+    gf2_matrix_square(odd, even);
+    // each square doubles the number of zero bytes, alternating between even
+    // and odd, until len has been shifted down to zero
+    do {
+        gf2_matrix_square(even, odd);
+        len >>= 1;
+        if (len == 0) {
+            return;
+        }
+        gf2_matrix_square(odd, even);
+        len >>= 1;
+    } while (len);
+    for (int n = 0; n < 32; n++) {
+        even[n] = odd[n];
+    }
+}
+
+// Expand the zeros operator for len bytes into four byte-at-a-time tables.
+static void crc32c_zeros(uint32_t zeros[][256], size_t len) {
+    uint32_t op[32];
+    crc32c_zeros_op(op, len);
+    for (uint32_t n = 0; n < 256; n++) {
+        zeros[0][n] = gf2_matrix_times(op, n);
+        zeros[1][n] = gf2_matrix_times(op, n << 8);
+        zeros[2][n] = gf2_matrix_times(op, n << 16);
+        zeros[3][n] = gf2_matrix_times(op, n << 24);
+    }
+}
+
+static inline uint32_t crc32c_shift(const uint32_t zeros[][256], uint32_t crc) {
+    return zeros[0][crc & 0xff] ^ zeros[1][(crc >> 8) & 0xff] ^
+           zeros[2][(crc >> 16) & 0xff] ^ zeros[3][crc >> 24];
+}
+
+static void crc32c_init_tables(struct crc32c_tables *t) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 1) ? (crc >> 1) ^ crc32c_poly : crc >> 1;
+        }
+        t->software[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = t->software[0][n];
+        for (int k = 1; k < 8; k++) {
+            crc = t->software[0][crc & 0xff] ^ (crc >> 8);
+            t->software[k][n] = crc;
+        }
+    }
+    crc32c_zeros(t->long_shift, crc32c_long_block);
+    crc32c_zeros(t->short_shift, crc32c_short_block);
+#if defined(__x86_64__)
+    t->hardware = __builtin_cpu_supports("sse4.2");
+#else
+    t->hardware = false;
+#endif
+}
+
+static const struct crc32c_tables &crc32c_get_tables(void) {
+    // initialized on first use, thread safe
+    static struct crc32c_tables *tables = [] {
+        struct crc32c_tables *XMALLOC(t);
+        crc32c_init_tables(t);
+        return t;
+    }();
+    return *tables;
+}
+
+static uint32_t crc32c_software(const struct crc32c_tables &t, uint32_t crc, const unsigned char *next, size_t len) {
+    uint64_t crc0 = crc ^ 0xffffffff;
+    while (len && ((uintptr_t) next & 7) != 0) {
+        crc0 = t.software[0][(crc0 ^ *next++) & 0xff] ^ (crc0 >> 8);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, next, sizeof word);
+        crc0 ^= word;
+        crc0 = t.software[7][crc0 & 0xff] ^
+               t.software[6][(crc0 >> 8) & 0xff] ^
+               t.software[5][(crc0 >> 16) & 0xff] ^
+               t.software[4][(crc0 >> 24) & 0xff] ^
+               t.software[3][(crc0 >> 32) & 0xff] ^
+               t.software[2][(crc0 >> 40) & 0xff] ^
+               t.software[1][(crc0 >> 48) & 0xff] ^
+               t.software[0][crc0 >> 56];
+        next += 8;
+        len -= 8;
+    }
+    while (len) {
+        crc0 = t.software[0][(crc0 ^ *next++) & 0xff] ^ (crc0 >> 8);
+        len--;
+    }
+    return (uint32_t) crc0 ^ 0xffffffff;
+}
+
+#if defined(__x86_64__)
+static inline uint64_t crc32c_load64(const unsigned char *p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof word);
+    return word;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hardware(const struct crc32c_tables &t, uint32_t crc, const unsigned char *next, size_t len) {
+    uint64_t crc0 = crc ^ 0xffffffff;
+    while (len && ((uintptr_t) next & 7) != 0) {
+        crc0 = _mm_crc32_u8(crc0, *next);
+        next++;
+        len--;
+    }
+    // three streams of crc32 instructions over three adjacent blocks
+    while (len >= crc32c_long_block * 3) {
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        const unsigned char *end = next + crc32c_long_block;
+        do {
+            crc0 = _mm_crc32_u64(crc0, crc32c_load64(next));
+            crc1 = _mm_crc32_u64(crc1, crc32c_load64(next + crc32c_long_block));
+            crc2 = _mm_crc32_u64(crc2, crc32c_load64(next + 2 * crc32c_long_block));
+            next += 8;
+        } while (next < end);
+        crc0 = crc32c_shift(t.long_shift, crc0) ^ crc1;
+        crc0 = crc32c_shift(t.long_shift, crc0) ^ crc2;
+        next += 2 * crc32c_long_block;
+        len -= 3 * crc32c_long_block;
+    }
+    while (len >= crc32c_short_block * 3) {
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        const unsigned char *end = next + crc32c_short_block;
+        do {
+            crc0 = _mm_crc32_u64(crc0, crc32c_load64(next));
+            crc1 = _mm_crc32_u64(crc1, crc32c_load64(next + crc32c_short_block));
+            crc2 = _mm_crc32_u64(crc2, crc32c_load64(next + 2 * crc32c_short_block));
+            next += 8;
+        } while (next < end);
+        crc0 = crc32c_shift(t.short_shift, crc0) ^ crc1;
+        crc0 = crc32c_shift(t.short_shift, crc0) ^ crc2;
+        next += 2 * crc32c_short_block;
+        len -= 3 * crc32c_short_block;
+    }
+    while (len >= 8) {
+        crc0 = _mm_crc32_u64(crc0, crc32c_load64(next));
+        next += 8;
+        len -= 8;
+    }
+    while (len) {
+        crc0 = _mm_crc32_u8(crc0, *next);
+        next++;
+        len--;
+    }
+    return (uint32_t) crc0 ^ 0xffffffff;
+}
+#endif
+
+uint32_t toku_crc32c_add(uint32_t crc, const void *buf, int len) {
+    paranoid_invariant(len >= 0);
+    const struct crc32c_tables &t = crc32c_get_tables();
+    const unsigned char *CAST_FROM_VOIDP(next, buf);
+#if defined(__x86_64__)
+    if (t.hardware) {
+        return crc32c_hardware(t, crc, next, len);
+    }
+#endif
+    return crc32c_software(t, crc, next, len);
+}
+
+uint32_t toku_crc32c_add_software(uint32_t crc, const void *buf, int len) {
+    const unsigned char *CAST_FROM_VOIDP(next, buf);
+    return crc32c_software(crc32c_get_tables(), crc, next, len);
+}
+
+uint32_t toku_crc32c_memory(const void *buf, int len) {
+    return toku_crc32c_add(0, buf, len);
+}
+
+uint32_t toku_crc32c_memory_simple(const void *buf, int len) {
+    const unsigned char *CAST_FROM_VOIDP(next, buf);
+    uint32_t crc = 0xffffffff;
+    for (int i = 0; i < len; i++) {
+        crc ^= next[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 1) ? (crc >> 1) ^ crc32c_poly : crc >> 1;
+        }
+    }
+    return crc ^ 0xffffffff;
+}
+
+bool toku_crc32c_is_hardware_accelerated(void) {
+    return crc32c_get_tables().hardware;
+}
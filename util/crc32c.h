@@ -0,0 +1,61 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#pragma once
+
+#include <toku_stdint.h>
+
+// CRC-32C (the Castagnoli polynomial, as used by iSCSI and ext4).
+// On x86-64 processors with SSE4.2 the crc32 instruction is used, otherwise a
+// table driven (slicing-by-8) implementation.  Both give identical results.
+
+uint32_t toku_crc32c_memory (const void *buf, int len);
+// Effect: Compute crc32c on the bytes of buf.  Return the 32 bit answer.
+
+uint32_t toku_crc32c_memory_simple (const void *buf, int len);
+// Effect: Same as toku_crc32c_memory, but computed one bit at a time.  Useful for testing the optimized versions.
+
+uint32_t toku_crc32c_add (uint32_t crc, const void *buf, int len);
+// Effect: Extend crc, the crc32c of some preceding bytes (0 for no bytes), with the bytes of buf.
+//  toku_crc32c_add(toku_crc32c_memory(a, alen), b, blen) is the crc32c of a followed by b.
+
+bool toku_crc32c_is_hardware_accelerated (void);
+// Effect: Return true if toku_crc32c_memory uses the processor's crc32 instruction.
+
+uint32_t toku_crc32c_add_software (uint32_t crc, const void *buf, int len);
+// Effect: Same as toku_crc32c_add, but never uses the crc32 instruction.  Useful for testing.
@@ -38,7 +38,9 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 
 #include <memory.h>
 
+#include <portability/toku_atomic.h>
 #include <portability/toku_config.h>
+#include <portability/toku_race_tools.h>
 #include <portability/toku_time.h>
 #include <toku_pthread.h>
 
@@ -48,55 +50,96 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 struct todo {
     void (*f)(void *extra);
     void *extra;
+    uint64_t ticket; // order in which the item was enqueued
     struct todo *next;
-    struct todo *prev;
 };
 
+// A queue of work owned by one worker. Items are appended at the tail and
+// taken from the head, by the owner and by other workers alike, so that
+// the oldest item always goes first. This is necessary to avoid deadlocks
+// in flusher threads.
+struct kibbutz_queue {
+    toku_mutex_t mutex;
+    struct todo *head, *tail; // head is the next thing to do.
+    // ticket of head, or EMPTY_TICKET. Written with the mutex held and
+    // read without it, to find work without locking every queue.
+    uint64_t head_ticket;
+};
+
+static const uint64_t EMPTY_TICKET = UINT64_MAX;
+
 struct kid {
     struct kibbutz *k;
+    int id;
+    struct kibbutz_queue queues[KIBBUTZ_NUM_PRIORITIES];
 };
 
 struct kibbutz {
-    toku_mutex_t mutex;
+    toku_mutex_t mutex; // protects sleeping and shutting down, not the queues
     toku_cond_t  cond;
     bool please_shutdown;
-    struct todo *head, *tail; // head is the next thing to do.
+    enum kibbutz_ordering ordering;
     int n_workers;
+    int n_ids;
     pthread_t *workers; // an array of n_workers
     struct kid *ids;    // pass this in when creating a worker so it knows who it is.
+    uint32_t next_id;   // round robin over workers for items with no affinity
+    uint64_t next_ticket;
+    uint64_t n_sleeping;
 
     uint64_t threads_active;
     uint64_t queue_size;
     uint64_t max_queue_size;
     uint64_t total_items_processed;
     uint64_t total_execution_time;
+    uint64_t total_steals;
 };
 
+// the worker this thread is, if it is a kibbutz worker
+static __thread struct kid *current_kid = nullptr;
+
 static void *work_on_kibbutz(void *);
 
 toku_instr_key *kibbutz_mutex_key;
+toku_instr_key *kibbutz_queue_mutex_key;
 toku_instr_key *kibbutz_k_cond_key;
+toku_instr_key *kibbutz_parallel_for_cond_key;
 toku_instr_key *kibbutz_thread_key;
 
-int toku_kibbutz_create(int n_workers, KIBBUTZ *kb_ret) {
+int toku_kibbutz_create(int n_workers, KIBBUTZ *kb_ret, enum kibbutz_ordering ordering) {
     int r = 0;
     *kb_ret = NULL;
     KIBBUTZ XCALLOC(k);
     toku_mutex_init(*kibbutz_mutex_key, &k->mutex, nullptr);
     toku_cond_init(*kibbutz_k_cond_key, &k->cond, nullptr);
     k->please_shutdown = false;
-    k->head = NULL;
-    k->tail = NULL;
+    k->ordering = ordering;
     k->n_workers = n_workers;
+    k->n_ids = n_workers;
+    k->next_id = 0;
+    k->next_ticket = 0;
+    k->n_sleeping = 0;
     k->threads_active = 0;
     k->queue_size = 0;
     k->max_queue_size = 0;
     k->total_items_processed = 0;
     k->total_execution_time = 0;
+    k->total_steals = 0;
     XMALLOC_N(n_workers, k->workers);
     XMALLOC_N(n_workers, k->ids);
+    // every queue must exist before any worker starts looking at them
     for (int i = 0; i < n_workers; i++) {
         k->ids[i].k = k;
+        k->ids[i].id = i;
+        for (int p = 0; p < KIBBUTZ_NUM_PRIORITIES; p++) {
+            struct kibbutz_queue *q = &k->ids[i].queues[p];
+            toku_mutex_init(*kibbutz_queue_mutex_key, &q->mutex, nullptr);
+            q->head = NULL;
+            q->tail = NULL;
+            q->head_ticket = EMPTY_TICKET;
+        }
+    }
+    for (int i = 0; i < n_workers; i++) {
         r = toku_pthread_create(*kibbutz_thread_key,
                                 &k->workers[i],
                                 nullptr,
@@ -126,29 +169,102 @@ static void kwait (KIBBUTZ k) {
 static void ksignal (KIBBUTZ k) {
     toku_cond_signal(&k->cond);
 }
+static void kbroadcast (KIBBUTZ k) {
+    toku_cond_broadcast(&k->cond);
+}
+
+// pops the head of q, if its ticket is the one expected (or any, if
+// expected is EMPTY_TICKET)
+static struct todo *queue_pop(struct kibbutz_queue *q, uint64_t expected) {
+    struct todo *item = NULL;
+    toku_mutex_lock(&q->mutex);
+    if (q->head && (expected == EMPTY_TICKET || q->head->ticket == expected)) {
+        item = q->head;
+        q->head = item->next;
+        if (q->head == NULL) {
+            q->tail = NULL;
+            toku_unsafe_set(&q->head_ticket, EMPTY_TICKET);
+        } else {
+            toku_unsafe_set(&q->head_ticket, q->head->ticket);
+        }
+    }
+    toku_mutex_unlock(&q->mutex);
+    return item;
+}
+
+// takes the oldest item of the given priority off any worker's queue
+static struct todo *take_oldest(KIBBUTZ k, int priority, int *owner) {
+    while (1) {
+        int oldest = -1;
+        uint64_t oldest_ticket = EMPTY_TICKET;
+        for (int i = 0; i < k->n_workers; i++) {
+            uint64_t ticket = toku_unsafe_fetch(&k->ids[i].queues[priority].head_ticket);
+            if (ticket < oldest_ticket) {
+                oldest = i;
+                oldest_ticket = ticket;
+            }
+        }
+        if (oldest < 0) {
+            return NULL;
+        }
+        struct todo *item = queue_pop(&k->ids[oldest].queues[priority], oldest_ticket);
+        if (item) {
+            *owner = oldest;
+            return item;
+        }
+        // someone else got there first, look again
+    }
+}
+
+// takes the oldest item of the given priority off our own queue, or failing
+// that, off the next worker's queue that has one
+static struct todo *take_own_or_steal(struct kid *kid, int priority, int *owner) {
+    KIBBUTZ k = kid->k;
+    for (int i = 0; i < k->n_workers; i++) {
+        int victim = (kid->id + i) % k->n_workers;
+        struct kibbutz_queue *q = &k->ids[victim].queues[priority];
+        if (toku_unsafe_fetch(&q->head_ticket) == EMPTY_TICKET) {
+            continue;
+        }
+        struct todo *item = queue_pop(q, EMPTY_TICKET);
+        if (item) {
+            *owner = victim;
+            return item;
+        }
+    }
+    return NULL;
+}
+
+static struct todo *take_work(struct kid *kid) {
+    KIBBUTZ k = kid->k;
+    for (int p = 0; p < KIBBUTZ_NUM_PRIORITIES; p++) {
+        int owner = kid->id;
+        struct todo *item = k->ordering == KIBBUTZ_FIFO
+            ? take_oldest(k, p, &owner)
+            : take_own_or_steal(kid, p, &owner);
+        if (item) {
+            toku_sync_sub_and_fetch(&k->queue_size, 1);
+            if (owner != kid->id) {
+                toku_sync_add_and_fetch(&k->total_steals, 1);
+            }
+            return item;
+        }
+    }
+    return NULL;
+}
 
 //
-// pops the tail of the kibbutz off the list and works on it
-// Note that in toku_kibbutz_enq, items are enqueued at the head,
-// making the work be done in FIFO order. This is necessary
-// to avoid deadlocks in flusher threads.
+// takes work off the queues and works on it, see take_oldest and
+// take_own_or_steal for which item is chosen. When there is nothing to do,
+// the worker sleeps until toku_kibbutz_enq wakes it.
 //
 static void *work_on_kibbutz (void *kidv) {
     struct kid *CAST_FROM_VOIDP(kid, kidv);
     KIBBUTZ k = kid->k;
-    klock(k);
+    current_kid = kid;
     while (1) {
-        while (k->tail) {
-            struct todo *item = k->tail;
-            k->tail = item->prev;
-            toku_sync_sub_and_fetch(&k->queue_size, 1);
-            if (k->tail==NULL) {
-                k->head=NULL;
-            } else {
-                // if there are other things to do, then wake up the next guy, if there is one.
-                ksignal(k);
-            }
-            kunlock(k);
+        struct todo *item = take_work(kid);
+        if (item) {
             toku_sync_add_and_fetch(&k->threads_active, 1);
             uint64_t starttime = toku_current_time_microsec();
             item->f(item->extra);
@@ -157,51 +273,166 @@ static void *work_on_kibbutz (void *kidv) {
             toku_sync_add_and_fetch(&k->total_items_processed, 1);
             toku_sync_sub_and_fetch(&k->threads_active, 1);
             toku_free(item);
-            klock(k);
-            // if there's another item on k->head, then we'll just go grab it now, without waiting for a signal.
+            // if there's another item queued, then we'll just go grab it now, without waiting for a signal.
+            continue;
+        }
+        klock(k);
+        // Announce that we are about to sleep before looking at the queue
+        // size one last time. The enqueuer bumps the queue size before it
+        // looks for sleepers, so one of us always sees the other.
+        toku_sync_add_and_fetch(&k->n_sleeping, 1);
+        if (toku_unsafe_fetch(&k->queue_size) == 0 && !k->please_shutdown) {
+            // There is no work to do and it's not time to shutdown, so wait.
+            kwait(k);
         }
-        if (k->please_shutdown) {
+        toku_sync_sub_and_fetch(&k->n_sleeping, 1);
+        if (k->please_shutdown && toku_unsafe_fetch(&k->queue_size) == 0) {
             // Don't follow this unless the work is all done, so that when we
             // set please_shutdown, all the work finishes before any threads
             // quit.
-            ksignal(k);  // must wake up anyone else who is waiting, so they can
-                         // shut down.
             kunlock(k);
             toku_instr_delete_current_thread();
             return nullptr;
         }
-        // There is no work to do and it's not time to shutdown, so wait.
-        kwait(k);
+        kunlock(k);
+    }
+}
+
+static struct kid *choose_kid(KIBBUTZ k) {
+    if (k->ordering == KIBBUTZ_WORK_STEALING && current_kid && current_kid->k == k) {
+        // work spawned by a worker stays with that worker unless stolen
+        return current_kid;
     }
+    uint32_t id = toku_sync_fetch_and_add(&k->next_id, 1);
+    return &k->ids[id % k->n_workers];
 }
 
 //
-// adds work to the head of the kibbutz 
-// Note that in work_on_kibbutz, items are popped off the tail for work,
+// adds work to the tail of a worker's queue 
+// Note that in work_on_kibbutz, items are popped off the head for work,
 // making the work be done in FIFO order. This is necessary
 // to avoid deadlocks in flusher threads.
 //
-void toku_kibbutz_enq (KIBBUTZ k, void (*f)(void*), void *extra) {
+static void kibbutz_enq_on(KIBBUTZ k, struct kid *kid, void (*f)(void*), void *extra, enum kibbutz_priority priority) {
     struct todo *XMALLOC(td);
     td->f = f;
     td->extra = extra;
-    klock(k);
-    assert(!k->please_shutdown);
-    td->next = k->head;
-    td->prev = NULL;
-    if (k->head) {
-        assert(k->head->prev == NULL);
-        k->head->prev = td;
+    td->next = NULL;
+    assert(!toku_unsafe_fetch(&k->please_shutdown));
+    struct kibbutz_queue *q = &kid->queues[priority];
+    toku_mutex_lock(&q->mutex);
+    // take the ticket under the queue's mutex, so tickets on one queue
+    // are in order
+    td->ticket = toku_sync_fetch_and_add(&k->next_ticket, 1);
+    if (q->tail) {
+        q->tail->next = td;
+    } else {
+        q->head = td;
+        toku_unsafe_set(&q->head_ticket, td->ticket);
     }
-    k->head = td;
-    if (k->tail==NULL) k->tail = td;
+    q->tail = td;
+    toku_mutex_unlock(&q->mutex);
 
     uint64_t newsize = toku_sync_add_and_fetch(&k->queue_size, 1);
     // not exactly precise but we'll live with it
-    if (newsize > k->max_queue_size) k->max_queue_size = k->queue_size;
+    if (newsize > k->max_queue_size) k->max_queue_size = newsize;
 
-    ksignal(k);
-    kunlock(k);
+    if (toku_unsafe_fetch(&k->n_sleeping) > 0) {
+        klock(k);
+        ksignal(k);
+        kunlock(k);
+    }
+}
+
+void toku_kibbutz_enq (KIBBUTZ k, void (*f)(void*), void *extra) {
+    kibbutz_enq_on(k, choose_kid(k), f, extra, KIBBUTZ_PRIORITY_BACKGROUND);
+}
+
+void toku_kibbutz_enq_with_priority (KIBBUTZ k, void (*f)(void*), void *extra, enum kibbutz_priority priority) {
+    kibbutz_enq_on(k, choose_kid(k), f, extra, priority);
+}
+
+void toku_kibbutz_enq_with_affinity (KIBBUTZ k, void (*f)(void*), void *extra, enum kibbutz_priority priority, uint32_t affinity) {
+    kibbutz_enq_on(k, &k->ids[affinity % k->n_workers], f, extra, priority);
+}
+
+// The state of a toku_kibbutz_parallel_for. It is shared by the caller and
+// the workers that help it, and freed by whichever of them lets go last,
+// since a helper may only get to run after the loop is long done.
+struct parallel_for {
+    void (*f)(void *extra, int i);
+    void *extra;
+    int n;
+    int next;      // next index to hand out
+    int finished;  // number of indexes done, protected by mutex
+    int refs;
+    toku_mutex_t mutex;
+    toku_cond_t finished_cond;
+};
+
+static void parallel_for_release(struct parallel_for *pf) {
+    if (toku_sync_sub_and_fetch(&pf->refs, 1) == 0) {
+        toku_cond_destroy(&pf->finished_cond);
+        toku_mutex_destroy(&pf->mutex);
+        toku_free(pf);
+    }
+}
+
+static void parallel_for_work(struct parallel_for *pf) {
+    int i;
+    while ((i = toku_sync_fetch_and_add(&pf->next, 1)) < pf->n) {
+        pf->f(pf->extra, i);
+        toku_mutex_lock(&pf->mutex);
+        if (++pf->finished == pf->n) {
+            toku_cond_signal(&pf->finished_cond);
+        }
+        toku_mutex_unlock(&pf->mutex);
+    }
+}
+
+static void parallel_for_helper(void *extra) {
+    struct parallel_for *CAST_FROM_VOIDP(pf, extra);
+    parallel_for_work(pf);
+    parallel_for_release(pf);
+}
+
+void toku_kibbutz_parallel_for (KIBBUTZ k, int n, int max_threads, void (*f)(void *extra, int i), void *extra) {
+    int helpers = n - 1;
+    if (helpers > max_threads - 1) {
+        helpers = max_threads - 1;
+    }
+    if (helpers > 0 && helpers > k->n_workers) {
+        helpers = k->n_workers;
+    }
+    if (helpers <= 0) {
+        for (int i = 0; i < n; i++) {
+            f(extra, i);
+        }
+        return;
+    }
+
+    struct parallel_for *XMALLOC(pf);
+    pf->f = f;
+    pf->extra = extra;
+    pf->n = n;
+    pf->next = 0;
+    pf->finished = 0;
+    pf->refs = helpers + 1;
+    toku_mutex_init(*kibbutz_mutex_key, &pf->mutex, nullptr);
+    toku_cond_init(*kibbutz_parallel_for_cond_key, &pf->finished_cond, nullptr);
+    // spread the helpers over different workers' queues, even when called
+    // from a worker
+    uint32_t id = toku_sync_fetch_and_add(&k->next_id, helpers);
+    for (int i = 0; i < helpers; i++) {
+        kibbutz_enq_on(k, &k->ids[(id + i) % k->n_workers], parallel_for_helper, pf, KIBBUTZ_PRIORITY_CLIENT);
+    }
+    parallel_for_work(pf);
+    toku_mutex_lock(&pf->mutex);
+    while (pf->finished < n) {
+        toku_cond_wait(&pf->finished_cond, &pf->mutex);
+    }
+    toku_mutex_unlock(&pf->mutex);
+    parallel_for_release(pf);
 }
 
 void toku_kibbutz_get_status(KIBBUTZ k,
@@ -210,13 +441,15 @@ void toku_kibbutz_get_status(KIBBUTZ k,
                              uint64_t *queue_size,
                              uint64_t *max_queue_size,
                              uint64_t *total_items_processed,
-                             uint64_t *total_execution_time) {
+                             uint64_t *total_execution_time,
+                             uint64_t *total_steals) {
     *num_threads = k->n_workers;
     *num_threads_active = k->threads_active;
     *queue_size = k->queue_size;
     *max_queue_size = k->max_queue_size;
     *total_items_processed = k->total_items_processed;
     *total_execution_time = k->total_execution_time / 1000; // return in ms.
+    *total_steals = k->total_steals;
 }
 
 void toku_kibbutz_destroy (KIBBUTZ k)
@@ -226,7 +459,7 @@ void toku_kibbutz_destroy (KIBBUTZ k)
     klock(k);
     assert(!k->please_shutdown);
     k->please_shutdown = true;
-    ksignal(k); // must wake everyone up to tell them to shutdown.
+    kbroadcast(k); // must wake everyone up to tell them to shutdown.
     kunlock(k);
     for (int i=0; i<k->n_workers; i++) {
         void *result;
@@ -234,6 +467,13 @@ void toku_kibbutz_destroy (KIBBUTZ k)
         assert(r==0);
         assert(result==NULL);
     }
+    for (int i = 0; i < k->n_ids; i++) {
+        for (int p = 0; p < KIBBUTZ_NUM_PRIORITIES; p++) {
+            struct kibbutz_queue *q = &k->ids[i].queues[p];
+            assert(q->head == NULL);
+            toku_mutex_destroy(&q->mutex);
+        }
+    }
     toku_free(k->workers);
     toku_free(k->ids);
     toku_cond_destroy(&k->cond);
@@ -41,24 +41,67 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 //
 // The kibbutz is another threadpool meant to do arbitrary work.
 //
+// Each worker owns a queue of work per priority, each with its own lock,
+// so that enqueuers and workers do not all serialize on one mutex. A
+// worker with nothing to do takes work from the other workers' queues.
+//
 
 typedef struct kibbutz *KIBBUTZ;
+
+// How workers choose the next workitem.
+enum kibbutz_ordering {
+    // Workers always take the oldest workitem of the highest priority,
+    // whichever queue it is on. See the invariant at toku_kibbutz_enq.
+    KIBBUTZ_FIFO = 0,
+    // Workers take the oldest workitem on their own queue, and only take
+    // from other workers' queues when their own is empty. Workitems may
+    // start out of order.
+    KIBBUTZ_WORK_STEALING,
+};
+
+// Workers run all queued CLIENT workitems before any BACKGROUND ones.
+enum kibbutz_priority {
+    KIBBUTZ_PRIORITY_CLIENT = 0,    // a client thread is waiting for the result
+    KIBBUTZ_PRIORITY_BACKGROUND,    // nobody is waiting for the result
+    KIBBUTZ_NUM_PRIORITIES
+};
+
 //
 // create a kibbutz where n_workers is the number of threads in the threadpool
 //
-int toku_kibbutz_create (int n_workers, KIBBUTZ *kb);
+int toku_kibbutz_create (int n_workers, KIBBUTZ *kb, enum kibbutz_ordering ordering = KIBBUTZ_FIFO);
 //
 // enqueue a workitem in the kibbutz. When the kibbutz is to work on this workitem,
 // it calls f(extra). 
 // At any time, the kibbutz is operating on at most n_workers jobs. 
-// Other enqueued workitems are on a queue. An invariant is 
-// that no currently enqueued item was placed on the queue before 
-// any item that is currently being operated on. Another way to state
-// this is that all items on the queue were placed there before any item
-// that is currently being worked on
+// Other enqueued workitems are on a queue. For a KIBBUTZ_FIFO kibbutz, an
+// invariant is that no currently enqueued item was placed on the queue before
+// any item of the same priority that is currently being operated on. Another
+// way to state this is that all items on the queue were placed there before
+// any item of that priority that is currently being worked on
+//
+// The workitem is enqueued with background priority.
 //
 void toku_kibbutz_enq (KIBBUTZ k, void (*f)(void*), void *extra);
 //
+// enqueue a workitem with the given priority
+//
+void toku_kibbutz_enq_with_priority (KIBBUTZ k, void (*f)(void*), void *extra, enum kibbutz_priority priority);
+//
+// enqueue a workitem on the queue of the worker chosen by affinity, so that
+// workitems with the same affinity (say, for the same pair) tend to run on
+// the same thread. It is only a hint, an idle worker may still take it.
+//
+void toku_kibbutz_enq_with_affinity (KIBBUTZ k, void (*f)(void*), void *extra, enum kibbutz_priority priority, uint32_t affinity);
+//
+// call f(extra, i) for every i in [0, n) and return when all calls are done.
+// The calling thread works on the loop too, along with up to
+// max_threads - 1 workers of the kibbutz, which run at client priority.
+// The caller never waits for a worker to get around to the loop, so it is
+// safe to call from a workitem of the same kibbutz.
+//
+void toku_kibbutz_parallel_for (KIBBUTZ k, int n, int max_threads, void (*f)(void *extra, int i), void *extra);
+//
 // get kibbuts status
 //
 void toku_kibbutz_get_status(KIBBUTZ k,
@@ -67,7 +110,8 @@ void toku_kibbutz_get_status(KIBBUTZ k,
                              uint64_t *queue_size,
                              uint64_t *max_queue_size,
                              uint64_t *total_items_processed,
-                             uint64_t *total_execution_time);
+                             uint64_t *total_execution_time,
+                             uint64_t *total_steals);
 //
 // destroys the kibbutz
 //
@@ -0,0 +1,159 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+#include <portability/memory.h>
+#include <portability/toku_os.h>
+#include <util/aio.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define NBLOCKS 100
+#define BLOCKSIZE 4096
+
+static void fill_block(char *buf, int b) {
+    for (int i = 0; i < BLOCKSIZE; i++) {
+        buf[i] = (char) (b * 31 + i);
+    }
+}
+
+static void aio_test(const char *fname, bool use_io_uring, uint32_t queue_depth) {
+    TOKU_AIO aio;
+    int r = toku_aio_create(&aio, queue_depth, use_io_uring);
+    assert(r == 0);
+    if (verbose) printf("backend %s queue depth %u\n", toku_aio_backend_name(aio), queue_depth);
+    if (!use_io_uring) {
+        assert(strcmp(toku_aio_backend_name(aio), "threadpool") == 0);
+    }
+
+    unlink(fname);
+    int fd = open(fname, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    assert(fd >= 0);
+
+    char *wbuf, *rbuf;
+    XMALLOC_N_ALIGNED(512, NBLOCKS * BLOCKSIZE, wbuf);
+    XMALLOC_N_ALIGNED(512, NBLOCKS * BLOCKSIZE, rbuf);
+    struct toku_aio_request reqs[NBLOCKS];
+
+    // write every block in one batch, in reverse order
+    for (int b = 0; b < NBLOCKS; b++) {
+        fill_block(wbuf + b * BLOCKSIZE, b);
+        struct toku_aio_request *req = &reqs[NBLOCKS - 1 - b];
+        req->fd = fd;
+        req->buf = wbuf + b * BLOCKSIZE;
+        req->len = BLOCKSIZE;
+        req->offset = (toku_off_t) b * BLOCKSIZE;
+        req->is_write = true;
+    }
+    struct toku_aio_batch batch;
+    toku_aio_batch_init(&batch);
+    toku_aio_submit(aio, &batch, reqs, NBLOCKS);
+    toku_aio_wait(aio, &batch);
+    for (int i = 0; i < NBLOCKS; i++) {
+        assert(reqs[i].result == BLOCKSIZE);
+    }
+
+    // read them back as two interleaved batches
+    memset(rbuf, 0, NBLOCKS * BLOCKSIZE);
+    struct toku_aio_batch even, odd;
+    toku_aio_batch_init(&even);
+    toku_aio_batch_init(&odd);
+    for (int b = 0; b < NBLOCKS; b++) {
+        struct toku_aio_request *req = &reqs[b];
+        req->fd = fd;
+        req->buf = rbuf + b * BLOCKSIZE;
+        req->len = BLOCKSIZE;
+        req->offset = (toku_off_t) b * BLOCKSIZE;
+        req->is_write = false;
+        toku_aio_submit(aio, (b % 2) ? &odd : &even, req, 1);
+    }
+    toku_aio_wait(aio, &odd);
+    toku_aio_wait(aio, &even);
+    for (int b = 0; b < NBLOCKS; b++) {
+        assert(reqs[b].result == BLOCKSIZE);
+    }
+    assert(memcmp(rbuf, wbuf, NBLOCKS * BLOCKSIZE) == 0);
+
+    // a read that runs off the end of the file is short, like pread
+    struct toku_aio_request tail;
+    tail.fd = fd;
+    tail.buf = rbuf;
+    tail.len = 2 * BLOCKSIZE;
+    tail.offset = (toku_off_t) (NBLOCKS - 1) * BLOCKSIZE;
+    tail.is_write = false;
+    toku_aio_batch_init(&batch);
+    toku_aio_submit(aio, &batch, &tail, 1);
+    toku_aio_wait(aio, &batch);
+    assert(tail.result == BLOCKSIZE);
+    assert(memcmp(rbuf, wbuf + (NBLOCKS - 1) * BLOCKSIZE, BLOCKSIZE) == 0);
+
+    // a read from a bad file descriptor reports the error
+    struct toku_aio_request bad;
+    bad.fd = -1;
+    bad.buf = rbuf;
+    bad.len = BLOCKSIZE;
+    bad.offset = 0;
+    bad.is_write = false;
+    toku_aio_batch_init(&batch);
+    toku_aio_submit(aio, &batch, &bad, 1);
+    toku_aio_wait(aio, &batch);
+    assert(bad.result == -EBADF);
+
+    toku_free(wbuf);
+    toku_free(rbuf);
+    r = close(fd);
+    assert(r == 0);
+    unlink(fname);
+    toku_aio_destroy(aio);
+}
+
+int
+test_main (int argc , const char *argv[]) {
+    default_parse_args(argc, argv);
+
+    char fname[64];
+    snprintf(fname, sizeof fname, "aio-test-%d.data", toku_os_getpid());
+    aio_test(fname, false, 4);
+    aio_test(fname, true, 1);
+    aio_test(fname, true, 8);
+    aio_test(fname, true, 256);
+    if (verbose) printf("test ok\n");
+    return 0;
+}
@@ -0,0 +1,142 @@
+/* -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+// vim: ft=cpp:expandtab:ts=8:sw=4:softtabstop=4:
+#ident "$Id$"
+/*======
+This file is part of PerconaFT.
+
+
+Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License, version 2,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------
+
+    PerconaFT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License, version 3,
+    as published by the Free Software Foundation.
+
+    PerconaFT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with PerconaFT.  If not, see <http://www.gnu.org/licenses/>.
+======= */
+
+#ident "Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved."
+
+#include "test.h"
+#include <portability/memory.h>
+#include <util/crc32c.h>
+#include <util/x1764.h>
+#include <sys/time.h>
+
+static void
+test0 (void) {
+    assert(toku_crc32c_memory("", 0) == 0);
+    assert(toku_crc32c_memory_simple("", 0) == 0);
+    // The standard check value for crc32c.
+    assert(toku_crc32c_memory("123456789", 9) == 0xe3069283);
+    assert(toku_crc32c_memory_simple("123456789", 9) == 0xe3069283);
+    assert(toku_crc32c_add_software(0, "123456789", 9) == 0xe3069283);
+}
+
+// Compute checksums incrementally, using random strides
+static void
+test1 (void) {
+    enum { N=200 };
+    char v[N];
+    for (int i=0; i<N; i++) v[i]=(char)random();
+    for (int i=0; i<N; i++) {
+        for (int j=i; j<=N; j++) {
+            uint32_t c = toku_crc32c_memory(&v[i], j-i);
+            int k=i;
+            uint32_t c2 = 0;
+            while (1) {
+                int stride=random()%16;
+                if (k+stride>j) break;
+                c2 = toku_crc32c_add(c2, &v[k], stride);
+                k+=stride;
+            }
+            c2 = toku_crc32c_add(c2, &v[k], j-k);
+            assert(c2==c);
+        }
+    }
+}
+
+static void
+test2 (void)
+// Compare the simple version to the table driven and hardware versions,
+// including lengths that cover the interleaved hardware blocks.
+{
+    const int datalen = 3*8192 + 1000;
+    char *XMALLOC_N(datalen, data);
+    for (int i=0; i<datalen; i++) data[i]=random();
+    for (int off=0; off<16; off++) {
+        if (verbose) {printf("."); fflush(stdout);}
+        for (int len=0; len+off<datalen; len += (len < 1000) ? 1 : 97) {
+            uint32_t reference_sum = toku_crc32c_memory_simple(data+off, len);
+            uint32_t table_sum     = toku_crc32c_add_software(0, data+off, len);
+            uint32_t fast_sum      = toku_crc32c_memory       (data+off, len);
+            assert(reference_sum==table_sum);
+            assert(reference_sum==fast_sum);
+        }
+    }
+    if (verbose) printf("\n");
+    toku_free(data);
+}
+
+static double
+tdiff (struct timeval *a, struct timeval *b) {
+    return (a->tv_sec - b->tv_sec) + 1e-6 * (a->tv_usec - b->tv_usec);
+}
+
+static void
+test3 (void)
+// Compare throughput against x1764 on node sized buffers.
+{
+    const int datalen = 4<<20;
+    const int iters = 16;
+    char *XMALLOC_N(datalen, data);
+    for (int i=0; i<datalen; i++) data[i]=random();
+    uint32_t sum = 0;
+    struct timeval t0, t1, t2;
+    gettimeofday(&t0, NULL);
+    for (int i=0; i<iters; i++) sum += toku_x1764_memory(data, datalen);
+    gettimeofday(&t1, NULL);
+    for (int i=0; i<iters; i++) sum += toku_crc32c_memory(data, datalen);
+    gettimeofday(&t2, NULL);
+    if (verbose) {
+        double mb = (double) datalen * iters / (1<<20);
+        printf("x1764  %8.1f MB/s\n", mb / tdiff(&t1, &t0));
+        printf("crc32c %8.1f MB/s (%s)\n", mb / tdiff(&t2, &t1),
+               toku_crc32c_is_hardware_accelerated() ? "sse4.2" : "table");
+        printf("sum %08x\n", sum);
+    }
+    toku_free(data);
+}
+
+int
+test_main (int argc, const char *argv[]) {
+    default_parse_args(argc, argv);
+    if (verbose) printf("0\n");
+    test0();
+    if (verbose) printf("1\n");
+    test1();
+    if (verbose) printf("2\n");
+    test2();
+    if (verbose) printf("3\n");
+    test3();
+    return 0;
+}
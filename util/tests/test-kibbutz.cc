@@ -39,8 +39,12 @@ Copyright (c) 2006, 2015, Percona and/or its affiliates. All rights reserved.
 #include "test.h"
 #include <util/kibbutz.h>
 
+#include <inttypes.h>
 #include <memory.h>
 #include <stdio.h>
+#include <portability/toku_atomic.h>
+#include <portability/toku_time.h>
+#include <toku_pthread.h>
 
 #define ND 10
 #define NT 4
@@ -78,12 +82,97 @@ static void kibbutz_test (bool parent_finishes_first) {
     for (int i=0; i<ND; i++) assert(done[i]);
 }
 
+// Throughput benchmark: NP producers each enqueue NI tiny workitems, half
+// of them spawning one more workitem from the worker, which a work stealing
+// kibbutz keeps on that worker's queue unless another worker steals it.
+
+#define NP 4
+#define NI 100000
+
+struct throughput_extra {
+    KIBBUTZ k;
+    uint64_t n_done;
+};
+
+static void tiny_work (void *ev) {
+    struct throughput_extra *CAST_FROM_VOIDP(e, ev);
+    toku_sync_fetch_and_add(&e->n_done, 1);
+}
+
+static void spawning_work (void *ev) {
+    struct throughput_extra *CAST_FROM_VOIDP(e, ev);
+    toku_kibbutz_enq(e->k, tiny_work, e);
+    toku_sync_fetch_and_add(&e->n_done, 1);
+}
+
+static void *producer (void *ev) {
+    struct throughput_extra *CAST_FROM_VOIDP(e, ev);
+    for (int i = 0; i < NI; i++) {
+        if (i % 2 == 0) {
+            toku_kibbutz_enq(e->k, spawning_work, e);
+        } else {
+            toku_kibbutz_enq_with_priority(e->k, tiny_work, e, KIBBUTZ_PRIORITY_CLIENT);
+        }
+    }
+    return ev;
+}
+
+static void sum_range (void *ev, int i) {
+    uint64_t *CAST_FROM_VOIDP(sum, ev);
+    toku_sync_fetch_and_add(sum, i);
+}
+
+static void kibbutz_throughput_test (enum kibbutz_ordering ordering) {
+    KIBBUTZ k = NULL;
+    int r = toku_kibbutz_create(NT, &k, ordering);
+    assert(r == 0);
+    struct throughput_extra e = { .k = k, .n_done = 0 };
+
+    uint64_t start = toku_current_time_microsec();
+    toku_pthread_t producers[NP];
+    for (int i = 0; i < NP; i++) {
+        r = toku_pthread_create(toku_uninstrumented, &producers[i], nullptr, producer, &e);
+        assert(r == 0);
+    }
+    for (int i = 0; i < NP; i++) {
+        void *ret;
+        r = toku_pthread_join(producers[i], &ret);
+        assert(r == 0);
+    }
+    // the caller and the workers all help with the loop
+    uint64_t sum = 0;
+    toku_kibbutz_parallel_for(k, 1000, NT + 1, sum_range, &sum);
+    assert(sum == 1000 * 999 / 2);
+
+    // workitems may still be spawning more, so wait for them before destroying
+    const uint64_t n_items = NP * NI + NP * NI / 2;
+    while (toku_sync_fetch_and_add(&e.n_done, 0) < n_items) {
+        usleep(1000);
+    }
+    uint64_t duration = toku_current_time_microsec() - start;
+    uint64_t num_threads, active, queue_size, max_queue_size, processed, exec_time, steals;
+    toku_kibbutz_get_status(k, &num_threads, &active, &queue_size, &max_queue_size, &processed, &exec_time, &steals);
+    toku_kibbutz_destroy(k);
+
+    assert(e.n_done == n_items);
+    assert(num_threads == NT);
+    assert(steals <= processed);
+    if (verbose) {
+        printf("%s: %" PRIu64 " items in %" PRIu64 "us, %.0f items/s, max queue %" PRIu64 ", %" PRIu64 " stolen\n",
+               ordering == KIBBUTZ_FIFO ? "fifo" : "work stealing",
+               n_items, duration, n_items * 1e6 / (duration ? duration : 1),
+               max_queue_size, steals);
+    }
+}
+
 int
 test_main (int argc , const char *argv[]) {
     default_parse_args(argc, argv);
     
     kibbutz_test(false);
     kibbutz_test(true);
+    kibbutz_throughput_test(KIBBUTZ_FIFO);
+    kibbutz_throughput_test(KIBBUTZ_WORK_STEALING);
     if (verbose) printf("test ok\n");
     return 0;
 }
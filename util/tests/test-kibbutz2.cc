@@ -77,11 +77,46 @@ static void kibbutz_test (void) {
     for (int i=0; i<ND; i++) assert(done[i]);
 }
 
+// With one worker, queued client workitems run before queued background
+// ones, and each priority is FIFO.
+
+static int order[4];
+static int n_ordered;
+
+static void record (void *idv) {
+    int *CAST_FROM_VOIDP(idp, idv);
+    order[n_ordered++] = *idp;
+}
+
+static void blocker (void *UU(extra)) {
+    // hold the only worker until everything else is queued
+    sleep(1);
+}
+
+static void kibbutz_priority_test (void) {
+    KIBBUTZ k = NULL;
+    int r = toku_kibbutz_create(1, &k);
+    assert(r == 0);
+    n_ordered = 0;
+    int ids[4] = { 0, 1, 2, 3 };
+    toku_kibbutz_enq(k, blocker, nullptr);
+    toku_kibbutz_enq(k, record, &ids[2]);
+    toku_kibbutz_enq_with_priority(k, record, &ids[0], KIBBUTZ_PRIORITY_CLIENT);
+    toku_kibbutz_enq(k, record, &ids[3]);
+    toku_kibbutz_enq_with_affinity(k, record, &ids[1], KIBBUTZ_PRIORITY_CLIENT, 17);
+    toku_kibbutz_destroy(k);
+    assert(n_ordered == 4);
+    for (int i = 0; i < 4; i++) {
+        assert(order[i] == i);
+    }
+}
+
 int
 test_main (int argc , const char *argv[]) {
     default_parse_args(argc, argv);
     
     kibbutz_test();
+    kibbutz_priority_test();
     if (verbose) printf("test ok\n");
     return 0;
 }